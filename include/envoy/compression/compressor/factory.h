@@ -16,6 +16,7 @@ public:
 };
 
 using CompressorFactoryPtr = std::unique_ptr<CompressorFactory>;
+using CompressorFactorySharedPtr = std::shared_ptr<CompressorFactory>;
 
 } // namespace Compressor
 } // namespace Compression
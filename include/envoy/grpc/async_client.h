@@ -66,6 +66,24 @@ public:
   virtual bool isAboveWriteBufferHighWatermark() const PURE;
 };
 
+/**
+ * The streams of the Envoy gRPC client, which frames the messages itself, also send messages
+ * compressed by the caller. The Google gRPC client compresses the messages itself, configured
+ * through the channel_args of the GoogleGrpc service, so its streams do not implement this.
+ */
+class RawCompressedAsyncStream {
+public:
+  virtual ~RawCompressedAsyncStream() = default;
+
+  /**
+   * Send a request message which is already compressed with the message encoding announced in the
+   * grpc-encoding initial metadata. The message is framed with the compressed flag set.
+   * @param request serialized and compressed message.
+   * @param end_stream close the stream locally. @see RawAsyncStream::sendMessageRaw().
+   */
+  virtual void sendCompressedMessageRaw(Buffer::InstancePtr&& request, bool end_stream) PURE;
+};
+
 class RawAsyncRequestCallbacks {
 public:
   virtual ~RawAsyncRequestCallbacks() = default;
@@ -295,6 +295,13 @@ public:
    */
   virtual bool aboveHighWatermark() const PURE;
 
+  /**
+   * @return boolean telling if the connection buffers no data, i.e. if the filters consumed all the
+   *         data read from the socket and all the data written to the connection went out to the
+   *         socket.
+   */
+  virtual bool buffersEmpty() const PURE;
+
   /**
    * Get the socket options set on this connection.
    */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 
 #include "envoy/network/connection.h"
@@ -105,6 +106,33 @@ public:
    */
   virtual const std::string& statPrefix() const PURE;
 
+  /**
+   * Callback invoked for a connection released by releaseTransferableConnections().
+   * @param io_handle supplies a duplicate of the connection's socket.
+   * @param listener_address supplies the address of the listener which accepted the connection.
+   */
+  using ReleasedConnectionCb =
+      std::function<void(IoHandlePtr&& io_handle, const Address::Instance& listener_address)>;
+
+  /**
+   * Release the connections of the TCP listeners which another process can take over, i.e. the
+   * connections whose filters report through Network::TransferableConnection that they are idle.
+   * Each released connection is closed once its pending writes are flushed, which leaves the peer
+   * connected through the duplicate of its socket.
+   * @param cb supplies the callback invoked for each released connection.
+   */
+  virtual void releaseTransferableConnections(const ReleasedConnectionCb& cb) PURE;
+
+  /**
+   * Adopt a connection which another process released. The connection skips the listener filters
+   * since the other process already ran them.
+   * @param listener_address supplies the address of the listener which accepted the connection.
+   * @param socket supplies the connection's socket.
+   * @return false if there is no TCP listener on the address, in which case the socket is closed.
+   */
+  virtual bool adoptConnection(const Address::Instance& listener_address,
+                               ConnectionSocketPtr&& socket) PURE;
+
   /**
    * Used by ConnectionHandler to manage listeners.
    */
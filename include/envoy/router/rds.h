@@ -52,9 +52,16 @@ public:
 
   /**
    * Validate if the route configuration can be applied to the context of the route config provider.
+   * The provider may keep the route table it built to validate the configuration, which the
+   * onConfigUpdate() that follows then publishes rather than building it again.
+   * @throw EnvoyException if the configuration is invalid.
    */
-  virtual void
-  validateConfig(const envoy::config::route::v3::RouteConfiguration& config) const PURE;
+  virtual void validateConfig(const envoy::config::route::v3::RouteConfiguration& config) PURE;
+
+  /**
+   * Drops what the last validateConfig() kept, when the configuration it validated is not applied.
+   */
+  virtual void discardValidatedConfig() PURE;
 
   /**
    * Callback used to request an update to the route configuration from the management server.
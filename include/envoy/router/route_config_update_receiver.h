@@ -26,10 +26,12 @@ public:
    * Called on updates via RDS.
    * @param rc supplies the RouteConfiguration.
    * @param version_info supplies RouteConfiguration version.
+   * @param config_hash supplies the hash of the RouteConfiguration, which the caller has already
+   *        computed to tell whether it changed.
    * @return bool whether RouteConfiguration has been updated.
    */
   virtual bool onRdsUpdate(const envoy::config::route::v3::RouteConfiguration& rc,
-                           const std::string& version_info) PURE;
+                           const std::string& version_info, uint64_t config_hash) PURE;
 
   using VirtualHostRefVector =
       std::vector<std::reference_wrapper<const envoy::config::route::v3::VirtualHost>>;
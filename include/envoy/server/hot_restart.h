@@ -1,10 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <string>
 
 #include "envoy/common/pure.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/ssl/context_manager.h"
 #include "envoy/stats/allocator.h"
 #include "envoy/stats/store.h"
 #include "envoy/thread/thread.h"
@@ -28,6 +30,8 @@ public:
     uint64_t parent_connections_ = 0;
   };
 
+  using ParentConnectionCb = std::function<void(int fd, const std::string& listener_address)>;
+
   virtual ~HotRestart() = default;
 
   /**
@@ -44,6 +48,25 @@ public:
    */
   virtual int duplicateParentListenSocket(const std::string& address) PURE;
 
+  /**
+   * Retrieve the established connections which the parent process hands over. The sockets will be
+   * duplicated across process boundaries. Does nothing if there is no parent. Does not block: the
+   * parent keeps handing connections over as they go idle, and they are passed to the callback as
+   * they arrive, until shutdown().
+   * @param dispatcher supplies the dispatcher on which the connections are received.
+   * @param cb supplies the callback invoked with the fd of each connection and the address of the
+   *        listener which accepted it, e.g. tcp://127.0.0.1:5000.
+   */
+  virtual void duplicateParentConnections(Event::Dispatcher& dispatcher,
+                                          const ParentConnectionCb& cb) PURE;
+
+  /**
+   * Retrieve the TLS session resumption state which the server contexts of the parent process
+   * share, so that the clients of the parent can resume their sessions with this process.
+   * @return the state, or absl::nullopt if there is no parent or its server contexts share none.
+   */
+  virtual absl::optional<Ssl::ServerSessionState> duplicateParentServerSessionState() PURE;
+
   /**
    * Initialize the parent logic of our restarter. Meant to be called after initialization of a
    * new child has begun. The hot restart implementation needs to be created early to deal with
@@ -75,7 +98,8 @@ public:
   virtual ServerStatsFromParent mergeParentStatsIfAny(Stats::StoreRoot& stats_store) PURE;
 
   /**
-   * Shutdown the half of our hot restarter that acts as a parent.
+   * Shutdown the half of our hot restarter that acts as a parent, and stop taking connections
+   * from our parent.
    */
   virtual void shutdown() PURE;
 
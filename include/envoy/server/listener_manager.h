@@ -6,6 +6,7 @@
 #include "envoy/config/core/v3/config_source.pb.h"
 #include "envoy/config/listener/v3/listener.pb.h"
 #include "envoy/config/listener/v3/listener_components.pb.h"
+#include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/listener.h"
@@ -244,6 +245,26 @@ public:
    * @return TRUE if the worker has started or FALSE if not.
    */
   virtual bool isWorkerStarted() PURE;
+
+  /**
+   * Release the connections across all workers which another process can take over. This is used
+   * to hand connections over to the new process on hot restart.
+   * @see Network::ConnectionHandler::releaseTransferableConnections().
+   * @param cb supplies the callback invoked on the worker threads for each released connection.
+   * @param completion supplies the completion called on the main thread once all the workers have
+   *        released their connections.
+   */
+  virtual void
+  releaseTransferableConnections(Network::ConnectionHandler::ReleasedConnectionCb cb,
+                                 std::function<void()> completion) PURE;
+
+  /**
+   * Adopt the connections which the parent process hands over on hot restart, as the parent
+   * releases them. The workers take turns adopting connections. Does nothing until the workers
+   * have started.
+   * @see Network::ConnectionHandler::adoptConnection().
+   */
+  virtual void adoptParentConnections() PURE;
 };
 
 // overload operator| to allow ListenerManager::listeners(ListenerState) to be called using a
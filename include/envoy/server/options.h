@@ -60,6 +60,22 @@ enum class DrainStrategy {
   Immediate,
 };
 
+/**
+ * What a file access log does with a write which would take its flush buffers past
+ * Options::fileFlushBufferLimitBytes().
+ */
+enum class FileFlushOverflowPolicy {
+  /**
+   * The write is discarded and counted.
+   */
+  Drop,
+
+  /**
+   * The writing thread waits for the flush thread to make room.
+   */
+  Block,
+};
+
 using CommandLineOptionsPtr = std::unique_ptr<envoy::admin::v3::CommandLineOptions>;
 
 /**
@@ -204,6 +220,17 @@ public:
    */
   virtual std::chrono::milliseconds fileFlushIntervalMsec() const PURE;
 
+  /**
+   * @return uint64_t the size in bytes to which the flush buffers of each log file are limited, or
+   *         0 if they are unlimited.
+   */
+  virtual uint64_t fileFlushBufferLimitBytes() const PURE;
+
+  /**
+   * @return FileFlushOverflowPolicy what happens to writes beyond fileFlushBufferLimitBytes().
+   */
+  virtual FileFlushOverflowPolicy fileFlushOverflowPolicy() const PURE;
+
   /**
    * @return const std::string& the server's cluster.
    */
@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include "envoy/network/connection_handler.h"
 #include "envoy/server/guarddog.h"
 #include "envoy/server/overload/overload_manager.h"
 
@@ -88,6 +89,27 @@ public:
    */
   virtual void stopListener(Network::ListenerConfig& listener,
                             std::function<void()> completion) PURE;
+
+  /**
+   * Release the worker's connections which another process can take over.
+   * @see Network::ConnectionHandler::releaseTransferableConnections().
+   * @param cb supplies the callback invoked on the worker thread for each released connection.
+   * @param completion supplies the completion to be called once all the connections have been
+   * released. This completion is called on the worker thread. No locking is performed by the
+   * worker.
+   */
+  virtual void
+  releaseTransferableConnections(Network::ConnectionHandler::ReleasedConnectionCb cb,
+                                 std::function<void()> completion) PURE;
+
+  /**
+   * Adopt a connection which another process released.
+   * @see Network::ConnectionHandler::adoptConnection().
+   * @param listener_address supplies the address of the listener which accepted the connection.
+   * @param socket supplies the connection's socket.
+   */
+  virtual void adoptConnection(Network::Address::InstanceConstSharedPtr listener_address,
+                               Network::ConnectionSocketPtr&& socket) PURE;
 };
 
 using WorkerPtr = std::unique_ptr<Worker>;
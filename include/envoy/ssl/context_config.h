@@ -84,6 +84,12 @@ public:
    * @return the set of capabilities for handshaker instances created by this context.
    */
   virtual HandshakerCapabilities capabilities() const PURE;
+
+  /**
+   * @return true if the encryption of outgoing records should be handed to the kernel once the
+   *         handshake completes, for connections which allow it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "envoy/common/time.h"
 #include "envoy/config/typed_config.h"
@@ -12,6 +15,19 @@
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * The session resumption state which the server contexts of a context manager share, as handed
+ * over to another process on hot restart.
+ */
+struct ServerSessionState {
+  // The session ticket keys generated in memory, the first one being used for encryption.
+  std::vector<ServerContextConfig::SessionTicketKey> ticket_keys_;
+  // How long ago the first ticket key was generated.
+  std::chrono::seconds ticket_key_age_{};
+  // The cached sessions, serialized with SSL_SESSION_to_bytes().
+  std::vector<std::string> sessions_;
+};
+
 /**
  * Manages all of the SSL contexts in the process
  */
@@ -55,6 +71,20 @@ public:
    * expire, or `absl::nullopt` if no OCSP responses exist.
    */
   virtual absl::optional<uint64_t> secondsUntilFirstOcspResponseExpires() const PURE;
+
+  /**
+   * @return the session resumption state which the server contexts share, to hand it over to
+   *         another process on hot restart, or absl::nullopt if they don't share any.
+   */
+  virtual absl::optional<ServerSessionState> exportServerSessionState() PURE;
+
+  /**
+   * Take over the session resumption state of another process, so that the clients of its server
+   * contexts can resume their sessions with the server contexts of this manager. Does nothing if
+   * the server contexts don't share any state.
+   * @param state supplies the state exported by the other process.
+   */
+  virtual void importServerSessionState(const ServerSessionState& state) PURE;
 };
 
 using ContextManagerPtr = std::unique_ptr<ContextManager>;
@@ -135,6 +135,14 @@ public:
    */
   virtual void finishSpan() PURE;
 
+  /**
+   * Same as finishSpan(), but for a span which finished at the given time rather than now, e.g.
+   * one recorded earlier and reported once the sampling decision is made. Tracers which can't set
+   * the finish time of a span finish it now.
+   * @param finish_time the time at which the span finished.
+   */
+  virtual void finishSpanAt(SystemTime finish_time) PURE;
+
   /**
    * Mutate the provided headers with the context necessary to propagate this
    * (implementation-specific) trace.
@@ -12,6 +12,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/assert.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/utility.h"
@@ -79,6 +80,10 @@ FilterPtr FilterFactory::fromProto(const envoy::config::accesslog::v3::AccessLog
     return FilterPtr{new GrpcStatusFilter(config.grpc_status_filter())};
   case envoy::config::accesslog::v3::AccessLogFilter::FilterSpecifierCase::kMetadataFilter:
     return FilterPtr{new MetadataFilter(config.metadata_filter())};
+  case envoy::config::accesslog::v3::AccessLogFilter::FilterSpecifierCase::kSamplingFilter:
+    MessageUtil::validate(config, validation_visitor);
+    return FilterPtr{
+        new SamplingFilter(config.sampling_filter(), runtime, random, validation_visitor)};
   case envoy::config::accesslog::v3::AccessLogFilter::FilterSpecifierCase::kExtensionFilter:
     MessageUtil::validate(config, validation_visitor);
     {
@@ -296,6 +301,69 @@ bool MetadataFilter::evaluate(const StreamInfo::StreamInfo& info, const Http::Re
   return default_match_;
 }
 
+SamplingFilter::SamplingFilter(const envoy::config::accesslog::v3::SamplingFilter& config,
+                               Runtime::Loader& runtime, Random::RandomGenerator& random,
+                               ProtobufMessage::ValidationVisitor& validation_visitor)
+    : runtime_(runtime), runtime_key_(config.sample_every().runtime_key()),
+      default_sample_every_(config.sample_every().default_value()) {
+  if (config.has_keep_filter()) {
+    keep_filter_ =
+        FilterFactory::fromProto(config.keep_filter(), runtime, random, validation_visitor);
+  }
+  for (const int key : config.keys()) {
+    keys_.push_back(static_cast<envoy::config::accesslog::v3::SamplingFilter::Key>(key));
+  }
+}
+
+uint64_t SamplingFilter::groupHash(const StreamInfo::StreamInfo& info) const {
+  uint64_t hash = 0;
+  for (const auto key : keys_) {
+    switch (key) {
+    case envoy::config::accesslog::v3::SamplingFilter::ROUTE_NAME:
+      hash = HashUtil::xxHash64(info.getRouteName(), hash);
+      break;
+    case envoy::config::accesslog::v3::SamplingFilter::UPSTREAM_CLUSTER: {
+      const auto& host = info.upstreamHost();
+      hash = HashUtil::xxHash64(host != nullptr ? absl::string_view(host->cluster().name())
+                                                : absl::string_view(),
+                                hash);
+      break;
+    }
+    case envoy::config::accesslog::v3::SamplingFilter::RESPONSE_CODE: {
+      const uint64_t code = info.responseCode().value_or(0);
+      hash = HashUtil::xxHash64(
+          absl::string_view(reinterpret_cast<const char*>(&code), sizeof(code)), hash);
+      break;
+    }
+    default:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+  }
+  return hash;
+}
+
+bool SamplingFilter::evaluate(const StreamInfo::StreamInfo& info,
+                              const Http::RequestHeaderMap& request_headers,
+                              const Http::ResponseHeaderMap& response_headers,
+                              const Http::ResponseTrailerMap& response_trailers) const {
+  if (keep_filter_ != nullptr &&
+      keep_filter_->evaluate(info, request_headers, response_headers, response_trailers)) {
+    return true;
+  }
+
+  uint64_t sample_every = default_sample_every_;
+  if (!runtime_key_.empty()) {
+    sample_every = runtime_.snapshot().getInteger(runtime_key_, sample_every);
+  }
+  if (sample_every == 0) {
+    return false;
+  }
+  // Relaxed ordering is enough: the counters only spread the sampled requests over each group.
+  const uint64_t count =
+      counters_[groupHash(info) % NumCounters].fetch_add(1, std::memory_order_relaxed);
+  return count % sample_every == 0;
+}
+
 InstanceSharedPtr AccessLogFactory::fromProto(const envoy::config::accesslog::v3::AccessLog& config,
                                               Server::Configuration::FactoryContext& context) {
   FilterPtr filter;
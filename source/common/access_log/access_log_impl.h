@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -250,6 +252,35 @@ private:
   const std::string filter_;
 };
 
+/**
+ * Filters requests by sampling them per group of request properties, except for the requests
+ * matching a keep filter which are always logged.
+ */
+class SamplingFilter : public Filter {
+public:
+  SamplingFilter(const envoy::config::accesslog::v3::SamplingFilter& config,
+                 Runtime::Loader& runtime, Random::RandomGenerator& random,
+                 ProtobufMessage::ValidationVisitor& validation_visitor);
+
+  // AccessLog::Filter
+  bool evaluate(const StreamInfo::StreamInfo& info, const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap& response_trailers) const override;
+
+private:
+  // The number of counters the groups are hashed into.
+  static constexpr size_t NumCounters = 1024;
+
+  uint64_t groupHash(const StreamInfo::StreamInfo& info) const;
+
+  FilterPtr keep_filter_;
+  std::vector<envoy::config::accesslog::v3::SamplingFilter::Key> keys_;
+  Runtime::Loader& runtime_;
+  const std::string runtime_key_;
+  const uint32_t default_sample_every_;
+  mutable std::array<std::atomic<uint64_t>, NumCounters> counters_{};
+};
+
 /**
  * Extension filter factory that reads from ExtensionFilter proto.
  */
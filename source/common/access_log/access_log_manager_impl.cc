@@ -1,6 +1,9 @@
 #include "common/access_log/access_log_manager_impl.h"
 
+#include <functional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
@@ -32,13 +35,15 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
 
   access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
       api_.fileSystem().createFile(file_name), dispatcher_, lock_, file_stats_,
-      file_flush_interval_msec_, api_.threadFactory());
+      file_flush_interval_msec_, file_flush_buffer_limit_bytes_, file_flush_block_on_overflow_,
+      api_.threadFactory());
   return access_logs_[file_name];
 }
 
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
+                                     uint64_t buffer_limit_bytes, bool block_on_overflow,
                                      Thread::ThreadFactory& thread_factory)
     : file_(std::move(file)), file_lock_(lock),
       flush_timer_(dispatcher.createTimer([this]() -> void {
@@ -46,7 +51,12 @@ AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatch
         flush_event_.notifyOne();
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec),
+      buffer_limit_bytes_(buffer_limit_bytes), block_on_overflow_(block_on_overflow),
+      flush_size_(buffer_limit_bytes > 0 && buffer_limit_bytes / 2 < MIN_FLUSH_SIZE
+                      ? buffer_limit_bytes / 2
+                      : MIN_FLUSH_SIZE),
+      stats_(stats) {
   open();
 }
 
@@ -70,7 +80,7 @@ void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
   {
-    Thread::LockGuard lock(write_lock_);
+    Thread::LockGuard lock(event_lock_);
     flush_thread_exit_ = true;
     flush_event_.notifyOne();
   }
@@ -81,8 +91,9 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    moveWriteShards();
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
 
     const Api::IoCallBoolResult result = file_->close();
@@ -92,7 +103,12 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 }
 
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
-  Buffer::RawSliceVector slices = buffer.getRawSlices();
+  const Buffer::RawSliceVector slices = buffer.getRawSlices();
+  std::vector<absl::string_view> data;
+  data.reserve(slices.size());
+  for (const Buffer::RawSlice& slice : slices) {
+    data.emplace_back(static_cast<const char*>(slice.mem_), slice.len_);
+  }
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different AccessLogFileImpl pointing to the same underlying file. This can happen either via
@@ -104,15 +120,12 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (const Buffer::RawSlice& slice : slices) {
-      absl::string_view data(static_cast<char*>(slice.mem_), slice.len_);
-      const Api::IoCallSizeResult result = file_->write(data);
-      if (result.ok() && result.rc_ == static_cast<ssize_t>(slice.len_)) {
-        stats_.write_completed_.inc();
-      } else {
-        // Probably disk full.
-        stats_.write_failed_.inc();
-      }
+    const Api::IoCallSizeResult result = file_->writev(data);
+    if (result.ok() && result.rc_ == static_cast<ssize_t>(buffer.length())) {
+      stats_.write_completed_.inc();
+    } else {
+      // Probably disk full.
+      stats_.write_failed_.inc();
     }
   }
 
@@ -123,27 +136,24 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
 void AccessLogFileImpl::flushThreadFunc() {
 
   while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
     {
-      Thread::LockGuard write_lock(write_lock_);
+      Thread::LockGuard event_lock(event_lock_);
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
+      // flush_event_ can be woken up either by large enough write shards or by timer.
+      // In case it was timer, the write shards can be empty.
+      while (buffered_bytes_ <= 0 && !flush_thread_exit_ && !reopen_file_) {
         // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
+        flush_event_.wait(event_lock_);
       }
 
       if (flush_thread_exit_) {
         return;
       }
-
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
     }
 
+    Thread::LockGuard flush_lock(flush_lock_);
+    moveWriteShards();
+
     // if we failed to open file before, then simply ignore
     if (file_->isOpen()) {
       try {
@@ -155,7 +165,9 @@ void AccessLogFileImpl::flushThreadFunc() {
           open();
         }
 
-        doWrite(about_to_write_buffer_);
+        if (about_to_write_buffer_.length() > 0) {
+          doWrite(about_to_write_buffer_);
+        }
       } catch (const EnvoyException&) {
         stats_.reopen_failed_.inc();
       }
@@ -164,40 +176,78 @@ void AccessLogFileImpl::flushThreadFunc() {
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
+  // flush_lock_ must be held while moving the write shards or else it is possible that
+  // flushThreadFunc() has already moved their data to about_to_write_buffer_ but has not yet
+  // completed doWrite(). This would allow flush() to return before the pending data has actually
+  // been written to disk.
+  Thread::LockGuard flush_lock(flush_lock_);
+  moveWriteShards();
+  if (about_to_write_buffer_.length() == 0) {
+    return;
+  }
 
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
+  doWrite(about_to_write_buffer_);
+}
 
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
+void AccessLogFileImpl::moveWriteShards() {
+  const uint64_t length_before = about_to_write_buffer_.length();
+  for (WriteShard& shard : write_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    about_to_write_buffer_.move(shard.buffer_);
+  }
+  const uint64_t moved = about_to_write_buffer_.length() - length_before;
+  if (moved == 0) {
+    return;
+  }
 
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+  buffered_bytes_ -= moved;
+  if (buffer_limit_bytes_ > 0 && block_on_overflow_) {
+    Thread::LockGuard lock(event_lock_);
+    space_event_.notifyAll();
   }
+}
 
-  doWrite(about_to_write_buffer_);
+bool AccessLogFileImpl::hasBufferSpace(uint64_t length) const {
+  // A write is only refused while the shards hold data, so that writes larger than the limit
+  // don't wait forever or always get dropped. The limit is soft: concurrent writers may exceed
+  // it by up to one write each.
+  const int64_t buffered = buffered_bytes_;
+  return buffered <= 0 || static_cast<uint64_t>(buffered) + length <= buffer_limit_bytes_;
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
-
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  if (buffer_limit_bytes_ > 0 && !hasBufferSpace(data.length())) {
+    if (!block_on_overflow_) {
+      stats_.write_dropped_.inc();
+      return;
+    }
+    Thread::LockGuard lock(event_lock_);
+    while (!hasBufferSpace(data.length())) {
+      // The flush thread may be waiting for the flush timer, which doesn't fire while this thread
+      // waits if it is the thread of the timer's dispatcher.
+      flush_event_.notifyOne();
+      space_event_.wait(event_lock_);
+    }
   }
 
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
+  WriteShard& shard =
+      write_shards_[std::hash<std::thread::id>()(std::this_thread::get_id()) % NUM_WRITE_SHARDS];
+  {
+    Thread::LockGuard lock(shard.lock_);
+    shard.buffer_.add(data.data(), data.size());
+  }
+  const int64_t buffered = buffered_bytes_.fetch_add(data.length()) + data.length();
+
+  // The flush thread is started after the first write has been buffered, so that it flushes the
+  // write on its first loop.
+  absl::call_once(flush_thread_once_, [this]() { createFlushStructures(); });
+
+  // The flush thread keeps flushing for as long as there is buffered data, so it only needs to be
+  // woken up when the buffered data grows past flush_size_.
+  if (buffered > flush_size_ && buffered - static_cast<int64_t>(data.length()) <= flush_size_) {
+    Thread::LockGuard lock(event_lock_);
     flush_event_.notifyOne();
   }
 }
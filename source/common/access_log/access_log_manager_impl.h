@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <string>
 
 #include "envoy/access_log/access_log.h"
@@ -13,6 +15,7 @@
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 
+#include "absl/base/call_once.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -22,6 +25,7 @@ namespace Envoy {
   COUNTER(reopen_failed)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
+  COUNTER(write_dropped)                                                                           \
   COUNTER(write_failed)                                                                            \
   GAUGE(write_total_buffered, Accumulate)
 
@@ -33,13 +37,22 @@ namespace AccessLog {
 
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
-  AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
-                       Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
+  /**
+   * @param file_flush_buffer_limit_bytes the size to which each file's flush buffers are limited,
+   *        or 0 for no limit.
+   * @param file_flush_block_on_overflow whether writes beyond the limit wait for the flush thread
+   *        rather than being dropped.
+   */
+  AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec,
+                       uint64_t file_flush_buffer_limit_bytes, bool file_flush_block_on_overflow,
+                       Api::Api& api, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
-      : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{
-                         ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
-                                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
+      : file_flush_interval_msec_(file_flush_interval_msec),
+        file_flush_buffer_limit_bytes_(file_flush_buffer_limit_bytes),
+        file_flush_block_on_overflow_(file_flush_block_on_overflow), api_(api),
+        dispatcher_(dispatcher), lock_(lock),
+        file_stats_{ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
+                                          POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
   ~AccessLogManagerImpl() override;
 
   // AccessLog::AccessLogManager
@@ -48,6 +61,8 @@ public:
 
 private:
   const std::chrono::milliseconds file_flush_interval_msec_;
+  const uint64_t file_flush_buffer_limit_bytes_;
+  const bool file_flush_block_on_overflow_;
   Api::Api& api_;
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
@@ -61,13 +76,18 @@ private:
  * This implementation uses a flush thread per file, with the idea there aren't that many
  * files. If this turns out to be a good implementation we can potentially have a single flush
  * thread that flushes all files, but we will start with this.
+ *
+ * Writers append to one of several write shards picked by their thread id, so that the workers
+ * don't contend on a single lock, and the flush thread gathers all the shards into one writev().
+ * The data of each thread is written in order, while data of different threads is interleaved at
+ * flush granularity.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
-                    std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    std::chrono::milliseconds flush_interval_msec, uint64_t buffer_limit_bytes,
+                    bool block_on_overflow, Thread::ThreadFactory& thread_factory);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
@@ -82,22 +102,31 @@ public:
   void flush() override;
 
 private:
+  struct WriteShard {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ ABSL_GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
   void flushThreadFunc();
   void open();
   void createFlushStructures();
+  bool hasBufferSpace(uint64_t length) const;
+  void moveWriteShards();
 
   // return default flags set which used by open
   static Filesystem::FlagSet defaultFlags();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // Number of write shards. Threads are spread over the shards by the hash of their id.
+  static const size_t NUM_WRITE_SHARDS = 16;
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) a write shard's lock_ or event_lock_
   //    3) file_lock_
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
@@ -108,31 +137,39 @@ private:
                                           // concurrent access to the about_to_write_buffer_, fd_,
                                           // and all other data used during flushing and file
                                           // re-opening.
-  Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
+  Thread::MutexBasicLockable event_lock_; // This lock is used with flush_event_ and space_event_
+                                          // to make sure that the flush thread and blocked
+                                          // writers don't miss their wakeups.
   Thread::ThreadPtr flush_thread_;
+  absl::once_flag flush_thread_once_;
   Thread::CondVar flush_event_;
+  Thread::CondVar space_event_; // Signaled when the flush thread empties the write shards.
   std::atomic<bool> flush_thread_exit_{};
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl
-      flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
-                                                  // gets filled and then flushed either when max
-                                                  // size is reached or when a timer fires.
+  std::array<WriteShard, NUM_WRITE_SHARDS> write_shards_; // These buffers get filled by the
+                                                          // writers and then flushed either when
+                                                          // MIN_FLUSH_SIZE is reached or when a
+                                                          // timer fires.
+  std::atomic<int64_t> buffered_bytes_{}; // Bytes held by the write shards. Writers update this
+                                          // after adding to a shard, so it can briefly be
+                                          // negative when the flush thread gets there first.
   // TODO(jmarantz): this should be ABSL_GUARDED_BY(flush_lock_) but the analysis cannot poke
   // through the std::make_unique assignment. I do not believe it's possible to annotate this
   // properly now due to limitations in the clang thread annotation analysis.
   Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
+                                            // is moved from the write shards one shard lock at a
+                                            // time, so that the shards can continue to fill. This
+                                            // buffer is then used for the final write to disk.
   Event::TimerPtr flush_timer_;
   Thread::ThreadFactory& thread_factory_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
+  const uint64_t buffer_limit_bytes_; // 0 if the write shards are unbounded.
+  const bool block_on_overflow_;
+  const int64_t flush_size_; // Buffered bytes past which the flush thread is woken up. Smaller
+                             // than MIN_FLUSH_SIZE for small buffer limits, so that the flush
+                             // thread gets going before writes are refused.
   AccessLogFileStats& stats_;
 };
 
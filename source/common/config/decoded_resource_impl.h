@@ -60,6 +60,12 @@ public:
                       const std::vector<std::string>& aliases, const std::string& version)
       : resource_(std::move(resource)), has_resource_(true), name_(name), aliases_(aliases),
         version_(version), ttl_(absl::nullopt) {}
+  // Wraps an already decoded resource, e.g. one shared from a per type URL resource cache, without
+  // decoding it again. The underlying message is shared, not copied.
+  DecodedResourceImpl(std::shared_ptr<const Protobuf::Message> resource, const std::string& name,
+                      const std::vector<std::string>& aliases, const std::string& version)
+      : resource_(std::move(resource)), has_resource_(true), name_(name), aliases_(aliases),
+        version_(version), ttl_(absl::nullopt) {}
 
   // Config::DecodedResource
   const std::string& name() const override { return name_; }
@@ -69,6 +75,12 @@ public:
   bool hasResource() const override { return has_resource_; }
   absl::optional<std::chrono::milliseconds> ttl() const override { return ttl_; }
 
+  /**
+   * @return the decoded message as a shared pointer, so that it can outlive this wrapper in a
+   *         resource cache.
+   */
+  const std::shared_ptr<const Protobuf::Message>& sharedResource() const { return resource_; }
+
 private:
   DecodedResourceImpl(OpaqueResourceDecoder& resource_decoder, absl::optional<std::string> name,
                       const Protobuf::RepeatedPtrField<std::string>& aliases,
@@ -78,7 +90,7 @@ private:
         name_(name ? *name : resource_decoder.resourceName(*resource_)),
         aliases_(repeatedPtrFieldToVector(aliases)), version_(version), ttl_(ttl) {}
 
-  const ProtobufTypes::MessagePtr resource_;
+  const std::shared_ptr<const Protobuf::Message> resource_;
   const bool has_resource_;
   const std::string name_;
   const std::vector<std::string> aliases_;
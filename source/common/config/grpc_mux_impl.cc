@@ -2,6 +2,7 @@
 
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
+#include "common/common/hash.h"
 #include "common/config/decoded_resource_impl.h"
 #include "common/config/utility.h"
 #include "common/config/version_converter.h"
@@ -26,7 +27,9 @@ GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
       first_stream_request_(true), transport_api_version_(transport_api_version),
       dispatcher_(dispatcher),
       enable_type_url_downgrade_and_upgrade_(Runtime::runtimeFeatureEnabled(
-          "envoy.reloadable_features.enable_type_url_downgrade_and_upgrade")) {
+          "envoy.reloadable_features.enable_type_url_downgrade_and_upgrade")),
+      skip_unchanged_resource_updates_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.skip_unchanged_sotw_resource_updates")) {
   Config::Utility::checkLocalInfo("ads", local_info);
 }
 
@@ -189,11 +192,13 @@ void GrpcMuxImpl::onDiscoveryResponse(
     // for test determinism.
     std::vector<DecodedResourceImplPtr> resources;
     absl::btree_map<std::string, DecodedResourceRef> resource_ref_map;
+    absl::flat_hash_map<std::string, uint64_t> resource_hashes;
     std::vector<DecodedResourceRef> all_resource_refs;
-    OpaqueResourceDecoder& resource_decoder =
-        apiStateFor(type_url).watches_.front()->resource_decoder_;
+    ApiState& api_state = apiStateFor(type_url);
+    OpaqueResourceDecoder& resource_decoder = api_state.watches_.front()->resource_decoder_;
+    ResourceCache next_cache;
 
-    const auto scoped_ttl_update = apiStateFor(type_url).ttl_.scopedTtlUpdate();
+    const auto scoped_ttl_update = api_state.ttl_.scopedTtlUpdate();
 
     for (const auto& resource : message->resources()) {
       // TODO(snowp): Check the underlying type when the resource is a Resource.
@@ -204,23 +209,26 @@ void GrpcMuxImpl::onDiscoveryResponse(
                         resource.type_url(), message->type_url(), message->DebugString()));
       }
 
-      auto decoded_resource =
-          DecodedResourceImpl::fromResource(resource_decoder, resource, message->version_info());
+      const uint64_t resource_hash =
+          HashUtil::xxHash64(resource.value(), HashUtil::xxHash64(resource.type_url()));
+      auto decoded_resource = decodeResource(api_state, resource_decoder, resource, resource_hash,
+                                             message->version_info(), next_cache);
 
       if (decoded_resource->ttl()) {
-        apiStateFor(type_url).ttl_.add(*decoded_resource->ttl(), decoded_resource->name());
+        api_state.ttl_.add(*decoded_resource->ttl(), decoded_resource->name());
       } else {
-        apiStateFor(type_url).ttl_.clear(decoded_resource->name());
+        api_state.ttl_.clear(decoded_resource->name());
       }
 
       if (!isHeartbeatResource(type_url, *decoded_resource)) {
         resources.emplace_back(std::move(decoded_resource));
         all_resource_refs.emplace_back(*resources.back());
         resource_ref_map.emplace(resources.back()->name(), *resources.back());
+        resource_hashes.emplace(resources.back()->name(), resource_hash);
       }
     }
 
-    for (auto watch : apiStateFor(type_url).watches_) {
+    for (auto watch : api_state.watches_) {
       // onConfigUpdate should be called in all cases for single watch xDS (Cluster and
       // Listener) even if the message does not have resources so that update_empty stat
       // is properly incremented and state-of-the-world semantics are maintained.
@@ -229,25 +237,40 @@ void GrpcMuxImpl::onDiscoveryResponse(
         continue;
       }
       std::vector<DecodedResourceRef> found_resources;
+      absl::flat_hash_map<std::string, uint64_t> found_hashes;
       for (const auto& watched_resource_name : watch->resources_) {
         auto it = resource_ref_map.find(watched_resource_name);
         if (it != resource_ref_map.end()) {
           found_resources.emplace_back(it->second);
+          found_hashes.emplace(it->first, resource_hashes[it->first]);
         }
       }
 
       // onConfigUpdate should be called only on watches(clusters/routes) that have
       // updates in the message for EDS/RDS.
-      if (!found_resources.empty()) {
-        watch->callbacks_.onConfigUpdate(found_resources, message->version_info());
+      if (found_resources.empty()) {
+        continue;
       }
+      // A SotW response re-sends every subscribed resource, even if only one of them changed.
+      // Don't make watches (e.g. thousands of EDS/RDS subscriptions) rebuild their config for
+      // content they have already been handed.
+      if (skip_unchanged_resource_updates_ && unchangedForWatch(*watch, found_hashes)) {
+        ENVOY_LOG(debug, "Skipping unchanged {} update for {} resource(s) at version {}",
+                  type_url, found_resources.size(), message->version_info());
+        continue;
+      }
+      watch->callbacks_.onConfigUpdate(found_resources, message->version_info());
+      watch->delivered_hashes_ = std::move(found_hashes);
     }
+    api_state.resource_cache_ = std::move(next_cache);
     // TODO(mattklein123): In the future if we start tracking per-resource versions, we
     // would do that tracking here.
     apiStateFor(type_url).request_.set_version_info(message->version_info());
     Memory::Utils::tryShrinkHeap();
   } catch (const EnvoyException& e) {
     for (auto watch : apiStateFor(type_url).watches_) {
+      // The rejected update may have been partially applied, make sure the next one is delivered.
+      watch->delivered_hashes_.clear();
       watch->callbacks_.onConfigUpdateFailed(
           Envoy::Config::ConfigUpdateFailureReason::UpdateRejected, &e);
     }
@@ -321,6 +344,39 @@ void GrpcMuxImpl::expiryCallback(const std::string& type_url,
   }
 }
 
+DecodedResourceImplPtr GrpcMuxImpl::decodeResource(ApiState& api_state,
+                                                   OpaqueResourceDecoder& resource_decoder,
+                                                   const ProtobufWkt::Any& resource,
+                                                   uint64_t resource_hash,
+                                                   const std::string& version,
+                                                   ResourceCache& next_cache) {
+  // Resources wrapped in a Resource carry their own name, TTL and heartbeat semantics, so they
+  // always take the regular decoding path.
+  if (resource.Is<envoy::service::discovery::v3::Resource>()) {
+    return DecodedResourceImpl::fromResource(resource_decoder, resource, version);
+  }
+
+  auto it = api_state.resource_cache_.find(resource_hash);
+  if (it != api_state.resource_cache_.end() && it->second.serialized_ == resource.value()) {
+    auto decoded_resource = std::make_unique<DecodedResourceImpl>(
+        it->second.resource_, it->second.name_, std::vector<std::string>{}, version);
+    next_cache.emplace(resource_hash, it->second);
+    return decoded_resource;
+  }
+
+  auto decoded_resource = DecodedResourceImpl::fromResource(resource_decoder, resource, version);
+  next_cache.emplace(resource_hash, CachedResource{decoded_resource->name(),
+                                                   decoded_resource->sharedResource(),
+                                                   resource.value()});
+  return decoded_resource;
+}
+
+bool GrpcMuxImpl::unchangedForWatch(
+    const GrpcMuxWatchImpl& watch, const absl::flat_hash_map<std::string, uint64_t>& found_hashes) {
+  // Any added or removed resource is a change for the watch, as is any content change.
+  return watch.delivered_hashes_ == found_hashes;
+}
+
 GrpcMuxImpl::ApiState& GrpcMuxImpl::apiStateFor(const std::string& type_url) {
   auto itr = api_state_.find(type_url);
   if (itr == api_state_.end()) {
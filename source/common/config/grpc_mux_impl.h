@@ -18,11 +18,13 @@
 #include "common/common/logger.h"
 #include "common/common/utility.h"
 #include "common/config/api_version.h"
+#include "common/config/decoded_resource_impl.h"
 #include "common/config/grpc_stream.h"
 #include "common/config/ttl.h"
 #include "common/config/utility.h"
 #include "common/runtime/runtime_features.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -111,11 +113,24 @@ private:
     OpaqueResourceDecoder& resource_decoder_;
     const std::string type_url_;
     GrpcMuxImpl& parent_;
+    // Content hashes of the resources last delivered to this watch, keyed by resource name.
+    absl::flat_hash_map<std::string, uint64_t> delivered_hashes_;
 
   private:
     std::list<GrpcMuxWatchImpl*>& watches_;
   };
 
+  // A decoded resource retained across responses, so that resources whose serialized content did
+  // not change are not decoded (and validated) again.
+  struct CachedResource {
+    std::string name_;
+    std::shared_ptr<const Protobuf::Message> resource_;
+    // Compared on a hit, so that a hash collision never hands out the wrong resource.
+    std::string serialized_;
+  };
+  // Cached resources keyed by the hash of their serialized content.
+  using ResourceCache = absl::flat_hash_map<uint64_t, CachedResource>;
+
   // Per muxed API state.
   struct ApiState {
     ApiState(Event::Dispatcher& dispatcher,
@@ -135,6 +150,9 @@ private:
     // Has this API been tracked in subscriptions_?
     bool subscribed_{};
     TtlManager ttl_;
+    // Resources decoded from the last accepted response. Since every SotW response carries the
+    // complete set of subscribed resources, this is replaced wholesale on each accepted response.
+    ResourceCache resource_cache_;
   };
 
   bool isHeartbeatResource(const std::string& type_url, const DecodedResource& resource) {
@@ -142,6 +160,12 @@ private:
            resource.version() == apiStateFor(type_url).request_.version_info();
   }
   void expiryCallback(const std::string& type_url, const std::vector<std::string>& expired);
+  DecodedResourceImplPtr decodeResource(ApiState& api_state,
+                                        OpaqueResourceDecoder& resource_decoder,
+                                        const ProtobufWkt::Any& resource, uint64_t resource_hash,
+                                        const std::string& version, ResourceCache& next_cache);
+  static bool unchangedForWatch(const GrpcMuxWatchImpl& watch,
+                                const absl::flat_hash_map<std::string, uint64_t>& found_hashes);
   // Request queue management logic.
   void queueDiscoveryRequest(const std::string& queue_item);
 
@@ -168,6 +192,7 @@ private:
 
   Event::Dispatcher& dispatcher_;
   bool enable_type_url_downgrade_and_upgrade_;
+  const bool skip_unchanged_resource_updates_;
 };
 
 using GrpcMuxImplPtr = std::unique_ptr<GrpcMuxImpl>;
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -47,7 +48,8 @@ DispatcherImpl::DispatcherImpl(const std::string& name, Buffer::WatermarkFactory
       scheduler_(time_system.createScheduler(base_scheduler_, base_scheduler_)),
       deferred_delete_cb_(base_scheduler_.createSchedulableCallback(
           [this]() -> void { clearDeferredDeleteList(); })),
-      post_cb_(base_scheduler_.createSchedulableCallback([this]() -> void { runPostCallbacks(); })),
+      post_cb_(base_scheduler_.createSchedulableCallback(
+          [this]() -> void { runPostCallbacks(max_post_callbacks_per_iteration_); })),
       current_to_delete_(&to_delete_1_) {
   ASSERT(!name_.empty());
   FatalErrorHandler::registerFatalErrorHandler(*this);
@@ -190,6 +192,18 @@ TimerPtr DispatcherImpl::createTimer(TimerCb cb) {
   return createTimerInternal(cb);
 }
 
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb) {
+  ASSERT(isThreadSafe());
+  if (!use_timer_wheel_) {
+    return createTimerInternal(cb);
+  }
+  if (timer_wheel_ == nullptr) {
+    timer_wheel_ = std::make_unique<TimerWheel>(*this, TimerWheel::DefaultTickDuration);
+  }
+  // The wheel's own timer touches the watchdog.
+  return timer_wheel_->createTimer(std::move(cb));
+}
+
 Event::SchedulableCallbackPtr DispatcherImpl::createSchedulableCallback(std::function<void()> cb) {
   ASSERT(isThreadSafe());
   return base_scheduler_.createSchedulableCallback([this, cb]() {
@@ -243,7 +257,16 @@ void DispatcherImpl::run(RunType type) {
   // callbacks that have to get run before the initial event loop starts running. libevent does
   // not guarantee that events are run in any particular order. So even if we post() and call
   // event_base_once() before some other event, the other event might get called first.
-  runPostCallbacks();
+  runPostCallbacks(std::numeric_limits<uint32_t>::max());
+  max_post_callbacks_per_iteration_ =
+      Runtime::LoaderSingleton::getExisting() &&
+              Runtime::runtimeFeatureEnabled(
+                  "envoy.reloadable_features.dispatcher_post_callback_budget")
+          ? MaxPostCallbacksPerIteration
+          : std::numeric_limits<uint32_t>::max();
+  use_timer_wheel_ =
+      Runtime::LoaderSingleton::getExisting() &&
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.coarse_timers_use_timer_wheel");
   base_scheduler_.run(type);
 }
 
@@ -257,24 +280,34 @@ void DispatcherImpl::updateApproximateMonotonicTimeInternal() {
   approximate_monotonic_time_ = api_.timeSource().monotonicTime();
 }
 
-void DispatcherImpl::runPostCallbacks() {
-  while (true) {
-    // It is important that this declaration is inside the body of the loop so that the callback is
-    // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
-    // for each iteration, the previous iteration's callback is destructed when callback is
-    // re-assigned, which happens while holding the lock. This can lead to a deadlock (via
-    // recursive mutex acquisition) if destroying the callback runs a destructor, which through some
-    // callstack calls post() on this dispatcher.
-    std::function<void()> callback;
-    {
+void DispatcherImpl::runPostCallbacks(uint32_t max_callbacks) {
+  uint64_t num_callbacks = 0;
+  while (num_callbacks < max_callbacks) {
+    if (current_post_callbacks_.empty()) {
+      // Take all the callbacks posted so far at once, so that posting threads contend for the lock
+      // once per batch rather than once per callback. Callbacks are never destructed while
+      // post_lock_ is held, as destroying one may call post() on this dispatcher and deadlock.
       Thread::LockGuard lock(post_lock_);
       if (post_callbacks_.empty()) {
-        return;
+        break;
       }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
+      current_post_callbacks_.swap(post_callbacks_);
     }
+    // It is important that this declaration is inside the body of the loop so that the callback is
+    // destructed before the lock may be taken again for the next batch.
+    std::function<void()> callback = std::move(current_post_callbacks_.front());
+    current_post_callbacks_.pop_front();
     callback();
+    ++num_callbacks;
+  }
+  if (!current_post_callbacks_.empty()) {
+    // Leave the remaining callbacks to the next iteration of the event loop, so that a burst of
+    // cross-thread work such as runOnAllThreads() during a large config update doesn't hold up
+    // network events. Callbacks posted since the batch was taken have already scheduled post_cb_.
+    post_cb_->scheduleCallbackNextIteration();
+  }
+  if (stats_ != nullptr && num_callbacks > 0) {
+    stats_->post_callbacks_.recordValue(num_callbacks);
   }
 }
 
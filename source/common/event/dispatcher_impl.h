@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <vector>
@@ -18,6 +19,7 @@
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
 #include "common/event/libevent_scheduler.h"
+#include "common/event/timer_wheel.h"
 #include "common/signal/fatal_error_handler.h"
 
 namespace Envoy {
@@ -35,6 +37,10 @@ public:
                  Event::TimeSystem& time_system);
   ~DispatcherImpl() override;
 
+  // The number of posted callbacks run in one event loop iteration when
+  // envoy.reloadable_features.dispatcher_post_callback_budget is enabled.
+  static constexpr uint32_t MaxPostCallbacksPerIteration = 256;
+
   /**
    * @return event_base& the libevent base.
    */
@@ -68,6 +74,7 @@ public:
   Network::UdpListenerPtr createUdpListener(Network::SocketSharedPtr socket,
                                             Network::UdpListenerCallbacks& cb) override;
   TimerPtr createTimer(TimerCb cb) override;
+  TimerPtr createCoarseTimer(TimerCb cb) override;
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override;
   void deferredDelete(DeferredDeletablePtr&& to_delete) override;
   void exit() override;
@@ -125,7 +132,7 @@ private:
 
   TimerPtr createTimerInternal(TimerCb cb);
   void updateApproximateMonotonicTimeInternal();
-  void runPostCallbacks();
+  void runPostCallbacks(uint32_t max_callbacks);
   // Helper used to touch the watchdog after most schedulable, fd, and timer callbacks.
   void touchWatchdog();
 
@@ -144,6 +151,10 @@ private:
   Buffer::WatermarkFactoryPtr buffer_factory_;
   LibeventScheduler base_scheduler_;
   SchedulerPtr scheduler_;
+  // Created on first use. Declared right after the scheduler, so that it outlives the deferred
+  // deletions and posted callbacks which may own coarse timers, and its own timer is destroyed
+  // before the scheduler.
+  TimerWheelPtr timer_wheel_;
   SchedulableCallbackPtr deferred_delete_cb_;
   SchedulableCallbackPtr post_cb_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
@@ -151,6 +162,12 @@ private:
   std::vector<DeferredDeletablePtr>* current_to_delete_;
   Thread::MutexBasicLockable post_lock_;
   std::list<std::function<void()>> post_callbacks_ ABSL_GUARDED_BY(post_lock_);
+  // Callbacks taken off post_callbacks_ which haven't run yet. Only used on the dispatcher thread.
+  std::list<std::function<void()>> current_post_callbacks_;
+  // Set when the event loop starts, as the server creates its dispatchers before the runtime.
+  uint32_t max_post_callbacks_per_iteration_{std::numeric_limits<uint32_t>::max()};
+  // Also set when the event loop starts. The coarse timers created before use libevent timers.
+  bool use_timer_wheel_{};
   const ScopeTrackedObject* current_object_{};
   bool deferred_deleting_{};
   MonotonicTime approximate_monotonic_time_;
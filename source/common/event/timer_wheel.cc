@@ -0,0 +1,182 @@
+#include "common/event/timer_wheel.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/scope_tracker.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * A timer on the wheel. While enabled, the timer's node sits in the slot of its expiry tick,
+ * otherwise in its own list, so that enabling and disabling the timer never allocates.
+ */
+class TimerWheel::WheelTimerImpl final : public Timer {
+public:
+  WheelTimerImpl(TimerCb cb, TimerWheel& wheel)
+      : node_(1, this), it_(node_.begin()), cb_(std::move(cb)), wheel_(wheel) {}
+
+  ~WheelTimerImpl() override { disableTimer(); }
+
+  // Timer
+  void disableTimer() override {
+    if (slot_ != nullptr) {
+      wheel_.remove(*this);
+    }
+    scope_ = nullptr;
+  }
+
+  void enableTimer(std::chrono::milliseconds ms, const ScopeTrackedObject* scope) override {
+    disableTimer();
+    scope_ = scope;
+    wheel_.add(*this, ms);
+  }
+
+  void enableHRTimer(std::chrono::microseconds us, const ScopeTrackedObject* scope) override {
+    enableTimer(std::chrono::ceil<std::chrono::milliseconds>(us), scope);
+  }
+
+  bool enabled() override { return slot_ != nullptr; }
+
+  void trigger() {
+    ASSERT(wheel_.dispatcher_.isThreadSafe());
+    if (scope_ == nullptr) {
+      cb_();
+      return;
+    }
+    ScopeTrackerScopeState scope(scope_, wheel_.dispatcher_);
+    scope_ = nullptr;
+    cb_();
+  }
+
+  // The tick at which the timer expires.
+  uint64_t expiry_tick_{};
+  // Holds the timer's node while the timer is disabled.
+  Slot node_;
+  // The timer's node, which stays valid as it moves between lists.
+  const Slot::iterator it_;
+  // The slot holding the timer's node, or nullptr if the timer is disabled.
+  Slot* slot_{};
+
+private:
+  const TimerCb cb_;
+  TimerWheel& wheel_;
+  const ScopeTrackedObject* scope_{};
+};
+
+TimerWheel::TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds tick_duration)
+    : dispatcher_(dispatcher),
+      tick_duration_(std::max(tick_duration, std::chrono::milliseconds(1))),
+      epoch_(dispatcher.timeSource().monotonicTime()),
+      tick_timer_(dispatcher.createTimer([this]() { onTick(); })) {}
+
+TimerWheel::~TimerWheel() { ASSERT(num_enabled_ == 0); }
+
+TimerPtr TimerWheel::createTimer(TimerCb cb) {
+  ASSERT(dispatcher_.isThreadSafe());
+  return std::make_unique<WheelTimerImpl>(std::move(cb), *this);
+}
+
+void TimerWheel::add(WheelTimerImpl& timer, std::chrono::milliseconds duration) {
+  const MonotonicTime::duration since_epoch = dispatcher_.timeSource().monotonicTime() - epoch_;
+  if (num_enabled_ == 0) {
+    // All slots are empty, so there is nothing to fire on the way to now.
+    current_tick_ = std::max<uint64_t>(current_tick_, since_epoch / tick_duration_);
+  }
+  // Round up to the next tick boundary so that timers never fire early.
+  const MonotonicTime::duration deadline =
+      since_epoch + std::max(duration, std::chrono::milliseconds::zero());
+  const uint64_t expiry_tick =
+      (deadline + tick_duration_ - MonotonicTime::duration(1)) / tick_duration_;
+  timer.expiry_tick_ = std::max(expiry_tick, current_tick_ + 1);
+  place(timer);
+  if (num_enabled_++ == 0) {
+    scheduleTick();
+  }
+}
+
+void TimerWheel::remove(WheelTimerImpl& timer) {
+  ASSERT(timer.slot_ != nullptr);
+  timer.node_.splice(timer.node_.end(), *timer.slot_, timer.it_);
+  timer.slot_ = nullptr;
+  if (--num_enabled_ == 0) {
+    tick_timer_->disableTimer();
+  }
+}
+
+void TimerWheel::place(WheelTimerImpl& timer) {
+  Slot& slot = slotFor(timer.expiry_tick_);
+  slot.splice(slot.end(), timer.node_, timer.it_);
+  timer.slot_ = &slot;
+}
+
+TimerWheel::Slot& TimerWheel::slotFor(uint64_t expiry_tick) {
+  uint64_t delta = expiry_tick - current_tick_;
+  if (delta < FirstLevelSlots) {
+    return first_level_[expiry_tick & (FirstLevelSlots - 1)];
+  }
+  if (delta >= MaxTicks) {
+    // Park the timer in the furthest slot, it is placed again when the slot comes around.
+    expiry_tick = current_tick_ + MaxTicks - 1;
+    delta = MaxTicks - 1;
+  }
+  uint32_t level = 0;
+  while (delta >= (uint64_t(1) << (FirstLevelBits + LevelBits * (level + 1)))) {
+    ++level;
+  }
+  const uint32_t shift = FirstLevelBits + LevelBits * level;
+  return levels_[level][(expiry_tick >> shift) & (LevelSlots - 1)];
+}
+
+void TimerWheel::cascade(uint32_t level) {
+  const uint32_t shift = FirstLevelBits + LevelBits * level;
+  const uint32_t index = (current_tick_ >> shift) & (LevelSlots - 1);
+  if (index == 0 && level + 1 < NumLevels - 1) {
+    cascade(level + 1);
+  }
+  Slot& slot = levels_[level][index];
+  while (!slot.empty()) {
+    WheelTimerImpl& timer = *slot.front();
+    timer.node_.splice(timer.node_.end(), slot, timer.it_);
+    place(timer);
+  }
+}
+
+void TimerWheel::onTick() {
+  const uint64_t target_tick = nowTick();
+  while (current_tick_ < target_tick && num_enabled_ > 0) {
+    ++current_tick_;
+    const uint32_t index = current_tick_ & (FirstLevelSlots - 1);
+    if (index == 0) {
+      cascade(0);
+    }
+    Slot& slot = first_level_[index];
+    // Timers enabled by the callbacks always expire at a later tick, so the loop ends.
+    while (!slot.empty()) {
+      WheelTimerImpl& timer = *slot.front();
+      remove(timer);
+      timer.trigger();
+    }
+  }
+  current_tick_ = std::max(current_tick_, target_tick);
+  scheduleTick();
+}
+
+uint64_t TimerWheel::nowTick() const {
+  return (dispatcher_.timeSource().monotonicTime() - epoch_) / tick_duration_;
+}
+
+void TimerWheel::scheduleTick() {
+  if (num_enabled_ == 0) {
+    return;
+  }
+  const MonotonicTime next_tick = epoch_ + tick_duration_ * static_cast<int64_t>(current_tick_ + 1);
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  tick_timer_->enableTimer(
+      next_tick > now ? std::chrono::ceil<std::chrono::milliseconds>(next_tick - now)
+                      : std::chrono::milliseconds::zero());
+}
+
+} // namespace Event
+} // namespace Envoy
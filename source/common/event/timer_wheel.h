@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * A hierarchical timing wheel for timeouts which tolerate firing up to one tick late, such as idle
+ * and stream timeouts. Enabling and disabling a timer is O(1), while each timer of the dispatcher
+ * costs O(log n) in the libevent min-heap. The wheel is driven by a single dispatcher timer, which
+ * only runs while any of the wheel's timers is enabled.
+ *
+ * The first level has a slot for each of the next 256 ticks. Each further level has 64 slots,
+ * each covering a whole turn of the level below. Timers further out than the last level are
+ * parked in its furthest slot and placed again whenever that slot comes around.
+ */
+class TimerWheel {
+public:
+  static constexpr std::chrono::milliseconds DefaultTickDuration{10};
+
+  TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds tick_duration);
+  ~TimerWheel();
+
+  /**
+   * Creates a timer on the wheel. Timers fire no earlier than requested, and at most one tick
+   * later. The timers must be freed before the wheel.
+   */
+  TimerPtr createTimer(TimerCb cb);
+
+private:
+  class WheelTimerImpl;
+
+  static constexpr uint32_t FirstLevelBits = 8;
+  static constexpr uint32_t LevelBits = 6;
+  static constexpr uint32_t NumLevels = 4;
+  static constexpr uint32_t FirstLevelSlots = 1 << FirstLevelBits;
+  static constexpr uint32_t LevelSlots = 1 << LevelBits;
+  // Timers which expire this many ticks or more from now are parked in the last level.
+  static constexpr uint64_t MaxTicks = uint64_t(1)
+                                       << (FirstLevelBits + LevelBits * (NumLevels - 1));
+
+  using Slot = std::list<WheelTimerImpl*>;
+
+  void add(WheelTimerImpl& timer, std::chrono::milliseconds duration);
+  void remove(WheelTimerImpl& timer);
+  void place(WheelTimerImpl& timer);
+  Slot& slotFor(uint64_t expiry_tick);
+  void cascade(uint32_t level);
+  void onTick();
+  uint64_t nowTick() const;
+  void scheduleTick();
+
+  Dispatcher& dispatcher_;
+  const std::chrono::milliseconds tick_duration_;
+  const MonotonicTime epoch_;
+  const TimerPtr tick_timer_;
+  // The last tick whose timers have fired.
+  uint64_t current_tick_{};
+  uint64_t num_enabled_{};
+  std::array<Slot, FirstLevelSlots> first_level_;
+  std::array<std::array<Slot, LevelSlots>, NumLevels - 1> levels_;
+};
+
+using TimerWheelPtr = std::unique_ptr<TimerWheel>;
+
+} // namespace Event
+} // namespace Envoy
@@ -49,6 +49,21 @@ Api::IoCallSizeResult FileImplWin32::write(absl::string_view buffer) {
   return resultSuccess<ssize_t>(bytes_written);
 };
 
+Api::IoCallSizeResult FileImplWin32::writev(absl::Span<const absl::string_view> buffers) {
+  ssize_t written = 0;
+  for (absl::string_view buffer : buffers) {
+    Api::IoCallSizeResult result = write(buffer);
+    if (!result.ok()) {
+      return result;
+    }
+    written += result.rc_;
+    if (result.rc_ != static_cast<ssize_t>(buffer.size())) {
+      break;
+    }
+  }
+  return resultSuccess<ssize_t>(written);
+}
+
 Api::IoCallBoolResult FileImplWin32::close() {
   ASSERT(isOpen());
 
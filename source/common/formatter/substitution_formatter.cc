@@ -1,7 +1,10 @@
 #include "common/formatter/substitution_formatter.h"
 
 #include <climits>
+#include <cmath>
 #include <cstdint>
+#include <iterator>
+#include <map>
 #include <regex>
 #include <string>
 #include <vector>
@@ -49,8 +52,145 @@ const std::regex& getStartTimeNewlinePattern() {
 }
 const std::regex& getNewlinePattern() { CONSTRUCT_ON_FIRST_USE(std::regex, "\n"); }
 
-template <class... Ts> struct JsonFormatMapVisitor : Ts... { using Ts::operator()...; };
-template <class... Ts> JsonFormatMapVisitor(Ts...) -> JsonFormatMapVisitor<Ts...>;
+// Returns the length of the JSON string encoding of a character.
+size_t jsonEscapedLength(unsigned char c) {
+  switch (c) {
+  case '"':
+  case '\\':
+  case '\b':
+  case '\f':
+  case '\n':
+  case '\r':
+  case '\t':
+    return 2;
+  default:
+    return c < 0x20 ? 6 : 1;
+  }
+}
+
+// Escapes the characters of the output from start on which JSON strings can't hold as is. The
+// output is expanded in place from the back, so nothing is copied when there is nothing to escape.
+void escapeJson(std::string& output, size_t start) {
+  size_t escaped_size = output.size();
+  for (size_t i = start; i < output.size(); ++i) {
+    escaped_size += jsonEscapedLength(output[i]) - 1;
+  }
+  if (escaped_size == output.size()) {
+    return;
+  }
+
+  static constexpr absl::string_view hex_digits = "0123456789abcdef";
+  size_t from = output.size();
+  size_t to = escaped_size;
+  output.resize(escaped_size);
+  while (from > start) {
+    const unsigned char c = output[--from];
+    switch (jsonEscapedLength(c)) {
+    case 1:
+      output[--to] = c;
+      continue;
+    case 2:
+      switch (c) {
+      case '\b':
+        output[--to] = 'b';
+        break;
+      case '\f':
+        output[--to] = 'f';
+        break;
+      case '\n':
+        output[--to] = 'n';
+        break;
+      case '\r':
+        output[--to] = 'r';
+        break;
+      case '\t':
+        output[--to] = 't';
+        break;
+      default:
+        output[--to] = c;
+        break;
+      }
+      break;
+    default:
+      output[--to] = hex_digits[c & 0xf];
+      output[--to] = hex_digits[c >> 4];
+      output[--to] = '0';
+      output[--to] = '0';
+      output[--to] = 'u';
+      break;
+    }
+    output[--to] = '\\';
+  }
+  ASSERT(to == from);
+}
+
+void writeJsonString(absl::string_view value, std::string& output) {
+  output.push_back('"');
+  const size_t start = output.size();
+  output.append(value.data(), value.size());
+  escapeJson(output, start);
+  output.push_back('"');
+}
+
+void writeJsonNumber(double value, std::string& output) {
+  if (!std::isfinite(value)) {
+    // Like the protobuf JSON encoding, which has no representation for these either.
+    output.append(std::isnan(value) ? "\"NaN\""
+                                    : (value > 0 ? "\"Infinity\"" : "\"-Infinity\""));
+    return;
+  }
+  // Integral values, which most numbers in access logs are, are written without a fraction.
+  if (std::trunc(value) == value && std::abs(value) < 9007199254740992.0) {
+    absl::StrAppend(&output, static_cast<int64_t>(value));
+    return;
+  }
+  fmt::format_to(std::back_inserter(output), "{}", value);
+}
+
+void writeJsonValue(const ProtobufWkt::Value& value, std::string& output) {
+  switch (value.kind_case()) {
+  case ProtobufWkt::Value::kNumberValue:
+    writeJsonNumber(value.number_value(), output);
+    break;
+  case ProtobufWkt::Value::kStringValue:
+    writeJsonString(value.string_value(), output);
+    break;
+  case ProtobufWkt::Value::kBoolValue:
+    output.append(value.bool_value() ? "true" : "false");
+    break;
+  case ProtobufWkt::Value::kStructValue: {
+    output.push_back('{');
+    bool first = true;
+    for (const auto& field : value.struct_value().fields()) {
+      if (!first) {
+        output.push_back(',');
+      }
+      first = false;
+      writeJsonString(field.first, output);
+      output.push_back(':');
+      writeJsonValue(field.second, output);
+    }
+    output.push_back('}');
+    break;
+  }
+  case ProtobufWkt::Value::kListValue: {
+    output.push_back('[');
+    bool first = true;
+    for (const ProtobufWkt::Value& element : value.list_value().values()) {
+      if (!first) {
+        output.push_back(',');
+      }
+      first = false;
+      writeJsonValue(element, output);
+    }
+    output.push_back(']');
+    break;
+  }
+  default:
+    output.append("null");
+    break;
+  }
+}
 
 } // namespace
 
@@ -122,96 +262,130 @@ std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
   log_line.reserve(256);
 
   for (const FormatterProviderPtr& provider : providers_) {
-    const auto bit = provider->format(request_headers, response_headers, response_trailers,
-                                      stream_info, local_reply_body);
-    log_line += bit.value_or(empty_value_string_);
+    if (!provider->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                            local_reply_body, log_line)) {
+      log_line += empty_value_string_;
+    }
   }
 
   return log_line;
 }
 
+JsonFormatterImpl::JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping,
+                                     bool preserve_types, bool omit_empty_values)
+    : omit_empty_values_(omit_empty_values), preserve_types_(preserve_types),
+      empty_value_string_(omit_empty_values ? EMPTY_STRING : DefaultUnspecifiedValueString) {
+  compile(format_mapping);
+}
+
 std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                       const Http::ResponseHeaderMap& response_headers,
                                       const Http::ResponseTrailerMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info,
                                       absl::string_view local_reply_body) const {
-  const auto output_struct =
-      toStruct(request_headers, response_headers, response_trailers, stream_info, local_reply_body);
+  std::string log_line;
+  log_line.reserve(512);
 
-  const std::string log_line = MessageUtil::getJsonStringFromMessage(output_struct, false, true);
-  return absl::StrCat(log_line, "\n");
+  log_line.push_back('{');
+  for (const JsonFormatOp& op : program_) {
+    if (op.type_ == JsonFormatOp::Type::EndObject) {
+      log_line.push_back('}');
+      continue;
+    }
+    const size_t start = log_line.size();
+    if (log_line.back() != '{') {
+      log_line.push_back(',');
+    }
+    log_line.append(op.key_);
+    if (op.type_ == JsonFormatOp::Type::StartObject) {
+      log_line.push_back('{');
+      continue;
+    }
+    if (!writeValue(op.providers_, request_headers, response_headers, response_trailers,
+                    stream_info, local_reply_body, log_line)) {
+      // Drop the separator and the key of the omitted value.
+      log_line.resize(start);
+    }
+  }
+  log_line.append("}\n");
+
+  return log_line;
 }
 
-JsonFormatterImpl::JsonFormatMapWrapper
-JsonFormatterImpl::toFormatMap(const ProtobufWkt::Struct& json_format) const {
-  auto output = std::make_unique<JsonFormatMap>();
+void JsonFormatterImpl::compile(const ProtobufWkt::Struct& json_format) {
+  // Although not required for JSON, it is nice to have the members in the same order in every log
+  // entry, thus std::map.
+  std::map<std::string, const ProtobufWkt::Value*> members;
   for (const auto& pair : json_format.fields()) {
-    switch (pair.second.kind_case()) {
+    members.emplace(pair.first, &pair.second);
+  }
+  for (const auto& member : members) {
+    JsonFormatOp op;
+    writeJsonString(member.first, op.key_);
+    op.key_.push_back(':');
+    switch (member.second->kind_case()) {
     case ProtobufWkt::Value::kStringValue:
-      output->emplace(pair.first, SubstitutionFormatParser::parse(pair.second.string_value()));
+      op.type_ = JsonFormatOp::Type::Value;
+      op.providers_ = SubstitutionFormatParser::parse(member.second->string_value());
+      program_.push_back(std::move(op));
       break;
     case ProtobufWkt::Value::kStructValue:
-      output->emplace(pair.first, toFormatMap(pair.second.struct_value()));
+      op.type_ = JsonFormatOp::Type::StartObject;
+      program_.push_back(std::move(op));
+      compile(member.second->struct_value());
+      program_.push_back({JsonFormatOp::Type::EndObject, EMPTY_STRING, {}});
       break;
     default:
       throw EnvoyException(
           "Only string values or nested structs are supported in the JSON access log format.");
     }
   }
-  return {std::move(output)};
-};
+}
 
-ProtobufWkt::Struct JsonFormatterImpl::toStruct(const Http::RequestHeaderMap& request_headers,
-                                                const Http::ResponseHeaderMap& response_headers,
-                                                const Http::ResponseTrailerMap& response_trailers,
-                                                const StreamInfo::StreamInfo& stream_info,
-                                                absl::string_view local_reply_body) const {
-  const std::string& empty_value =
-      omit_empty_values_ ? EMPTY_STRING : DefaultUnspecifiedValueString;
-  const std::function<ProtobufWkt::Value(const std::vector<FormatterProviderPtr>&)>
-      providers_callback = [&](const std::vector<FormatterProviderPtr>& providers) {
-        ASSERT(!providers.empty());
-        if (providers.size() == 1) {
-          const auto& provider = providers.front();
-          if (preserve_types_) {
-            return provider->formatValue(request_headers, response_headers, response_trailers,
-                                         stream_info, local_reply_body);
-          }
+bool JsonFormatterImpl::writeValue(const std::vector<FormatterProviderPtr>& providers,
+                                   const Http::RequestHeaderMap& request_headers,
+                                   const Http::ResponseHeaderMap& response_headers,
+                                   const Http::ResponseTrailerMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   absl::string_view local_reply_body, std::string& output) const {
+  if (providers.size() == 1) {
+    const FormatterProvider& provider = *providers.front();
+    if (preserve_types_) {
+      const ProtobufWkt::Value value = provider.formatValue(
+          request_headers, response_headers, response_trailers, stream_info, local_reply_body);
+      if (omit_empty_values_ && value.kind_case() == ProtobufWkt::Value::kNullValue) {
+        return false;
+      }
+      writeJsonValue(value, output);
+      return true;
+    }
 
-          if (omit_empty_values_) {
-            return ValueUtil::optionalStringValue(
-                provider->format(request_headers, response_headers, response_trailers, stream_info,
-                                 local_reply_body));
-          }
+    output.push_back('"');
+    const size_t start = output.size();
+    if (!provider.formatTo(request_headers, response_headers, response_trailers, stream_info,
+                           local_reply_body, output)) {
+      if (omit_empty_values_) {
+        return false;
+      }
+      output.append(DefaultUnspecifiedValueString);
+    }
+    escapeJson(output, start);
+    output.push_back('"');
+    return true;
+  }
 
-          const auto str = provider->format(request_headers, response_headers, response_trailers,
-                                            stream_info, local_reply_body);
-          return ValueUtil::stringValue(str.value_or(DefaultUnspecifiedValueString));
-        }
-        // Multiple providers forces string output.
-        std::string str;
-        for (const auto& provider : providers) {
-          const auto bit = provider->format(request_headers, response_headers, response_trailers,
-                                            stream_info, local_reply_body);
-          str += bit.value_or(empty_value);
-        }
-        return ValueUtil::stringValue(str);
-      };
-  const std::function<ProtobufWkt::Value(const JsonFormatterImpl::JsonFormatMapWrapper&)>
-      json_format_map_callback = [&](const JsonFormatterImpl::JsonFormatMapWrapper& format) {
-        ProtobufWkt::Struct output;
-        auto* fields = output.mutable_fields();
-        JsonFormatMapVisitor visitor{json_format_map_callback, providers_callback};
-        for (const auto& pair : *format.value_) {
-          ProtobufWkt::Value value = absl::visit(visitor, pair.second);
-          if (omit_empty_values_ && value.kind_case() == ProtobufWkt::Value::kNullValue) {
-            continue;
-          }
-          (*fields)[pair.first] = value;
-        }
-        return ValueUtil::structValue(output);
-      };
-  return json_format_map_callback(json_output_format_).struct_value();
+  // Multiple providers forces string output.
+  output.push_back('"');
+  const size_t start = output.size();
+  for (const FormatterProviderPtr& provider : providers) {
+    if (!provider->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                            local_reply_body, output)) {
+      output.append(empty_value_string_);
+    }
+  }
+  escapeJson(output, start);
+  output.push_back('"');
+  return true;
 }
 
 void SubstitutionFormatParser::parseCommandHeader(const std::string& token, const size_t start,
@@ -834,6 +1008,13 @@ absl::optional<std::string> PlainStringFormatter::format(const Http::RequestHead
   return str_.string_value();
 }
 
+bool PlainStringFormatter::formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                                    const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
+                                    absl::string_view, std::string& output) const {
+  output.append(str_.string_value());
+  return true;
+}
+
 ProtobufWkt::Value PlainStringFormatter::formatValue(const Http::RequestHeaderMap&,
                                                      const Http::ResponseHeaderMap&,
                                                      const Http::ResponseTrailerMap&,
@@ -849,6 +1030,16 @@ LocalReplyBodyFormatter::format(const Http::RequestHeaderMap&, const Http::Respo
   return std::string(local_reply_body);
 }
 
+bool LocalReplyBodyFormatter::formatTo(const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap&,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&,
+                                       absl::string_view local_reply_body,
+                                       std::string& output) const {
+  output.append(local_reply_body.data(), local_reply_body.size());
+  return true;
+}
+
 ProtobufWkt::Value LocalReplyBodyFormatter::formatValue(const Http::RequestHeaderMap&,
                                                         const Http::ResponseHeaderMap&,
                                                         const Http::ResponseTrailerMap&,
@@ -885,6 +1076,20 @@ absl::optional<std::string> HeaderFormatter::format(const Http::HeaderMap& heade
   return val;
 }
 
+bool HeaderFormatter::formatTo(const Http::HeaderMap& headers, std::string& output) const {
+  const Http::HeaderEntry* header = findHeader(headers);
+  if (!header) {
+    return false;
+  }
+
+  absl::string_view val = header->value().getStringView();
+  if (max_length_) {
+    val = val.substr(0, max_length_.value());
+  }
+  output.append(val.data(), val.size());
+  return true;
+}
+
 ProtobufWkt::Value HeaderFormatter::formatValue(const Http::HeaderMap& headers) const {
   const Http::HeaderEntry* header = findHeader(headers);
   if (!header) {
@@ -907,6 +1112,14 @@ absl::optional<std::string> ResponseHeaderFormatter::format(
   return HeaderFormatter::format(response_headers);
 }
 
+bool ResponseHeaderFormatter::formatTo(const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap& response_headers,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&, absl::string_view,
+                                       std::string& output) const {
+  return HeaderFormatter::formatTo(response_headers, output);
+}
+
 ProtobufWkt::Value ResponseHeaderFormatter::formatValue(
     const Http::RequestHeaderMap&, const Http::ResponseHeaderMap& response_headers,
     const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view) const {
@@ -925,6 +1138,14 @@ RequestHeaderFormatter::format(const Http::RequestHeaderMap& request_headers,
   return HeaderFormatter::format(request_headers);
 }
 
+bool RequestHeaderFormatter::formatTo(const Http::RequestHeaderMap& request_headers,
+                                      const Http::ResponseHeaderMap&,
+                                      const Http::ResponseTrailerMap&,
+                                      const StreamInfo::StreamInfo&, absl::string_view,
+                                      std::string& output) const {
+  return HeaderFormatter::formatTo(request_headers, output);
+}
+
 ProtobufWkt::Value
 RequestHeaderFormatter::formatValue(const Http::RequestHeaderMap& request_headers,
                                     const Http::ResponseHeaderMap&, const Http::ResponseTrailerMap&,
@@ -944,6 +1165,14 @@ ResponseTrailerFormatter::format(const Http::RequestHeaderMap&, const Http::Resp
   return HeaderFormatter::format(response_trailers);
 }
 
+bool ResponseTrailerFormatter::formatTo(const Http::RequestHeaderMap&,
+                                        const Http::ResponseHeaderMap&,
+                                        const Http::ResponseTrailerMap& response_trailers,
+                                        const StreamInfo::StreamInfo&, absl::string_view,
+                                        std::string& output) const {
+  return HeaderFormatter::formatTo(response_trailers, output);
+}
+
 ProtobufWkt::Value
 ResponseTrailerFormatter::formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                       const Http::ResponseTrailerMap& response_trailers,
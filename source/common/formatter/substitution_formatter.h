@@ -107,12 +107,14 @@ private:
   std::vector<FormatterProviderPtr> providers_;
 };
 
+/**
+ * JSON formatter implementation. The format is compiled into a flat program at construction,
+ * which renders each log line straight into its output string, escaping the values as it goes.
+ */
 class JsonFormatterImpl : public Formatter {
 public:
   JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
-                    bool omit_empty_values)
-      : omit_empty_values_(omit_empty_values), preserve_types_(preserve_types),
-        json_output_format_(toFormatMap(format_mapping)) {}
+                    bool omit_empty_values);
 
   // Formatter::format
   std::string format(const Http::RequestHeaderMap& request_headers,
@@ -122,27 +124,31 @@ public:
                      absl::string_view local_reply_body) const override;
 
 private:
-  struct JsonFormatMapWrapper;
-  using JsonFormatMapValue =
-      absl::variant<const std::vector<FormatterProviderPtr>, const JsonFormatMapWrapper>;
-  // Although not required for JSON, it is nice to have the order of properties
-  // preserved between the format and the log entry, thus std::map.
-  using JsonFormatMap = std::map<std::string, JsonFormatMapValue>;
-  using JsonFormatMapPtr = std::unique_ptr<JsonFormatMap>;
-  struct JsonFormatMapWrapper {
-    JsonFormatMapPtr value_;
+  // An instruction of the compiled format. StartObject and Value write the separator and the key of
+  // an object member, followed by the opening brace of a nested object or by the formatted value.
+  // EndObject closes the nested object.
+  struct JsonFormatOp {
+    enum class Type { StartObject, EndObject, Value };
+
+    Type type_;
+    // The JSON encoded key followed by ':'.
+    std::string key_;
+    std::vector<FormatterProviderPtr> providers_;
   };
 
-  bool omit_empty_values_;
-  bool preserve_types_;
-  const JsonFormatMapWrapper json_output_format_;
-
-  ProtobufWkt::Struct toStruct(const Http::RequestHeaderMap& request_headers,
-                               const Http::ResponseHeaderMap& response_headers,
-                               const Http::ResponseTrailerMap& response_trailers,
-                               const StreamInfo::StreamInfo& stream_info,
-                               absl::string_view local_reply_body) const;
-  JsonFormatMapWrapper toFormatMap(const ProtobufWkt::Struct& json_format) const;
+  void compile(const ProtobufWkt::Struct& json_format);
+  // Writes the value of an object member. Returns false if the value is missing, and is omitted.
+  bool writeValue(const std::vector<FormatterProviderPtr>& providers,
+                  const Http::RequestHeaderMap& request_headers,
+                  const Http::ResponseHeaderMap& response_headers,
+                  const Http::ResponseTrailerMap& response_trailers,
+                  const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
+                  std::string& output) const;
+
+  const bool omit_empty_values_;
+  const bool preserve_types_;
+  const std::string& empty_value_string_;
+  std::vector<JsonFormatOp> program_;
 };
 
 /**
@@ -157,6 +163,9 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -176,6 +185,9 @@ public:
   absl::optional<std::string> format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view local_reply_body) const override;
+  bool formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
+                absl::string_view local_reply_body, std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view local_reply_body) const override;
@@ -188,6 +200,7 @@ public:
 
 protected:
   absl::optional<std::string> format(const Http::HeaderMap& headers) const;
+  bool formatTo(const Http::HeaderMap& headers, std::string& output) const;
   ProtobufWkt::Value formatValue(const Http::HeaderMap& headers) const;
 
 private:
@@ -211,6 +224,9 @@ public:
                                      const Http::ResponseHeaderMap&,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap& request_headers, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -229,6 +245,9 @@ public:
                                      const Http::ResponseHeaderMap& response_headers,
                                      const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap& response_headers,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&, absl::string_view,
+                std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
@@ -247,6 +266,9 @@ public:
                                      const Http::ResponseTrailerMap& response_trailers,
                                      const StreamInfo::StreamInfo&,
                                      absl::string_view) const override;
+  bool formatTo(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap& response_trailers, const StreamInfo::StreamInfo&,
+                absl::string_view, std::string& output) const override;
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
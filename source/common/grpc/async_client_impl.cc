@@ -195,6 +195,11 @@ void AsyncStreamImpl::sendMessageRaw(Buffer::InstancePtr&& buffer, bool end_stre
   stream_->sendData(*buffer, end_stream);
 }
 
+void AsyncStreamImpl::sendCompressedMessageRaw(Buffer::InstancePtr&& buffer, bool end_stream) {
+  Common::prependGrpcFrameHeader(*buffer, GRPC_FH_COMPRESSED);
+  stream_->sendData(*buffer, end_stream);
+}
+
 void AsyncStreamImpl::closeStream() {
   Buffer::OwnedImpl empty_buffer;
   stream_->sendData(empty_buffer, true);
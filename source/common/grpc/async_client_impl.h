@@ -49,6 +49,7 @@ private:
 };
 
 class AsyncStreamImpl : public RawAsyncStream,
+                        public RawCompressedAsyncStream,
                         Http::AsyncClient::StreamCallbacks,
                         public Event::DeferredDeletable,
                         public LinkedObject<AsyncStreamImpl> {
@@ -76,6 +77,9 @@ public:
     return stream_ && stream_->isAboveWriteBufferHighWatermark();
   }
 
+  // Grpc::RawCompressedAsyncStream
+  void sendCompressedMessageRaw(Buffer::InstancePtr&& request, bool end_stream) override;
+
   bool hasResetStream() const { return http_reset_; }
 
 private:
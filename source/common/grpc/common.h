@@ -11,6 +11,7 @@
 #include "envoy/http/message.h"
 
 #include "common/common/hash.h"
+#include "common/grpc/codec.h"
 #include "common/grpc/status.h"
 #include "common/protobuf/protobuf.h"
 
@@ -151,8 +152,9 @@ public:
   /**
    * Prepend a gRPC frame header to a Buffer::Instance containing a single gRPC frame.
    * @param buffer containing the frame data which will be modified.
+   * @param flags supplies the frame flags, e.g. GRPC_FH_COMPRESSED for a compressed frame.
    */
-  static void prependGrpcFrameHeader(Buffer::Instance& buffer);
+  static void prependGrpcFrameHeader(Buffer::Instance& buffer, uint8_t flags = GRPC_FH_DEFAULT);
 
   /**
    * Parse a Buffer::Instance into a Protobuf::Message.
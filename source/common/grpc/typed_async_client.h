@@ -46,6 +46,16 @@ public:
                                                         transport_api_version);
     Internal::sendMessageUntyped(stream_, std::move(request), end_stream);
   }
+  void sendMessageRaw(Buffer::InstancePtr&& request, bool end_stream) {
+    stream_->sendMessageRaw(std::move(request), end_stream);
+  }
+  /**
+   * @return the stream as a RawCompressedAsyncStream, or nullptr if its client compresses the
+   *         messages itself.
+   */
+  RawCompressedAsyncStream* compressedStream() const {
+    return dynamic_cast<RawCompressedAsyncStream*>(stream_);
+  }
   void closeStream() { stream_->closeStream(); }
   void resetStream() { stream_->resetStream(); }
   bool isAboveWriteBufferHighWatermark() const {
@@ -39,6 +39,7 @@
 #include "common/http/path_utility.h"
 #include "common/http/status.h"
 #include "common/http/utility.h"
+#include "common/network/transferable_connection.h"
 #include "common/network/utility.h"
 #include "common/router/config_impl.h"
 #include "common/runtime/runtime_features.h"
@@ -133,6 +134,21 @@ void ConnectionManagerImpl::initializeReadFilterCallbacks(Network::ReadFilterCal
     connection_duration_timer_->enableTimer(config_.maxConnectionDuration().value());
   }
 
+  if (Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.hot_restart_transfer_idle_connections")) {
+    // Only HTTP/1 connections between requests carry no state beyond the socket. Pipelined requests
+    // stay in the connection's read buffer, which the connection handler checks. The filter state
+    // is only read while the connection, and so this filter, is open.
+    read_callbacks_->connection().streamInfo().filterState()->setData(
+        Network::TransferableConnection::key(),
+        std::make_shared<Network::TransferableConnection>([this]() {
+          return streams_.empty() && read_callbacks_->connection().ssl() == nullptr &&
+                 (codec_ == nullptr || codec_->protocol() < Protocol::Http2);
+        }),
+        StreamInfo::FilterState::StateType::ReadOnly,
+        StreamInfo::FilterState::LifeSpan::Connection);
+  }
+
   read_callbacks_->connection().setDelayedCloseTimeout(config_.delayedCloseTimeout());
 
   read_callbacks_->connection().setConnectionStats(
@@ -637,15 +653,17 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
 
   if (connection_manager_.config_.streamIdleTimeout().count()) {
     idle_timeout_ms_ = connection_manager_.config_.streamIdleTimeout();
-    stream_idle_timer_ = connection_manager_.read_callbacks_->connection().dispatcher().createTimer(
-        [this]() -> void { onIdleTimeout(); });
+    stream_idle_timer_ =
+        connection_manager_.read_callbacks_->connection().dispatcher().createCoarseTimer(
+            [this]() -> void { onIdleTimeout(); });
     resetIdleTimer();
   }
 
   if (connection_manager_.config_.requestTimeout().count()) {
     std::chrono::milliseconds request_timeout = connection_manager_.config_.requestTimeout();
-    request_timer_ = connection_manager.read_callbacks_->connection().dispatcher().createTimer(
-        [this]() -> void { onRequestTimeout(); });
+    request_timer_ =
+        connection_manager.read_callbacks_->connection().dispatcher().createCoarseTimer(
+            [this]() -> void { onRequestTimeout(); });
     request_timer_->enableTimer(request_timeout, this);
   }
 
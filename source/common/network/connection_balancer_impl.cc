@@ -34,5 +34,56 @@ ExactConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler&) {
   return *min_connection_handler;
 }
 
+void LeastConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(&lock_);
+  handlers_.push_back(&handler);
+}
+
+void LeastConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(&lock_);
+  handlers_.erase(std::find(handlers_.begin(), handlers_.end(), &handler));
+}
+
+BalancedConnectionHandler&
+LeastConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current_handler) {
+  BalancedConnectionHandler* min_connection_handler = nullptr;
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    const size_t num_handlers = handlers_.size();
+    if (num_handlers <= choice_count_) {
+      // Not enough handlers to choose from, compare all of them.
+      for (BalancedConnectionHandler* handler : handlers_) {
+        if (min_connection_handler == nullptr ||
+            handler->numConnections() < min_connection_handler->numConnections()) {
+          min_connection_handler = handler;
+        }
+      }
+    } else {
+      // The same handler may be chosen more than once, as in the least request load balancer.
+      for (uint32_t i = 0; i < choice_count_; ++i) {
+        BalancedConnectionHandler* handler = handlers_[random_.random() % num_handlers];
+        if (min_connection_handler == nullptr ||
+            handler->numConnections() < min_connection_handler->numConnections()) {
+          min_connection_handler = handler;
+        }
+      }
+    }
+
+    if (min_connection_handler == nullptr) {
+      // No handler registered (e.g. during shutdown), keep the connection where it is.
+      min_connection_handler = &current_handler;
+    } else if (min_connection_handler != &current_handler &&
+               min_connection_handler->numConnections() >= current_handler.numConnections()) {
+      // Don't pay for a cross thread transfer if the current handler is at least as good.
+      min_connection_handler = &current_handler;
+    }
+
+    // The count has to be incremented while the handler is known to be registered.
+    min_connection_handler->incNumConnections();
+  }
+
+  return *min_connection_handler;
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vector>
+
+#include "envoy/common/random_generator.h"
 #include "envoy/network/connection_balancer.h"
 
 #include "absl/synchronization/mutex.h"
@@ -27,6 +30,31 @@ private:
   std::vector<BalancedConnectionHandler*> handlers_ ABSL_GUARDED_BY(lock_);
 };
 
+/**
+ * Implementation of connection balancer that picks the handler with the fewest connections among
+ * choice_count randomly chosen handlers ("power of two choices" for the default of 2). Picking
+ * only takes a shared lock on the handler list, which is exclusively locked when handlers are
+ * registered or unregistered, so accepts on different handlers don't serialize. Connection counts
+ * are read without synchronizing with the other handlers, so two concurrent accepts may both pick
+ * the same lightly loaded handler; the random choice keeps this from turning into a herd.
+ */
+class LeastConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  LeastConnectionBalancerImpl(Random::RandomGenerator& random, uint32_t choice_count)
+      : random_(random), choice_count_(choice_count) {}
+
+  // ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override;
+
+private:
+  Random::RandomGenerator& random_;
+  const uint32_t choice_count_;
+  absl::Mutex lock_;
+  std::vector<BalancedConnectionHandler*> handlers_ ABSL_GUARDED_BY(lock_);
+};
+
 /**
  * A NOP connection balancer implementation that always continues execution after incrementing
  * the handler's connection count.
@@ -86,6 +86,9 @@ public:
   uint32_t bufferLimit() const override { return read_buffer_limit_; }
   bool localAddressRestored() const override { return socket_->localAddressRestored(); }
   bool aboveHighWatermark() const override { return write_buffer_above_high_watermark_; }
+  bool buffersEmpty() const override {
+    return read_buffer_.length() == 0 && write_buffer_->length() == 0;
+  }
   const ConnectionSocket::OptionsSharedPtr& socketOptions() const override {
     return socket_->options();
   }
@@ -0,0 +1,13 @@
+#include "common/network/transferable_connection.h"
+
+#include "common/common/macros.h"
+
+namespace Envoy {
+namespace Network {
+
+const std::string& TransferableConnection::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "envoy.network.transferable_connection");
+}
+
+} // namespace Network
+} // namespace Envoy
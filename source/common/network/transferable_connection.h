@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+
+#include "envoy/stream_info/filter_state.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Connection filter state through which the terminal network filter reports whether the connection
+ * is idle, i.e. whether another process could take over the connection's socket without the peer
+ * noticing. This is how connections move to the new process on hot restart.
+ */
+class TransferableConnection : public StreamInfo::FilterState::Object {
+public:
+  using IdleCb = std::function<bool()>;
+
+  TransferableConnection(IdleCb idle_cb) : idle_cb_(std::move(idle_cb)) {}
+  bool idle() const { return idle_cb_(); }
+  static const std::string& key();
+
+private:
+  const IdleCb idle_cb_;
+};
+
+} // namespace Network
+} // namespace Envoy
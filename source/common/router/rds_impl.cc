@@ -116,14 +116,31 @@ void RdsRouteConfigSubscription::onConfigUpdate(
     throw EnvoyException(fmt::format("Unexpected RDS configuration (expecting {}): {}",
                                      route_config_name_, route_config.name()));
   }
-  for (auto* provider : route_config_providers_) {
-    // This seems inefficient, though it is necessary to validate config in each context,
-    // especially when it comes with per_filter_config,
-    provider->validateConfig(route_config);
+  const uint64_t config_hash = MessageUtil::hash(route_config);
+  if (config_hash == config_update_info_->configHash()) {
+    // The same configuration was already validated and applied, don't build the (potentially
+    // very large) route table again just to throw it away.
+    ENVOY_LOG(debug, "rds: skipping unchanged configuration: config_name={} hash={}",
+              route_config_name_, config_update_info_->configHash());
+    local_init_target_.ready();
+    return;
+  }
+  try {
+    for (auto* provider : route_config_providers_) {
+      // This seems inefficient, though it is necessary to validate config in each context,
+      // especially when it comes with per_filter_config,
+      provider->validateConfig(route_config);
+    }
+  } catch (const EnvoyException&) {
+    // Don't let the providers which did validate the rejected configuration publish it later.
+    for (auto* provider : route_config_providers_) {
+      provider->discardValidatedConfig();
+    }
+    throw;
   }
   std::unique_ptr<Init::ManagerImpl> noop_init_manager;
   std::unique_ptr<Cleanup> resume_rds;
-  if (config_update_info_->onRdsUpdate(route_config, version_info)) {
+  if (config_update_info_->onRdsUpdate(route_config, version_info, config_hash)) {
     stats_.config_reload_.inc();
     if (config_update_info_->routeConfiguration().has_vhds() &&
         config_update_info_->vhdsConfigurationChanged()) {
@@ -253,8 +270,14 @@ RdsRouteConfigProviderImpl::~RdsRouteConfigProviderImpl() {
 Router::ConfigConstSharedPtr RdsRouteConfigProviderImpl::config() { return tls_->config_; }
 
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(new ConfigImpl(config_update_info_->routeConfiguration(),
-                                                 factory_context_, validator_, false));
+  ConfigConstSharedPtr new_config = std::move(validated_config_);
+  discardValidatedConfig();
+  if (new_config == nullptr || config_update_info_->routeConfiguration().has_vhds()) {
+    // VHDS merges its virtual hosts into the route configuration, so the route table built while
+    // validating the RDS resource alone can't be used.
+    new_config = std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(),
+                                              factory_context_, validator_, false);
+  }
   tls_.runOnAllThreads([new_config](OptRef<ThreadLocalConfig> tls) { tls->config_ = new_config; });
 
   const auto aliases = config_update_info_->resourceIdsInLastVhdsUpdate();
@@ -288,9 +311,12 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
 }
 
 void RdsRouteConfigProviderImpl::validateConfig(
-    const envoy::config::route::v3::RouteConfiguration& config) const {
-  // TODO(lizan): consider cache the config here until onConfigUpdate.
-  ConfigImpl validation_config(config, factory_context_, validator_, false);
+    const envoy::config::route::v3::RouteConfiguration& config) {
+  // Building the route table is the expensive part of an RDS update. Keep the one built for
+  // validation around so that the onConfigUpdate() which follows a successful validation can
+  // publish it rather than building it a second time.
+  discardValidatedConfig();
+  validated_config_ = std::make_shared<ConfigImpl>(config, factory_context_, validator_, false);
 }
 
 // Schedules a VHDS request on the main thread and queues up the callback to use when the VHDS
@@ -14,13 +14,13 @@ namespace Envoy {
 namespace Router {
 
 bool RouteConfigUpdateReceiverImpl::onRdsUpdate(
-    const envoy::config::route::v3::RouteConfiguration& rc, const std::string& version_info) {
-  const uint64_t new_hash = MessageUtil::hash(rc);
-  if (new_hash == last_config_hash_) {
+    const envoy::config::route::v3::RouteConfiguration& rc, const std::string& version_info,
+    uint64_t config_hash) {
+  if (config_hash == last_config_hash_) {
     return false;
   }
   route_config_proto_ = rc;
-  last_config_hash_ = new_hash;
+  last_config_hash_ = config_hash;
   const uint64_t new_vhds_config_hash = rc.has_vhds() ? MessageUtil::hash(rc.vhds()) : 0ul;
   vhds_configuration_changed_ = new_vhds_config_hash != last_vhds_config_hash_;
   last_vhds_config_hash_ = new_vhds_config_hash;
@@ -35,7 +35,7 @@ public:
 
   // Router::RouteConfigUpdateReceiver
   bool onRdsUpdate(const envoy::config::route::v3::RouteConfiguration& rc,
-                   const std::string& version_info) override;
+                   const std::string& version_info, uint64_t config_hash) override;
   bool onVhdsUpdate(const VirtualHostRefVector& added_vhosts,
                     const std::set<std::string>& added_resource_ids,
                     const Protobuf::RepeatedPtrField<std::string>& removed_resources,
@@ -100,13 +100,30 @@ constexpr const char* runtime_features[] = {
 // When features are added here, there should be a tracking bug assigned to the
 // code owner to flip the default after sufficient testing.
 constexpr const char* disabled_runtime_features[] = {
+    // Bounding the posted callbacks run per event loop iteration lets network events overtake
+    // cross-thread work, which slows down config propagation to the workers.
+    "envoy.reloadable_features.dispatcher_post_callback_budget",
+    // Timers on the timer wheel fire up to a tick late, which tests of exact timeouts don't expect.
+    "envoy.reloadable_features.coarse_timers_use_timer_wheel",
     // v2 is fatal-by-default.
     "envoy.reloadable_features.enable_deprecated_v2_api",
     // Allow Envoy to upgrade or downgrade version of type url, should be removed when support for
     // v2 url is removed from codebase.
     "envoy.reloadable_features.enable_type_url_downgrade_and_upgrade",
+    // Handing connections over on hot restart leaves the old process with fewer connections to
+    // drain, so this stays opt-in until it has seen wider use.
+    "envoy.reloadable_features.hot_restart_transfer_idle_connections",
     // TODO(alyssawilk) flip true after the release.
     "envoy.reloadable_features.new_tcp_connection_pool",
+    // Skipping SotW xDS updates whose resources are unchanged means subscriptions no longer see
+    // (or count) every version, so this stays opt-in until the stats semantics are settled.
+    "envoy.reloadable_features.skip_unchanged_sotw_resource_updates",
+    // Selecting certificates by SNI changes which certificate clients get from listeners with
+    // several certificates, so this stays opt-in until operators have checked their certificates.
+    "envoy.reloadable_features.tls_select_certificate_by_sni",
+    // Sharing session resumption state between server contexts changes how much memory TLS
+    // listeners use, so this stays opt-in until the cache size is configurable.
+    "envoy.reloadable_features.tls_shared_server_session_cache",
     // TODO(yanavlasov) flip true after all tests for upstream flood checks are implemented
     "envoy.reloadable_features.upstream_http2_flood_checks",
     // Sentinel and test flag.
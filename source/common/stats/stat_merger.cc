@@ -2,6 +2,8 @@
 
 #include <algorithm>
 
+#include "common/common/logger.h"
+
 namespace Envoy {
 namespace Stats {
 
@@ -92,8 +94,8 @@ void StatMerger::mergeGauges(const Protobuf::Map<std::string, uint64_t>& gauges,
     //
     // 1. Child thinks gauge is Accumulate : data is combined in
     //    gauge_ref.add() below.
-    // 2. Child thinks gauge is NeverImport: we skip this loop entry via
-    //    'continue'.
+    // 2. Child thinks gauge is NeverImport: importGauge() returns nullptr
+    //    and we skip this loop entry.
     // 3. Child has not yet initialized gauge yet -- this merge is the
     //    first time the child learns of the gauge. It's possible the child
     //    will think the gauge is NeverImport due to a code change. But for
@@ -109,36 +111,86 @@ void StatMerger::mergeGauges(const Protobuf::Map<std::string, uint64_t>& gauges,
 
     StatMerger::DynamicContext dynamic_context(temp_scope_->symbolTable());
     StatName stat_name = dynamic_context.makeDynamicStatName(gauge.first, dynamic_map);
-    GaugeOptConstRef gauge_opt = temp_scope_->findGauge(stat_name);
+    Gauge* gauge_ptr = importGauge(stat_name);
+    if (gauge_ptr != nullptr) {
+      mergeGauge(*gauge_ptr, gauge.second);
+    }
+  }
+}
+
+Gauge* StatMerger::importGauge(StatName stat_name) {
+  GaugeOptConstRef gauge_opt = temp_scope_->findGauge(stat_name);
 
-    Gauge::ImportMode import_mode = Gauge::ImportMode::Uninitialized;
-    if (gauge_opt) {
-      import_mode = gauge_opt->get().importMode();
-      if (import_mode == Gauge::ImportMode::NeverImport) {
+  Gauge::ImportMode import_mode = Gauge::ImportMode::Uninitialized;
+  if (gauge_opt) {
+    import_mode = gauge_opt->get().importMode();
+    if (import_mode == Gauge::ImportMode::NeverImport) {
+      return nullptr;
+    }
+  }
+
+  // TODO(snowp): Propagate tag values during hot restarts.
+  auto& gauge_ref = temp_scope_->gaugeFromStatName(stat_name, import_mode);
+  if (gauge_ref.importMode() == Gauge::ImportMode::NeverImport) {
+    // On the first iteration through the loop, the gauge will not be loaded into the scope
+    // cache even though it might exist in another scope. Thus, we need to check again for
+    // the import status to see if we should skip this gauge.
+    //
+    // TODO(mattklein123): There is a race condition here. It's technically possible that
+    // between the time we created this stat, the stat might be created by the child as a
+    // never import stat, making the below math invalid. A follow up solution is to take the
+    // store lock starting from gaugeFromStatName() to the end of this function, but this will
+    // require adding some type of mergeGauge() function to the scope and dealing with recursive
+    // lock acquisition, etc. so we will leave this as a follow up. This race should be incredibly
+    // rare.
+    return nullptr;
+  }
+  return &gauge_ref;
+}
+
+void StatMerger::mergeGauge(Gauge& gauge, uint64_t parent_value) {
+  parent_gauges_.insert(gauge.statName());
+  gauge.setParentValue(parent_value);
+}
+
+void StatMerger::mergeIndexedStats(const Protobuf::Map<uint32_t, std::string>& stat_names,
+                                   const Protobuf::Map<uint32_t, uint64_t>& counter_deltas,
+                                   const Protobuf::Map<uint32_t, uint64_t>& gauges,
+                                   const DynamicsMap& dynamics) {
+  // The stats are only looked up by name the first time the parent sends them.
+  for (const auto& counter : counter_deltas) {
+    auto it = indexed_counters_.find(counter.first);
+    if (it == indexed_counters_.end()) {
+      auto name = stat_names.find(counter.first);
+      if (name == stat_names.end()) {
+        ENVOY_LOG_MISC(error, "hot restart parent sent a counter with unknown index {}",
+                       counter.first);
         continue;
       }
+      StatMerger::DynamicContext dynamic_context(temp_scope_->symbolTable());
+      StatName stat_name = dynamic_context.makeDynamicStatName(name->second, dynamics);
+      it = indexed_counters_.emplace(counter.first, &temp_scope_->counterFromStatName(stat_name))
+               .first;
     }
+    it->second->add(counter.second);
+  }
 
-    // TODO(snowp): Propagate tag values during hot restarts.
-    auto& gauge_ref = temp_scope_->gaugeFromStatName(stat_name, import_mode);
-    if (gauge_ref.importMode() == Gauge::ImportMode::NeverImport) {
-      // On the first iteration through the loop, the gauge will not be loaded into the scope
-      // cache even though it might exist in another scope. Thus, we need to check again for
-      // the import status to see if we should skip this gauge.
-      //
-      // TODO(mattklein123): There is a race condition here. It's technically possible that
-      // between the time we created this stat, the stat might be created by the child as a
-      // never import stat, making the below math invalid. A follow up solution is to take the
-      // store lock starting from gaugeFromStatName() to the end of this function, but this will
-      // require adding some type of mergeGauge() function to the scope and dealing with recursive
-      // lock acquisition, etc. so we will leave this as a follow up. This race should be incredibly
-      // rare.
-      continue;
+  for (const auto& gauge : gauges) {
+    auto it = indexed_gauges_.find(gauge.first);
+    if (it == indexed_gauges_.end()) {
+      auto name = stat_names.find(gauge.first);
+      if (name == stat_names.end()) {
+        ENVOY_LOG_MISC(error, "hot restart parent sent a gauge with unknown index {}", gauge.first);
+        continue;
+      }
+      StatMerger::DynamicContext dynamic_context(temp_scope_->symbolTable());
+      StatName stat_name = dynamic_context.makeDynamicStatName(name->second, dynamics);
+      it = indexed_gauges_.emplace(gauge.first, importGauge(stat_name)).first;
+    }
+    // The child may have initialized the gauge as never imported since the last merge.
+    if (it->second != nullptr && it->second->importMode() != Gauge::ImportMode::NeverImport) {
+      mergeGauge(*it->second, gauge.second);
     }
-
-    const uint64_t new_parent_value = gauge.second;
-    parent_gauges_.insert(gauge_ref.statName());
-    gauge_ref.setParentValue(new_parent_value);
   }
 }
 
@@ -56,6 +56,20 @@ public:
                   const Protobuf::Map<std::string, uint64_t>& gauges,
                   const DynamicsMap& dynamics = DynamicsMap());
 
+  /**
+   * Like mergeStats(), for stats which the parent identifies by an index. The parent sends the
+   * name of each stat once, along with its first value, and only the index afterwards.
+   *
+   * @param stat_names map of the names of the stats indexed for the first time
+   * @param counter_deltas map of counter changes from parent, keyed by index
+   * @param gauges map of gauge changes from parent, keyed by index
+   * @param dynamics information about which segments of the new names are dynamic.
+   */
+  void mergeIndexedStats(const Protobuf::Map<uint32_t, std::string>& stat_names,
+                         const Protobuf::Map<uint32_t, uint64_t>& counter_deltas,
+                         const Protobuf::Map<uint32_t, uint64_t>& gauges,
+                         const DynamicsMap& dynamics = DynamicsMap());
+
   /**
    * Indicates that a gauge's value from the hot-restart parent should be
    * retained, combining it with the child data. By default, data is transferred
@@ -76,8 +90,15 @@ private:
                      const DynamicsMap& dynamics_map);
   void mergeGauges(const Protobuf::Map<std::string, uint64_t>& gauges,
                    const DynamicsMap& dynamics_map);
+  // Returns the gauge which merges the parent's value, or nullptr if the gauge is never imported.
+  Gauge* importGauge(StatName stat_name);
+  void mergeGauge(Gauge& gauge, uint64_t parent_value);
 
   StatNameHashSet parent_gauges_;
+  // The stats merged by index. The stats live as long as temp_scope_. A gauge is nullptr if it
+  // is never imported.
+  absl::flat_hash_map<uint32_t, Counter*> indexed_counters_;
+  absl::flat_hash_map<uint32_t, Gauge*> indexed_gauges_;
   // A stats Scope for our in-the-merging-process counters to live in. Scopes conceptually hold
   // shared_ptrs to the stats that live in them, with the question of which stats are living in a
   // given scope determined by which stat names have been accessed via that scope. E.g., if you
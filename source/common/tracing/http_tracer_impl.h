@@ -168,6 +168,7 @@ public:
   void setTag(absl::string_view, absl::string_view) override {}
   void log(SystemTime, const std::string&) override {}
   void finishSpan() override {}
+  void finishSpanAt(SystemTime) override {}
   void injectContext(Http::RequestHeaderMap&) override {}
   void setBaggage(absl::string_view, absl::string_view) override {}
   std::string getBaggage(absl::string_view) override { return std::string(); }
@@ -0,0 +1,193 @@
+#include "common/tracing/tail_sampling_impl.h"
+
+#include "common/common/assert.h"
+#include "common/tracing/http_tracer_impl.h"
+
+namespace Envoy {
+namespace Tracing {
+
+void SpanRecord::clear() {
+  operation_.clear();
+  tags_.clear();
+  logs_.clear();
+  baggage_.clear();
+  children_.clear();
+  finish_time_.reset();
+}
+
+void SpanRecord::replay(const Config& config, Span& span) const {
+  if (!operation_.empty()) {
+    span.setOperation(operation_);
+  }
+  for (const auto& tag : tags_) {
+    span.setTag(tag.first, tag.second);
+  }
+  for (const auto& log : logs_) {
+    span.log(log.first, log.second);
+  }
+  for (const auto& baggage : baggage_) {
+    span.setBaggage(baggage.first, baggage.second);
+  }
+  for (const SpanRecordSharedPtr& child : children_) {
+    // The child spans still in progress are left out, their record is not complete.
+    if (child->finish_time_.has_value()) {
+      SpanPtr child_span = span.spawnChild(config, child->operation_, child->start_time_);
+      child->replay(config, *child_span);
+      child_span->finishSpanAt(child->finish_time_.value());
+    }
+  }
+}
+
+SpanRecordPtr SpanRecordBuffer::acquire() {
+  if (active_records_ == max_records_) {
+    return nullptr;
+  }
+  ++active_records_;
+  if (free_records_.empty()) {
+    return std::make_unique<SpanRecord>();
+  }
+  SpanRecordPtr record = std::move(free_records_.back());
+  free_records_.pop_back();
+  return record;
+}
+
+void SpanRecordBuffer::release(SpanRecordPtr&& record) {
+  ASSERT(active_records_ > 0);
+  --active_records_;
+  record->clear();
+  free_records_.push_back(std::move(record));
+}
+
+void RecordingSpan::setOperation(absl::string_view operation) {
+  record_.operation_.assign(operation.data(), operation.size());
+}
+
+void RecordingSpan::setTag(absl::string_view name, absl::string_view value) {
+  auto& tag = record_.tags_.add();
+  tag.first.assign(name.data(), name.size());
+  tag.second.assign(value.data(), value.size());
+}
+
+void RecordingSpan::log(SystemTime timestamp, const std::string& event) {
+  auto& log = record_.logs_.add();
+  log.first = timestamp;
+  log.second.assign(event);
+}
+
+void RecordingSpan::setBaggage(absl::string_view key, absl::string_view value) {
+  auto& baggage = record_.baggage_.add();
+  baggage.first.assign(key.data(), key.size());
+  baggage.second.assign(value.data(), value.size());
+}
+
+std::string RecordingSpan::getBaggage(absl::string_view key) {
+  // The last value set wins.
+  for (size_t i = record_.baggage_.size(); i > 0; --i) {
+    if (record_.baggage_[i - 1].first == key) {
+      return record_.baggage_[i - 1].second;
+    }
+  }
+  return std::string();
+}
+
+SpanPtr RecordingSpan::spawnChild(const Config&, const std::string& name, SystemTime start_time) {
+  SpanRecordSharedPtr& child = record_.children_.add();
+  // The span of an earlier child may outlive its parent, in which case it keeps its record.
+  if (child == nullptr || child.use_count() > 1) {
+    child = std::make_shared<SpanRecord>();
+  } else {
+    child->clear();
+  }
+  child->operation_.assign(name);
+  child->start_time_ = start_time;
+  return std::make_unique<RecordingChildSpan>(child, time_source_);
+}
+
+TailSampledSpan::TailSampledSpan(TailSamplingHttpTracer& parent, SpanRecordBuffer& buffer,
+                                 SpanRecordPtr&& record, const Config& config,
+                                 Http::RequestHeaderMap& request_headers,
+                                 const StreamInfo::StreamInfo& stream_info)
+    : RecordingSpan(*record, parent.timeSource()), parent_(parent), buffer_(buffer),
+      record_(std::move(record)), config_(config), request_headers_(request_headers),
+      stream_info_(stream_info) {}
+
+TailSampledSpan::~TailSampledSpan() {
+  if (record_ != nullptr) {
+    buffer_.release(std::move(record_));
+  }
+}
+
+void TailSampledSpan::finishSpanAt(SystemTime finish_time) {
+  ASSERT(record_ != nullptr);
+  if (sampled_.value_or(parent_.shouldSample(*record_, stream_info_))) {
+    parent_.stats().sampled_.inc();
+    SpanPtr span = parent_.tracer().startSpan(config_, request_headers_, stream_info_,
+                                              {Reason::Sampling, true});
+    if (span != nullptr) {
+      record_->replay(config_, *span);
+      // The span is reported after the fact, its duration can't be taken from the time it was
+      // started.
+      span->finishSpanAt(finish_time);
+    }
+  } else {
+    parent_.stats().not_sampled_.inc();
+  }
+  buffer_.release(std::move(record_));
+}
+
+TailSamplingHttpTracer::TailSamplingHttpTracer(HttpTracerSharedPtr tracer,
+                                               const TailSamplingConfig& config,
+                                               ThreadLocal::SlotAllocator& tls,
+                                               TimeSource& time_source,
+                                               const TailSamplingStats& stats)
+    : tracer_(std::move(tracer)), config_(config), time_source_(time_source), stats_(stats),
+      tls_slot_(tls.allocateSlot()) {
+  const uint32_t max_buffered_spans = config_.max_buffered_spans_;
+  tls_slot_->set([max_buffered_spans](Event::Dispatcher&) {
+    return std::make_shared<SpanRecordBuffer>(max_buffered_spans);
+  });
+}
+
+TailSamplingStats TailSamplingHttpTracer::generateStats(const std::string& prefix,
+                                                        Stats::Scope& scope) {
+  return {ALL_TAIL_SAMPLING_STATS(POOL_COUNTER_PREFIX(scope, prefix + "tail_sampling."))};
+}
+
+SpanPtr TailSamplingHttpTracer::startSpan(const Config& config,
+                                          Http::RequestHeaderMap& request_headers,
+                                          const StreamInfo::StreamInfo& stream_info,
+                                          const Tracing::Decision tracing_decision) {
+  if (tracing_decision.traced || tracing_decision.reason == Reason::HealthCheck) {
+    return tracer_->startSpan(config, request_headers, stream_info, tracing_decision);
+  }
+
+  SpanRecordBuffer& buffer = tls_slot_->getTyped<SpanRecordBuffer>();
+  SpanRecordPtr record = buffer.acquire();
+  if (record == nullptr) {
+    stats_.overflow_.inc();
+    return tracer_->startSpan(config, request_headers, stream_info, tracing_decision);
+  }
+  stats_.recorded_.inc();
+  return std::make_unique<TailSampledSpan>(*this, buffer, std::move(record), config,
+                                           request_headers, stream_info);
+}
+
+bool TailSamplingHttpTracer::shouldSample(const SpanRecord& record,
+                                          const StreamInfo::StreamInfo& stream_info) const {
+  if (config_.min_duration_.has_value() &&
+      time_source_.monotonicTime() - stream_info.startTimeMonotonic() >=
+          config_.min_duration_.value()) {
+    return true;
+  }
+  if (config_.sample_errors_) {
+    for (const auto& tag : record.tags_) {
+      if (tag.first == Tags::get().Error && tag.second == Tags::get().True) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace Tracing
+} // namespace Envoy
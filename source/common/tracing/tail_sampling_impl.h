@@ -0,0 +1,240 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/stream_info/stream_info.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/tracing/http_tracer.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Tracing {
+
+/**
+ * All tail sampling stats. @see stats_macros.h
+ */
+#define ALL_TAIL_SAMPLING_STATS(COUNTER)                                                           \
+  COUNTER(not_sampled)                                                                             \
+  COUNTER(overflow)                                                                                \
+  COUNTER(recorded)                                                                                \
+  COUNTER(sampled)
+
+/**
+ * Struct definition for all tail sampling stats. @see stats_macros.h
+ */
+struct TailSamplingStats {
+  ALL_TAIL_SAMPLING_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration of tail sampling, which is set on the connection manager level.
+ */
+struct TailSamplingConfig {
+  uint32_t max_buffered_spans_;
+  absl::optional<std::chrono::milliseconds> min_duration_;
+  bool sample_errors_;
+};
+
+/**
+ * A list whose entries stay allocated when it is cleared, so that the entries added afterwards
+ * reuse them along with the memory they hold, e.g. the capacity of their strings.
+ */
+template <class T> class ReusableList {
+public:
+  /**
+   * @return the entry added at the end of the list, which still holds the value it had when it
+   *         was last used, if any.
+   */
+  T& add() {
+    if (size_ == entries_.size()) {
+      entries_.emplace_back();
+    }
+    return entries_[size_++];
+  }
+
+  void clear() { size_ = 0; }
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  T& operator[](size_t index) { return entries_[index]; }
+  const T& operator[](size_t index) const { return entries_[index]; }
+  T* begin() { return entries_.data(); }
+  T* end() { return entries_.data() + size_; }
+  const T* begin() const { return entries_.data(); }
+  const T* end() const { return entries_.data() + size_; }
+
+private:
+  std::vector<T> entries_;
+  size_t size_{};
+};
+
+struct SpanRecord;
+using SpanRecordSharedPtr = std::shared_ptr<SpanRecord>;
+
+/**
+ * The operations recorded on a span, which are replayed on a span of the wrapped tracer if the
+ * request is sampled once it completes.
+ */
+struct SpanRecord {
+  /**
+   * Empties the record, keeping its entries and child records for reuse.
+   */
+  void clear();
+
+  /**
+   * Replays the recorded operations, and the finished child spans, on the given span.
+   */
+  void replay(const Config& config, Span& span) const;
+
+  std::string operation_;
+  ReusableList<std::pair<std::string, std::string>> tags_;
+  ReusableList<std::pair<SystemTime, std::string>> logs_;
+  ReusableList<std::pair<std::string, std::string>> baggage_;
+  // A child record is only reused once the span it was recorded from is gone.
+  ReusableList<SpanRecordSharedPtr> children_;
+  // Only set on the records of child spans.
+  SystemTime start_time_;
+  // Set once the span finishes.
+  absl::optional<SystemTime> finish_time_;
+};
+
+using SpanRecordPtr = std::unique_ptr<SpanRecord>;
+
+/**
+ * The per-worker buffer of the records of the requests in progress. The records, along with their
+ * entries and child records, are reused once their request completes. Past the span objects
+ * themselves, recording a request only allocates when it records more, or longer, entries than
+ * the earlier requests did.
+ */
+class SpanRecordBuffer : public ThreadLocal::ThreadLocalObject {
+public:
+  SpanRecordBuffer(uint32_t max_records) : max_records_(max_records) {}
+
+  /**
+   * @return an empty record, or nullptr if the largest number of records are in use.
+   */
+  SpanRecordPtr acquire();
+
+  /**
+   * Returns a record acquired from this buffer.
+   */
+  void release(SpanRecordPtr&& record);
+
+private:
+  const uint32_t max_records_;
+  uint32_t active_records_{};
+  std::vector<SpanRecordPtr> free_records_;
+};
+
+/**
+ * A span which only records the operations made on it.
+ */
+class RecordingSpan : public Span {
+public:
+  RecordingSpan(SpanRecord& record, TimeSource& time_source)
+      : record_(record), time_source_(time_source) {}
+
+  // Tracing::Span
+  void finishSpan() override { finishSpanAt(time_source_.systemTime()); }
+  void finishSpanAt(SystemTime finish_time) override { record_.finish_time_ = finish_time; }
+  void setOperation(absl::string_view operation) override;
+  void setTag(absl::string_view name, absl::string_view value) override;
+  void log(SystemTime timestamp, const std::string& event) override;
+  void injectContext(Http::RequestHeaderMap&) override {}
+  void setBaggage(absl::string_view key, absl::string_view value) override;
+  std::string getBaggage(absl::string_view key) override;
+  SpanPtr spawnChild(const Config& config, const std::string& name,
+                     SystemTime start_time) override;
+  void setSampled(bool) override {}
+
+private:
+  SpanRecord& record_;
+  TimeSource& time_source_;
+};
+
+/**
+ * A child span, which keeps its record alive as long as either the span or its parent record
+ * needs it.
+ */
+class RecordingChildSpan : public RecordingSpan {
+public:
+  RecordingChildSpan(SpanRecordSharedPtr record, TimeSource& time_source)
+      : RecordingSpan(*record, time_source), child_record_(std::move(record)) {}
+
+private:
+  const SpanRecordSharedPtr child_record_;
+};
+
+class TailSamplingHttpTracer;
+
+/**
+ * The span of a request whose sampling decision is made once the request completes.
+ */
+class TailSampledSpan : public RecordingSpan {
+public:
+  TailSampledSpan(TailSamplingHttpTracer& parent, SpanRecordBuffer& buffer, SpanRecordPtr&& record,
+                  const Config& config, Http::RequestHeaderMap& request_headers,
+                  const StreamInfo::StreamInfo& stream_info);
+  ~TailSampledSpan() override;
+
+  // Tracing::Span
+  void finishSpanAt(SystemTime finish_time) override;
+  void setSampled(bool sampled) override { sampled_ = sampled; }
+
+private:
+  TailSamplingHttpTracer& parent_;
+  SpanRecordBuffer& buffer_;
+  SpanRecordPtr record_;
+  // The request lives at least as long as its span.
+  const Config& config_;
+  Http::RequestHeaderMap& request_headers_;
+  const StreamInfo::StreamInfo& stream_info_;
+  // Overrides the sampling rules once set.
+  absl::optional<bool> sampled_;
+};
+
+/**
+ * A tracer which traces the requests sampled when they start with the wrapped tracer, and records
+ * the spans of the other requests so that they can be traced once they complete if they match the
+ * tail sampling rules.
+ */
+class TailSamplingHttpTracer : public HttpTracer {
+public:
+  TailSamplingHttpTracer(HttpTracerSharedPtr tracer, const TailSamplingConfig& config,
+                         ThreadLocal::SlotAllocator& tls, TimeSource& time_source,
+                         const TailSamplingStats& stats);
+
+  static TailSamplingStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  // Tracing::HttpTracer
+  SpanPtr startSpan(const Config& config, Http::RequestHeaderMap& request_headers,
+                    const StreamInfo::StreamInfo& stream_info,
+                    const Tracing::Decision tracing_decision) override;
+
+  /**
+   * @return whether the completed request with the given span record matches the tail sampling
+   * rules.
+   */
+  bool shouldSample(const SpanRecord& record, const StreamInfo::StreamInfo& stream_info) const;
+
+  HttpTracer& tracer() { return *tracer_; }
+  TailSamplingStats& stats() { return stats_; }
+  TimeSource& timeSource() { return time_source_; }
+
+private:
+  const HttpTracerSharedPtr tracer_;
+  const TailSamplingConfig config_;
+  TimeSource& time_source_;
+  TailSamplingStats stats_;
+  ThreadLocal::SlotPtr tls_slot_;
+};
+
+} // namespace Tracing
+} // namespace Envoy
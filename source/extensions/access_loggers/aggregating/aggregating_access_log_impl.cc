@@ -0,0 +1,252 @@
+#include "extensions/access_loggers/aggregating/aggregating_access_log_impl.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/formatter/substitution_formatter.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Aggregating {
+namespace {
+
+// The length which encodes a null dimension value in a key.
+constexpr uint32_t NullLength = 0xffffffff;
+
+std::vector<uint64_t> durationBucketBounds(
+    const envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog& config) {
+  if (config.duration_buckets_ms().empty()) {
+    return {1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+  }
+  std::vector<uint64_t> bounds(config.duration_buckets_ms().begin(),
+                               config.duration_buckets_ms().end());
+  if (std::adjacent_find(bounds.begin(), bounds.end(), std::greater_equal<uint64_t>()) !=
+      bounds.end()) {
+    throw EnvoyException("aggregating access log duration_buckets_ms must be strictly increasing");
+  }
+  return bounds;
+}
+
+void writeLength(uint32_t length, char* out) {
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    out[i] = static_cast<char>((length >> (8 * (sizeof(uint32_t) - 1 - i))) & 0xff);
+  }
+}
+
+void appendLength(uint32_t length, std::string& key) {
+  const size_t start = key.size();
+  key.resize(start + sizeof(uint32_t));
+  writeLength(length, &key[start]);
+}
+
+uint32_t readLength(absl::string_view key) {
+  ASSERT(key.size() >= sizeof(uint32_t));
+  uint32_t length = 0;
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    length = (length << 8) | static_cast<uint8_t>(key[i]);
+  }
+  return length;
+}
+
+uint64_t toMilliseconds(SystemTime time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+void Aggregate::merge(const Aggregate& other) {
+  count_ += other.count_;
+  duration_ms_sum_ += other.duration_ms_sum_;
+  duration_buckets_.resize(std::max(duration_buckets_.size(), other.duration_buckets_.size()));
+  for (size_t i = 0; i < other.duration_buckets_.size(); ++i) {
+    duration_buckets_[i] += other.duration_buckets_[i];
+  }
+}
+
+AggregatingLogSink::AggregatingLogSink(
+    const envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog& config,
+    AccessLog::AccessLogManager& log_manager, TimeSource& time_source, Stats::Scope& scope)
+    : duration_bucket_bounds_(durationBucketBounds(config)),
+      interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, interval, 10000)),
+      max_groups_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_groups, 10000)),
+      time_source_(time_source),
+      stats_{ALL_AGGREGATING_ACCESS_LOG_STATS(
+          POOL_COUNTER_PREFIX(scope, "access_logs.aggregating_access_log."))},
+      log_file_(log_manager.createAccessLog(config.path())),
+      interval_start_(time_source.systemTime()),
+      interval_start_monotonic_(time_source.monotonicTime()) {
+  for (const auto& dimension : config.dimensions()) {
+    dimension_names_.push_back(dimension.name());
+    dimensions_.push_back(Formatter::SubstitutionFormatParser::parse(dimension.format()));
+    appendLength(NullLength, overflow_key_);
+  }
+}
+
+AggregatingLogSink::~AggregatingLogSink() {
+  absl::MutexLock lock(&lock_);
+  writeRows();
+}
+
+void AggregatingLogSink::key(const Http::RequestHeaderMap& request_headers,
+                             const Http::ResponseHeaderMap& response_headers,
+                             const Http::ResponseTrailerMap& response_trailers,
+                             const StreamInfo::StreamInfo& stream_info, std::string& key) const {
+  for (const auto& dimension : dimensions_) {
+    const size_t start = key.size();
+    // Reserve the room of the length, which is only known once the value is formatted.
+    appendLength(0, key);
+    bool null = false;
+    for (const Formatter::FormatterProviderPtr& provider : dimension) {
+      if (!provider->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                              absl::string_view(), key)) {
+        null = true;
+        break;
+      }
+    }
+    if (null) {
+      key.resize(start);
+      appendLength(NullLength, key);
+      continue;
+    }
+    const size_t length = key.size() - start - sizeof(uint32_t);
+    ASSERT(length < NullLength);
+    writeLength(length, &key[start]);
+  }
+}
+
+size_t AggregatingLogSink::durationBucket(uint64_t duration_ms) const {
+  return std::lower_bound(duration_bucket_bounds_.begin(), duration_bucket_bounds_.end(),
+                          duration_ms) -
+         duration_bucket_bounds_.begin();
+}
+
+void AggregatingLogSink::merge(AggregateMap& aggregates) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  absl::MutexLock lock(&lock_);
+  for (auto& entry : aggregates) {
+    auto it = aggregates_.find(entry.first);
+    if (it == aggregates_.end()) {
+      if (aggregates_.size() < max_groups_ || entry.first == overflow_key_) {
+        aggregates_.emplace(entry.first, std::move(entry.second));
+        continue;
+      }
+      stats_.entries_overflowed_.add(entry.second.count_);
+      it = aggregates_.try_emplace(overflow_key_).first;
+    }
+    it->second.merge(entry.second);
+  }
+  aggregates.clear();
+
+  if (now - interval_start_monotonic_ >= interval_) {
+    writeRows();
+    interval_start_monotonic_ = now;
+  }
+}
+
+void AggregatingLogSink::writeRows() {
+  const SystemTime end = time_source_.systemTime();
+  for (const auto& entry : aggregates_) {
+    ProtobufWkt::Struct dimensions;
+    absl::string_view key = entry.first;
+    for (const std::string& name : dimension_names_) {
+      const uint32_t length = readLength(key);
+      key.remove_prefix(sizeof(uint32_t));
+      if (length == NullLength) {
+        (*dimensions.mutable_fields())[name] = ValueUtil::nullValue();
+        continue;
+      }
+      (*dimensions.mutable_fields())[name] =
+          ValueUtil::stringValue(std::string(key.substr(0, length)));
+      key.remove_prefix(length);
+    }
+
+    const Aggregate& aggregate = entry.second;
+    std::vector<ProtobufWkt::Value> buckets;
+    buckets.reserve(durationBucketCount());
+    for (size_t i = 0; i < durationBucketCount(); ++i) {
+      buckets.push_back(ValueUtil::numberValue(
+          i < aggregate.duration_buckets_.size() ? aggregate.duration_buckets_[i] : 0));
+    }
+
+    ProtobufWkt::Struct row;
+    auto& fields = *row.mutable_fields();
+    fields["start_time_ms"] = ValueUtil::numberValue(toMilliseconds(interval_start_));
+    fields["end_time_ms"] = ValueUtil::numberValue(toMilliseconds(end));
+    fields["dimensions"] = ValueUtil::structValue(dimensions);
+    fields["count"] = ValueUtil::numberValue(aggregate.count_);
+    fields["duration_ms_sum"] = ValueUtil::numberValue(aggregate.duration_ms_sum_);
+    fields["duration_ms_buckets"] = ValueUtil::listValue(buckets);
+    log_file_->write(absl::StrCat(MessageUtil::getJsonStringFromMessage(row), "\n"));
+    stats_.rows_written_.inc();
+  }
+  aggregates_.clear();
+  interval_start_ = end;
+}
+
+AggregatingAccessLog::ThreadLocalAggregates::ThreadLocalAggregates(
+    AggregatingLogSinkSharedPtr sink, Event::Dispatcher& dispatcher)
+    : sink_(std::move(sink)), flush_timer_(dispatcher.createTimer([this]() { flush(); })) {
+  // The timer runs even without entries, so that the sink writes its rows when traffic stops.
+  flush_timer_->enableTimer(sink_->interval());
+}
+
+AggregatingAccessLog::ThreadLocalAggregates::~ThreadLocalAggregates() {
+  sink_->merge(aggregates_);
+}
+
+void AggregatingAccessLog::ThreadLocalAggregates::flush() {
+  sink_->merge(aggregates_);
+  flush_timer_->enableTimer(sink_->interval());
+}
+
+AggregatingAccessLog::AggregatingAccessLog(AccessLog::FilterPtr&& filter,
+                                           AggregatingLogSinkSharedPtr sink,
+                                           ThreadLocal::SlotAllocator& tls)
+    : Common::ImplBase(std::move(filter)), sink_(std::move(sink)), tls_slot_(tls.allocateSlot()) {
+  tls_slot_->set([sink = sink_](Event::Dispatcher& dispatcher) {
+    return std::make_shared<ThreadLocalAggregates>(sink, dispatcher);
+  });
+}
+
+void AggregatingAccessLog::emitLog(const Http::RequestHeaderMap& request_headers,
+                                   const Http::ResponseHeaderMap& response_headers,
+                                   const Http::ResponseTrailerMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info) {
+  ThreadLocalAggregates& local = tls_slot_->getTyped<ThreadLocalAggregates>();
+  local.key_.clear();
+  sink_->key(request_headers, response_headers, response_trailers, stream_info, local.key_);
+
+  auto it = local.aggregates_.find(local.key_);
+  if (it == local.aggregates_.end()) {
+    if (local.aggregates_.size() < sink_->maxGroups()) {
+      it = local.aggregates_.try_emplace(local.key_).first;
+    } else {
+      sink_->stats().entries_overflowed_.inc();
+      it = local.aggregates_.try_emplace(sink_->overflowKey()).first;
+    }
+    it->second.duration_buckets_.resize(sink_->durationBucketCount());
+  }
+
+  Aggregate& aggregate = it->second;
+  ++aggregate.count_;
+  const absl::optional<std::chrono::nanoseconds> duration = stream_info.requestComplete();
+  if (duration.has_value()) {
+    const uint64_t duration_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(duration.value()).count();
+    aggregate.duration_ms_sum_ += duration_ms;
+    ++aggregate.duration_buckets_[sink_->durationBucket(duration_ms)];
+  }
+  sink_->stats().entries_aggregated_.inc();
+}
+
+} // namespace Aggregating
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
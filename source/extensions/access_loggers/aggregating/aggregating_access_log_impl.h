@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/access_log/access_log.h"
+#include "envoy/common/time.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/access_loggers/aggregating/v3/aggregating.pb.h"
+#include "envoy/formatter/substitution_formatter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "extensions/access_loggers/common/access_log_base.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Aggregating {
+
+/**
+ * All stats for the aggregating access logger. @see stats_macros.h
+ */
+#define ALL_AGGREGATING_ACCESS_LOG_STATS(COUNTER)                                                  \
+  COUNTER(entries_aggregated)                                                                      \
+  COUNTER(entries_overflowed)                                                                      \
+  COUNTER(rows_written)
+
+/**
+ * Wrapper struct for the aggregating access logger stats. @see stats_macros.h
+ */
+struct AggregatingAccessLogStats {
+  ALL_AGGREGATING_ACCESS_LOG_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * The totals of the entries of a group.
+ */
+struct Aggregate {
+  void merge(const Aggregate& other);
+
+  uint64_t count_{};
+  uint64_t duration_ms_sum_{};
+  std::vector<uint64_t> duration_buckets_;
+};
+
+/**
+ * Aggregates keyed by the encoded dimension values of their group. @see AggregatingLogSink::key.
+ */
+using AggregateMap = absl::flat_hash_map<std::string, Aggregate>;
+
+/**
+ * Merges the aggregates of all workers for the current interval, and writes a row per group as a
+ * line of JSON to the log file once the interval is over.
+ */
+class AggregatingLogSink {
+public:
+  AggregatingLogSink(
+      const envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog& config,
+      AccessLog::AccessLogManager& log_manager, TimeSource& time_source, Stats::Scope& scope);
+  ~AggregatingLogSink();
+
+  /**
+   * Appends the encoded dimension values of an entry to a key. Each value is encoded as its 32 bit
+   * big endian length followed by the value, or as 0xffffffff if it is null.
+   */
+  void key(const Http::RequestHeaderMap& request_headers,
+           const Http::ResponseHeaderMap& response_headers,
+           const Http::ResponseTrailerMap& response_trailers,
+           const StreamInfo::StreamInfo& stream_info, std::string& key) const;
+
+  /**
+   * @return the key of the group with all dimensions null, which also holds the entries of the
+   *         groups past the maximum number of groups.
+   */
+  const std::string& overflowKey() const { return overflow_key_; }
+
+  /**
+   * @return the index of the histogram bucket of a request duration.
+   */
+  size_t durationBucket(uint64_t duration_ms) const;
+  size_t durationBucketCount() const { return duration_bucket_bounds_.size() + 1; }
+
+  uint32_t maxGroups() const { return max_groups_; }
+  std::chrono::milliseconds interval() const { return interval_; }
+  AggregatingAccessLogStats& stats() { return stats_; }
+
+  /**
+   * Merges the aggregates of a worker into those of the interval and empties them. Writes the rows
+   * of the interval if it is over.
+   */
+  void merge(AggregateMap& aggregates);
+
+private:
+  void writeRows() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  std::vector<std::vector<Formatter::FormatterProviderPtr>> dimensions_;
+  std::vector<std::string> dimension_names_;
+  std::string overflow_key_;
+  const std::vector<uint64_t> duration_bucket_bounds_;
+  const std::chrono::milliseconds interval_;
+  const uint32_t max_groups_;
+  TimeSource& time_source_;
+  AggregatingAccessLogStats stats_;
+  const AccessLog::AccessLogFileSharedPtr log_file_;
+  absl::Mutex lock_;
+  AggregateMap aggregates_ ABSL_GUARDED_BY(lock_);
+  SystemTime interval_start_ ABSL_GUARDED_BY(lock_);
+  MonotonicTime interval_start_monotonic_ ABSL_GUARDED_BY(lock_);
+};
+
+using AggregatingLogSinkSharedPtr = std::shared_ptr<AggregatingLogSink>;
+
+/**
+ * Access log Instance that aggregates the entries per worker and group of dimension values, and
+ * writes the totals of each group at every interval instead of the entries.
+ */
+class AggregatingAccessLog : public Common::ImplBase {
+public:
+  AggregatingAccessLog(AccessLog::FilterPtr&& filter, AggregatingLogSinkSharedPtr sink,
+                       ThreadLocal::SlotAllocator& tls);
+
+private:
+  /**
+   * Per-thread aggregates, handed over to the sink at every interval and when the logger is
+   * destroyed.
+   */
+  struct ThreadLocalAggregates : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalAggregates(AggregatingLogSinkSharedPtr sink, Event::Dispatcher& dispatcher);
+    ~ThreadLocalAggregates() override;
+
+    void flush();
+
+    const AggregatingLogSinkSharedPtr sink_;
+    AggregateMap aggregates_;
+    // Reused to build the key of each entry without allocating.
+    std::string key_;
+    const Event::TimerPtr flush_timer_;
+  };
+
+  // Common::ImplBase
+  void emitLog(const Http::RequestHeaderMap& request_headers,
+               const Http::ResponseHeaderMap& response_headers,
+               const Http::ResponseTrailerMap& response_trailers,
+               const StreamInfo::StreamInfo& stream_info) override;
+
+  const AggregatingLogSinkSharedPtr sink_;
+  const ThreadLocal::SlotPtr tls_slot_;
+};
+
+} // namespace Aggregating
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
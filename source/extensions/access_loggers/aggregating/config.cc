@@ -0,0 +1,48 @@
+#include "extensions/access_loggers/aggregating/config.h"
+
+#include <memory>
+
+#include "envoy/extensions/access_loggers/aggregating/v3/aggregating.pb.h"
+#include "envoy/extensions/access_loggers/aggregating/v3/aggregating.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/access_loggers/aggregating/aggregating_access_log_impl.h"
+#include "extensions/access_loggers/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Aggregating {
+
+AccessLog::InstanceSharedPtr AggregatingAccessLogFactory::createAccessLogInstance(
+    const Protobuf::Message& config, AccessLog::FilterPtr&& filter,
+    Server::Configuration::FactoryContext& context) {
+  const auto& proto_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog&>(
+      config, context.messageValidationVisitor());
+
+  auto sink = std::make_shared<AggregatingLogSink>(proto_config, context.accessLogManager(),
+                                                   context.timeSource(), context.scope());
+  return std::make_shared<AggregatingAccessLog>(std::move(filter), std::move(sink),
+                                                context.threadLocal());
+}
+
+ProtobufTypes::MessagePtr AggregatingAccessLogFactory::createEmptyConfigProto() {
+  return std::make_unique<
+      envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog>();
+}
+
+std::string AggregatingAccessLogFactory::name() const { return AccessLogNames::get().Aggregating; }
+
+/**
+ * Static registration for the aggregating access log. @see RegisterFactory.
+ */
+REGISTER_FACTORY(AggregatingAccessLogFactory, Server::Configuration::AccessLogInstanceFactory);
+
+} // namespace Aggregating
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
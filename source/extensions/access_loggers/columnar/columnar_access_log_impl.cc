@@ -0,0 +1,184 @@
+#include "extensions/access_loggers/columnar/columnar_access_log_impl.h"
+
+#include <cstdio>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+#include "common/common/utility.h"
+#include "common/formatter/substitution_formatter.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+ColumnarLogFile::ColumnarLogFile(const std::string& path,
+                                 AccessLog::AccessLogManager& log_manager,
+                                 Filesystem::Instance& file_system, TimeSource& time_source)
+    : path_(path), file_system_(file_system), time_source_(time_source),
+      log_file_(log_manager.createAccessLog(path_)),
+      file_opened_(time_source.monotonicTime().time_since_epoch().count()) {
+  // The file may hold the blocks of an earlier run, which count towards its rotation.
+  const ssize_t file_size = file_system_.fileSize(path_);
+  file_bytes_ = file_size > 0 ? file_size : 0;
+}
+
+void ColumnarLogFile::write(absl::string_view block) {
+  log_file_->write(block);
+  file_bytes_ += block.size();
+}
+
+bool ColumnarLogFile::claimRotation(uint64_t max_file_bytes,
+                                    std::chrono::milliseconds rotation_interval) {
+  const bool too_large = max_file_bytes != 0 && file_bytes_ >= max_file_bytes;
+  const bool too_old =
+      rotation_interval.count() != 0 &&
+      std::chrono::nanoseconds(time_source_.monotonicTime().time_since_epoch().count() -
+                               file_opened_) >= rotation_interval;
+  return (too_large || too_old) && !rotation_pending_.exchange(true);
+}
+
+bool ColumnarLogFile::rotate() {
+  // Whether or not the rename works, wait for another full file before trying again.
+  file_bytes_ = 0;
+  file_opened_ = time_source_.monotonicTime().time_since_epoch().count();
+  rotation_pending_ = false;
+
+  const std::string prefix = absl::StrCat(
+      path_, ".",
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          time_source_.systemTime().time_since_epoch())
+          .count());
+  // Never overwrite a file rotated within the same millisecond.
+  std::string rotated_path = prefix;
+  for (uint32_t i = 1; file_system_.fileExists(rotated_path); ++i) {
+    rotated_path = absl::StrCat(prefix, ".", i);
+  }
+  if (std::rename(path_.c_str(), rotated_path.c_str()) != 0) {
+    ENVOY_LOG_MISC(warn, "unable to rotate columnar access log {} to {}: {}", path_, rotated_path,
+                   errorDetails(errno));
+    return false;
+  }
+  // The log file still has the renamed file open, so the blocks written until it is reopened,
+  // including those it still buffers, go to the renamed file.
+  log_file_->flush();
+  log_file_->reopen();
+  return true;
+}
+
+ColumnarLogFileSharedPtr ColumnarLogFileCache::get(const std::string& path) {
+  auto it = files_.find(path);
+  if (it != files_.end()) {
+    ColumnarLogFileSharedPtr file = it->second.lock();
+    if (file != nullptr) {
+      return file;
+    }
+  }
+  auto file = std::make_shared<ColumnarLogFile>(path, log_manager_, file_system_, time_source_);
+  files_[path] = file;
+  return file;
+}
+
+ColumnarLogSink::ColumnarLogSink(
+    const envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog& config,
+    Compression::Compressor::CompressorFactoryPtr compressor_factory,
+    ColumnarLogFileCacheSharedPtr file_cache, Event::Dispatcher& main_dispatcher,
+    Stats::Scope& scope)
+    : max_batch_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_entries, 1024)),
+      batch_flush_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, batch_flush_interval, 1000)),
+      max_file_bytes_(config.max_file_bytes()),
+      rotation_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, rotation_interval, 0)),
+      compressor_factory_(std::move(compressor_factory)), file_cache_(std::move(file_cache)),
+      log_file_(file_cache_->get(config.path())),
+      main_dispatcher_(main_dispatcher),
+      stats_{ALL_COLUMNAR_ACCESS_LOG_STATS(
+          POOL_COUNTER_PREFIX(scope, "access_logs.columnar_access_log."))} {
+  for (const auto& column : config.columns()) {
+    column_names_.push_back(column.name());
+    columns_.push_back(Formatter::SubstitutionFormatParser::parse(column.format()));
+  }
+}
+
+void ColumnarLogSink::write(BatchEncoder& batch) {
+  const uint32_t rows = batch.rows();
+  if (rows == 0) {
+    return;
+  }
+
+  Buffer::OwnedImpl block;
+  stats_.bytes_uncompressed_.add(batch.encode(compressor_factory_.get(), block));
+  const uint64_t block_length = block.length();
+  log_file_->write(
+      absl::string_view(static_cast<const char*>(block.linearize(block_length)), block_length));
+  stats_.logs_written_.add(rows);
+  stats_.batches_written_.inc();
+  stats_.bytes_written_.add(block_length);
+  // The limits of each log apply to the file, whichever log is writing.
+  if ((max_file_bytes_ != 0 || rotation_interval_.count() != 0) &&
+      log_file_->claimRotation(max_file_bytes_, rotation_interval_)) {
+    main_dispatcher_.post([sink = shared_from_this()]() { sink->rotate(); });
+  }
+}
+
+void ColumnarLogSink::rotate() {
+  if (log_file_->rotate()) {
+    stats_.rotated_.inc();
+  } else {
+    stats_.rotation_failed_.inc();
+  }
+}
+
+ColumnarAccessLog::ThreadLocalBatch::ThreadLocalBatch(ColumnarLogSinkSharedPtr sink,
+                                                      Event::Dispatcher& dispatcher)
+    : sink_(std::move(sink)), encoder_(sink_->columnNames()),
+      flush_timer_(dispatcher.createTimer([this]() { flush(); })) {}
+
+ColumnarAccessLog::ThreadLocalBatch::~ThreadLocalBatch() { sink_->write(encoder_); }
+
+void ColumnarAccessLog::ThreadLocalBatch::flush() {
+  flush_timer_->disableTimer();
+  sink_->write(encoder_);
+}
+
+ColumnarAccessLog::ColumnarAccessLog(AccessLog::FilterPtr&& filter, ColumnarLogSinkSharedPtr sink,
+                                     ThreadLocal::SlotAllocator& tls)
+    : Common::ImplBase(std::move(filter)), sink_(std::move(sink)), tls_slot_(tls.allocateSlot()) {
+  tls_slot_->set([sink = sink_](Event::Dispatcher& dispatcher) {
+    return std::make_shared<ThreadLocalBatch>(sink, dispatcher);
+  });
+}
+
+void ColumnarAccessLog::emitLog(const Http::RequestHeaderMap& request_headers,
+                                const Http::ResponseHeaderMap& response_headers,
+                                const Http::ResponseTrailerMap& response_trailers,
+                                const StreamInfo::StreamInfo& stream_info) {
+  ThreadLocalBatch& batch = tls_slot_->getTyped<ThreadLocalBatch>();
+  const auto& columns = sink_->columns();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    std::string& value = batch.encoder_.valueBuffer(i);
+    bool null = false;
+    for (const Formatter::FormatterProviderPtr& provider : columns[i]) {
+      if (!provider->formatTo(request_headers, response_headers, response_trailers, stream_info,
+                              absl::string_view(), value)) {
+        null = true;
+        break;
+      }
+    }
+    batch.encoder_.endValue(i, null);
+  }
+  batch.encoder_.endRow();
+
+  if (batch.encoder_.rows() >= sink_->maxBatchEntries()) {
+    batch.flush();
+  } else if (batch.encoder_.rows() == 1) {
+    batch.flush_timer_->enableTimer(sink_->batchFlushInterval());
+  }
+}
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
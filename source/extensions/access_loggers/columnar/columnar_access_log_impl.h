@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/access_log/access_log.h"
+#include "envoy/common/time.h"
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+#include "envoy/filesystem/filesystem.h"
+#include "envoy/formatter/substitution_formatter.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "extensions/access_loggers/columnar/columnar_format.h"
+#include "extensions/access_loggers/common/access_log_base.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+/**
+ * All stats for the columnar access logger. @see stats_macros.h
+ */
+#define ALL_COLUMNAR_ACCESS_LOG_STATS(COUNTER)                                                     \
+  COUNTER(batches_written)                                                                         \
+  COUNTER(bytes_uncompressed)                                                                      \
+  COUNTER(bytes_written)                                                                           \
+  COUNTER(logs_written)                                                                            \
+  COUNTER(rotated)                                                                                 \
+  COUNTER(rotation_failed)
+
+/**
+ * Wrapper struct for the columnar access logger stats. @see stats_macros.h
+ */
+struct ColumnarAccessLogStats {
+  ALL_COLUMNAR_ACCESS_LOG_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * The log file of a path along with the state of its rotation. It is shared by all the columnar
+ * access logs of the path, as is the underlying access log file, so that the file is rotated once
+ * however many logs write to it.
+ */
+class ColumnarLogFile {
+public:
+  ColumnarLogFile(const std::string& path, AccessLog::AccessLogManager& log_manager,
+                  Filesystem::Instance& file_system, TimeSource& time_source);
+
+  const std::string& path() const { return path_; }
+
+  /**
+   * Appends a block to the file.
+   */
+  void write(absl::string_view block);
+
+  /**
+   * Checks whether the file outgrew the given limits, a limit of zero being no limit. Only the
+   * first caller is told to rotate the file, until the rotation is done.
+   * @return whether the caller must rotate the file.
+   */
+  bool claimRotation(uint64_t max_file_bytes, std::chrono::milliseconds rotation_interval);
+
+  /**
+   * Renames the file, flushes the blocks written so far to it and reopens the log file. Only
+   * called from the main thread, once claimRotation() returned true.
+   * @return whether the file was renamed.
+   */
+  bool rotate();
+
+private:
+  const std::string path_;
+  Filesystem::Instance& file_system_;
+  TimeSource& time_source_;
+  const AccessLog::AccessLogFileSharedPtr log_file_;
+  std::atomic<uint64_t> file_bytes_;
+  // The monotonic time at which the file was opened, in nanoseconds.
+  std::atomic<int64_t> file_opened_;
+  // Set from the time a worker claims the rotation until the rotation is done.
+  std::atomic<bool> rotation_pending_{};
+};
+
+using ColumnarLogFileSharedPtr = std::shared_ptr<ColumnarLogFile>;
+
+/**
+ * The columnar log files in use, by path. Only used from the main thread.
+ */
+class ColumnarLogFileCache : public Singleton::Instance {
+public:
+  ColumnarLogFileCache(AccessLog::AccessLogManager& log_manager, Filesystem::Instance& file_system,
+                       TimeSource& time_source)
+      : log_manager_(log_manager), file_system_(file_system), time_source_(time_source) {}
+
+  /**
+   * @return the file of the path, which is created unless a log still uses it.
+   */
+  ColumnarLogFileSharedPtr get(const std::string& path);
+
+private:
+  AccessLog::AccessLogManager& log_manager_;
+  Filesystem::Instance& file_system_;
+  TimeSource& time_source_;
+  absl::flat_hash_map<std::string, std::weak_ptr<ColumnarLogFile>> files_;
+};
+
+using ColumnarLogFileCacheSharedPtr = std::shared_ptr<ColumnarLogFileCache>;
+
+/**
+ * Encodes the batches of all workers and appends them to the log file, rotating the file when it
+ * grows too large or too old. The workers only notice that the file is due for rotation, the main
+ * thread renames the file, flushes the blocks written so far to it and reopens the log file, so
+ * that the workers never wait on the file system. Blocks are never split between files.
+ */
+class ColumnarLogSink : public std::enable_shared_from_this<ColumnarLogSink> {
+public:
+  ColumnarLogSink(const envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog& config,
+                  Compression::Compressor::CompressorFactoryPtr compressor_factory,
+                  ColumnarLogFileCacheSharedPtr file_cache, Event::Dispatcher& main_dispatcher,
+                  Stats::Scope& scope);
+
+  /**
+   * @return the formatters of each column, whose values are concatenated.
+   */
+  const std::vector<std::vector<Formatter::FormatterProviderPtr>>& columns() const {
+    return columns_;
+  }
+  const std::vector<std::string>& columnNames() const { return column_names_; }
+  uint32_t maxBatchEntries() const { return max_batch_entries_; }
+  std::chrono::milliseconds batchFlushInterval() const { return batch_flush_interval_; }
+
+  /**
+   * Encodes the batch as a block, empties it and appends the block to the log file.
+   */
+  void write(BatchEncoder& batch);
+
+private:
+  void rotate();
+
+  std::vector<std::vector<Formatter::FormatterProviderPtr>> columns_;
+  std::vector<std::string> column_names_;
+  const uint32_t max_batch_entries_;
+  const std::chrono::milliseconds batch_flush_interval_;
+  const uint64_t max_file_bytes_;
+  const std::chrono::milliseconds rotation_interval_;
+  const Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+  // The singleton manager only keeps the cache while a sink holds on to it.
+  const ColumnarLogFileCacheSharedPtr file_cache_;
+  const ColumnarLogFileSharedPtr log_file_;
+  Event::Dispatcher& main_dispatcher_;
+  ColumnarAccessLogStats stats_;
+};
+
+using ColumnarLogSinkSharedPtr = std::shared_ptr<ColumnarLogSink>;
+
+/**
+ * Access log Instance that batches logs per worker and writes each batch as a column oriented,
+ * optionally compressed block.
+ */
+class ColumnarAccessLog : public Common::ImplBase {
+public:
+  ColumnarAccessLog(AccessLog::FilterPtr&& filter, ColumnarLogSinkSharedPtr sink,
+                    ThreadLocal::SlotAllocator& tls);
+
+private:
+  /**
+   * Per-thread batch, written when it is full, when its flush interval expires, and when the
+   * logger is destroyed.
+   */
+  struct ThreadLocalBatch : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalBatch(ColumnarLogSinkSharedPtr sink, Event::Dispatcher& dispatcher);
+    ~ThreadLocalBatch() override;
+
+    void flush();
+
+    const ColumnarLogSinkSharedPtr sink_;
+    BatchEncoder encoder_;
+    const Event::TimerPtr flush_timer_;
+  };
+
+  // Common::ImplBase
+  void emitLog(const Http::RequestHeaderMap& request_headers,
+               const Http::ResponseHeaderMap& response_headers,
+               const Http::ResponseTrailerMap& response_trailers,
+               const StreamInfo::StreamInfo& stream_info) override;
+
+  const ColumnarLogSinkSharedPtr sink_;
+  const ThreadLocal::SlotPtr tls_slot_;
+};
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,195 @@
+#include "extensions/access_loggers/columnar/columnar_format.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+namespace {
+
+// The header up to and including the encoding length, and the header after the encoding.
+constexpr uint64_t HeaderPrefixLength = 6;
+constexpr uint64_t HeaderSuffixLength = 16;
+
+void throwMalformed(absl::string_view reason) {
+  throw EnvoyException(fmt::format("malformed columnar access log block: {}", reason));
+}
+
+uint32_t drainLength(Buffer::Instance& payload) {
+  if (payload.length() < sizeof(uint32_t)) {
+    throwMalformed("truncated payload");
+  }
+  return payload.drainBEInt<uint32_t>();
+}
+
+std::string drainBytes(Buffer::Instance& payload, uint64_t length) {
+  if (payload.length() < length) {
+    throwMalformed("truncated payload");
+  }
+  std::string bytes(length, '\0');
+  payload.copyOut(0, length, bytes.data());
+  payload.drain(length);
+  return bytes;
+}
+
+} // namespace
+
+BatchEncoder::BatchEncoder(std::vector<std::string> column_names) {
+  columns_.resize(column_names.size());
+  for (size_t i = 0; i < column_names.size(); ++i) {
+    columns_[i].name_ = std::move(column_names[i]);
+  }
+}
+
+void BatchEncoder::endValue(size_t column, bool null) {
+  Column& c = columns_[column];
+  ASSERT(c.lengths_.size() == rows_);
+  if (null) {
+    c.values_.resize(c.value_start_);
+    c.lengths_.push_back(BlockFormat::NullValueLength);
+    return;
+  }
+  // Values are far too small to reach the null length; cap them just in case.
+  const uint64_t length = c.values_.size() - c.value_start_;
+  if (length >= BlockFormat::NullValueLength) {
+    c.values_.resize(c.value_start_ + BlockFormat::NullValueLength - 1);
+  }
+  c.lengths_.push_back(c.values_.size() - c.value_start_);
+  c.value_start_ = c.values_.size();
+}
+
+void BatchEncoder::endRow() {
+  ++rows_;
+#ifndef NDEBUG
+  for (const Column& c : columns_) {
+    ASSERT(c.lengths_.size() == rows_);
+  }
+#endif
+}
+
+uint64_t BatchEncoder::encode(Compression::Compressor::CompressorFactory* compressor_factory,
+                              Buffer::Instance& output) {
+  Buffer::OwnedImpl payload;
+  for (Column& c : columns_) {
+    payload.writeBEInt<uint32_t>(c.name_.size());
+    payload.add(c.name_);
+    for (const uint32_t length : c.lengths_) {
+      payload.writeBEInt<uint32_t>(length);
+    }
+    payload.add(c.values_);
+    c.lengths_.clear();
+    c.values_.clear();
+    c.value_start_ = 0;
+  }
+  const uint64_t uncompressed_length = payload.length();
+
+  absl::string_view encoding;
+  if (compressor_factory != nullptr) {
+    compressor_factory->createCompressor()->compress(
+        payload, Compression::Compressor::State::Finish);
+    encoding = compressor_factory->contentEncoding();
+  }
+
+  output.add(BlockFormat::Magic);
+  output.writeBEInt<uint8_t>(BlockFormat::Version);
+  output.writeBEInt<uint8_t>(encoding.size());
+  output.add(encoding);
+  output.writeBEInt<uint32_t>(rows_);
+  output.writeBEInt<uint32_t>(columns_.size());
+  output.writeBEInt<uint32_t>(uncompressed_length);
+  output.writeBEInt<uint32_t>(payload.length());
+  output.move(payload);
+
+  rows_ = 0;
+  return uncompressed_length;
+}
+
+bool decodeBlock(Buffer::Instance& input, const DecompressorLookup& decompressor_lookup,
+                 DecodedBlock& block) {
+  if (input.length() < HeaderPrefixLength) {
+    return false;
+  }
+  char magic[4];
+  input.copyOut(0, sizeof(magic), magic);
+  if (absl::string_view(magic, sizeof(magic)) != BlockFormat::Magic) {
+    throwMalformed("bad magic");
+  }
+  const uint8_t version = input.peekBEInt<uint8_t>(4);
+  if (version != BlockFormat::Version) {
+    throwMalformed(fmt::format("unsupported version {}", version));
+  }
+  const uint8_t encoding_length = input.peekBEInt<uint8_t>(5);
+  const uint64_t header_length = HeaderPrefixLength + encoding_length + HeaderSuffixLength;
+  if (input.length() < header_length) {
+    return false;
+  }
+  const uint64_t suffix = HeaderPrefixLength + encoding_length;
+  const uint32_t num_rows = input.peekBEInt<uint32_t>(suffix);
+  const uint32_t num_columns = input.peekBEInt<uint32_t>(suffix + 4);
+  const uint32_t uncompressed_length = input.peekBEInt<uint32_t>(suffix + 8);
+  const uint32_t payload_length = input.peekBEInt<uint32_t>(suffix + 12);
+  if (input.length() < header_length + payload_length) {
+    return false;
+  }
+
+  std::string encoding(encoding_length, '\0');
+  input.copyOut(HeaderPrefixLength, encoding_length, encoding.data());
+  input.drain(header_length);
+  Buffer::OwnedImpl payload;
+  payload.move(input, payload_length);
+
+  if (!encoding.empty()) {
+    Compression::Decompressor::DecompressorPtr decompressor = decompressor_lookup(encoding);
+    if (decompressor == nullptr) {
+      throw EnvoyException(
+          fmt::format("unknown columnar access log block encoding '{}'", encoding));
+    }
+    Buffer::OwnedImpl decompressed;
+    decompressor->decompress(payload, decompressed);
+    payload.drain(payload.length());
+    payload.move(decompressed);
+  }
+  if (payload.length() != uncompressed_length) {
+    throwMalformed("payload length mismatch");
+  }
+
+  // Each column holds a name length and a value length for each row, which bounds the allocations
+  // below.
+  if (num_columns > uncompressed_length / sizeof(uint32_t) / (uint64_t(num_rows) + 1)) {
+    throwMalformed("too many rows or columns for the payload");
+  }
+  block.column_names_.clear();
+  block.columns_.clear();
+  block.columns_.resize(num_columns);
+  std::vector<uint32_t> lengths(num_rows);
+  for (uint32_t column = 0; column < num_columns; ++column) {
+    block.column_names_.push_back(drainBytes(payload, drainLength(payload)));
+    for (uint32_t& length : lengths) {
+      length = drainLength(payload);
+    }
+    auto& values = block.columns_[column];
+    values.reserve(num_rows);
+    for (const uint32_t length : lengths) {
+      if (length == BlockFormat::NullValueLength) {
+        values.emplace_back(absl::nullopt);
+      } else {
+        values.emplace_back(drainBytes(payload, length));
+      }
+    }
+  }
+  if (payload.length() != 0) {
+    throwMalformed("trailing payload");
+  }
+  return true;
+}
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
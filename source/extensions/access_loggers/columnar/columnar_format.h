@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/compression/decompressor/decompressor.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+/**
+ * Layout of a block of the columnar access log. All integers are big endian.
+ *
+ *   magic "ECAL" | u8 version | u8 encoding length | encoding | u32 rows | u32 columns |
+ *   u32 uncompressed payload length | u32 payload length | payload
+ *
+ * The payload, compressed with the content encoding named in the header unless the encoding is
+ * empty, holds each column in turn: its u32 name length and name, a u32 value length for each
+ * row, and the values of all rows back to back. A value length of NullValueLength marks a null.
+ */
+struct BlockFormat {
+  static constexpr absl::string_view Magic{"ECAL"};
+  static constexpr uint8_t Version = 1;
+  static constexpr uint32_t NullValueLength = 0xffffffff;
+};
+
+/**
+ * Accumulates the rows of a batch column by column and encodes them as a single block.
+ */
+class BatchEncoder {
+public:
+  explicit BatchEncoder(std::vector<std::string> column_names);
+
+  /**
+   * @return the buffer to append the value of the column for the current row to.
+   */
+  std::string& valueBuffer(size_t column) { return columns_[column].values_; }
+
+  /**
+   * Completes the value of a column for the current row.
+   * @param null supplies whether the value is null, in which case anything appended to the value
+   *        buffer since the last value of the column is discarded.
+   */
+  void endValue(size_t column, bool null);
+
+  /**
+   * Completes the current row. Every column must have been given a value.
+   */
+  void endRow();
+
+  /**
+   * @return the number of complete rows in the batch.
+   */
+  uint32_t rows() const { return rows_; }
+
+  /**
+   * Encodes the batch as a block and empties the batch.
+   * @param compressor_factory supplies the compressor for the payload, or nullptr to leave the
+   *        payload uncompressed.
+   * @param output supplies the buffer to append the block to.
+   * @return the uncompressed length of the payload.
+   */
+  uint64_t encode(Compression::Compressor::CompressorFactory* compressor_factory,
+                  Buffer::Instance& output);
+
+private:
+  struct Column {
+    std::string name_;
+    std::vector<uint32_t> lengths_;
+    std::string values_;
+    // Offset in values_ at which the value of the current row starts.
+    size_t value_start_{};
+  };
+
+  std::vector<Column> columns_;
+  uint32_t rows_{};
+};
+
+/**
+ * A decoded block of the columnar access log.
+ */
+struct DecodedBlock {
+  std::vector<std::string> column_names_;
+  // The values of each column, by column and then by row.
+  std::vector<std::vector<absl::optional<std::string>>> columns_;
+};
+
+/**
+ * Supplies a decompressor for a content encoding, or nullptr if the encoding is unknown.
+ */
+using DecompressorLookup =
+    std::function<Compression::Decompressor::DecompressorPtr(absl::string_view encoding)>;
+
+/**
+ * Decodes and drains the block at the start of a buffer.
+ * @param input supplies the buffer.
+ * @param decompressor_lookup supplies the decompressors for the payload encodings.
+ * @param block supplies the block to decode to.
+ * @return false if the buffer does not hold a whole block, in which case it is left untouched.
+ * @throw EnvoyException if the block is malformed or uses an unknown encoding.
+ */
+bool decodeBlock(Buffer::Instance& input, const DecompressorLookup& decompressor_lookup,
+                 DecodedBlock& block);
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,79 @@
+#include "extensions/access_loggers/columnar/config.h"
+
+#include <memory>
+
+#include "envoy/compression/compressor/config.h"
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+#include "envoy/singleton/manager.h"
+
+#include "common/config/utility.h"
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/access_loggers/columnar/columnar_access_log_impl.h"
+#include "extensions/access_loggers/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(columnar_log_file_cache);
+
+AccessLog::InstanceSharedPtr
+ColumnarAccessLogFactory::createAccessLogInstance(const Protobuf::Message& config,
+                                                  AccessLog::FilterPtr&& filter,
+                                                  Server::Configuration::FactoryContext& context) {
+  const auto& proto_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog&>(
+      config, context.messageValidationVisitor());
+
+  Compression::Compressor::CompressorFactoryPtr compressor_factory;
+  if (proto_config.has_compressor_library()) {
+    const std::string type{TypeUtil::typeUrlToDescriptorFullName(
+        proto_config.compressor_library().typed_config().type_url())};
+    Compression::Compressor::NamedCompressorLibraryConfigFactory* const config_factory =
+        Registry::FactoryRegistry<
+            Compression::Compressor::NamedCompressorLibraryConfigFactory>::getFactoryByType(type);
+    if (config_factory == nullptr) {
+      throw EnvoyException(
+          fmt::format("Didn't find a registered implementation for type: '{}'", type));
+    }
+    ProtobufTypes::MessagePtr message = Config::Utility::translateAnyToFactoryConfig(
+        proto_config.compressor_library().typed_config(), context.messageValidationVisitor(),
+        *config_factory);
+    compressor_factory = config_factory->createCompressorFactoryFromProto(*message, context);
+  }
+
+  // The logs of a path share its file, and rotate it together.
+  ColumnarLogFileCacheSharedPtr file_cache =
+      context.singletonManager().getTyped<ColumnarLogFileCache>(
+          SINGLETON_MANAGER_REGISTERED_NAME(columnar_log_file_cache), [&context] {
+            return std::make_shared<ColumnarLogFileCache>(
+                context.accessLogManager(), context.api().fileSystem(), context.timeSource());
+          });
+  auto sink = std::make_shared<ColumnarLogSink>(proto_config, std::move(compressor_factory),
+                                                std::move(file_cache), context.dispatcher(),
+                                                context.scope());
+  return std::make_shared<ColumnarAccessLog>(std::move(filter), std::move(sink),
+                                             context.threadLocal());
+}
+
+ProtobufTypes::MessagePtr ColumnarAccessLogFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog>();
+}
+
+std::string ColumnarAccessLogFactory::name() const { return AccessLogNames::get().Columnar; }
+
+/**
+ * Static registration for the columnar access log. @see RegisterFactory.
+ */
+REGISTER_FACTORY(ColumnarAccessLogFactory, Server::Configuration::AccessLogInstanceFactory);
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -1,7 +1,12 @@
 #include "extensions/access_loggers/grpc/config_utils.h"
 
+#include "envoy/compression/compressor/config.h"
+#include "envoy/registry/registry.h"
 #include "envoy/singleton/manager.h"
 
+#include "common/config/utility.h"
+#include "common/protobuf/utility.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace AccessLoggers {
@@ -19,6 +24,32 @@ getGrpcAccessLoggerCacheSingleton(Server::Configuration::FactoryContext& context
             context.threadLocal(), context.localInfo());
       });
 }
+
+Compression::Compressor::CompressorFactorySharedPtr createCompressorFactory(
+    const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig& config,
+    Server::Configuration::FactoryContext& context) {
+  if (!config.has_compressor_library()) {
+    return nullptr;
+  }
+  if (config.grpc_service().has_google_grpc()) {
+    throw EnvoyException("gRPC access log compressor_library is only supported with envoy_grpc, "
+                         "configure the compression of google_grpc through its channel_args");
+  }
+  const std::string type{TypeUtil::typeUrlToDescriptorFullName(
+      config.compressor_library().typed_config().type_url())};
+  Compression::Compressor::NamedCompressorLibraryConfigFactory* const config_factory =
+      Registry::FactoryRegistry<
+          Compression::Compressor::NamedCompressorLibraryConfigFactory>::getFactoryByType(type);
+  if (config_factory == nullptr) {
+    throw EnvoyException(
+        fmt::format("Didn't find a registered implementation for type: '{}'", type));
+  }
+  ProtobufTypes::MessagePtr message = Config::Utility::translateAnyToFactoryConfig(
+      config.compressor_library().typed_config(), context.messageValidationVisitor(),
+      *config_factory);
+  return config_factory->createCompressorFactoryFromProto(*message, context);
+}
+
 } // namespace GrpcCommon
 } // namespace AccessLoggers
 } // namespace Extensions
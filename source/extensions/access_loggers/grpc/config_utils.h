@@ -1,5 +1,7 @@
 #pragma once
 
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/extensions/access_loggers/grpc/v3/als.pb.h"
 #include "envoy/server/filter_config.h"
 
 #include "extensions/access_loggers/grpc/grpc_access_log_impl.h"
@@ -12,6 +14,19 @@ namespace GrpcCommon {
 GrpcAccessLoggerCacheSharedPtr
 getGrpcAccessLoggerCacheSingleton(Server::Configuration::FactoryContext& context);
 
+/**
+ * Creates the factory of the compressors of the access log messages.
+ * @param config supplies the configuration of the logger.
+ * @param context supplies the factory context.
+ * @return the compressor factory of the compressor_library of the configuration, or nullptr if the
+ *         messages are not compressed.
+ * @throw EnvoyException if the compressor library is not registered, or is configured along with a
+ *        Google gRPC service.
+ */
+Compression::Compressor::CompressorFactorySharedPtr createCompressorFactory(
+    const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig& config,
+    Server::Configuration::FactoryContext& context);
+
 } // namespace GrpcCommon
 } // namespace AccessLoggers
 } // namespace Extensions
@@ -5,7 +5,10 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/assert.h"
+#include "common/config/version_converter.h"
+#include "common/grpc/common.h"
 #include "common/grpc/typed_async_client.h"
+#include "common/http/headers.h"
 #include "common/network/utility.h"
 #include "common/runtime/runtime_features.h"
 #include "common/stream_info/utility.h"
@@ -15,6 +18,13 @@ namespace Extensions {
 namespace AccessLoggers {
 namespace GrpcCommon {
 
+void GrpcAccessLoggerImpl::LocalStream::onCreateInitialMetadata(Http::RequestHeaderMap& metadata) {
+  if (parent_.compressor_factory_ != nullptr) {
+    metadata.setReferenceKey(Http::CustomHeaders::get().GrpcEncoding,
+                             parent_.compressor_factory_->contentEncoding());
+  }
+}
+
 void GrpcAccessLoggerImpl::LocalStream::onRemoteClose(Grpc::Status::GrpcStatus,
                                                       const std::string&) {
   ASSERT(parent_.stream_ != absl::nullopt);
@@ -29,16 +39,21 @@ GrpcAccessLoggerImpl::GrpcAccessLoggerImpl(
     Grpc::RawAsyncClientPtr&& client, std::string log_name,
     std::chrono::milliseconds buffer_flush_interval_msec, uint64_t max_buffer_size_bytes,
     Event::Dispatcher& dispatcher, const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-    envoy::config::core::v3::ApiVersion transport_api_version)
+    envoy::config::core::v3::ApiVersion transport_api_version, uint64_t max_pending_bytes,
+    std::chrono::milliseconds adaptive_target_fill_time, uint64_t min_buffer_size_bytes,
+    Compression::Compressor::CompressorFactorySharedPtr compressor_factory)
     : stats_({ALL_GRPC_ACCESS_LOGGER_STATS(
           POOL_COUNTER_PREFIX(scope, "access_logs.grpc_access_log."))}),
       client_(std::move(client)), log_name_(log_name),
       buffer_flush_interval_msec_(buffer_flush_interval_msec),
-      flush_timer_(dispatcher.createTimer([this]() {
-        flush();
-        flush_timer_->enableTimer(buffer_flush_interval_msec_);
-      })),
-      max_buffer_size_bytes_(max_buffer_size_bytes), local_info_(local_info),
+      flush_timer_(dispatcher.createTimer([this]() { onFlushTimer(); })),
+      max_buffer_size_bytes_(max_buffer_size_bytes), max_pending_bytes_(max_pending_bytes),
+      adaptive_target_fill_time_(adaptive_target_fill_time),
+      min_buffer_size_bytes_(std::min(min_buffer_size_bytes, max_buffer_size_bytes)),
+      compressor_factory_(std::move(compressor_factory)),
+      flush_threshold_bytes_(adaptive_target_fill_time_.count() > 0 ? min_buffer_size_bytes_
+                                                                     : max_buffer_size_bytes_),
+      local_info_(local_info),
       service_method_(
           Grpc::VersionedMethods("envoy.service.accesslog.v3.AccessLogService.StreamAccessLogs",
                                  "envoy.service.accesslog.v2.AccessLogService.StreamAccessLogs")
@@ -47,13 +62,33 @@ GrpcAccessLoggerImpl::GrpcAccessLoggerImpl(
   flush_timer_->enableTimer(buffer_flush_interval_msec_);
 }
 
+void GrpcAccessLoggerImpl::onFlushTimer() {
+  if (adaptive_target_fill_time_.count() > 0) {
+    // Moving average in which the last interval weighs as much as all the previous ones, so that
+    // the batch size catches up with a change of rate within a few intervals.
+    average_interval_bytes_ = average_interval_bytes_.has_value()
+                                  ? (average_interval_bytes_.value() + interval_bytes_) / 2
+                                  : interval_bytes_;
+    interval_bytes_ = 0;
+    const double target_bytes = average_interval_bytes_.value() *
+                                adaptive_target_fill_time_.count() /
+                                buffer_flush_interval_msec_.count();
+    flush_threshold_bytes_ = std::max(
+        min_buffer_size_bytes_,
+        static_cast<uint64_t>(std::min(target_bytes, static_cast<double>(max_buffer_size_bytes_))));
+  }
+  flush();
+  flush_timer_->enableTimer(buffer_flush_interval_msec_);
+}
+
 bool GrpcAccessLoggerImpl::canLogMore() {
-  if (max_buffer_size_bytes_ == 0 || approximate_message_size_bytes_ < max_buffer_size_bytes_) {
+  if (max_pending_bytes_ == 0 ||
+      pending_bytes_ + approximate_message_size_bytes_ < max_pending_bytes_) {
     stats_.logs_written_.inc();
     return true;
   }
   flush();
-  if (approximate_message_size_bytes_ < max_buffer_size_bytes_) {
+  if (pending_bytes_ + approximate_message_size_bytes_ < max_pending_bytes_) {
     stats_.logs_written_.inc();
     return true;
   }
@@ -69,23 +104,45 @@ void GrpcAccessLoggerImpl::log(envoy::data::accesslog::v3::HTTPAccessLogEntry&&
   if (!canLogMore()) {
     return;
   }
-  approximate_message_size_bytes_ += entry.ByteSizeLong();
+  const uint64_t entry_size_bytes = entry.ByteSizeLong();
+  approximate_message_size_bytes_ += entry_size_bytes;
+  interval_bytes_ += entry_size_bytes;
   message_.mutable_http_logs()->mutable_log_entry()->Add(std::move(entry));
-  if (approximate_message_size_bytes_ >= max_buffer_size_bytes_) {
-    flush();
-  }
+  maybeFlush();
 }
 
 void GrpcAccessLoggerImpl::log(envoy::data::accesslog::v3::TCPAccessLogEntry&& entry) {
-  approximate_message_size_bytes_ += entry.ByteSizeLong();
+  if (!canLogMore()) {
+    return;
+  }
+  const uint64_t entry_size_bytes = entry.ByteSizeLong();
+  approximate_message_size_bytes_ += entry_size_bytes;
+  interval_bytes_ += entry_size_bytes;
   message_.mutable_tcp_logs()->mutable_log_entry()->Add(std::move(entry));
-  if (approximate_message_size_bytes_ >= max_buffer_size_bytes_) {
+  maybeFlush();
+}
+
+void GrpcAccessLoggerImpl::maybeFlush() {
+  if (approximate_message_size_bytes_ >= flush_threshold_bytes_) {
     flush();
   }
 }
 
-void GrpcAccessLoggerImpl::flush() {
+void GrpcAccessLoggerImpl::enqueueMessage() {
   if (!message_.has_http_logs() && !message_.has_tcp_logs()) {
+    return;
+  }
+  // Swapping hands the entries over to the queue without copying them.
+  pending_messages_.emplace_back();
+  pending_messages_.back().message_.Swap(&message_);
+  pending_messages_.back().size_bytes_ = approximate_message_size_bytes_;
+  pending_bytes_ += approximate_message_size_bytes_;
+  approximate_message_size_bytes_ = 0;
+}
+
+void GrpcAccessLoggerImpl::flush() {
+  enqueueMessage();
+  if (pending_messages_.empty()) {
     // Nothing to flush.
     return;
   }
@@ -97,25 +154,49 @@ void GrpcAccessLoggerImpl::flush() {
   if (stream_->stream_ == nullptr) {
     stream_->stream_ =
         client_->start(service_method_, *stream_, Http::AsyncClient::StreamOptions());
+    if (stream_->stream_ == nullptr) {
+      // Clear out the stream data due to stream creation failure. The batches stay queued, within
+      // max_pending_bytes_, until the next flush.
+      stream_.reset();
+      return;
+    }
+    if (compressor_factory_ != nullptr) {
+      stream_->compressed_stream_ = stream_->stream_.compressedStream();
+    }
 
-    auto* identifier = message_.mutable_identifier();
+    auto* identifier = pending_messages_.front().message_.mutable_identifier();
     *identifier->mutable_node() = local_info_.node();
     identifier->set_log_name(log_name_);
   }
 
-  if (stream_->stream_ != nullptr) {
+  // The stream is reset if it is closed while sending.
+  while (!pending_messages_.empty() && stream_ != absl::nullopt) {
     if (stream_->stream_->isAboveWriteBufferHighWatermark()) {
       return;
     }
-    stream_->stream_->sendMessage(message_, transport_api_version_, false);
-  } else {
-    // Clear out the stream data due to stream creation failure.
-    stream_.reset();
+    PendingMessage& pending = pending_messages_.front();
+    pending_bytes_ -= pending.size_bytes_;
+    sendMessage(pending.message_);
+    pending_messages_.pop_front();
   }
+}
 
-  // Clear the message regardless of the success.
-  approximate_message_size_bytes_ = 0;
-  message_.Clear();
+void GrpcAccessLoggerImpl::sendMessage(
+    envoy::service::accesslog::v3::StreamAccessLogsMessage& message) {
+  Config::VersionConverter::prepareMessageForGrpcWire(message, transport_api_version_);
+  Buffer::InstancePtr request = Grpc::Common::serializeMessage(message);
+  stats_.messages_sent_.inc();
+  stats_.bytes_uncompressed_.add(request->length());
+  if (stream_->compressed_stream_ == nullptr) {
+    // Uncompressed messages may be sent whatever the encoding announced in the initial metadata.
+    stats_.bytes_sent_.add(request->length());
+    stream_->stream_->sendMessageRaw(std::move(request), false);
+    return;
+  }
+  compressor_factory_->createCompressor()->compress(*request,
+                                                    Envoy::Compression::Compressor::State::Finish);
+  stats_.bytes_sent_.add(request->length());
+  stream_->compressed_stream_->sendCompressedMessageRaw(std::move(request), false);
 }
 
 GrpcAccessLoggerCacheImpl::GrpcAccessLoggerCacheImpl(Grpc::AsyncClientManager& async_client_manager,
@@ -130,7 +211,8 @@ GrpcAccessLoggerCacheImpl::GrpcAccessLoggerCacheImpl(Grpc::AsyncClientManager& a
 
 GrpcAccessLoggerSharedPtr GrpcAccessLoggerCacheImpl::getOrCreateLogger(
     const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig& config,
-    GrpcAccessLoggerType logger_type, Stats::Scope& scope) {
+    GrpcAccessLoggerType logger_type, Stats::Scope& scope,
+    Compression::Compressor::CompressorFactorySharedPtr compressor_factory) {
   // TODO(euroelessar): Consider cleaning up loggers.
   auto& cache = tls_slot_->getTyped<ThreadLocalCache>();
   const auto cache_key = std::make_pair(MessageUtil::hash(config), logger_type);
@@ -140,11 +222,22 @@ GrpcAccessLoggerSharedPtr GrpcAccessLoggerCacheImpl::getOrCreateLogger(
   }
   const Grpc::AsyncClientFactoryPtr factory =
       async_client_manager_.factoryForGrpcService(config.grpc_service(), scope_, false);
+  const uint64_t buffer_size_bytes =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_bytes, 16384);
+  std::chrono::milliseconds adaptive_target_fill_time{0};
+  uint64_t min_buffer_size_bytes = 0;
+  if (config.has_adaptive_batching()) {
+    adaptive_target_fill_time = std::chrono::milliseconds(
+        PROTOBUF_GET_MS_OR_DEFAULT(config.adaptive_batching(), target_fill_time, 100));
+    min_buffer_size_bytes =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.adaptive_batching(), min_buffer_size_bytes, 1024);
+  }
   const GrpcAccessLoggerSharedPtr logger = std::make_shared<GrpcAccessLoggerImpl>(
       factory->create(), config.log_name(),
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, buffer_flush_interval, 1000)),
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_bytes, 16384), cache.dispatcher_,
-      local_info_, scope, config.transport_api_version());
+      buffer_size_bytes, cache.dispatcher_, local_info_, scope, config.transport_api_version(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pending_bytes, buffer_size_bytes),
+      adaptive_target_fill_time, min_buffer_size_bytes, std::move(compressor_factory));
   cache.access_loggers_.emplace(cache_key, logger);
   return logger;
 }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <vector>
 
+#include "envoy/compression/compressor/factory.h"
 #include "envoy/data/accesslog/v3/accesslog.pb.h"
 #include "envoy/extensions/access_loggers/grpc/v3/als.pb.h"
 #include "envoy/grpc/async_client.h"
@@ -26,7 +28,10 @@ namespace GrpcCommon {
  */
 #define ALL_GRPC_ACCESS_LOGGER_STATS(COUNTER)                                                      \
   COUNTER(logs_written)                                                                            \
-  COUNTER(logs_dropped)
+  COUNTER(logs_dropped)                                                                            \
+  COUNTER(messages_sent)                                                                           \
+  COUNTER(bytes_sent)                                                                              \
+  COUNTER(bytes_uncompressed)
 
 /**
  * Wrapper struct for the access log stats. @see stats_macros.h
@@ -71,22 +76,36 @@ public:
   /**
    * Get existing logger or create a new one for the given configuration.
    * @param config supplies the configuration for the logger.
+   * @param compressor_factory supplies the factory of the compressors of the messages, built from
+   *        the compressor_library of the configuration. nullptr if the messages are not compressed.
    * @return GrpcAccessLoggerSharedPtr ready for logging requests.
    */
   virtual GrpcAccessLoggerSharedPtr getOrCreateLogger(
       const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig& config,
-      GrpcAccessLoggerType logger_type, Stats::Scope& scope) PURE;
+      GrpcAccessLoggerType logger_type, Stats::Scope& scope,
+      Compression::Compressor::CompressorFactorySharedPtr compressor_factory) PURE;
 };
 
 using GrpcAccessLoggerCacheSharedPtr = std::shared_ptr<GrpcAccessLoggerCache>;
 
+/**
+ * Logger which batches the entries into messages of the gRPC stream. Full batches wait in a queue
+ * bounded by max_pending_bytes while the stream is above its write buffer high watermark or is
+ * being re-established. When adaptive_target_fill_time is not zero, the batch size follows the
+ * rate of logged bytes, estimated at every flush interval, between min_buffer_size_bytes and
+ * max_buffer_size_bytes.
+ */
 class GrpcAccessLoggerImpl : public GrpcAccessLogger {
 public:
   GrpcAccessLoggerImpl(Grpc::RawAsyncClientPtr&& client, std::string log_name,
                        std::chrono::milliseconds buffer_flush_interval_msec,
                        uint64_t max_buffer_size_bytes, Event::Dispatcher& dispatcher,
                        const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-                       envoy::config::core::v3::ApiVersion transport_api_version);
+                       envoy::config::core::v3::ApiVersion transport_api_version,
+                       uint64_t max_pending_bytes,
+                       std::chrono::milliseconds adaptive_target_fill_time,
+                       uint64_t min_buffer_size_bytes,
+                       Compression::Compressor::CompressorFactorySharedPtr compressor_factory);
 
   // Extensions::AccessLoggers::GrpcCommon::GrpcAccessLogger
   void log(envoy::data::accesslog::v3::HTTPAccessLogEntry&& entry) override;
@@ -98,7 +117,7 @@ private:
     LocalStream(GrpcAccessLoggerImpl& parent) : parent_(parent) {}
 
     // Grpc::AsyncStreamCallbacks
-    void onCreateInitialMetadata(Http::RequestHeaderMap&) override {}
+    void onCreateInitialMetadata(Http::RequestHeaderMap& metadata) override;
     void onReceiveInitialMetadata(Http::ResponseHeaderMapPtr&&) override {}
     void onReceiveMessage(
         std::unique_ptr<envoy::service::accesslog::v3::StreamAccessLogsResponse>&&) override {}
@@ -107,9 +126,23 @@ private:
 
     GrpcAccessLoggerImpl& parent_;
     Grpc::AsyncStream<envoy::service::accesslog::v3::StreamAccessLogsMessage> stream_{};
+    // Set if the messages are compressed and the client of the stream sends compressed messages.
+    Grpc::RawCompressedAsyncStream* compressed_stream_{};
+  };
+
+  /**
+   * A full batch waiting to be sent.
+   */
+  struct PendingMessage {
+    envoy::service::accesslog::v3::StreamAccessLogsMessage message_;
+    uint64_t size_bytes_;
   };
 
   void flush();
+  void onFlushTimer();
+  void maybeFlush();
+  void enqueueMessage();
+  void sendMessage(envoy::service::accesslog::v3::StreamAccessLogsMessage& message);
 
   bool canLogMore();
 
@@ -121,8 +154,19 @@ private:
   const std::chrono::milliseconds buffer_flush_interval_msec_;
   const Event::TimerPtr flush_timer_;
   const uint64_t max_buffer_size_bytes_;
+  const uint64_t max_pending_bytes_;
+  const std::chrono::milliseconds adaptive_target_fill_time_;
+  const uint64_t min_buffer_size_bytes_;
+  const Compression::Compressor::CompressorFactorySharedPtr compressor_factory_;
+  // The batch size past which the batch is flushed.
+  uint64_t flush_threshold_bytes_;
+  // The bytes logged since the last flush interval, and their moving average over the intervals.
+  uint64_t interval_bytes_ = 0;
+  absl::optional<double> average_interval_bytes_;
   uint64_t approximate_message_size_bytes_ = 0;
   envoy::service::accesslog::v3::StreamAccessLogsMessage message_;
+  std::deque<PendingMessage> pending_messages_;
+  uint64_t pending_bytes_ = 0;
   absl::optional<LocalStream> stream_;
   const LocalInfo::LocalInfo& local_info_;
   const Protobuf::MethodDescriptor& service_method_;
@@ -139,7 +183,8 @@ public:
 
   GrpcAccessLoggerSharedPtr getOrCreateLogger(
       const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig& config,
-      GrpcAccessLoggerType logger_type, Stats::Scope& scope) override;
+      GrpcAccessLoggerType logger_type, Stats::Scope& scope,
+      Compression::Compressor::CompressorFactorySharedPtr compressor_factory) override;
 
 private:
   /**
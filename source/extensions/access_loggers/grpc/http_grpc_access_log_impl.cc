@@ -27,9 +27,10 @@ HttpGrpcAccessLog::HttpGrpcAccessLog(
     AccessLog::FilterPtr&& filter,
     envoy::extensions::access_loggers::grpc::v3::HttpGrpcAccessLogConfig config,
     ThreadLocal::SlotAllocator& tls, GrpcCommon::GrpcAccessLoggerCacheSharedPtr access_logger_cache,
-    Stats::Scope& scope)
+    Stats::Scope& scope, Compression::Compressor::CompressorFactorySharedPtr compressor_factory)
     : Common::ImplBase(std::move(filter)), scope_(scope), config_(std::move(config)),
-      tls_slot_(tls.allocateSlot()), access_logger_cache_(std::move(access_logger_cache)) {
+      tls_slot_(tls.allocateSlot()), access_logger_cache_(std::move(access_logger_cache)),
+      compressor_factory_(std::move(compressor_factory)) {
   for (const auto& header : config_.additional_request_headers_to_log()) {
     request_headers_to_log_.emplace_back(header);
   }
@@ -44,7 +45,8 @@ HttpGrpcAccessLog::HttpGrpcAccessLog(
 
   tls_slot_->set([this](Event::Dispatcher&) {
     return std::make_shared<ThreadLocalLogger>(access_logger_cache_->getOrCreateLogger(
-        config_.common_config(), GrpcCommon::GrpcAccessLoggerType::HTTP, scope_));
+        config_.common_config(), GrpcCommon::GrpcAccessLoggerType::HTTP, scope_,
+        compressor_factory_));
   });
 }
 
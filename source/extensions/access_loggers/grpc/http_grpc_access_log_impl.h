@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 
+#include "envoy/compression/compressor/factory.h"
 #include "envoy/extensions/access_loggers/grpc/v3/als.pb.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
@@ -31,7 +32,8 @@ public:
                     envoy::extensions::access_loggers::grpc::v3::HttpGrpcAccessLogConfig config,
                     ThreadLocal::SlotAllocator& tls,
                     GrpcCommon::GrpcAccessLoggerCacheSharedPtr access_logger_cache,
-                    Stats::Scope& scope);
+                    Stats::Scope& scope,
+                    Compression::Compressor::CompressorFactorySharedPtr compressor_factory);
 
 private:
   /**
@@ -53,6 +55,7 @@ private:
   const envoy::extensions::access_loggers::grpc::v3::HttpGrpcAccessLogConfig config_;
   const ThreadLocal::SlotPtr tls_slot_;
   const GrpcCommon::GrpcAccessLoggerCacheSharedPtr access_logger_cache_;
+  const Compression::Compressor::CompressorFactorySharedPtr compressor_factory_;
   std::vector<Http::LowerCaseString> request_headers_to_log_;
   std::vector<Http::LowerCaseString> response_headers_to_log_;
   std::vector<Http::LowerCaseString> response_trailers_to_log_;
@@ -21,12 +21,14 @@ TcpGrpcAccessLog::TcpGrpcAccessLog(
     AccessLog::FilterPtr&& filter,
     envoy::extensions::access_loggers::grpc::v3::TcpGrpcAccessLogConfig config,
     ThreadLocal::SlotAllocator& tls, GrpcCommon::GrpcAccessLoggerCacheSharedPtr access_logger_cache,
-    Stats::Scope& scope)
+    Stats::Scope& scope, Compression::Compressor::CompressorFactorySharedPtr compressor_factory)
     : Common::ImplBase(std::move(filter)), scope_(scope), config_(std::move(config)),
-      tls_slot_(tls.allocateSlot()), access_logger_cache_(std::move(access_logger_cache)) {
+      tls_slot_(tls.allocateSlot()), access_logger_cache_(std::move(access_logger_cache)),
+      compressor_factory_(std::move(compressor_factory)) {
   tls_slot_->set([this](Event::Dispatcher&) {
     return std::make_shared<ThreadLocalLogger>(access_logger_cache_->getOrCreateLogger(
-        config_.common_config(), GrpcCommon::GrpcAccessLoggerType::TCP, scope_));
+        config_.common_config(), GrpcCommon::GrpcAccessLoggerType::TCP, scope_,
+        compressor_factory_));
   });
 }
 
@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "envoy/compression/compressor/factory.h"
 #include "envoy/extensions/access_loggers/grpc/v3/als.pb.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
@@ -30,7 +31,8 @@ public:
                    envoy::extensions::access_loggers::grpc::v3::TcpGrpcAccessLogConfig config,
                    ThreadLocal::SlotAllocator& tls,
                    GrpcCommon::GrpcAccessLoggerCacheSharedPtr access_logger_cache,
-                   Stats::Scope& scope);
+                   Stats::Scope& scope,
+                   Compression::Compressor::CompressorFactorySharedPtr compressor_factory);
 
 private:
   /**
@@ -52,6 +54,7 @@ private:
   const envoy::extensions::access_loggers::grpc::v3::TcpGrpcAccessLogConfig config_;
   const ThreadLocal::SlotPtr tls_slot_;
   const GrpcCommon::GrpcAccessLoggerCacheSharedPtr access_logger_cache_;
+  const Compression::Compressor::CompressorFactorySharedPtr compressor_factory_;
 };
 
 } // namespace TcpGrpc
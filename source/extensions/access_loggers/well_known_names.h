@@ -14,6 +14,10 @@ namespace AccessLoggers {
  */
 class AccessLogNameValues {
 public:
+  // Aggregating access log
+  const std::string Aggregating = "envoy.access_loggers.aggregating";
+  // Columnar access log
+  const std::string Columnar = "envoy.access_loggers.columnar";
   // File access log
   const std::string File = "envoy.access_loggers.file";
   // HTTP gRPC access log
@@ -0,0 +1,33 @@
+#include "extensions/compression/brotli/common/base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Common {
+
+Base::Base(uint32_t chunk_size)
+    : chunk_size_{chunk_size}, chunk_ptr_{new uint8_t[chunk_size]}, next_out_{chunk_ptr_.get()},
+      avail_out_{chunk_size} {}
+
+void Base::updateOutput(Buffer::Instance& output_buffer) {
+  if (avail_out_ == 0) {
+    finalizeOutput(output_buffer);
+  }
+}
+
+void Base::finalizeOutput(Buffer::Instance& output_buffer) {
+  const size_t n_output = chunk_size_ - avail_out_;
+  if (n_output == 0) {
+    return;
+  }
+  output_buffer.add(static_cast<void*>(chunk_ptr_.get()), n_output);
+  next_out_ = chunk_ptr_.get();
+  avail_out_ = chunk_size_;
+}
+
+} // namespace Common
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
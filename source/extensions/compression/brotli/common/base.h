@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/buffer/buffer.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Common {
+
+/**
+ * Shared code between the compressor and the decompressor: the output chunk the brotli stream
+ * writes to, and the cursors into the input and the output.
+ */
+class Base {
+public:
+  Base(uint32_t chunk_size);
+
+protected:
+  /**
+   * Moves the output chunk into the output buffer once the chunk is full.
+   */
+  void updateOutput(Buffer::Instance& output_buffer);
+
+  /**
+   * Moves whatever the output chunk holds into the output buffer.
+   */
+  void finalizeOutput(Buffer::Instance& output_buffer);
+
+  const uint32_t chunk_size_;
+  const std::unique_ptr<uint8_t[]> chunk_ptr_;
+  const uint8_t* next_in_{};
+  size_t avail_in_{};
+  uint8_t* next_out_;
+  size_t avail_out_;
+};
+
+} // namespace Common
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,84 @@
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+
+BrotliEncoderDictionary::BrotliEncoderDictionary(std::string data, uint32_t quality)
+    : data_(std::move(data)),
+      prepared_(BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW, data_.size(),
+                                               reinterpret_cast<const uint8_t*>(data_.data()),
+                                               quality, nullptr, nullptr, nullptr),
+                &BrotliEncoderDestroyPreparedDictionary) {
+  if (prepared_ == nullptr) {
+    throw EnvoyException("brotli: unable to prepare the compression dictionary");
+  }
+}
+
+BrotliCompressorImpl::BrotliCompressorImpl(uint32_t quality, uint32_t window_bits,
+                                           uint32_t input_block_bits, EncoderMode mode,
+                                           uint32_t chunk_size,
+                                           BrotliEncoderDictionarySharedPtr dictionary)
+    : Common::Base(chunk_size),
+      state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr), &BrotliEncoderDestroyInstance),
+      dictionary_(std::move(dictionary)) {
+  RELEASE_ASSERT(state_ != nullptr, "unable to create the brotli encoder");
+  BROTLI_BOOL result = BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_QUALITY, quality);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  result = BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_LGWIN, window_bits);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  result = BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_LGBLOCK, input_block_bits);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  result =
+      BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_MODE, static_cast<uint32_t>(mode));
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  if (dictionary_ != nullptr) {
+    result = BrotliEncoderAttachPreparedDictionary(state_.get(), dictionary_->prepared());
+    RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  }
+}
+
+void BrotliCompressorImpl::compress(Buffer::Instance& buffer,
+                                    Envoy::Compression::Compressor::State state) {
+  for (const Buffer::RawSlice& input_slice : buffer.getRawSlices()) {
+    avail_in_ = input_slice.len_;
+    next_in_ = static_cast<uint8_t*>(input_slice.mem_);
+    // As with zlib, the output is appended to the end of the buffer while its input slices are
+    // processed, and the input is drained from the beginning of the buffer afterwards.
+    while (avail_in_ > 0) {
+      process(buffer, BROTLI_OPERATION_PROCESS);
+    }
+    buffer.drain(input_slice.len_);
+  }
+
+  if (state == Envoy::Compression::Compressor::State::Finish) {
+    do {
+      process(buffer, BROTLI_OPERATION_FINISH);
+    } while (!BrotliEncoderIsFinished(state_.get()));
+  } else {
+    do {
+      process(buffer, BROTLI_OPERATION_FLUSH);
+    } while (BrotliEncoderHasMoreOutput(state_.get()));
+  }
+  finalizeOutput(buffer);
+}
+
+void BrotliCompressorImpl::process(Buffer::Instance& output_buffer,
+                                   BrotliEncoderOperation operation) {
+  const BROTLI_BOOL result = BrotliEncoderCompressStream(
+      state_.get(), operation, &avail_in_, &next_in_, &avail_out_, &next_out_, nullptr);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "unable to compress");
+  updateOutput(output_buffer);
+}
+
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
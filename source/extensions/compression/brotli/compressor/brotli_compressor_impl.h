@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/compression/compressor/compressor.h"
+
+#include "extensions/compression/brotli/common/base.h"
+
+#include "brotli/encode.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+
+/**
+ * A raw shared dictionary, prepared for the encoder once and then attached to every compressed
+ * stream. The prepared dictionary is immutable, so it can be shared across workers.
+ */
+class BrotliEncoderDictionary {
+public:
+  /**
+   * @param data supplies the raw dictionary content.
+   * @param quality supplies the quality the dictionary is prepared for.
+   * @throw EnvoyException if the dictionary can't be prepared.
+   */
+  BrotliEncoderDictionary(std::string data, uint32_t quality);
+
+  const BrotliEncoderPreparedDictionary* prepared() const { return prepared_.get(); }
+
+private:
+  // The prepared dictionary refers to the raw content, which therefore lives as long.
+  const std::string data_;
+  const std::unique_ptr<BrotliEncoderPreparedDictionary,
+                        decltype(&BrotliEncoderDestroyPreparedDictionary)>
+      prepared_;
+};
+
+using BrotliEncoderDictionarySharedPtr = std::shared_ptr<const BrotliEncoderDictionary>;
+
+/**
+ * Implementation of compressor's interface.
+ */
+class BrotliCompressorImpl : public Common::Base,
+                             public Envoy::Compression::Compressor::Compressor {
+public:
+  /**
+   * Enum values are used for setting the encoder mode.
+   * generic: in this mode the compressor does not know anything in advance about the properties
+   * of the input.
+   * text: compression mode for UTF-8 formatted text input.
+   * font: compression mode used in WOFF 2.0.
+   * default: the same as generic. @see BROTLI_DEFAULT_MODE in the brotli manual.
+   */
+  enum class EncoderMode : uint32_t {
+    Generic = BROTLI_MODE_GENERIC,
+    Text = BROTLI_MODE_TEXT,
+    Font = BROTLI_MODE_FONT,
+    Default = BROTLI_DEFAULT_MODE,
+  };
+
+  /**
+   * @param quality sets the compression level, from 0 (fastest) to 11 (best compression).
+   * @param window_bits sets the base two logarithmic of the history buffer's size.
+   * @param input_block_bits sets the base two logarithmic of the maximum input block size.
+   * @param mode @see EncoderMode enum.
+   * @param chunk_size amount of memory reserved for the compressor output.
+   * @param dictionary supplies an optional shared dictionary, nullptr if there is none.
+   */
+  BrotliCompressorImpl(uint32_t quality, uint32_t window_bits, uint32_t input_block_bits,
+                       EncoderMode mode, uint32_t chunk_size,
+                       BrotliEncoderDictionarySharedPtr dictionary);
+
+  // Compression::Compressor::Compressor
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, BrotliEncoderOperation operation);
+
+  const std::unique_ptr<BrotliEncoderState, decltype(&BrotliEncoderDestroyInstance)> state_;
+  const BrotliEncoderDictionarySharedPtr dictionary_;
+};
+
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
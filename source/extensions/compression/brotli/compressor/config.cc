@@ -0,0 +1,76 @@
+#include "extensions/compression/brotli/compressor/config.h"
+
+#include "common/config/datasource.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+
+namespace {
+// Default quality, which compresses text faster than gzip's default level while producing
+// smaller output.
+const uint32_t DefaultQuality = 3;
+
+// Default compression window size.
+const uint32_t DefaultWindowBits = 18;
+
+// Default maximum input block size.
+const uint32_t DefaultInputBlockBits = 24;
+
+// Default brotli chunk size.
+const uint32_t DefaultChunkSize = 4096;
+} // namespace
+
+BrotliCompressorFactory::BrotliCompressorFactory(
+    const envoy::extensions::compression::brotli::compressor::v3::Brotli& brotli, Api::Api& api)
+    : quality_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, quality, DefaultQuality)),
+      window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, window_bits, DefaultWindowBits)),
+      input_block_bits_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, input_block_bits, DefaultInputBlockBits)),
+      encoder_mode_(encoderModeEnum(brotli.encoder_mode())),
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, chunk_size, DefaultChunkSize)) {
+  if (brotli.has_dictionary()) {
+    dictionary_ = std::make_shared<const BrotliEncoderDictionary>(
+        Config::DataSource::read(brotli.dictionary(), false, api), quality_);
+  }
+}
+
+BrotliCompressorImpl::EncoderMode BrotliCompressorFactory::encoderModeEnum(
+    envoy::extensions::compression::brotli::compressor::v3::Brotli::EncoderMode encoder_mode) {
+  switch (encoder_mode) {
+  case envoy::extensions::compression::brotli::compressor::v3::Brotli::GENERIC:
+    return BrotliCompressorImpl::EncoderMode::Generic;
+  case envoy::extensions::compression::brotli::compressor::v3::Brotli::TEXT:
+    return BrotliCompressorImpl::EncoderMode::Text;
+  case envoy::extensions::compression::brotli::compressor::v3::Brotli::FONT:
+    return BrotliCompressorImpl::EncoderMode::Font;
+  default:
+    return BrotliCompressorImpl::EncoderMode::Default;
+  }
+}
+
+Envoy::Compression::Compressor::CompressorPtr BrotliCompressorFactory::createCompressor() {
+  return std::make_unique<BrotliCompressorImpl>(quality_, window_bits_, input_block_bits_,
+                                                encoder_mode_, chunk_size_, dictionary_);
+}
+
+Envoy::Compression::Compressor::CompressorFactoryPtr
+BrotliCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
+    const envoy::extensions::compression::brotli::compressor::v3::Brotli& proto_config,
+    Server::Configuration::FactoryContext& context) {
+  return std::make_unique<BrotliCompressorFactory>(proto_config, context.api());
+}
+
+/**
+ * Static registration for the brotli compressor library. @see NamedCompressorLibraryConfigFactory.
+ */
+REGISTER_FACTORY(BrotliCompressorLibraryFactory,
+                 Envoy::Compression::Compressor::NamedCompressorLibraryConfigFactory);
+
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
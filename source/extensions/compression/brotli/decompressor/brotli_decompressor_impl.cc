@@ -0,0 +1,65 @@
+#include "extensions/compression/brotli/decompressor/brotli_decompressor_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Decompressor {
+
+BrotliDecompressorImpl::BrotliDecompressorImpl(Stats::Scope& scope,
+                                               const std::string& stats_prefix,
+                                               uint32_t chunk_size,
+                                               bool disable_ring_buffer_reallocation,
+                                               BrotliDictionarySharedPtr dictionary)
+    : Common::Base(chunk_size),
+      state_(BrotliDecoderCreateInstance(nullptr, nullptr, nullptr), &BrotliDecoderDestroyInstance),
+      dictionary_(std::move(dictionary)), stats_(generateStats(stats_prefix, scope)) {
+  RELEASE_ASSERT(state_ != nullptr, "unable to create the brotli decoder");
+  BROTLI_BOOL result =
+      BrotliDecoderSetParameter(state_.get(), BROTLI_DECODER_PARAM_DISABLE_RING_BUFFER_REALLOCATION,
+                                disable_ring_buffer_reallocation ? BROTLI_TRUE : BROTLI_FALSE);
+  RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  if (dictionary_ != nullptr) {
+    result = BrotliDecoderAttachDictionary(state_.get(), BROTLI_SHARED_DICTIONARY_RAW,
+                                           dictionary_->size(),
+                                           reinterpret_cast<const uint8_t*>(dictionary_->data()));
+    RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  }
+}
+
+void BrotliDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
+                                        Buffer::Instance& output_buffer) {
+  for (const Buffer::RawSlice& input_slice : input_buffer.getRawSlices()) {
+    avail_in_ = input_slice.len_;
+    next_in_ = static_cast<uint8_t*>(input_slice.mem_);
+    while (process(output_buffer)) {
+    }
+  }
+
+  // Flush the output chunk, so that its content doesn't wait for the next call to decompress().
+  finalizeOutput(output_buffer);
+}
+
+bool BrotliDecompressorImpl::process(Buffer::Instance& output_buffer) {
+  const BrotliDecoderResult result = BrotliDecoderDecompressStream(
+      state_.get(), &avail_in_, &next_in_, &avail_out_, &next_out_, nullptr);
+  if (result == BROTLI_DECODER_RESULT_ERROR) {
+    ENVOY_LOG(trace, "brotli decompression error: {}",
+              BrotliDecoderErrorString(BrotliDecoderGetErrorCode(state_.get())));
+    stats_.brotli_error_.inc();
+    return false;
+  }
+
+  updateOutput(output_buffer);
+  // The decoder stops whenever the output chunk is full, otherwise it has consumed all the input
+  // or reached the end of the stream.
+  return result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+}
+
+} // namespace Decompressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
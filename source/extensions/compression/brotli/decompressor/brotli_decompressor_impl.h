@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/compression/decompressor/decompressor.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/compression/brotli/common/base.h"
+
+#include "brotli/decode.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Decompressor {
+
+/**
+ * All brotli decompressor stats. @see stats_macros.h
+ */
+#define ALL_BROTLI_DECOMPRESSOR_STATS(COUNTER) COUNTER(brotli_error)
+
+/**
+ * Struct definition for brotli decompressor stats. @see stats_macros.h
+ */
+struct BrotliDecompressorStats {
+  ALL_BROTLI_DECOMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * The raw content of a shared dictionary. The decoder refers to it rather than copying it, so it
+ * is shared by all the decompressors which use it.
+ */
+using BrotliDictionarySharedPtr = std::shared_ptr<const std::string>;
+
+/**
+ * Implementation of decompressor's interface.
+ */
+class BrotliDecompressorImpl : public Common::Base,
+                               public Envoy::Compression::Decompressor::Decompressor,
+                               public Logger::Loggable<Logger::Id::decompression> {
+public:
+  /**
+   * @param scope supplies the scope of the error stats.
+   * @param stats_prefix supplies the prefix of the error stats.
+   * @param chunk_size amount of memory reserved for the decompressor output.
+   * @param disable_ring_buffer_reallocation if true, the ring buffer is allocated according to the
+   * window size rather than to the size of the content.
+   * @param dictionary supplies an optional shared dictionary, nullptr if there is none.
+   */
+  BrotliDecompressorImpl(Stats::Scope& scope, const std::string& stats_prefix,
+                         uint32_t chunk_size, bool disable_ring_buffer_reallocation,
+                         BrotliDictionarySharedPtr dictionary);
+
+  // Compression::Decompressor::Decompressor
+  void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
+
+private:
+  static BrotliDecompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return BrotliDecompressorStats{
+        ALL_BROTLI_DECOMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  bool process(Buffer::Instance& output_buffer);
+
+  const std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> state_;
+  const BrotliDictionarySharedPtr dictionary_;
+  const BrotliDecompressorStats stats_;
+};
+
+} // namespace Decompressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
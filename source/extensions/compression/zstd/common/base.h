@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/buffer/buffer.h"
+
+#include "zstd.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Common {
+
+/**
+ * Shared code between the compressor and the decompressor: the output chunk the zstd stream
+ * writes to.
+ */
+class Base {
+public:
+  Base(uint32_t chunk_size);
+
+protected:
+  /**
+   * Moves the output chunk into the output buffer once the chunk is full.
+   */
+  void updateOutput(Buffer::Instance& output_buffer);
+
+  /**
+   * Moves whatever the output chunk holds into the output buffer.
+   */
+  void finalizeOutput(Buffer::Instance& output_buffer);
+
+  const std::unique_ptr<uint8_t[]> chunk_ptr_;
+  ZSTD_outBuffer output_;
+};
+
+} // namespace Common
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
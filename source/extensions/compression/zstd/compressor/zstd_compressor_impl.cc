@@ -0,0 +1,79 @@
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+ZstdCDictSharedPtr createCDict(const std::string& data, uint32_t compression_level) {
+  ZSTD_CDict* cdict = ZSTD_createCDict(data.data(), data.size(), compression_level);
+  if (cdict == nullptr) {
+    throw EnvoyException("zstd: unable to digest the compression dictionary");
+  }
+  return {cdict, &ZSTD_freeCDict};
+}
+
+ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, uint32_t strategy,
+                                       uint32_t window_log, bool enable_checksum,
+                                       uint32_t chunk_size, ZstdCDictSharedPtr cdict)
+    : Common::Base(chunk_size), cctx_(ZSTD_createCCtx(), &ZSTD_freeCCtx), cdict_(std::move(cdict)) {
+  RELEASE_ASSERT(cctx_ != nullptr, "unable to create the zstd compression context");
+  setParameter(ZSTD_c_compressionLevel, compression_level);
+  setParameter(ZSTD_c_checksumFlag, enable_checksum);
+  // Zero leaves the choice to the compression level.
+  if (strategy != 0) {
+    setParameter(ZSTD_c_strategy, strategy);
+  }
+  if (window_log != 0) {
+    setParameter(ZSTD_c_windowLog, window_log);
+  }
+  if (cdict_ != nullptr) {
+    const size_t result = ZSTD_CCtx_refCDict(cctx_.get(), cdict_.get());
+    RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+  }
+}
+
+void ZstdCompressorImpl::setParameter(ZSTD_cParameter parameter, int value) {
+  const size_t result = ZSTD_CCtx_setParameter(cctx_.get(), parameter, value);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+}
+
+void ZstdCompressorImpl::compress(Buffer::Instance& buffer,
+                                  Envoy::Compression::Compressor::State state) {
+  for (const Buffer::RawSlice& input_slice : buffer.getRawSlices()) {
+    ZSTD_inBuffer input = {input_slice.mem_, input_slice.len_, 0};
+    // As with zlib, the output is appended to the end of the buffer while its input slices are
+    // processed, and the input is drained from the beginning of the buffer afterwards.
+    while (input.pos < input.size) {
+      process(buffer, input, ZSTD_e_continue);
+    }
+    buffer.drain(input_slice.len_);
+  }
+
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  const ZSTD_EndDirective mode =
+      state == Envoy::Compression::Compressor::State::Finish ? ZSTD_e_end : ZSTD_e_flush;
+  // The stream returns how much is left to flush, which needs more room than the output chunk had.
+  while (process(buffer, input, mode) != 0) {
+  }
+  finalizeOutput(buffer);
+}
+
+size_t ZstdCompressorImpl::process(Buffer::Instance& output_buffer, ZSTD_inBuffer& input,
+                                   ZSTD_EndDirective mode) {
+  const size_t result = ZSTD_compressStream2(cctx_.get(), &output_, &input, mode);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+  updateOutput(output_buffer);
+  return result;
+}
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
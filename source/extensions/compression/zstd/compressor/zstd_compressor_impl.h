@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/compression/compressor/compressor.h"
+
+#include "extensions/compression/zstd/common/base.h"
+
+#include "zstd.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+/**
+ * A shared dictionary, digested once and then referenced by every compressed stream. The digested
+ * dictionary is immutable, so it can be shared across workers.
+ */
+using ZstdCDictSharedPtr = std::shared_ptr<const ZSTD_CDict>;
+
+/**
+ * Digests a shared dictionary for the compressor.
+ * @param data supplies the dictionary, either trained by zstd or raw content.
+ * @param compression_level supplies the compression level the dictionary is digested for.
+ * @throw EnvoyException if the dictionary can't be digested.
+ */
+ZstdCDictSharedPtr createCDict(const std::string& data, uint32_t compression_level);
+
+/**
+ * Implementation of compressor's interface.
+ */
+class ZstdCompressorImpl : public Common::Base, public Envoy::Compression::Compressor::Compressor {
+public:
+  /**
+   * @param compression_level sets the compression level, from 1 (fastest) to 22 (best
+   * compression).
+   * @param strategy sets the compression strategy, @see ZSTD_strategy in the zstd manual. 0 lets
+   * the compression level choose the strategy.
+   * @param window_log sets the base two logarithmic of the history buffer's size. 0 lets the
+   * compression level choose the window.
+   * @param enable_checksum whether to write a checksum of the content at the end of each frame.
+   * @param chunk_size amount of memory reserved for the compressor output.
+   * @param cdict supplies an optional shared dictionary, nullptr if there is none.
+   */
+  ZstdCompressorImpl(uint32_t compression_level, uint32_t strategy, uint32_t window_log,
+                     bool enable_checksum, uint32_t chunk_size, ZstdCDictSharedPtr cdict);
+
+  // Compression::Compressor::Compressor
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
+
+private:
+  size_t process(Buffer::Instance& output_buffer, ZSTD_inBuffer& input, ZSTD_EndDirective mode);
+  void setParameter(ZSTD_cParameter parameter, int value);
+
+  const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx_;
+  const ZstdCDictSharedPtr cdict_;
+};
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
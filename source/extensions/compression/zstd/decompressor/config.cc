@@ -0,0 +1,50 @@
+#include "extensions/compression/zstd/decompressor/config.h"
+
+#include "common/config/datasource.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+
+namespace {
+// The largest window zstd accepts by default, @see ZSTD_WINDOWLOG_LIMIT_DEFAULT.
+const uint32_t DefaultWindowLogMax = 27;
+const uint32_t DefaultChunkSize = 4096;
+} // namespace
+
+ZstdDecompressorFactory::ZstdDecompressorFactory(
+    const envoy::extensions::compression::zstd::decompressor::v3::Zstd& zstd, Stats::Scope& scope,
+    Api::Api& api)
+    : scope_(scope),
+      window_log_max_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, window_log_max, DefaultWindowLogMax)),
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, chunk_size, DefaultChunkSize)) {
+  if (zstd.has_dictionary()) {
+    ddict_ = createDDict(Config::DataSource::read(zstd.dictionary(), false, api));
+  }
+}
+
+Envoy::Compression::Decompressor::DecompressorPtr
+ZstdDecompressorFactory::createDecompressor(const std::string& stats_prefix) {
+  return std::make_unique<ZstdDecompressorImpl>(scope_, stats_prefix, window_log_max_, chunk_size_,
+                                                ddict_);
+}
+
+Envoy::Compression::Decompressor::DecompressorFactoryPtr
+ZstdDecompressorLibraryFactory::createDecompressorFactoryFromProtoTyped(
+    const envoy::extensions::compression::zstd::decompressor::v3::Zstd& proto_config,
+    Server::Configuration::FactoryContext& context) {
+  return std::make_unique<ZstdDecompressorFactory>(proto_config, context.scope(), context.api());
+}
+
+/**
+ * Static registration for the zstd decompressor. @see NamedDecompressorLibraryConfigFactory.
+ */
+REGISTER_FACTORY(ZstdDecompressorLibraryFactory,
+                 Envoy::Compression::Decompressor::NamedDecompressorLibraryConfigFactory);
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
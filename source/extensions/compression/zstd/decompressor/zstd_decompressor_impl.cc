@@ -0,0 +1,84 @@
+#include "extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+
+ZstdDDictSharedPtr createDDict(const std::string& data) {
+  ZSTD_DDict* ddict = ZSTD_createDDict(data.data(), data.size());
+  if (ddict == nullptr) {
+    throw EnvoyException("zstd: unable to digest the decompression dictionary");
+  }
+  return {ddict, &ZSTD_freeDDict};
+}
+
+ZstdDecompressorImpl::ZstdDecompressorImpl(Stats::Scope& scope, const std::string& stats_prefix,
+                                           uint32_t window_log_max, uint32_t chunk_size,
+                                           ZstdDDictSharedPtr ddict)
+    : Common::Base(chunk_size), dctx_(ZSTD_createDCtx(), &ZSTD_freeDCtx), ddict_(std::move(ddict)),
+      stats_(generateStats(stats_prefix, scope)) {
+  RELEASE_ASSERT(dctx_ != nullptr, "unable to create the zstd decompression context");
+  size_t result = ZSTD_DCtx_setParameter(dctx_.get(), ZSTD_d_windowLogMax, window_log_max);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+  if (ddict_ != nullptr) {
+    result = ZSTD_DCtx_refDDict(dctx_.get(), ddict_.get());
+    RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+  }
+}
+
+void ZstdDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
+                                      Buffer::Instance& output_buffer) {
+  for (const Buffer::RawSlice& input_slice : input_buffer.getRawSlices()) {
+    ZSTD_inBuffer input = {input_slice.mem_, input_slice.len_, 0};
+    while (process(output_buffer, input)) {
+    }
+  }
+
+  // Flush the output chunk, so that its content doesn't wait for the next call to decompress().
+  finalizeOutput(output_buffer);
+}
+
+bool ZstdDecompressorImpl::process(Buffer::Instance& output_buffer, ZSTD_inBuffer& input) {
+  const size_t result = ZSTD_decompressStream(dctx_.get(), &output_, &input);
+  if (ZSTD_isError(result)) {
+    ENVOY_LOG(trace, "zstd decompression error: {}", ZSTD_getErrorName(result));
+    chargeErrorStats(result);
+    return false;
+  }
+
+  // When the output chunk is full, the stream may hold more output even if all the input has been
+  // consumed.
+  const bool output_full = output_.pos == output_.size;
+  updateOutput(output_buffer);
+  return input.pos < input.size || output_full;
+}
+
+void ZstdDecompressorImpl::chargeErrorStats(size_t result) {
+  switch (ZSTD_getErrorCode(result)) {
+  case ZSTD_error_dictionary_corrupted:
+  case ZSTD_error_dictionary_wrong:
+    stats_.zstd_dictionary_error_.inc();
+    break;
+  case ZSTD_error_checksum_wrong:
+    stats_.zstd_checksum_wrong_error_.inc();
+    break;
+  case ZSTD_error_memory_allocation:
+    stats_.zstd_memory_error_.inc();
+    break;
+  default:
+    stats_.zstd_generic_error_.inc();
+    break;
+  }
+}
+
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
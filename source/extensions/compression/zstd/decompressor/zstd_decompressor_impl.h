@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/compression/decompressor/decompressor.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/compression/zstd/common/base.h"
+
+#include "zstd.h"
+#include "zstd_errors.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+
+/**
+ * All zstd decompressor stats. @see stats_macros.h
+ */
+#define ALL_ZSTD_DECOMPRESSOR_STATS(COUNTER)                                                       \
+  COUNTER(zstd_generic_error)                                                                      \
+  COUNTER(zstd_dictionary_error)                                                                   \
+  COUNTER(zstd_checksum_wrong_error)                                                               \
+  COUNTER(zstd_memory_error)
+
+/**
+ * Struct definition for zstd decompressor stats. @see stats_macros.h
+ */
+struct ZstdDecompressorStats {
+  ALL_ZSTD_DECOMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * A shared dictionary, digested once and then referenced by every decompressed stream. The
+ * digested dictionary is immutable, so it can be shared across workers.
+ */
+using ZstdDDictSharedPtr = std::shared_ptr<const ZSTD_DDict>;
+
+/**
+ * Digests a shared dictionary for the decompressor.
+ * @param data supplies the dictionary, either trained by zstd or raw content.
+ * @throw EnvoyException if the dictionary can't be digested.
+ */
+ZstdDDictSharedPtr createDDict(const std::string& data);
+
+/**
+ * Implementation of decompressor's interface.
+ */
+class ZstdDecompressorImpl : public Common::Base,
+                             public Envoy::Compression::Decompressor::Decompressor,
+                             public Logger::Loggable<Logger::Id::decompression> {
+public:
+  /**
+   * @param scope supplies the scope of the error stats.
+   * @param stats_prefix supplies the prefix of the error stats.
+   * @param window_log_max sets the base two logarithmic of the largest window accepted.
+   * @param chunk_size amount of memory reserved for the decompressor output.
+   * @param ddict supplies an optional shared dictionary, nullptr if there is none.
+   */
+  ZstdDecompressorImpl(Stats::Scope& scope, const std::string& stats_prefix,
+                       uint32_t window_log_max, uint32_t chunk_size, ZstdDDictSharedPtr ddict);
+
+  // Compression::Decompressor::Decompressor
+  void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
+
+private:
+  static ZstdDecompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return ZstdDecompressorStats{ALL_ZSTD_DECOMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  bool process(Buffer::Instance& output_buffer, ZSTD_inBuffer& input);
+  void chargeErrorStats(size_t result);
+
+  const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx_;
+  const ZstdDDictSharedPtr ddict_;
+  const ZstdDecompressorStats stats_;
+};
+
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -2,6 +2,7 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -25,6 +26,9 @@ Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::Respons
 // Default minimum length of an upstream response that allows compression.
 const uint64_t DefaultMinimumContentLength = 30;
 
+// Default maximum size of a compressed body held by the response cache.
+const uint64_t DefaultMaxCachedBodyBytes = 1024 * 1024;
+
 // Default content types will be used if any is provided by the user.
 const std::vector<std::string>& defaultContentEncoding() {
   CONSTRUCT_ON_FIRST_USE(
@@ -54,7 +58,7 @@ CompressorFilterConfig::CompressorFilterConfig(
       disable_on_etag_header_(compressor.disable_on_etag_header()),
       remove_accept_encoding_header_(compressor.remove_accept_encoding_header()),
       stats_(generateStats(stats_prefix, scope)), enabled_(compressor.runtime_enabled(), runtime),
-      content_encoding_(content_encoding) {}
+      content_encoding_(content_encoding), response_cache_(responseCachePtr(compressor)) {}
 
 StringUtil::CaseUnorderedSet
 CompressorFilterConfig::contentTypeSet(const Protobuf::RepeatedPtrField<std::string>& types) {
@@ -68,6 +72,17 @@ uint32_t CompressorFilterConfig::contentLengthUint(Protobuf::uint32 length) {
   return length > 0 ? length : DefaultMinimumContentLength;
 }
 
+CompressedResponseCachePtr CompressorFilterConfig::responseCachePtr(
+    const envoy::extensions::filters::http::compressor::v3::Compressor& compressor) {
+  if (!compressor.has_response_cache()) {
+    return nullptr;
+  }
+  return std::make_unique<CompressedResponseCache>(
+      compressor.response_cache().max_bytes(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(compressor.response_cache(), max_entry_bytes,
+                                      DefaultMaxCachedBodyBytes));
+}
+
 CompressorFilter::CompressorFilter(const CompressorFilterConfigSharedPtr config)
     : skip_compression_{true}, config_(std::move(config)) {}
 
@@ -79,6 +94,10 @@ Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::RequestHeaderMap
     accept_encoding_ = std::make_unique<std::string>(accept_encoding->value().getStringView());
   }
 
+  if (config_->responseCache() != nullptr) {
+    request_key_ = absl::StrCat(headers.getHostValue(), headers.getPathValue());
+  }
+
   if (config_->enabled() && config_->removeAcceptEncodingHeader()) {
     headers.removeInline(accept_encoding_handle.handle());
   }
@@ -119,12 +138,16 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
   if (!end_stream && isEnabledAndContentLengthBigEnough && isAcceptEncodingAllowed(headers) &&
       isCompressible && isTransferEncodingAllowed(headers)) {
     skip_compression_ = false;
+    // The cache is keyed by the strong etag, so look it up before the etag is sanitized.
+    lookupResponseCache(headers);
     sanitizeEtagHeader(headers);
     headers.removeContentLength();
     headers.setInline(content_encoding_handle.handle(), config_->contentEncoding());
     config_->stats().compressed_.inc();
-    // Finally instantiate the compressor.
-    compressor_ = config_->makeCompressor();
+    if (cached_body_ == nullptr) {
+      // Finally instantiate the compressor.
+      compressor_ = config_->makeCompressor();
+    }
   } else {
     config_->stats().not_compressed_.inc();
   }
@@ -142,8 +165,15 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
 Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
   if (!skip_compression_) {
     config_->stats().total_uncompressed_bytes_.add(data.length());
-    compressor_->compress(data, end_stream ? Envoy::Compression::Compressor::State::Finish
-                                           : Envoy::Compression::Compressor::State::Flush);
+    if (cached_body_ != nullptr) {
+      // The upstream body is identical to the one the cached body was compressed from.
+      data.drain(data.length());
+      addCachedBody(data);
+    } else {
+      compressor_->compress(data, end_stream ? Envoy::Compression::Compressor::State::Finish
+                                             : Envoy::Compression::Compressor::State::Flush);
+      recordCompressedData(data, end_stream);
+    }
     config_->stats().total_compressed_bytes_.add(data.length());
   }
   return Http::FilterDataStatus::Continue;
@@ -152,7 +182,12 @@ Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool
 Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTrailerMap&) {
   if (!skip_compression_) {
     Buffer::OwnedImpl empty_buffer;
-    compressor_->compress(empty_buffer, Envoy::Compression::Compressor::State::Finish);
+    if (cached_body_ != nullptr) {
+      addCachedBody(empty_buffer);
+    } else {
+      compressor_->compress(empty_buffer, Envoy::Compression::Compressor::State::Finish);
+      recordCompressedData(empty_buffer, true);
+    }
     config_->stats().total_compressed_bytes_.add(empty_buffer.length());
     encoder_callbacks_->addEncodedData(empty_buffer, true);
   }
@@ -447,6 +482,81 @@ void CompressorFilter::sanitizeEtagHeader(Http::ResponseHeaderMap& headers) {
   }
 }
 
+// Responses are cached only if they are complete, the same for every client given the request's
+// authority and path, and identified by a strong etag.
+std::string CompressorFilter::responseCacheKey(const Http::ResponseHeaderMap& headers) const {
+  const Http::HeaderEntry* etag = headers.getInline(etag_handle.handle());
+  if (etag == nullptr || headers.getStatusValue() != "200") {
+    return EMPTY_STRING;
+  }
+  const absl::string_view value = etag->value().getStringView();
+  if (value.length() <= 2 || ((value[0] == 'w' || value[0] == 'W') && value[1] == '/')) {
+    return EMPTY_STRING;
+  }
+  const Http::HeaderEntry* cache_control = headers.getInline(cache_control_handle.handle());
+  if (cache_control != nullptr &&
+      StringUtil::caseFindToken(cache_control->value().getStringView(), ",",
+                                Http::CustomHeaders::get().CacheControlValues.NoStore)) {
+    return EMPTY_STRING;
+  }
+  return absl::StrCat(request_key_, "\n", value);
+}
+
+void CompressorFilter::lookupResponseCache(const Http::ResponseHeaderMap& headers) {
+  CompressedResponseCache* cache = config_->responseCache();
+  if (cache == nullptr) {
+    return;
+  }
+  std::string key = responseCacheKey(headers);
+  if (key.empty()) {
+    return;
+  }
+  cached_body_ = cache->lookup(key);
+  if (cached_body_ != nullptr) {
+    config_->stats().response_cache_hit_.inc();
+    return;
+  }
+  config_->stats().response_cache_miss_.inc();
+  response_cache_key_ = std::move(key);
+}
+
+void CompressorFilter::addCachedBody(Buffer::Instance& data) {
+  if (cached_body_sent_) {
+    return;
+  }
+  cached_body_sent_ = true;
+  // The fragment keeps the cached body alive until the connection has written it out.
+  auto fragment = new Buffer::BufferFragmentImpl(
+      cached_body_->data(), cached_body_->size(),
+      [body = cached_body_](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+        delete fragment;
+      });
+  data.addBufferFragment(*fragment);
+}
+
+void CompressorFilter::recordCompressedData(const Buffer::Instance& data, bool end_stream) {
+  if (response_cache_key_.empty()) {
+    return;
+  }
+  CompressedResponseCache& cache = *config_->responseCache();
+  if (compressed_body_.size() + data.length() > cache.maxEntryBytes()) {
+    // Too large to cache, stop recording.
+    response_cache_key_.clear();
+    compressed_body_.clear();
+    compressed_body_.shrink_to_fit();
+    return;
+  }
+  for (const Buffer::RawSlice& slice : data.getRawSlices()) {
+    compressed_body_.append(static_cast<const char*>(slice.mem_), slice.len_);
+  }
+  if (end_stream) {
+    config_->stats().response_cache_insert_.inc();
+    config_->stats().response_cache_evicted_.add(cache.insert(
+        response_cache_key_, std::make_shared<const std::string>(std::move(compressed_body_))));
+    response_cache_key_.clear();
+  }
+}
+
 } // namespace Compressors
 } // namespace Common
 } // namespace HttpFilters
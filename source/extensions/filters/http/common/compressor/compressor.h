@@ -9,6 +9,7 @@
 #include "common/protobuf/protobuf.h"
 #include "common/runtime/runtime_protos.h"
 
+#include "extensions/filters/http/common/compressor/response_cache.h"
 #include "extensions/filters/http/common/pass_through_filter.h"
 
 namespace Envoy {
@@ -32,6 +33,9 @@ namespace Compressors {
  *
  * "header_gzip" is specific to the gzip filter and is deprecated since it duplicates
  * "header_compressor_used".
+ *
+ * "response_cache_hit" and "response_cache_miss" count the compressed responses which could be
+ * served from the response cache, and "response_cache_evicted" the bodies evicted from it.
  */
 #define ALL_COMPRESSOR_STATS(COUNTER)                                                              \
   COUNTER(compressed)                                                                              \
@@ -46,7 +50,11 @@ namespace Compressors {
   COUNTER(total_uncompressed_bytes)                                                                \
   COUNTER(total_compressed_bytes)                                                                  \
   COUNTER(content_length_too_small)                                                                \
-  COUNTER(not_compressed_etag)
+  COUNTER(not_compressed_etag)                                                                     \
+  COUNTER(response_cache_hit)                                                                      \
+  COUNTER(response_cache_miss)                                                                     \
+  COUNTER(response_cache_insert)                                                                   \
+  COUNTER(response_cache_evicted)
 
 /**
  * Struct definition for compressor stats. @see stats_macros.h
@@ -71,6 +79,8 @@ public:
   bool removeAcceptEncodingHeader() const { return remove_accept_encoding_header_; }
   uint32_t minimumLength() const { return content_length_; }
   const std::string contentEncoding() const { return content_encoding_; };
+  // The cache of compressed bodies, or nullptr if it isn't configured.
+  CompressedResponseCache* responseCache() const { return response_cache_.get(); }
 
 protected:
   CompressorFilterConfig(
@@ -84,6 +94,9 @@ private:
 
   static uint32_t contentLengthUint(Protobuf::uint32 length);
 
+  static CompressedResponseCachePtr responseCachePtr(
+      const envoy::extensions::filters::http::compressor::v3::Compressor& compressor);
+
   static CompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
     return CompressorStats{ALL_COMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
   }
@@ -96,6 +109,7 @@ private:
   const CompressorStats stats_;
   Runtime::FeatureFlag enabled_;
   const std::string content_encoding_;
+  const CompressedResponseCachePtr response_cache_;
 };
 using CompressorFilterConfigSharedPtr = std::shared_ptr<CompressorFilterConfig>;
 
@@ -128,6 +142,11 @@ private:
   void sanitizeEtagHeader(Http::ResponseHeaderMap& headers);
   void insertVaryHeader(Http::ResponseHeaderMap& headers);
 
+  std::string responseCacheKey(const Http::ResponseHeaderMap& headers) const;
+  void lookupResponseCache(const Http::ResponseHeaderMap& headers);
+  void addCachedBody(Buffer::Instance& data);
+  void recordCompressedData(const Buffer::Instance& data, bool end_stream);
+
   class EncodingDecision : public StreamInfo::FilterState::Object {
   public:
     enum class HeaderStat { NotValid, Identity, Wildcard, ValidCompressor };
@@ -148,6 +167,14 @@ private:
   Envoy::Compression::Compressor::CompressorPtr compressor_;
   const CompressorFilterConfigSharedPtr config_;
   std::unique_ptr<std::string> accept_encoding_;
+  // The request's authority and path, captured only if the response cache is configured.
+  std::string request_key_;
+  // The cached compressed body sent instead of the upstream body on a response cache hit.
+  CompressedBodySharedPtr cached_body_;
+  bool cached_body_sent_{};
+  // On a response cache miss, the key and the compressed body to insert once the stream ends.
+  std::string response_cache_key_;
+  std::string compressed_body_;
 };
 
 } // namespace Compressors
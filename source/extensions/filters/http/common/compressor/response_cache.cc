@@ -0,0 +1,64 @@
+#include "extensions/filters/http/common/compressor/response_cache.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Common {
+namespace Compressors {
+
+CompressedResponseCache::CompressedResponseCache(uint64_t max_bytes, uint64_t max_entry_bytes)
+    : max_bytes_(max_bytes), max_entry_bytes_(std::min(max_bytes, max_entry_bytes)) {}
+
+CompressedBodySharedPtr CompressedResponseCache::lookup(const std::string& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->second;
+}
+
+uint64_t CompressedResponseCache::insert(const std::string& key, CompressedBodySharedPtr body) {
+  ASSERT(body != nullptr);
+  if (body->size() > max_entry_bytes_) {
+    return 0;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    removeLocked(it->second);
+  }
+  uint64_t evicted = 0;
+  while (bytes_ + body->size() > max_bytes_) {
+    ASSERT(!lru_.empty());
+    removeLocked(std::prev(lru_.end()));
+    ++evicted;
+  }
+  bytes_ += body->size();
+  lru_.emplace_front(key, std::move(body));
+  entries_.emplace(key, lru_.begin());
+  return evicted;
+}
+
+uint64_t CompressedResponseCache::bytes() {
+  absl::MutexLock lock(&mutex_);
+  return bytes_;
+}
+
+void CompressedResponseCache::removeLocked(std::list<Entry>::iterator it) {
+  bytes_ -= it->second->size();
+  entries_.erase(it->first);
+  lru_.erase(it);
+}
+
+} // namespace Compressors
+} // namespace Common
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Common {
+namespace Compressors {
+
+using CompressedBodySharedPtr = std::shared_ptr<const std::string>;
+
+/**
+ * A byte-bounded LRU cache of compressed response bodies, shared by the workers. The bodies are
+ * immutable, so a body handed out by lookup() stays valid after it has been evicted.
+ */
+class CompressedResponseCache {
+public:
+  CompressedResponseCache(uint64_t max_bytes, uint64_t max_entry_bytes);
+
+  /**
+   * @return the compressed body cached for the key, or nullptr.
+   */
+  CompressedBodySharedPtr lookup(const std::string& key);
+
+  /**
+   * Caches a compressed body, replacing the body previously cached for the key.
+   * @return the number of bodies evicted to make room for the new one.
+   */
+  uint64_t insert(const std::string& key, CompressedBodySharedPtr body);
+
+  /**
+   * @return the maximum size of a single body the cache accepts.
+   */
+  uint64_t maxEntryBytes() const { return max_entry_bytes_; }
+
+  /**
+   * @return the total size of the cached bodies.
+   */
+  uint64_t bytes();
+
+private:
+  using Entry = std::pair<std::string, CompressedBodySharedPtr>;
+
+  void removeLocked(std::list<Entry>::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const uint64_t max_bytes_;
+  const uint64_t max_entry_bytes_;
+  absl::Mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> lru_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> entries_ ABSL_GUARDED_BY(mutex_);
+  uint64_t bytes_ ABSL_GUARDED_BY(mutex_){};
+};
+
+using CompressedResponseCachePtr = std::unique_ptr<CompressedResponseCache>;
+
+} // namespace Compressors
+} // namespace Common
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
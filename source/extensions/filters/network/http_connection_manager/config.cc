@@ -36,6 +36,7 @@
 #include "common/runtime/runtime_impl.h"
 #include "common/tracing/http_tracer_config_impl.h"
 #include "common/tracing/http_tracer_manager_impl.h"
+#include "common/tracing/tail_sampling_impl.h"
 
 #include "extensions/filters/http/common/pass_through_filter.h"
 
@@ -406,6 +407,19 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
     const uint32_t max_path_tag_length = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
         tracing_config, max_path_tag_length, Tracing::DefaultMaxPathTagLength);
 
+    if (tracing_config.has_tail_sampling()) {
+      const auto& tail_sampling = tracing_config.tail_sampling();
+      http_tracer_ = std::make_shared<Tracing::TailSamplingHttpTracer>(
+          http_tracer_,
+          Tracing::TailSamplingConfig{
+              PROTOBUF_GET_WRAPPED_OR_DEFAULT(tail_sampling, max_buffered_spans, 1024),
+              PROTOBUF_GET_OPTIONAL_MS(tail_sampling, min_duration),
+              tail_sampling.sample_errors()},
+          context_.threadLocal(), context_.timeSource(),
+          Tracing::TailSamplingHttpTracer::generateStats(stats_prefix_ + "tracing.",
+                                                         context_.scope()));
+    }
+
     tracing_config_ =
         std::make_unique<Http::TracingConnectionManagerConfig>(Http::TracingConnectionManagerConfig{
             tracing_operation_name, custom_tags, client_sampling, random_sampling, overall_sampling,
@@ -0,0 +1,352 @@
+#include "extensions/private_key_providers/thread_pool/thread_pool_provider.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#include "envoy/common/exception.h"
+#include "envoy/singleton/manager.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/config/datasource.h"
+#include "common/protobuf/utility.h"
+
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+PrivateKeyOperation::PrivateKeyOperation(Type type, EVP_PKEY* pkey, uint16_t signature_algorithm,
+                                         const uint8_t* in, size_t in_len,
+                                         Ssl::PrivateKeyConnectionCallbacks& cb,
+                                         Event::Dispatcher& dispatcher)
+    : type_(type), pkey_(bssl::UpRef(pkey)), signature_algorithm_(signature_algorithm),
+      input_(in, in + in_len), cb_(&cb), dispatcher_(&dispatcher) {}
+
+void PrivateKeyOperation::run() {
+  {
+    Thread::LockGuard guard(lock_);
+    if (dispatcher_ == nullptr) {
+      // The connection went away while the operation was queued.
+      return;
+    }
+  }
+
+  failed_ = !(type_ == Type::Sign ? sign() : decrypt());
+
+  Thread::LockGuard guard(lock_);
+  if (dispatcher_ != nullptr) {
+    dispatcher_->post([self = shared_from_this()]() { self->onComplete(); });
+  }
+}
+
+void PrivateKeyOperation::cancel() {
+  cb_ = nullptr;
+  Thread::LockGuard guard(lock_);
+  dispatcher_ = nullptr;
+}
+
+void PrivateKeyOperation::onComplete() {
+  if (cb_ == nullptr) {
+    return;
+  }
+  done_ = true;
+  cb_->onPrivateKeyMethodComplete();
+}
+
+bool PrivateKeyOperation::sign() {
+  EVP_PKEY* pkey = pkey_.get();
+  if (SSL_get_signature_algorithm_key_type(signature_algorithm_) != EVP_PKEY_id(pkey)) {
+    return false;
+  }
+
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pkey_ctx;
+  if (!EVP_DigestSignInit(ctx.get(), &pkey_ctx,
+                          SSL_get_signature_algorithm_digest(signature_algorithm_), nullptr,
+                          pkey)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+    return false;
+  }
+
+  size_t out_len = EVP_PKEY_size(pkey);
+  output_.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), output_.data(), &out_len, input_.data(), input_.size())) {
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+bool PrivateKeyOperation::decrypt() {
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+  if (rsa == nullptr) {
+    return false;
+  }
+
+  size_t out_len = RSA_size(rsa);
+  output_.resize(out_len);
+  if (!RSA_decrypt(rsa, &out_len, output_.data(), output_.size(), input_.data(), input_.size(),
+                   RSA_NO_PADDING)) {
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+PrivateKeyThreadPool::PrivateKeyThreadPool(Thread::ThreadFactory& thread_factory,
+                                           uint32_t num_threads, uint32_t max_batch_size)
+    : max_batch_size_(max_batch_size) {
+  Thread::Options options{"keyprovider"};
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads_.push_back(thread_factory.createThread([this]() -> void { threadRoutine(); }, options));
+  }
+}
+
+PrivateKeyThreadPool::~PrivateKeyThreadPool() {
+  {
+    Thread::LockGuard guard(lock_);
+    shutdown_ = true;
+  }
+  queue_not_empty_.notifyAll();
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyThreadPool::enqueue(PrivateKeyOperationSharedPtr operation) {
+  {
+    Thread::LockGuard guard(lock_);
+    queue_.push_back(std::move(operation));
+  }
+  queue_not_empty_.notifyOne();
+}
+
+void PrivateKeyThreadPool::threadRoutine() {
+  std::vector<PrivateKeyOperationSharedPtr> batch;
+  batch.reserve(max_batch_size_);
+  while (true) {
+    {
+      Thread::LockGuard guard(lock_);
+      while (queue_.empty() && !shutdown_) {
+        queue_not_empty_.wait(lock_);
+      }
+      if (shutdown_) {
+        // The connections of any queued operations are gone, as they hold on to their provider,
+        // which holds on to the pool.
+        return;
+      }
+      const size_t batch_size = std::min<size_t>(queue_.size(), max_batch_size_);
+      std::move(queue_.begin(), queue_.begin() + batch_size, std::back_inserter(batch));
+      queue_.erase(queue_.begin(), queue_.begin() + batch_size);
+      if (!queue_.empty()) {
+        // Let another thread take on the rest.
+        queue_not_empty_.notifyOne();
+      }
+    }
+
+    ENVOY_LOG(trace, "performing {} private key operations", batch.size());
+    for (PrivateKeyOperationSharedPtr& operation : batch) {
+      operation->run();
+    }
+    batch.clear();
+  }
+}
+
+PrivateKeyThreadPoolSharedPtr PrivateKeyThreadPoolManager::get(uint32_t num_threads,
+                                                               uint32_t max_batch_size) {
+  std::weak_ptr<PrivateKeyThreadPool>& entry = pools_[{num_threads, max_batch_size}];
+  PrivateKeyThreadPoolSharedPtr pool = entry.lock();
+  if (pool == nullptr) {
+    pool = std::make_shared<PrivateKeyThreadPool>(thread_factory_, num_threads, max_batch_size);
+    entry = pool;
+  }
+  return pool;
+}
+
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(private_key_thread_pool_manager);
+
+ThreadPoolPrivateKeyConnection::~ThreadPoolPrivateKeyConnection() {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::start(PrivateKeyOperation::Type type,
+                                                               uint16_t signature_algorithm,
+                                                               const uint8_t* in, size_t in_len) {
+  if (operation_ != nullptr) {
+    // BoringSSL only starts an operation once the previous one completed.
+    return ssl_private_key_failure;
+  }
+  operation_ = std::make_shared<PrivateKeyOperation>(type, pkey_, signature_algorithm, in, in_len,
+                                                     cb_, dispatcher_);
+  thread_pool_.enqueue(operation_);
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                                  size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!operation_->done()) {
+    return ssl_private_key_retry;
+  }
+
+  PrivateKeyOperationSharedPtr operation = std::move(operation_);
+  const std::vector<uint8_t>& output = operation->output();
+  if (operation->failed() || output.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(output.begin(), output.end(), out);
+  *out_len = output.size();
+  return ssl_private_key_success;
+}
+
+namespace {
+
+ThreadPoolPrivateKeyConnection* getConnection(SSL* ssl, int index) {
+  return static_cast<ThreadPoolPrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+}
+
+template <int (*Index)()>
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t*, size_t*, size_t,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl, Index());
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->start(PrivateKeyOperation::Type::Sign, signature_algorithm, in, in_len);
+}
+
+template <int (*Index)()>
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t*, size_t*, size_t, const uint8_t* in,
+                                           size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl, Index());
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->start(PrivateKeyOperation::Type::Decrypt, 0, in, in_len);
+}
+
+template <int (*Index)()>
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl, Index());
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->complete(out, out_len, max_out);
+}
+
+template <int (*Index)()> Ssl::BoringSslPrivateKeyMethodSharedPtr createMethod() {
+  auto method = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method->sign = privateKeySign<Index>;
+  method->decrypt = privateKeyDecrypt<Index>;
+  method->complete = privateKeyComplete<Index>;
+  return method;
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+int ThreadPoolPrivateKeyMethodProvider::rsaConnectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+int ThreadPoolPrivateKeyMethodProvider::ecdsaConnectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::extensions::private_key_providers::thread_pool::v3alpha::
+        ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  const std::string private_key =
+      Config::DataSource::read(config.private_key(), false, factory_context.api());
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey_ == nullptr) {
+    throw EnvoyException("Failed to load private key for the thread pool private key provider");
+  }
+
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_RSA:
+    method_ = createMethod<&ThreadPoolPrivateKeyMethodProvider::rsaConnectionIndex>();
+    break;
+  case EVP_PKEY_EC:
+    method_ = createMethod<&ThreadPoolPrivateKeyMethodProvider::ecdsaConnectionIndex>();
+    break;
+  default:
+    throw EnvoyException("The thread pool private key provider only supports RSA and ECDSA keys");
+  }
+
+  thread_pool_manager_ = factory_context.singletonManager().getTyped<PrivateKeyThreadPoolManager>(
+      SINGLETON_MANAGER_REGISTERED_NAME(private_key_thread_pool_manager), [&factory_context] {
+        return std::make_shared<PrivateKeyThreadPoolManager>(
+            factory_context.api().threadFactory());
+      });
+  thread_pool_ =
+      thread_pool_manager_->get(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, num_threads, 1),
+                                PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_size, 16));
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() const {
+  return EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA ? rsaConnectionIndex() : ecdsaConnectionIndex();
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  const int index = connectionIndex();
+  if (SSL_get_ex_data(ssl, index) != nullptr) {
+    throw EnvoyException(
+        "Can't distinguish between two registered providers for the same SSL object.");
+  }
+  SSL_set_ex_data(ssl, index, new ThreadPoolPrivateKeyConnection(cb, dispatcher, pkey_.get(),
+                                                                 *thread_pool_));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  const int index = connectionIndex();
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl, index);
+  SSL_set_ex_data(ssl, index, nullptr);
+  delete connection;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  if (EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA) {
+    RSA* rsa_private_key = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa_private_key != nullptr && RSA_check_fips(rsa_private_key);
+  }
+  const EC_KEY* ecdsa_private_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+  return ecdsa_private_key != nullptr && EC_KEY_check_fips(ecdsa_private_key);
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
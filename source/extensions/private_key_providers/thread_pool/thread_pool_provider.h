@@ -0,0 +1,182 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3alpha/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+/**
+ * A private key operation performed on the thread pool on behalf of a connection. The operation is
+ * owned jointly by the connection and the thread pool, so either can let go of it first.
+ */
+class PrivateKeyOperation : public std::enable_shared_from_this<PrivateKeyOperation> {
+public:
+  enum class Type { Sign, Decrypt };
+
+  PrivateKeyOperation(Type type, EVP_PKEY* pkey, uint16_t signature_algorithm, const uint8_t* in,
+                      size_t in_len, Ssl::PrivateKeyConnectionCallbacks& cb,
+                      Event::Dispatcher& dispatcher);
+
+  /**
+   * Perform the operation and post its completion to the dispatcher of the connection. Called on
+   * a thread pool thread.
+   */
+  void run();
+
+  /**
+   * Stop the completion from reaching the connection. Called on the worker thread of the
+   * connection.
+   */
+  void cancel();
+
+  // The accessors below may only be used on the worker thread of the connection.
+  bool done() const { return done_; }
+  bool failed() const { return failed_; }
+  const std::vector<uint8_t>& output() const { return output_; }
+
+private:
+  bool sign();
+  bool decrypt();
+  void onComplete();
+
+  const Type type_;
+  // The pool is shared with other providers, which may outlive the provider of the key.
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  // Only written by run(), which happens before the completion is posted.
+  std::vector<uint8_t> output_;
+  bool failed_{};
+  // Only used on the worker thread of the connection, nullptr once cancelled.
+  Ssl::PrivateKeyConnectionCallbacks* cb_;
+  bool done_{};
+
+  Thread::MutexBasicLockable lock_;
+  // The dispatcher is guaranteed to outlive the connection, but not the operation.
+  Event::Dispatcher* dispatcher_ ABSL_GUARDED_BY(lock_);
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+/**
+ * A fixed set of threads performing queued private key operations, for any key. Each thread takes
+ * on up to max_batch_size operations at once.
+ */
+class PrivateKeyThreadPool : Logger::Loggable<Logger::Id::connection> {
+public:
+  PrivateKeyThreadPool(Thread::ThreadFactory& thread_factory, uint32_t num_threads,
+                       uint32_t max_batch_size);
+  ~PrivateKeyThreadPool();
+
+  void enqueue(PrivateKeyOperationSharedPtr operation);
+
+private:
+  void threadRoutine();
+
+  const uint32_t max_batch_size_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar queue_not_empty_;
+  std::deque<PrivateKeyOperationSharedPtr> queue_ ABSL_GUARDED_BY(lock_);
+  bool shutdown_ ABSL_GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+using PrivateKeyThreadPoolSharedPtr = std::shared_ptr<PrivateKeyThreadPool>;
+
+/**
+ * The thread pools in use, shared by the providers configured with the same number of threads and
+ * batch size, however many certificates use the provider. Only used from the main thread.
+ */
+class PrivateKeyThreadPoolManager : public Singleton::Instance {
+public:
+  PrivateKeyThreadPoolManager(Thread::ThreadFactory& thread_factory)
+      : thread_factory_(thread_factory) {}
+
+  /**
+   * @return the thread pool of the given size, which is created unless a provider still uses it.
+   */
+  PrivateKeyThreadPoolSharedPtr get(uint32_t num_threads, uint32_t max_batch_size);
+
+private:
+  Thread::ThreadFactory& thread_factory_;
+  absl::flat_hash_map<std::pair<uint32_t, uint32_t>, std::weak_ptr<PrivateKeyThreadPool>> pools_;
+};
+
+using PrivateKeyThreadPoolManagerSharedPtr = std::shared_ptr<PrivateKeyThreadPoolManager>;
+
+/**
+ * The private key operation state of a connection, stored in the SSL object.
+ */
+class ThreadPoolPrivateKeyConnection {
+public:
+  ThreadPoolPrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher, EVP_PKEY* pkey,
+                                 PrivateKeyThreadPool& thread_pool)
+      : cb_(cb), dispatcher_(dispatcher), pkey_(pkey), thread_pool_(thread_pool) {}
+  ~ThreadPoolPrivateKeyConnection();
+
+  ssl_private_key_result_t start(PrivateKeyOperation::Type type, uint16_t signature_algorithm,
+                                 const uint8_t* in, size_t in_len);
+  ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+private:
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  // The provider, which owns the key and the pool, outlives its connections.
+  EVP_PKEY* const pkey_;
+  PrivateKeyThreadPool& thread_pool_;
+  PrivateKeyOperationSharedPtr operation_;
+};
+
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::private_key_providers::thread_pool::v3alpha::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  // An RSA and an ECDSA certificate of the same context register on the same SSL object, so each
+  // key type keeps its connection state in its own index.
+  static int rsaConnectionIndex();
+  static int ecdsaConnectionIndex();
+
+private:
+  int connectionIndex() const;
+
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  // The singleton manager only keeps the pool manager while a provider holds on to it.
+  PrivateKeyThreadPoolManagerSharedPtr thread_pool_manager_;
+  PrivateKeyThreadPoolSharedPtr thread_pool_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -85,6 +85,10 @@ public:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
   bool aboveHighWatermark() const override;
+  bool buffersEmpty() const override {
+    // Only used to hand TCP connections over on hot restart.
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
 
   const Network::ConnectionSocket::OptionsSharedPtr& socketOptions() const override;
   StreamInfo::StreamInfo& streamInfo() override { return stream_info_; }
@@ -0,0 +1,29 @@
+#include "extensions/resource_monitors/event_loop_latency/config.h"
+
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.h"
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/resource_monitors/event_loop_latency/event_loop_latency_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLatencyMonitor {
+
+Server::ResourceMonitorPtr EventLoopLatencyMonitorFactory::createResourceMonitorFromProtoTyped(
+    const envoy::extensions::resource_monitors::event_loop_latency::v3alpha::EventLoopLatencyConfig&
+        config,
+    Server::Configuration::ResourceMonitorFactoryContext& context) {
+  return std::make_unique<EventLoopLatencyMonitor>(config, context);
+}
+
+/**
+ * Static registration for the event loop latency resource monitor factory. @see RegistryFactory.
+ */
+REGISTER_FACTORY(EventLoopLatencyMonitorFactory, Server::Configuration::ResourceMonitorFactory);
+
+} // namespace EventLoopLatencyMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
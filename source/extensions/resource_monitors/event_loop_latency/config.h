@@ -0,0 +1,31 @@
+#pragma once
+
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.h"
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "extensions/resource_monitors/common/factory_base.h"
+#include "extensions/resource_monitors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLatencyMonitor {
+
+class EventLoopLatencyMonitorFactory
+    : public Common::FactoryBase<envoy::extensions::resource_monitors::event_loop_latency::
+                                     v3alpha::EventLoopLatencyConfig> {
+public:
+  EventLoopLatencyMonitorFactory() : FactoryBase(ResourceMonitorNames::get().EventLoopLatency) {}
+
+private:
+  Server::ResourceMonitorPtr createResourceMonitorFromProtoTyped(
+      const envoy::extensions::resource_monitors::event_loop_latency::v3alpha::
+          EventLoopLatencyConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace EventLoopLatencyMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,76 @@
+#include "extensions/resource_monitors/event_loop_latency/event_loop_latency_monitor.h"
+
+#include <algorithm>
+
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.h"
+
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLatencyMonitor {
+
+EventLoopLatencyMonitor::EventLoopLatencyMonitor(
+    const envoy::extensions::resource_monitors::event_loop_latency::v3alpha::
+        EventLoopLatencyConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& context)
+    : max_latency_(std::chrono::milliseconds(
+          std::max<uint64_t>(1, PROTOBUF_GET_MS_REQUIRED(config, max_latency)))),
+      time_source_(context.dispatcher().timeSource()), tls_(context.threadLocal()) {}
+
+void EventLoopLatencyMonitor::updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) {
+  // The worker threads are registered by the time the overload manager starts updating resources,
+  // so the slot is set on the first update rather than at construction.
+  if (!tls_set_) {
+    tls_.set([](Event::Dispatcher& dispatcher) {
+      return std::make_shared<ThreadLocalDispatcher>(dispatcher);
+    });
+    tls_set_ = true;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (in_flight_ != nullptr && in_flight_->done_) {
+    last_latency_ = std::chrono::microseconds(in_flight_->max_latency_us_.load());
+    in_flight_.reset();
+  }
+
+  // A probe which is still in flight is at least as late as its age, which lets a stalled worker
+  // show up before it gets around to running the probe.
+  std::chrono::microseconds latency = last_latency_;
+  if (in_flight_ != nullptr) {
+    latency = std::max(
+        latency, std::chrono::duration_cast<std::chrono::microseconds>(now - in_flight_->sent_));
+  } else {
+    sendProbe(now);
+  }
+
+  Server::ResourceUsage usage;
+  usage.resource_pressure_ = latency.count() / static_cast<double>(max_latency_.count());
+  callbacks.onSuccess(usage);
+}
+
+void EventLoopLatencyMonitor::sendProbe(MonotonicTime now) {
+  in_flight_ = std::make_shared<Probe>(now);
+  tls_.runOnAllThreads(
+      [probe = in_flight_](OptRef<ThreadLocalDispatcher> obj) {
+        const int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       obj->dispatcher_.timeSource().monotonicTime() - probe->sent_)
+                                       .count();
+        int64_t max_latency_us = probe->max_latency_us_.load();
+        while (latency_us > max_latency_us &&
+               !probe->max_latency_us_.compare_exchange_weak(max_latency_us, latency_us)) {
+        }
+      },
+      // The completion runs on the main thread, after the monitor may have been destroyed.
+      [weak_probe = std::weak_ptr<Probe>(in_flight_)]() {
+        if (ProbeSharedPtr probe = weak_probe.lock()) {
+          probe->done_ = true;
+        }
+      });
+}
+
+} // namespace EventLoopLatencyMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
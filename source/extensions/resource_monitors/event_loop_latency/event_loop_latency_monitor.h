@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.h"
+#include "envoy/server/resource_monitor.h"
+#include "envoy/server/resource_monitor_config.h"
+#include "envoy/thread_local/thread_local.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLatencyMonitor {
+
+/**
+ * Worker event loop latency monitor with a statically configured maximum. Each update posts a
+ * probe to all threads, unless the previous one is still in flight, and reports the latency of
+ * the slowest thread.
+ */
+class EventLoopLatencyMonitor : public Server::ResourceMonitor {
+public:
+  EventLoopLatencyMonitor(
+      const envoy::extensions::resource_monitors::event_loop_latency::v3alpha::
+          EventLoopLatencyConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context);
+
+  void updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) override;
+
+private:
+  struct ThreadLocalDispatcher : public ThreadLocal::ThreadLocalObject {
+    explicit ThreadLocalDispatcher(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+    Event::Dispatcher& dispatcher_;
+  };
+
+  // A probe is shared with the threads running it, so it may outlive the monitor.
+  struct Probe {
+    explicit Probe(MonotonicTime sent) : sent_(sent) {}
+
+    const MonotonicTime sent_;
+    // The largest latency observed by the threads so far.
+    std::atomic<int64_t> max_latency_us_{0};
+    // Only used on the main thread.
+    bool done_{};
+  };
+
+  using ProbeSharedPtr = std::shared_ptr<Probe>;
+
+  void sendProbe(MonotonicTime now);
+
+  const std::chrono::microseconds max_latency_;
+  TimeSource& time_source_;
+  ThreadLocal::TypedSlot<ThreadLocalDispatcher> tls_;
+  bool tls_set_{};
+  ProbeSharedPtr in_flight_;
+  std::chrono::microseconds last_latency_{0};
+};
+
+} // namespace EventLoopLatencyMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
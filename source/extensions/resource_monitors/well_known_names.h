@@ -16,6 +16,9 @@ public:
   // Heap monitor with statically configured max.
   const std::string FixedHeap = "envoy.resource_monitors.fixed_heap";
 
+  // Worker event loop latency monitor with statically configured max.
+  const std::string EventLoopLatency = "envoy.resource_monitors.event_loop_latency";
+
   // File-based injected resource monitor.
   const std::string InjectedResource = "envoy.resource_monitors.injected_resource";
 };
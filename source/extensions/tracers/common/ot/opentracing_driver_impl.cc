@@ -89,6 +89,15 @@ OpenTracingSpan::OpenTracingSpan(OpenTracingDriver& driver,
 
 void OpenTracingSpan::finishSpan() { span_->FinishWithOptions(finish_options_); }
 
+void OpenTracingSpan::finishSpanAt(SystemTime finish_time) {
+  // OpenTracing takes the finish time from the steady clock.
+  finish_options_.finish_steady_timestamp =
+      std::chrono::steady_clock::now() -
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::system_clock::now() - finish_time);
+  span_->FinishWithOptions(finish_options_);
+}
+
 void OpenTracingSpan::setOperation(absl::string_view operation) {
   span_->SetOperationName({operation.data(), operation.length()});
 }
@@ -33,6 +33,7 @@ public:
 
   // Tracing::Span
   void finishSpan() override;
+  void finishSpanAt(SystemTime finish_time) override;
   void setOperation(absl::string_view operation) override;
   void setTag(absl::string_view name, const absl::string_view) override;
   void log(SystemTime timestamp, const std::string& event) override;
@@ -0,0 +1,136 @@
+#include "extensions/tracers/common/trace_context.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Tracers {
+namespace Common {
+
+namespace {
+
+constexpr uint8_t InvalidDigit = 0x10;
+constexpr char LowercaseDigits[] = "0123456789abcdef";
+
+struct HexDigitTable {
+  uint8_t values_[256];
+};
+
+constexpr HexDigitTable makeHexDigitTable(bool accept_uppercase) {
+  HexDigitTable table{};
+  for (uint8_t& value : table.values_) {
+    value = InvalidDigit;
+  }
+  for (uint8_t i = 0; i < 10; ++i) {
+    table.values_['0' + i] = i;
+  }
+  for (uint8_t i = 0; i < 6; ++i) {
+    table.values_['a' + i] = 10 + i;
+    if (accept_uppercase) {
+      table.values_['A' + i] = 10 + i;
+    }
+  }
+  return table;
+}
+
+constexpr HexDigitTable AnyCaseDigits = makeHexDigitTable(true);
+constexpr HexDigitTable LowercaseOnlyDigits = makeHexDigitTable(false);
+
+// The digits are looked up in a table and the invalid ones are only checked once all are decoded,
+// so that the loop has no data dependent branch.
+bool decodeWithTable(absl::string_view hex, uint64_t& value, const HexDigitTable& table) {
+  if (hex.empty() || hex.size() > TraceContextHex::Uint64Length) {
+    return false;
+  }
+  uint64_t result = 0;
+  uint8_t invalid = 0;
+  for (const char c : hex) {
+    const uint8_t digit = table.values_[static_cast<uint8_t>(c)];
+    invalid |= digit;
+    result = (result << 4) | (digit & 0x0f);
+  }
+  if ((invalid & InvalidDigit) != 0) {
+    return false;
+  }
+  value = result;
+  return true;
+}
+
+} // namespace
+
+bool TraceContextHex::decode(absl::string_view hex, uint64_t& value) {
+  return decodeWithTable(hex, value, AnyCaseDigits);
+}
+
+bool TraceContextHex::decodeLowercase(absl::string_view hex, uint64_t& value) {
+  return decodeWithTable(hex, value, LowercaseOnlyDigits);
+}
+
+void TraceContextHex::encode(uint64_t value, char* out) {
+  for (size_t i = Uint64Length; i > 0; --i) {
+    out[i - 1] = LowercaseDigits[value & 0x0f];
+    value >>= 4;
+  }
+}
+
+bool W3cTraceContext::parseTraceParent(absl::string_view value, TraceParent& trace_parent) {
+  // version "-" trace-id "-" parent-id "-" trace-flags
+  if (value.size() < TraceParent::Length || value[2] != '-' || value[35] != '-' ||
+      value[52] != '-') {
+    return false;
+  }
+
+  uint64_t version;
+  if (!TraceContextHex::decodeLowercase(value.substr(0, 2), version) || version == 0xff) {
+    return false;
+  }
+  // Only the later versions may append fields, which are ignored.
+  if (value.size() > TraceParent::Length &&
+      (version == 0 || value[TraceParent::Length] != '-')) {
+    return false;
+  }
+
+  uint64_t trace_id_high;
+  uint64_t trace_id_low;
+  uint64_t parent_id;
+  uint64_t trace_flags;
+  if (!TraceContextHex::decodeLowercase(value.substr(3, 16), trace_id_high) ||
+      !TraceContextHex::decodeLowercase(value.substr(19, 16), trace_id_low) ||
+      !TraceContextHex::decodeLowercase(value.substr(36, 16), parent_id) ||
+      !TraceContextHex::decodeLowercase(value.substr(53, 2), trace_flags)) {
+    return false;
+  }
+  // The all zero ids are invalid.
+  if ((trace_id_high == 0 && trace_id_low == 0) || parent_id == 0) {
+    return false;
+  }
+
+  trace_parent.version_ = static_cast<uint8_t>(version);
+  trace_parent.trace_id_high_ = trace_id_high;
+  trace_parent.trace_id_low_ = trace_id_low;
+  trace_parent.parent_id_ = parent_id;
+  trace_parent.trace_flags_ = static_cast<uint8_t>(trace_flags);
+  return true;
+}
+
+absl::string_view W3cTraceContext::formatTraceParent(const TraceParent& trace_parent,
+                                                     TraceParentBuffer& buffer) {
+  char* out = buffer.data();
+  *out++ = '0';
+  *out++ = '0';
+  *out++ = '-';
+  TraceContextHex::encode(trace_parent.trace_id_high_, out);
+  out += TraceContextHex::Uint64Length;
+  TraceContextHex::encode(trace_parent.trace_id_low_, out);
+  out += TraceContextHex::Uint64Length;
+  *out++ = '-';
+  TraceContextHex::encode(trace_parent.parent_id_, out);
+  out += TraceContextHex::Uint64Length;
+  *out++ = '-';
+  *out++ = LowercaseDigits[trace_parent.trace_flags_ >> 4];
+  *out++ = LowercaseDigits[trace_parent.trace_flags_ & 0x0f];
+  return {buffer.data(), buffer.size()};
+}
+
+} // namespace Common
+} // namespace Tracers
+} // namespace Extensions
+} // namespace Envoy
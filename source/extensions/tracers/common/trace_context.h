@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Tracers {
+namespace Common {
+
+/**
+ * Decoding and encoding of the hexadecimal ids carried by the trace context headers. None of the
+ * functions allocate, so that the headers can be parsed straight from the header map.
+ */
+class TraceContextHex {
+public:
+  // The number of hexadecimal digits of a 64 bit id.
+  static constexpr size_t Uint64Length = 16;
+
+  /**
+   * Decodes an id of 1 to 16 hexadecimal digits of either case.
+   * @param hex supplies the digits.
+   * @param value receives the id, only set if the digits are valid.
+   * @return whether the digits are a valid id.
+   */
+  static bool decode(absl::string_view hex, uint64_t& value);
+
+  /**
+   * Same as decode(), but only accepts lowercase digits as the W3C trace context requires.
+   */
+  static bool decodeLowercase(absl::string_view hex, uint64_t& value);
+
+  /**
+   * Encodes an id as 16 lowercase hexadecimal digits.
+   * @param value supplies the id.
+   * @param out supplies the buffer of at least 16 characters the digits are written to.
+   */
+  static void encode(uint64_t value, char* out);
+};
+
+/**
+ * The fields of a W3C traceparent header, see https://www.w3.org/TR/trace-context/.
+ */
+struct TraceParent {
+  // The length of a version 00 traceparent header.
+  static constexpr size_t Length = 55;
+  static constexpr uint8_t SampledFlag = 0x01;
+
+  bool sampled() const { return (trace_flags_ & SampledFlag) != 0; }
+
+  uint8_t version_{};
+  uint64_t trace_id_high_{};
+  uint64_t trace_id_low_{};
+  uint64_t parent_id_{};
+  uint8_t trace_flags_{};
+};
+
+/**
+ * Parsing and formatting of the W3C trace context headers.
+ */
+class W3cTraceContext {
+public:
+  using TraceParentBuffer = std::array<char, TraceParent::Length>;
+
+  /**
+   * Parses a traceparent header value. The headers of later versions are accepted as long as they
+   * start with the version 00 fields, as the specification requires.
+   * @param value supplies the header value.
+   * @param trace_parent receives the fields, only set if the value is valid.
+   * @return whether the value is a valid traceparent header.
+   */
+  static bool parseTraceParent(absl::string_view value, TraceParent& trace_parent);
+
+  /**
+   * Formats a version 00 traceparent header value, whatever the version of the fields.
+   * @param trace_parent supplies the fields.
+   * @param buffer supplies the storage of the returned value.
+   * @return the header value, which points into the buffer.
+   */
+  static absl::string_view formatTraceParent(const TraceParent& trace_parent,
+                                             TraceParentBuffer& buffer);
+};
+
+} // namespace Common
+} // namespace Tracers
+} // namespace Extensions
+} // namespace Envoy
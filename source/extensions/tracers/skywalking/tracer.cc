@@ -60,6 +60,13 @@ void Span::finishSpan() {
   tryToReportSpan();
 }
 
+void Span::finishSpanAt(SystemTime finish_time) {
+  span_store_->setEndTime(
+      std::chrono::duration_cast<std::chrono::milliseconds>(finish_time.time_since_epoch())
+          .count());
+  tryToReportSpan();
+}
+
 void Span::injectContext(Http::RequestHeaderMap& request_headers) {
   span_store_->injectContext(request_headers);
 }
@@ -54,7 +54,7 @@ std::string generateTraceId(SystemTime point_in_time, Random::RandomGenerator& r
 
 } // namespace
 
-void Span::finishSpan() {
+void Span::finishSpanAt(Envoy::SystemTime finish_time) {
   using std::chrono::time_point_cast;
   using namespace source::extensions::tracers::xray;
   // X-Ray expects timestamps to be in epoch seconds with milli/micro-second precision as a fraction
@@ -68,8 +68,7 @@ void Span::finishSpan() {
   s.set_id(id());
   s.set_trace_id(traceId());
   s.set_start_time(time_point_cast<SecondsWithFraction>(startTime()).time_since_epoch().count());
-  s.set_end_time(
-      time_point_cast<SecondsWithFraction>(time_source_.systemTime()).time_since_epoch().count());
+  s.set_end_time(time_point_cast<SecondsWithFraction>(finish_time).time_since_epoch().count());
   s.set_origin(origin());
   s.set_parent_id(parentId());
 
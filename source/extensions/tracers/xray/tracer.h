@@ -51,7 +51,12 @@ public:
   /**
    * Completes the current span, serialize it and send it to the X-Ray daemon.
    */
-  void finishSpan() override;
+  void finishSpan() override { finishSpanAt(time_source_.systemTime()); }
+
+  /**
+   * Same as finishSpan(), with the given end time.
+   */
+  void finishSpanAt(Envoy::SystemTime finish_time) override;
 
   /**
    * Sets the current operation name on the Span.
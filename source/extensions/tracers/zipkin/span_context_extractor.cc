@@ -1,16 +1,21 @@
 #include "extensions/tracers/zipkin/span_context_extractor.h"
 
 #include "common/common/assert.h"
-#include "common/common/utility.h"
+#include "common/common/fmt.h"
 
+#include "extensions/tracers/common/trace_context.h"
 #include "extensions/tracers/zipkin/span_context.h"
 #include "extensions/tracers/zipkin/zipkin_core_constants.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
 namespace {
+using Common::TraceContextHex;
+
 constexpr int FormatMaxLength = 32 + 1 + 16 + 3 + 16; // traceid128-spanid-1-parentid
 bool validSamplingFlags(char c) {
   if (c == '1' || c == '0' || c == 'd') {
@@ -89,31 +94,31 @@ std::pair<SpanContext, bool> SpanContextExtractor::extractSpanContext(bool is_sa
     // Extract trace id - which can either be 128 or 64 bit. For 128 bit,
     // it needs to be divided into two 64 bit numbers (high and low).
     // This is an implicitly untrusted header, so only the first value is used.
-    const std::string tid(b3_trace_id_entry[0]->value().getStringView());
-    if (b3_trace_id_entry[0]->value().size() == 32) {
-      const std::string high_tid = tid.substr(0, 16);
-      const std::string low_tid = tid.substr(16, 16);
-      if (!StringUtil::atoull(high_tid.c_str(), trace_id_high, 16) ||
-          !StringUtil::atoull(low_tid.c_str(), trace_id, 16)) {
+    const absl::string_view tid = b3_trace_id_entry[0]->value().getStringView();
+    if (tid.size() == 32) {
+      const absl::string_view high_tid = tid.substr(0, 16);
+      const absl::string_view low_tid = tid.substr(16, 16);
+      if (!TraceContextHex::decode(high_tid, trace_id_high) ||
+          !TraceContextHex::decode(low_tid, trace_id)) {
         throw ExtractorException(
-            fmt::format("Invalid traceid_high {} or tracid {}", high_tid.c_str(), low_tid.c_str()));
+            fmt::format("Invalid traceid_high {} or tracid {}", high_tid, low_tid));
       }
-    } else if (!StringUtil::atoull(tid.c_str(), trace_id, 16)) {
-      throw ExtractorException(absl::StrCat("Invalid trace_id ", tid.c_str()));
+    } else if (!TraceContextHex::decode(tid, trace_id)) {
+      throw ExtractorException(absl::StrCat("Invalid trace_id ", tid));
     }
 
     // This is an implicitly untrusted header, so only the first value is used.
-    const std::string spid(b3_span_id_entry[0]->value().getStringView());
-    if (!StringUtil::atoull(spid.c_str(), span_id, 16)) {
-      throw ExtractorException(absl::StrCat("Invalid span id ", spid.c_str()));
+    const absl::string_view spid = b3_span_id_entry[0]->value().getStringView();
+    if (!TraceContextHex::decode(spid, span_id)) {
+      throw ExtractorException(absl::StrCat("Invalid span id ", spid));
     }
 
     auto b3_parent_id_entry = request_headers_.get(ZipkinCoreConstants::get().X_B3_PARENT_SPAN_ID);
     if (!b3_parent_id_entry.empty() && !b3_parent_id_entry[0]->value().empty()) {
       // This is an implicitly untrusted header, so only the first value is used.
-      const std::string pspid(b3_parent_id_entry[0]->value().getStringView());
-      if (!StringUtil::atoull(pspid.c_str(), parent_id, 16)) {
-        throw ExtractorException(absl::StrCat("Invalid parent span id ", pspid.c_str()));
+      const absl::string_view pspid = b3_parent_id_entry[0]->value().getStringView();
+      if (!TraceContextHex::decode(pspid, parent_id)) {
+        throw ExtractorException(absl::StrCat("Invalid parent span id ", pspid));
       }
     }
   } else {
@@ -128,7 +133,7 @@ SpanContextExtractor::extractSpanContextFromB3SingleFormat(bool is_sampled) {
   auto b3_head_entry = request_headers_.get(ZipkinCoreConstants::get().B3);
   ASSERT(!b3_head_entry.empty());
   // This is an implicitly untrusted header, so only the first value is used.
-  const std::string b3(b3_head_entry[0]->value().getStringView());
+  const absl::string_view b3 = b3_head_entry[0]->value().getStringView();
   if (!b3.length()) {
     throw ExtractorException("Invalid input: empty");
   }
@@ -153,22 +158,20 @@ SpanContextExtractor::extractSpanContextFromB3SingleFormat(bool is_sampled) {
 
   uint64_t pos = 0;
 
-  const std::string trace_id_str = b3.substr(pos, 16);
+  const absl::string_view trace_id_str = b3.substr(pos, 16);
   if (b3[pos + 32] == '-') {
-    if (!StringUtil::atoull(trace_id_str.c_str(), trace_id_high, 16)) {
+    if (!TraceContextHex::decode(trace_id_str, trace_id_high)) {
       throw ExtractorException(
-          fmt::format("Invalid input: invalid trace id high {}", trace_id_str.c_str()));
+          fmt::format("Invalid input: invalid trace id high {}", trace_id_str));
     }
     pos += 16;
-    const std::string trace_id_low_str = b3.substr(pos, 16);
-    if (!StringUtil::atoull(trace_id_low_str.c_str(), trace_id, 16)) {
-      throw ExtractorException(
-          fmt::format("Invalid input: invalid trace id {}", trace_id_low_str.c_str()));
+    const absl::string_view trace_id_low_str = b3.substr(pos, 16);
+    if (!TraceContextHex::decode(trace_id_low_str, trace_id)) {
+      throw ExtractorException(fmt::format("Invalid input: invalid trace id {}", trace_id_low_str));
     }
   } else {
-    if (!StringUtil::atoull(trace_id_str.c_str(), trace_id, 16)) {
-      throw ExtractorException(
-          fmt::format("Invalid input: invalid trace id {}", trace_id_str.c_str()));
+    if (!TraceContextHex::decode(trace_id_str, trace_id)) {
+      throw ExtractorException(fmt::format("Invalid input: invalid trace id {}", trace_id_str));
     }
   }
 
@@ -177,9 +180,9 @@ SpanContextExtractor::extractSpanContextFromB3SingleFormat(bool is_sampled) {
     throw ExtractorException("Invalid input: not exists span id");
   }
 
-  const std::string span_id_str = b3.substr(pos, 16);
-  if (!StringUtil::atoull(span_id_str.c_str(), span_id, 16)) {
-    throw ExtractorException(fmt::format("Invalid input: invalid span id {}", span_id_str.c_str()));
+  const absl::string_view span_id_str = b3.substr(pos, 16);
+  if (!TraceContextHex::decode(span_id_str, span_id)) {
+    throw ExtractorException(fmt::format("Invalid input: invalid span id {}", span_id_str));
   }
   pos += 16; // spanId ended
 
@@ -216,10 +219,9 @@ SpanContextExtractor::extractSpanContextFromB3SingleFormat(bool is_sampled) {
       ASSERT(b3[pos] == '-');
       pos++;
 
-      const std::string parent_id_str = b3.substr(pos, b3.length() - pos);
-      if (!StringUtil::atoull(parent_id_str.c_str(), parent_id, 16)) {
-        throw ExtractorException(
-            fmt::format("Invalid input: invalid parent id {}", parent_id_str.c_str()));
+      const absl::string_view parent_id_str = b3.substr(pos, b3.length() - pos);
+      if (!TraceContextHex::decode(parent_id_str, parent_id)) {
+        throw ExtractorException(fmt::format("Invalid input: invalid parent id {}", parent_id_str));
       }
     }
   }
@@ -227,6 +229,21 @@ SpanContextExtractor::extractSpanContextFromB3SingleFormat(bool is_sampled) {
   return {SpanContext(trace_id_high, trace_id, span_id, parent_id, is_sampled), true};
 }
 
+std::pair<SpanContext, bool> SpanContextExtractor::extractW3cSpanContext() {
+  auto trace_parent_entry = request_headers_.get(ZipkinCoreConstants::get().TRACE_PARENT);
+  Common::TraceParent trace_parent;
+  // This is an implicitly untrusted header, so only the first value is used.
+  if (trace_parent_entry.empty() ||
+      !Common::W3cTraceContext::parseTraceParent(trace_parent_entry[0]->value().getStringView(),
+                                                 trace_parent)) {
+    return {SpanContext(), false};
+  }
+  // The parent id of the header is the id of the span of the caller.
+  return {SpanContext(trace_parent.trace_id_high_, trace_parent.trace_id_low_,
+                      trace_parent.parent_id_, 0, trace_parent.sampled()),
+          true};
+}
+
 } // namespace Zipkin
 } // namespace Tracers
 } // namespace Extensions
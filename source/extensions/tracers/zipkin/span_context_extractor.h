@@ -26,6 +26,14 @@ public:
   bool extractSampled(const Tracing::Decision tracing_decision);
   std::pair<SpanContext, bool> extractSpanContext(bool is_sampled);
 
+  /**
+   * Extracts the span context from the W3C traceparent header. An invalid header is ignored, as
+   * the specification requires.
+   * @return the span context, whose sampling decision is taken from the header, and whether a
+   * valid header was found.
+   */
+  std::pair<SpanContext, bool> extractW3cSpanContext();
+
 private:
   /*
    * Use to SpanContext extracted from B3 single format Http header
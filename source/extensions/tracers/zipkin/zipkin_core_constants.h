@@ -53,6 +53,9 @@ public:
 
   // Zipkin b3 single header
   const Http::LowerCaseString B3{"b3"};
+
+  // W3C trace context header
+  const Http::LowerCaseString TRACE_PARENT{"traceparent"};
 };
 
 using ZipkinCoreConstants = ConstSingleton<ZipkinCoreConstantValues>;
@@ -188,31 +188,36 @@ const ProtobufWkt::Struct Span::toStruct(Util::Replacements& replacements) const
   return span;
 }
 
-void Span::finish() {
+void Span::finish(absl::optional<SystemTime> finish_time) {
   // Assumption: Span will have only one annotation when this method is called.
   SpanContext context(*this);
+  const uint64_t stop_timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      finish_time.value_or(time_source_.systemTime())
+                                          .time_since_epoch())
+                                      .count();
   if (annotations_[0].value() == SERVER_RECV) {
     // Need to set the SS annotation
     Annotation ss;
     ss.setEndpoint(annotations_[0].endpoint());
-    ss.setTimestamp(std::chrono::duration_cast<std::chrono::microseconds>(
-                        time_source_.systemTime().time_since_epoch())
-                        .count());
+    ss.setTimestamp(stop_timestamp);
     ss.setValue(SERVER_SEND);
     annotations_.push_back(std::move(ss));
   } else if (annotations_[0].value() == CLIENT_SEND) {
     // Need to set the CR annotation.
     Annotation cr;
-    const uint64_t stop_timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
-                                        time_source_.systemTime().time_since_epoch())
-                                        .count();
     cr.setEndpoint(annotations_[0].endpoint());
     cr.setTimestamp(stop_timestamp);
     cr.setValue(CLIENT_RECV);
     annotations_.push_back(std::move(cr));
   }
 
-  if (monotonic_start_time_) {
+  if (finish_time.has_value()) {
+    // The monotonic clock has moved on since the span finished, so measure from the start
+    // timestamp instead.
+    if (isSetTimestamp()) {
+      setDuration(static_cast<int64_t>(stop_timestamp) - timestamp());
+    }
+  } else if (monotonic_start_time_) {
     const int64_t monotonic_stop_time = std::chrono::duration_cast<std::chrono::microseconds>(
                                             time_source_.monotonicTime().time_since_epoch())
                                             .count();
@@ -580,8 +580,10 @@ public:
    * annotation will need to add a CR annotation) and add them;
    * (2) compute and set the span's duration; and
    * (3) invoke the tracer's reportSpan() method if a tracer has been associated with the span.
+   *
+   * @param finish_time The time at which the span finished, if not now.
    */
-  void finish();
+  void finish(absl::optional<SystemTime> finish_time = absl::nullopt);
 
   /**
    * Adds a binary annotation to the span.
@@ -2,6 +2,7 @@
 
 #include "envoy/config/trace/v3/zipkin.pb.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
@@ -9,8 +10,11 @@
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/http/utility.h"
+#include "common/protobuf/utility.h"
 #include "common/tracing/http_tracer_impl.h"
 
+#include "extensions/compression/gzip/compressor/zlib_compressor_impl.h"
+#include "extensions/tracers/common/trace_context.h"
 #include "extensions/tracers/zipkin/span_context_extractor.h"
 #include "extensions/tracers/zipkin/zipkin_core_constants.h"
 
@@ -18,11 +22,48 @@ namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
+namespace {
+
+// Window bits of zlib which select the gzip wrapper, @see deflateInit2 in the zlib manual.
+constexpr int64_t GzipWindowBits = 15 | 16;
+constexpr uint64_t GzipMemoryLevel = 8;
+
+Http::RequestMessagePtr makeRequest(Driver& driver, const CollectorInfo& collector) {
+  Http::RequestMessagePtr message = std::make_unique<Http::RequestMessageImpl>();
+  message->headers().setReferenceMethod(Http::Headers::get().MethodValues.Post);
+  message->headers().setPath(collector.endpoint_);
+  message->headers().setHost(driver.cluster());
+  message->headers().setReferenceContentType(
+      collector.version_ == envoy::config::trace::v3::ZipkinConfig::HTTP_PROTO
+          ? Http::Headers::get().ContentTypeValues.Protobuf
+          : Http::Headers::get().ContentTypeValues.Json);
+  return message;
+}
+
+Http::AsyncClient::RequestOptions requestOptions(Driver& driver) {
+  const uint64_t timeout =
+      driver.runtime().snapshot().getInteger("tracing.zipkin.request_timeout", 5000U);
+  return Http::AsyncClient::RequestOptions().setTimeout(std::chrono::milliseconds(timeout));
+}
+
+void onResponse(Driver& driver, const Http::ResponseMessage& http_response) {
+  if (Http::Utility::getResponseStatus(http_response.headers()) !=
+      enumToInt(Http::Code::Accepted)) {
+    driver.tracerStats().reports_dropped_.inc();
+  } else {
+    driver.tracerStats().reports_sent_.inc();
+  }
+}
+
+} // namespace
 
-ZipkinSpan::ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer) : span_(span), tracer_(tracer) {}
+ZipkinSpan::ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer, bool w3c_trace_context)
+    : span_(span), tracer_(tracer), w3c_trace_context_(w3c_trace_context) {}
 
 void ZipkinSpan::finishSpan() { span_.finish(); }
 
+void ZipkinSpan::finishSpanAt(SystemTime finish_time) { span_.finish(finish_time); }
+
 void ZipkinSpan::setOperation(absl::string_view operation) {
   span_.setName(std::string(operation));
 }
@@ -54,6 +95,18 @@ void ZipkinSpan::injectContext(Http::RequestHeaderMap& request_headers) {
   // Set the sampled header.
   request_headers.setReferenceKey(ZipkinCoreConstants::get().X_B3_SAMPLED,
                                   span_.sampled() ? SAMPLED : NOT_SAMPLED);
+
+  if (w3c_trace_context_) {
+    Common::TraceParent trace_parent;
+    trace_parent.trace_id_high_ = span_.isSetTraceIdHigh() ? span_.traceIdHigh() : 0;
+    trace_parent.trace_id_low_ = span_.traceId();
+    trace_parent.parent_id_ = span_.id();
+    trace_parent.trace_flags_ = span_.sampled() ? Common::TraceParent::SampledFlag : 0;
+    Common::W3cTraceContext::TraceParentBuffer buffer;
+    request_headers.setReferenceKey(
+        ZipkinCoreConstants::get().TRACE_PARENT,
+        Common::W3cTraceContext::formatTraceParent(trace_parent, buffer));
+  }
 }
 
 void ZipkinSpan::setSampled(bool sampled) { span_.setSampled(sampled); }
@@ -62,7 +115,7 @@ Tracing::SpanPtr ZipkinSpan::spawnChild(const Tracing::Config& config, const std
                                         SystemTime start_time) {
   SpanContext previous_context(span_);
   return std::make_unique<ZipkinSpan>(
-      *tracer_.startSpan(config, name, start_time, previous_context), tracer_);
+      *tracer_.startSpan(config, name, start_time, previous_context), tracer_, w3c_trace_context_);
 }
 
 Driver::TlsTracer::TlsTracer(TracerPtr&& tracer, Driver& driver)
@@ -72,11 +125,12 @@ Driver::Driver(const envoy::config::trace::v3::ZipkinConfig& zipkin_config,
                Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
                ThreadLocal::SlotAllocator& tls, Runtime::Loader& runtime,
                const LocalInfo::LocalInfo& local_info, Random::RandomGenerator& random_generator,
-               TimeSource& time_source)
+               TimeSource& time_source, Event::Dispatcher& dispatcher,
+               Thread::ThreadFactory& thread_factory)
     : cm_(cluster_manager), tracer_stats_{ZIPKIN_TRACER_STATS(
                                 POOL_COUNTER_PREFIX(scope, "tracing.zipkin."))},
       tls_(tls.allocateSlot()), runtime_(runtime), local_info_(local_info),
-      time_source_(time_source) {
+      time_source_(time_source), w3c_trace_context_(zipkin_config.w3c_trace_context()) {
   Config::Utility::checkCluster("envoy.tracers.zipkin", zipkin_config.collector_cluster(), cm_,
                                 /* allow_added_via_api */ true);
   cluster_ = zipkin_config.collector_cluster();
@@ -93,13 +147,22 @@ Driver::Driver(const envoy::config::trace::v3::ZipkinConfig& zipkin_config,
       zipkin_config, shared_span_context, DEFAULT_SHARED_SPAN_CONTEXT);
   collector.shared_span_context_ = shared_span_context;
 
+  if (zipkin_config.has_export_config()) {
+    exporter_ = SpanExporter::create(zipkin_config.export_config(), collector, *this, dispatcher,
+                                     thread_factory);
+  }
+
   tls_->set([this, collector, &random_generator, trace_id_128bit, shared_span_context](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     TracerPtr tracer =
         std::make_unique<Tracer>(local_info_.clusterName(), local_info_.address(), random_generator,
                                  trace_id_128bit, shared_span_context, time_source_);
-    tracer->setReporter(
-        ReporterImpl::NewInstance(std::ref(*this), std::ref(dispatcher), collector));
+    if (exporter_ != nullptr) {
+      tracer->setReporter(std::make_unique<ExportingReporter>(*exporter_));
+    } else {
+      tracer->setReporter(
+          ReporterImpl::NewInstance(std::ref(*this), std::ref(dispatcher), collector));
+    }
     return std::make_shared<TlsTracer>(std::move(tracer), *this);
   });
 }
@@ -114,6 +177,9 @@ Tracing::SpanPtr Driver::startSpan(const Tracing::Config& config,
   bool sampled{extractor.extractSampled(tracing_decision)};
   try {
     auto ret_span_context = extractor.extractSpanContext(sampled);
+    if (!ret_span_context.second && w3c_trace_context_) {
+      ret_span_context = extractor.extractW3cSpanContext();
+    }
     if (!ret_span_context.second) {
       // Create a root Zipkin span. No context was found in the headers.
       new_zipkin_span =
@@ -129,7 +195,7 @@ Tracing::SpanPtr Driver::startSpan(const Tracing::Config& config,
   }
 
   // Return the active Zipkin span.
-  return std::make_unique<ZipkinSpan>(*new_zipkin_span, tracer);
+  return std::make_unique<ZipkinSpan>(*new_zipkin_span, tracer, w3c_trace_context_);
 }
 
 ReporterImpl::ReporterImpl(Driver& driver, Event::Dispatcher& dispatcher,
@@ -177,27 +243,15 @@ void ReporterImpl::flushSpans() {
   if (span_buffer_->pendingSpans()) {
     driver_.tracerStats().spans_sent_.add(span_buffer_->pendingSpans());
     const std::string request_body = span_buffer_->serialize();
-    Http::RequestMessagePtr message = std::make_unique<Http::RequestMessageImpl>();
-    message->headers().setReferenceMethod(Http::Headers::get().MethodValues.Post);
-    message->headers().setPath(collector_.endpoint_);
-    message->headers().setHost(driver_.cluster());
-    message->headers().setReferenceContentType(
-        collector_.version_ == envoy::config::trace::v3::ZipkinConfig::HTTP_PROTO
-            ? Http::Headers::get().ContentTypeValues.Protobuf
-            : Http::Headers::get().ContentTypeValues.Json);
-
+    Http::RequestMessagePtr message = makeRequest(driver_, collector_);
     message->body().add(request_body);
-
-    const uint64_t timeout =
-        driver_.runtime().snapshot().getInteger("tracing.zipkin.request_timeout", 5000U);
+    const Http::AsyncClient::RequestOptions options = requestOptions(driver_);
 
     if (collector_cluster_.exists()) {
       Http::AsyncClient::Request* request =
           driver_.clusterManager()
               .httpAsyncClientForCluster(collector_cluster_.info()->name())
-              .send(std::move(message), *this,
-                    Http::AsyncClient::RequestOptions().setTimeout(
-                        std::chrono::milliseconds(timeout)));
+              .send(std::move(message), *this, options);
       if (request) {
         active_requests_.add(*request);
       }
@@ -219,14 +273,170 @@ void ReporterImpl::onFailure(const Http::AsyncClient::Request& request,
 void ReporterImpl::onSuccess(const Http::AsyncClient::Request& request,
                              Http::ResponseMessagePtr&& http_response) {
   active_requests_.remove(request);
-  if (Http::Utility::getResponseStatus(http_response->headers()) !=
-      enumToInt(Http::Code::Accepted)) {
-    driver_.tracerStats().reports_dropped_.inc();
-  } else {
-    driver_.tracerStats().reports_sent_.inc();
+  onResponse(driver_, *http_response);
+}
+
+SpanExporter::SpanExporter(const envoy::config::trace::v3::ZipkinConfig::ExportConfig& config,
+                           const CollectorInfo& collector, Driver& driver,
+                           Event::Dispatcher& dispatcher)
+    : driver_(driver), collector_(collector),
+      max_pending_spans_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pending_spans, 10000)),
+      max_batch_spans_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_spans, 1000)),
+      flush_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, flush_interval, 1000)),
+      max_inflight_requests_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_inflight_requests, 1)),
+      gzip_compression_(config.gzip_compression()), dispatcher_(dispatcher),
+      batch_(collector.version_, collector.shared_span_context_, max_batch_spans_),
+      collector_cluster_(driver_.clusterManager(), driver_.cluster()) {
+  pending_spans_.reserve(std::min(max_pending_spans_, max_batch_spans_));
+  flush_timer_ = dispatcher.createTimer([this]() -> void {
+    driver_.tracerStats().timer_flushed_.inc();
+    {
+      Thread::LockGuard guard(lock_);
+      flush_requested_ = !pending_spans_.empty();
+    }
+    export_event_.notifyOne();
+    flush_timer_->enableTimer(flush_interval_);
+  });
+  flush_timer_->enableTimer(flush_interval_);
+}
+
+SpanExporter::~SpanExporter() {
+  {
+    Thread::LockGuard guard(lock_);
+    shutdown_ = true;
+  }
+  export_event_.notifyOne();
+  if (thread_ != nullptr) {
+    thread_->join();
+  }
+}
+
+SpanExporterSharedPtr
+SpanExporter::create(const envoy::config::trace::v3::ZipkinConfig::ExportConfig& config,
+                     const CollectorInfo& collector, Driver& driver, Event::Dispatcher& dispatcher,
+                     Thread::ThreadFactory& thread_factory) {
+  auto exporter = std::make_shared<SpanExporter>(config, collector, driver, dispatcher);
+  // The thread posts the batches with a weak pointer to the exporter, so it only starts once the
+  // exporter is owned by a shared pointer.
+  exporter->thread_ = thread_factory.createThread(
+      [raw = exporter.get()]() -> void { raw->threadRoutine(); }, Thread::Options{"zipkin_export"});
+  return exporter;
+}
+
+void SpanExporter::exportSpan(Span&& span) {
+  {
+    Thread::LockGuard guard(lock_);
+    if (pending_spans_.size() >= max_pending_spans_) {
+      driver_.tracerStats().spans_dropped_.inc();
+      return;
+    }
+    pending_spans_.push_back(std::move(span));
+    if (pending_spans_.size() != max_batch_spans_) {
+      // Either a batch is not full yet, or the thread already knows about it.
+      return;
+    }
+  }
+  export_event_.notifyOne();
+}
+
+bool SpanExporter::readyToExport() const {
+  return !pending_spans_.empty() && inflight_requests_ < max_inflight_requests_ &&
+         (flush_requested_ || pending_spans_.size() >= max_batch_spans_);
+}
+
+void SpanExporter::threadRoutine() {
+  while (true) {
+    {
+      Thread::LockGuard guard(lock_);
+      while (!shutdown_ && !readyToExport()) {
+        export_event_.wait(lock_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      const size_t batch_size = std::min<size_t>(pending_spans_.size(), max_batch_spans_);
+      for (size_t i = 0; i < batch_size; ++i) {
+        // Invalid spans are left out of the batch.
+        batch_.addSpan(std::move(pending_spans_[i]));
+      }
+      pending_spans_.erase(pending_spans_.begin(), pending_spans_.begin() + batch_size);
+      flush_requested_ = flush_requested_ && !pending_spans_.empty();
+      if (batch_.pendingSpans() == 0) {
+        continue;
+      }
+      ++inflight_requests_;
+    }
+
+    const uint64_t spans = batch_.pendingSpans();
+    std::string body = batch_.serialize();
+    batch_.clear();
+    if (gzip_compression_) {
+      Buffer::OwnedImpl buffer(body);
+      Compression::Gzip::Compressor::ZlibCompressorImpl compressor;
+      compressor.init(
+          Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+          Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+          GzipWindowBits, GzipMemoryLevel);
+      compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+      body = buffer.toString();
+    }
+    ENVOY_LOG(trace, "exporting {} zipkin spans in {} bytes", spans, body.size());
+
+    dispatcher_.post([weak_this = weak_from_this(), body = std::move(body), spans]() mutable {
+      if (SpanExporterSharedPtr exporter = weak_this.lock()) {
+        exporter->send(std::move(body), spans);
+      }
+    });
   }
 }
 
+void SpanExporter::send(std::string&& body, uint64_t spans) {
+  driver_.tracerStats().spans_sent_.add(spans);
+  if (!collector_cluster_.exists()) {
+    ENVOY_LOG(debug, "collector cluster '{}' does not exist", driver_.cluster());
+    driver_.tracerStats().reports_skipped_no_cluster_.inc();
+    onRequestDone();
+    return;
+  }
+
+  Http::RequestMessagePtr message = makeRequest(driver_, collector_);
+  if (gzip_compression_) {
+    message->headers().setReferenceKey(Http::CustomHeaders::get().ContentEncoding,
+                                       Http::CustomHeaders::get().ContentEncodingValues.Gzip);
+  }
+  message->body().add(body);
+  Http::AsyncClient::Request* request =
+      driver_.clusterManager()
+          .httpAsyncClientForCluster(collector_cluster_.info()->name())
+          .send(std::move(message), *this, requestOptions(driver_));
+  if (request) {
+    active_requests_.add(*request);
+  }
+}
+
+void SpanExporter::onRequestDone() {
+  {
+    Thread::LockGuard guard(lock_);
+    ASSERT(inflight_requests_ > 0);
+    --inflight_requests_;
+  }
+  export_event_.notifyOne();
+}
+
+void SpanExporter::onFailure(const Http::AsyncClient::Request& request,
+                             Http::AsyncClient::FailureReason) {
+  active_requests_.remove(request);
+  driver_.tracerStats().reports_failed_.inc();
+  onRequestDone();
+}
+
+void SpanExporter::onSuccess(const Http::AsyncClient::Request& request,
+                             Http::ResponseMessagePtr&& http_response) {
+  active_requests_.remove(request);
+  onResponse(driver_, *http_response);
+  onRequestDone();
+}
+
 } // namespace Zipkin
 } // namespace Tracers
 } // namespace Extensions
@@ -4,10 +4,12 @@
 #include "envoy/config/trace/v3/zipkin.pb.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/runtime/runtime.h"
+#include "envoy/thread/thread.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/tracing/http_tracer.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/thread.h"
 #include "common/http/async_client_utility.h"
 #include "common/http/header_map_impl.h"
 #include "common/json/json_loader.h"
@@ -28,7 +30,8 @@ namespace Zipkin {
   COUNTER(reports_skipped_no_cluster)                                                              \
   COUNTER(reports_sent)                                                                            \
   COUNTER(reports_dropped)                                                                         \
-  COUNTER(reports_failed)
+  COUNTER(reports_failed)                                                                          \
+  COUNTER(spans_dropped)
 
 struct ZipkinTracerStats {
   ZIPKIN_TRACER_STATS(GENERATE_COUNTER_STRUCT)
@@ -43,8 +46,9 @@ public:
    * Constructor. Wraps a Zipkin::Span object.
    *
    * @param span to be wrapped.
+   * @param w3c_trace_context whether to also inject the W3C traceparent header.
    */
-  ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer);
+  ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer, bool w3c_trace_context = false);
 
   /**
    * Calls Zipkin::Span::finishSpan() to perform all actions needed to finalize the span.
@@ -52,6 +56,11 @@ public:
    */
   void finishSpan() override;
 
+  /**
+   * Same as finishSpan(), with the given finish time.
+   */
+  void finishSpanAt(SystemTime finish_time) override;
+
   /**
    * This method sets the operation name on the span.
    * @param operation the operation name
@@ -88,10 +97,14 @@ public:
 private:
   Zipkin::Span span_;
   Zipkin::Tracer& tracer_;
+  const bool w3c_trace_context_;
 };
 
 using ZipkinSpanPtr = std::unique_ptr<ZipkinSpan>;
 
+class SpanExporter;
+using SpanExporterSharedPtr = std::shared_ptr<SpanExporter>;
+
 /**
  * Class for a Zipkin-specific Driver.
  */
@@ -100,12 +113,15 @@ public:
   /**
    * Constructor. It adds itself and a newly-created Zipkin::Tracer object to a thread-local store.
    * Also, it associates the given random-number generator to the Zipkin::Tracer object it creates.
+   * The main thread dispatcher and the thread factory are only used when the spans are exported
+   * through a SpanExporter, @see ZipkinConfig.export_config.
    */
   Driver(const envoy::config::trace::v3::ZipkinConfig& zipkin_config,
          Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
          ThreadLocal::SlotAllocator& tls, Runtime::Loader& runtime,
          const LocalInfo::LocalInfo& localinfo, Random::RandomGenerator& random_generator,
-         TimeSource& time_source);
+         TimeSource& time_source, Event::Dispatcher& dispatcher,
+         Thread::ThreadFactory& thread_factory);
 
   /**
    * This function is inherited from the abstract Driver class.
@@ -145,6 +161,9 @@ private:
   Runtime::Loader& runtime_;
   const LocalInfo::LocalInfo& local_info_;
   TimeSource& time_source_;
+  // Shared by the reporters of all threads, null unless export_config is set.
+  SpanExporterSharedPtr exporter_;
+  const bool w3c_trace_context_;
 };
 
 /**
@@ -241,6 +260,93 @@ private:
   // Track active HTTP requests to be able to cancel them on destruction.
   Http::AsyncClientRequestTracker active_requests_;
 };
+
+/**
+ * Exports the spans reported on all threads to Zipkin. The spans are serialized, and optionally
+ * compressed, on a dedicated thread in batches of up to max_batch_spans, which are sent once full
+ * or once flush_interval expires through the HTTP async client of the main thread. While
+ * max_inflight_requests requests are outstanding the spans wait in a queue bounded by
+ * max_pending_spans, past which newly reported spans are dropped.
+ */
+class SpanExporter : public std::enable_shared_from_this<SpanExporter>,
+                     public Http::AsyncClient::Callbacks,
+                     Logger::Loggable<Logger::Id::tracing> {
+public:
+  SpanExporter(const envoy::config::trace::v3::ZipkinConfig::ExportConfig& config,
+               const CollectorInfo& collector, Driver& driver, Event::Dispatcher& dispatcher);
+  ~SpanExporter() override;
+
+  /**
+   * Creates an exporter and starts its thread.
+   *
+   * @param config supplies the batching and compression configuration.
+   * @param collector holds the endpoint version and path information.
+   * @param driver ZipkinDriver to be associated with the exporter.
+   * @param dispatcher supplies the main thread dispatcher, which sends the batches.
+   * @param thread_factory supplies the factory of the export thread.
+   */
+  static SpanExporterSharedPtr create(
+      const envoy::config::trace::v3::ZipkinConfig::ExportConfig& config,
+      const CollectorInfo& collector, Driver& driver, Event::Dispatcher& dispatcher,
+      Thread::ThreadFactory& thread_factory);
+
+  /**
+   * Queues a span for export, or drops it if max_pending_spans are already queued. May be called
+   * from any thread.
+   *
+   * @param span The span to be exported.
+   */
+  void exportSpan(Span&& span);
+
+  // Http::AsyncClient::Callbacks.
+  void onSuccess(const Http::AsyncClient::Request&, Http::ResponseMessagePtr&&) override;
+  void onFailure(const Http::AsyncClient::Request&, Http::AsyncClient::FailureReason) override;
+  void onBeforeFinalizeUpstreamSpan(Tracing::Span&, const Http::ResponseHeaderMap*) override {}
+
+private:
+  bool readyToExport() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void threadRoutine();
+  void send(std::string&& body, uint64_t spans);
+  void onRequestDone();
+
+  Driver& driver_;
+  const CollectorInfo collector_;
+  const uint32_t max_pending_spans_;
+  const uint32_t max_batch_spans_;
+  const std::chrono::milliseconds flush_interval_;
+  const uint32_t max_inflight_requests_;
+  const bool gzip_compression_;
+  Event::Dispatcher& dispatcher_;
+  // Only used on the export thread.
+  SpanBuffer batch_;
+  Event::TimerPtr flush_timer_;
+  Upstream::ClusterUpdateTracker collector_cluster_;
+  // Track active HTTP requests to be able to cancel them on destruction.
+  Http::AsyncClientRequestTracker active_requests_;
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar export_event_;
+  std::vector<Span> pending_spans_ ABSL_GUARDED_BY(lock_);
+  uint32_t inflight_requests_ ABSL_GUARDED_BY(lock_){};
+  bool flush_requested_ ABSL_GUARDED_BY(lock_){};
+  bool shutdown_ ABSL_GUARDED_BY(lock_){};
+  Thread::ThreadPtr thread_;
+};
+
+/**
+ * A Zipkin::Reporter handing the spans over to the SpanExporter shared by all threads.
+ */
+class ExportingReporter : public Reporter {
+public:
+  ExportingReporter(SpanExporter& exporter) : exporter_(exporter) {}
+
+  // Zipkin::Reporter
+  void reportSpan(Span&& span) override { exporter_.exportSpan(std::move(span)); }
+
+private:
+  SpanExporter& exporter_;
+};
+
 } // namespace Zipkin
 } // namespace Tracers
 } // namespace Extensions
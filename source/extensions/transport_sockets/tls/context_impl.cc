@@ -25,6 +25,7 @@
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "absl/container/node_hash_set.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "openssl/evp.h"
@@ -74,7 +75,8 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
       ssl_ciphers_(stat_name_set_->add("ssl.ciphers")),
       ssl_versions_(stat_name_set_->add("ssl.versions")),
       ssl_curves_(stat_name_set_->add("ssl.curves")),
-      ssl_sigalgs_(stat_name_set_->add("ssl.sigalgs")), capabilities_(config.capabilities()) {
+      ssl_sigalgs_(stat_name_set_->add("ssl.sigalgs")), capabilities_(config.capabilities()),
+      kernel_tls_offload_(config.kernelTlsOffload()) {
   const auto tls_certificates = config.tlsCertificates();
   tls_contexts_.resize(std::max(static_cast<size_t>(1), tls_certificates.size()));
 
@@ -281,6 +283,9 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
     }
   }
 
+  // Without selection by SNI only the first certificate of each type would ever be used.
+  const bool several_certs_per_type =
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_select_certificate_by_sni");
   absl::node_hash_set<int> cert_pkey_ids;
   if (!capabilities_.provides_certificates) {
     for (uint32_t i = 0; i < tls_certificates.size(); ++i) {
@@ -336,7 +341,7 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
 
       bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(ctx.cert_chain_.get()));
       const int pkey_id = EVP_PKEY_id(public_key.get());
-      if (!cert_pkey_ids.insert(pkey_id).second) {
+      if (!cert_pkey_ids.insert(pkey_id).second && !several_certs_per_type) {
         throw EnvoyException(fmt::format("Failed to load certificate chain from {}, at most one "
                                          "certificate of a given type may be specified",
                                          ctx.cert_chain_file_path_));
@@ -890,6 +895,9 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
       max_session_keys_(config.maxSessionKeys()) {
   // This should be guaranteed during configuration ingestion for client contexts.
   ASSERT(tls_contexts_.size() == 1);
+  if (allow_renegotiation_) {
+    kernel_tls_offload_ = false;
+  }
   if (!parsed_alpn_protocols_.empty()) {
     for (auto& ctx : tls_contexts_) {
       const int rc = SSL_CTX_set_alpn_protos(ctx.ssl_ctx_.get(), parsed_alpn_protocols_.data(),
@@ -1033,9 +1041,10 @@ uint16_t ClientContextImpl::parseSigningAlgorithmsForTest(const std::string& sig
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     TimeSource& time_source)
+                                     TimeSource& time_source,
+                                     ServerSessionCacheSharedPtr session_cache)
     : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()),
-      ocsp_staple_policy_(config.ocspStaplePolicy()) {
+      ocsp_staple_policy_(config.ocspStaplePolicy()), session_cache_(std::move(session_cache)) {
   if (config.tlsCertificates().empty() && !config.capabilities().provides_certificates) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
@@ -1082,7 +1091,8 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
     // `SSL_CTX_set_tlsext_ticket_key_cb`.
     if (config.disableStatelessSessionResumption()) {
       SSL_CTX_set_options(ctx.ssl_ctx_.get(), SSL_OP_NO_TICKET);
-    } else if (!session_ticket_keys_.empty() && !config.capabilities().handles_session_resumption) {
+    } else if ((!session_ticket_keys_.empty() || session_cache_ != nullptr) &&
+               !config.capabilities().handles_session_resumption) {
       SSL_CTX_set_tlsext_ticket_key_cb(
           ctx.ssl_ctx_.get(),
           [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
@@ -1096,6 +1106,27 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
           });
     }
 
+    if (session_cache_ != nullptr && !config.capabilities().handles_session_resumption) {
+      // Keep sessions in the shared cache only, so that they outlive this context. BoringSSL only
+      // calls the remove callback for sessions of its internal cache, so the sessions of the
+      // shared cache are evicted by age and size only.
+      SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(),
+                                     SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+        static_cast<ServerContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)))
+            ->session_cache_->insert(bssl::UniquePtr<SSL_SESSION>(session));
+        return 1; // Tell BoringSSL that we took ownership of the session.
+      });
+      SSL_CTX_sess_set_get_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+            *out_copy = 0; // The returned session is a new reference.
+            return static_cast<ServerContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)))
+                ->session_cache_->lookup({id, static_cast<size_t>(id_len)})
+                .release();
+          });
+    }
+
     if (config.sessionTimeout() && !config.capabilities().handles_session_resumption) {
       auto timeout = config.sessionTimeout().value().count();
       SSL_CTX_set_timeout(ctx.ssl_ctx_.get(), uint32_t(timeout));
@@ -1123,6 +1154,44 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
       ctx.ocsp_response_ = std::move(response);
     }
   }
+
+  if (tls_certificates.size() > 1) {
+    indexServerNames();
+  }
+}
+
+void ServerContextImpl::indexServerNames() {
+  for (uint32_t i = 0; i < tls_contexts_.size(); ++i) {
+    X509* cert = tls_contexts_[i].cert_chain_.get();
+    if (cert == nullptr) {
+      continue;
+    }
+    std::vector<std::string> names = Utility::getSubjectAltNames(*cert, GEN_DNS);
+    if (names.empty()) {
+      // Clients fall back to the common name of certificates without DNS SANs.
+      X509_NAME* subject = X509_get_subject_name(cert);
+      const int index = X509_NAME_get_index_by_NID(subject, NID_commonName, -1);
+      if (index >= 0) {
+        const ASN1_STRING* common_name =
+            X509_NAME_ENTRY_get_data(X509_NAME_get_entry(subject, index));
+        names.emplace_back(reinterpret_cast<const char*>(ASN1_STRING_get0_data(common_name)),
+                           ASN1_STRING_length(common_name));
+      }
+    }
+    for (std::string& name : names) {
+      absl::AsciiStrToLower(&name);
+      if (absl::StartsWith(name, "*.")) {
+        name.erase(0, 1);
+      } else if (absl::StrContains(name, '*')) {
+        // Other wildcards never match, see dnsNameMatch().
+        continue;
+      }
+      std::vector<uint32_t>& contexts = server_names_index_[name];
+      if (contexts.empty() || contexts.back() != i) {
+        contexts.push_back(i);
+      }
+    }
+  }
 }
 
 ServerContextImpl::SessionContextID
@@ -1266,14 +1335,20 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   const EVP_MD* hmac = EVP_sha256();
   const EVP_CIPHER* cipher = EVP_aes_256_cbc();
 
+  // Without configured keys, use the in memory keys of the shared session cache.
+  const SessionTicketKeys* keys = &session_ticket_keys_;
+  if (keys->empty() && session_cache_ != nullptr) {
+    keys = &session_cache_->ticketKeys();
+  }
+
   if (encrypt == 1) {
     // Encrypt
-    RELEASE_ASSERT(!session_ticket_keys_.empty(), "");
+    RELEASE_ASSERT(!keys->empty(), "");
     // TODO(ggreenway): validate in SDS that session_ticket_keys_ cannot be empty,
     // or if we allow it to be emptied, reconfigure the context so this callback
     // isn't set.
 
-    const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key = session_ticket_keys_.front();
+    const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key = keys->front();
 
     static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                   "Expected key.name length");
@@ -1297,7 +1372,7 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   } else {
     // Decrypt
     bool is_enc_key = true; // first element is the encryption key
-    for (const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key : session_ticket_keys_) {
+    for (const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key : *keys) {
       static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                     "Expected key.name length");
       if (std::equal(key.name_.begin(), key.name_.end(), key_name)) {
@@ -1456,22 +1531,35 @@ ServerContextImpl::selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello) {
   const bool client_ecdsa_capable = isClientEcdsaCapable(ssl_client_hello);
   const bool client_ocsp_capable = isClientOcspCapable(ssl_client_hello);
 
-  // Fallback on first certificate.
-  const TlsContext* selected_ctx = &tls_contexts_[0];
-  auto ocsp_staple_action = ocspStapleAction(*selected_ctx, client_ocsp_capable);
-  for (const auto& ctx : tls_contexts_) {
-    if (client_ecdsa_capable != ctx.is_ecdsa_) {
-      continue;
+  OcspStapleAction ocsp_staple_action = OcspStapleAction::ClientNotCapable;
+  const TlsContext* selected_ctx = nullptr;
+  if (!server_names_index_.empty() &&
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_select_certificate_by_sni")) {
+    selected_ctx = selectTlsContextByServerName(ssl_client_hello, client_ecdsa_capable,
+                                                client_ocsp_capable, ocsp_staple_action);
+    if (selected_ctx == nullptr) {
+      stats_.certificate_selected_by_default_.inc();
     }
+  }
 
-    auto action = ocspStapleAction(ctx, client_ocsp_capable);
-    if (action == OcspStapleAction::Fail) {
-      continue;
-    }
+  if (selected_ctx == nullptr) {
+    // Fallback on first certificate.
+    selected_ctx = &tls_contexts_[0];
+    ocsp_staple_action = ocspStapleAction(*selected_ctx, client_ocsp_capable);
+    for (const auto& ctx : tls_contexts_) {
+      if (client_ecdsa_capable != ctx.is_ecdsa_) {
+        continue;
+      }
 
-    selected_ctx = &ctx;
-    ocsp_staple_action = action;
-    break;
+      auto action = ocspStapleAction(ctx, client_ocsp_capable);
+      if (action == OcspStapleAction::Fail) {
+        continue;
+      }
+
+      selected_ctx = &ctx;
+      ocsp_staple_action = action;
+      break;
+    }
   }
 
   if (client_ocsp_capable) {
@@ -1503,6 +1591,71 @@ ServerContextImpl::selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello) {
   return ssl_select_cert_success;
 }
 
+const ServerContextImpl::TlsContext* ServerContextImpl::selectTlsContextByServerName(
+    const SSL_CLIENT_HELLO* ssl_client_hello, bool client_ecdsa_capable, bool client_ocsp_capable,
+    OcspStapleAction& ocsp_staple_action) {
+  absl::string_view server_name = absl::NullSafeStringView(
+      SSL_get_servername(ssl_client_hello->ssl, TLSEXT_NAMETYPE_host_name));
+  if (server_name.empty()) {
+    return nullptr;
+  }
+  // Clients send lower case names almost always, so only those with upper case ones pay for the
+  // conversion.
+  std::string lower_case_server_name;
+  if (std::any_of(server_name.begin(), server_name.end(), absl::ascii_isupper)) {
+    lower_case_server_name = absl::AsciiStrToLower(server_name);
+    server_name = lower_case_server_name;
+  }
+
+  bool wildcard = false;
+  auto it = server_names_index_.find(server_name);
+  if (it == server_names_index_.end()) {
+    // A wildcard name covers exactly one label.
+    const size_t label_end = server_name.find('.');
+    if (label_end == 0 || label_end == absl::string_view::npos) {
+      return nullptr;
+    }
+    it = server_names_index_.find(server_name.substr(label_end));
+    if (it == server_names_index_.end()) {
+      return nullptr;
+    }
+    wildcard = true;
+  }
+
+  // Prefer a certificate of the key type the client prefers, but ECDSA capable clients can do
+  // with an RSA certificate for the name as well.
+  const TlsContext* selected_ctx = nullptr;
+  for (const uint32_t index : it->second) {
+    const TlsContext& ctx = tls_contexts_[index];
+    if (ctx.is_ecdsa_ && !client_ecdsa_capable) {
+      continue;
+    }
+    if (selected_ctx != nullptr && client_ecdsa_capable != ctx.is_ecdsa_) {
+      continue;
+    }
+
+    auto action = ocspStapleAction(ctx, client_ocsp_capable);
+    if (action == OcspStapleAction::Fail) {
+      continue;
+    }
+
+    selected_ctx = &ctx;
+    ocsp_staple_action = action;
+    if (client_ecdsa_capable == ctx.is_ecdsa_) {
+      break;
+    }
+  }
+
+  if (selected_ctx != nullptr) {
+    if (wildcard) {
+      stats_.certificate_selected_by_wildcard_name_.inc();
+    } else {
+      stats_.certificate_selected_by_exact_name_.inc();
+    }
+  }
+  return selected_ctx;
+}
+
 void ServerContextImpl::TlsContext::addClientValidationContext(
     const Envoy::Ssl::CertificateValidationContextConfig& config, bool require_client_cert) {
   bssl::UniquePtr<BIO> bio(
@@ -19,7 +19,9 @@
 
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
 #include "extensions/transport_sockets/tls/ocsp/ocsp.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
@@ -36,6 +38,8 @@ namespace Tls {
 #define ALL_SSL_STATS(COUNTER, GAUGE, HISTOGRAM)                                                   \
   COUNTER(connection_error)                                                                        \
   COUNTER(handshake)                                                                               \
+  COUNTER(kernel_tls_tx_offload)                                                                   \
+  COUNTER(kernel_tls_tx_offload_failed)                                                            \
   COUNTER(session_reused)                                                                          \
   COUNTER(no_certificate)                                                                          \
   COUNTER(fail_verify_no_cert)                                                                     \
@@ -45,7 +49,10 @@ namespace Tls {
   COUNTER(ocsp_staple_failed)                                                                      \
   COUNTER(ocsp_staple_omitted)                                                                     \
   COUNTER(ocsp_staple_responses)                                                                   \
-  COUNTER(ocsp_staple_requests)
+  COUNTER(ocsp_staple_requests)                                                                    \
+  COUNTER(certificate_selected_by_exact_name)                                                      \
+  COUNTER(certificate_selected_by_wildcard_name)                                                   \
+  COUNTER(certificate_selected_by_default)
 
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
@@ -93,6 +100,13 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if connections should try to offload the encryption of outgoing records to the
+   *         kernel once the handshake completes. Never the case for the contexts which
+   *         renegotiate, as renegotiation writes handshake records past the kernel.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -220,6 +234,7 @@ protected:
   const Stats::StatName ssl_curves_;
   const Stats::StatName ssl_sigalgs_;
   const Ssl::HandshakerCapabilities capabilities_;
+  bool kernel_tls_offload_;
 };
 
 using ContextImplSharedPtr = std::shared_ptr<ContextImpl>;
@@ -248,7 +263,8 @@ enum class OcspStapleAction { Staple, NoStaple, Fail, ClientNotCapable };
 class ServerContextImpl : public ContextImpl, public Envoy::Ssl::ServerContext {
 public:
   ServerContextImpl(Stats::Scope& scope, const Envoy::Ssl::ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, TimeSource& time_source);
+                    const std::vector<std::string>& server_names, TimeSource& time_source,
+                    ServerSessionCacheSharedPtr session_cache);
 
 private:
   using SessionContextID = std::array<uint8_t, SSL_MAX_SSL_SESSION_ID_LENGTH>;
@@ -262,6 +278,13 @@ private:
   // Select the TLS certificate context in SSL_CTX_set_select_certificate_cb() callback with
   // ClientHello details.
   enum ssl_select_cert_result_t selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello);
+  // Select the first certificate context that covers the server name requested by the client and
+  // suits the client, nullptr if there is none.
+  const TlsContext* selectTlsContextByServerName(const SSL_CLIENT_HELLO* ssl_client_hello,
+                                                 bool client_ecdsa_capable,
+                                                 bool client_ocsp_capable,
+                                                 OcspStapleAction& ocsp_staple_action);
+  void indexServerNames();
   OcspStapleAction ocspStapleAction(const ServerContextImpl::TlsContext& ctx,
                                     bool client_ocsp_capable);
 
@@ -269,6 +292,12 @@ private:
 
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
+  // Shared with the other server contexts of the context manager, may be nullptr.
+  const ServerSessionCacheSharedPtr session_cache_;
+  // Indexes of the certificate contexts by the lower case DNS names of their certificates, in
+  // configuration order. Wildcard names are indexed without the leading '*'. Only populated when
+  // there is more than one certificate to choose from.
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> server_names_index_;
 };
 
 } // namespace Tls
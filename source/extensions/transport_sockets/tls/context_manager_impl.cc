@@ -7,6 +7,7 @@
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
+#include "common/runtime/runtime_features.h"
 
 #include "extensions/transport_sockets/tls/context_impl.h"
 
@@ -59,8 +60,11 @@ Envoy::Ssl::ServerContextSharedPtr ContextManagerImpl::createSslServerContext(
     return nullptr;
   }
 
-  Envoy::Ssl::ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_);
+  Envoy::Ssl::ServerContextSharedPtr context = std::make_shared<ServerContextImpl>(
+      scope, config, server_names, time_source_,
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_shared_server_session_cache")
+          ? session_cache_
+          : nullptr);
   removeOldContext(old_context);
   removeEmptyContexts();
   contexts_.emplace_back(context);
@@ -102,6 +106,20 @@ void ContextManagerImpl::iterateContexts(std::function<void(const Envoy::Ssl::Co
   }
 }
 
+absl::optional<Envoy::Ssl::ServerSessionState> ContextManagerImpl::exportServerSessionState() {
+  if (!Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.tls_shared_server_session_cache")) {
+    return absl::nullopt;
+  }
+  return session_cache_->exportState();
+}
+
+void ContextManagerImpl::importServerSessionState(const Envoy::Ssl::ServerSessionState& state) {
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_shared_server_session_cache")) {
+    session_cache_->importState(state);
+  }
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
@@ -9,6 +9,7 @@
 #include "envoy/stats/scope.h"
 
 #include "extensions/transport_sockets/tls/private_key/private_key_manager_impl.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -24,7 +25,9 @@ namespace Tls {
  */
 class ContextManagerImpl final : public Envoy::Ssl::ContextManager {
 public:
-  ContextManagerImpl(TimeSource& time_source) : time_source_(time_source) {}
+  ContextManagerImpl(TimeSource& time_source)
+      : time_source_(time_source),
+        session_cache_(std::make_shared<ServerSessionCache>(time_source)) {}
   ~ContextManagerImpl() override;
 
   // Ssl::ContextManager
@@ -41,6 +44,8 @@ public:
   Ssl::PrivateKeyMethodManager& privateKeyMethodManager() override {
     return private_key_method_manager_;
   };
+  absl::optional<Envoy::Ssl::ServerSessionState> exportServerSessionState() override;
+  void importServerSessionState(const Envoy::Ssl::ServerSessionState& state) override;
 
 private:
   void removeEmptyContexts();
@@ -48,6 +53,7 @@ private:
   TimeSource& time_source_;
   std::list<std::weak_ptr<Envoy::Ssl::Context>> contexts_;
   PrivateKeyMethodManagerImpl private_key_method_manager_{};
+  const ServerSessionCacheSharedPtr session_cache_;
 };
 
 } // namespace Tls
@@ -0,0 +1,156 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/tls.h>)
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <linux/tls.h>
+#define ENVOY_KERNEL_TLS
+#endif
+#endif
+
+#include "common/api/os_sys_calls_impl.h"
+
+#include "openssl/bio.h"
+#include "openssl/crypto.h"
+#include "openssl/nid.h"
+
+#ifdef ENVOY_KERNEL_TLS
+// Older libc headers don't define these yet.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TLS_SET_RECORD_TYPE
+#define TLS_SET_RECORD_TYPE 1
+#endif
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+#ifdef ENVOY_KERNEL_TLS
+namespace {
+
+// The implicit part of the AES-GCM nonce in TLS 1.2.
+constexpr size_t SaltSize = 4;
+
+template <class CryptoInfo>
+bool setTxCryptoInfo(Network::IoHandle& io_handle, uint16_t cipher_type, const uint8_t* key,
+                     const uint8_t* salt, const uint8_t* sequence) {
+  CryptoInfo info{};
+  static_assert(sizeof(info.salt) == SaltSize, "unexpected AES-GCM salt size");
+  static_assert(sizeof(info.iv) == sizeof(info.rec_seq), "unexpected AES-GCM IV size");
+  info.info.version = TLS_1_2_VERSION;
+  info.info.cipher_type = cipher_type;
+  memcpy(info.key, key, sizeof(info.key));
+  memcpy(info.salt, salt, sizeof(info.salt));
+  // BoringSSL uses the record sequence number as the explicit part of the nonce, so does the
+  // kernel.
+  memcpy(info.iv, sequence, sizeof(info.iv));
+  memcpy(info.rec_seq, sequence, sizeof(info.rec_seq));
+  const bool enabled = io_handle.setOption(SOL_TLS, TLS_TX, &info, sizeof(info)).rc_ == 0;
+  OPENSSL_cleanse(&info, sizeof(info));
+  return enabled;
+}
+
+} // namespace
+
+bool enableKernelTlsTx(SSL* ssl, Network::IoHandle& io_handle) {
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return false;
+  }
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return false;
+  }
+  size_t key_size;
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+  case NID_aes_128_gcm:
+    key_size = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    break;
+  case NID_aes_256_gcm:
+    key_size = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+    break;
+  default:
+    return false;
+  }
+
+  // AEAD ciphers have no MAC keys, so the key block consists of the client write key, the server
+  // write key, the client salt and the server salt.
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (key_block.size() != 2 * (key_size + SaltSize) ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+  const bool is_server = SSL_is_server(ssl);
+  const uint8_t* key = key_block.data() + (is_server ? key_size : 0);
+  const uint8_t* salt = key_block.data() + 2 * key_size + (is_server ? SaltSize : 0);
+
+  uint8_t sequence[8];
+  uint64_t write_sequence = SSL_get_write_sequence(ssl);
+  for (int i = sizeof(sequence) - 1; i >= 0; --i) {
+    sequence[i] = write_sequence & 0xff;
+    write_sequence >>= 8;
+  }
+
+  // If the kernel TLS module isn't available this fails and the socket is left untouched.
+  bool enabled = io_handle.setOption(SOL_TCP, TCP_ULP, "tls", sizeof("tls")).rc_ == 0;
+  if (enabled) {
+    // If this fails the ULP stays attached, which leaves the socket usable: until crypto info is
+    // set for a direction, the tls ULP passes the data of that direction through to TCP as is, so
+    // the connection goes on with SSL_write().
+    enabled = key_size == TLS_CIPHER_AES_GCM_128_KEY_SIZE
+                  ? setTxCryptoInfo<tls12_crypto_info_aes_gcm_128>(
+                        io_handle, TLS_CIPHER_AES_GCM_128, key, salt, sequence)
+                  : setTxCryptoInfo<tls12_crypto_info_aes_gcm_256>(
+                        io_handle, TLS_CIPHER_AES_GCM_256, key, salt, sequence);
+  }
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+  if (enabled) {
+    // Reads keep going through the socket, but the records BoringSSL writes from now on go to a
+    // memory BIO which is never sent.
+    SSL_set0_wbio(ssl, BIO_new(BIO_s_mem()));
+  }
+  return enabled;
+}
+
+bool sendKernelTlsCloseNotify(Network::IoHandle& io_handle) {
+  // The kernel sends the alert in a record of its own with the record type set on the message.
+  uint8_t alert[] = {SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY};
+  iovec iov{alert, sizeof(alert)};
+  char control[CMSG_SPACE(sizeof(uint8_t))]{};
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = SSL3_RT_ALERT;
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().sendmsg(io_handle.fdDoNotUse(), &message, 0);
+  return result.rc_ == static_cast<ssize_t>(sizeof(alert));
+}
+
+#else
+
+bool enableKernelTlsTx(SSL*, Network::IoHandle&) { return false; }
+
+bool sendKernelTlsCloseNotify(Network::IoHandle&) { return false; }
+
+#endif
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "envoy/network/io_handle.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Hands the encryption of the records sent on a connection over to the kernel TLS module. This
+ * must happen right after the handshake completed, before any application data is written.
+ * Only TLS 1.2 connections with an AES-GCM cipher on Linux are supported, and only if the SSL
+ * object never writes records past the handshake by itself, i.e. it doesn't renegotiate.
+ *
+ * Once enabled, the records BoringSSL would still write, such as the alert sent when a read fails,
+ * are dropped, as they would be out of sequence with those the kernel sends.
+ * @param ssl the SSL object of the connection.
+ * @param io_handle the socket of the connection.
+ * @return true if the kernel encrypts the records from now on, in which case plaintext must be
+ *         written to the socket directly, false if the connection keeps using SSL_write().
+ */
+bool enableKernelTlsTx(SSL* ssl, Network::IoHandle& io_handle);
+
+/**
+ * Sends a close_notify alert on a connection whose records the kernel encrypts.
+ * @param io_handle the socket of the connection.
+ * @return true if the alert was sent, false if it wasn't, e.g. as the socket buffer is full.
+ */
+bool sendKernelTlsCloseNotify(Network::IoHandle& io_handle);
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
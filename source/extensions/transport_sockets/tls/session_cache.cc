@@ -0,0 +1,210 @@
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+#include "openssl/rand.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+namespace {
+
+absl::Span<const uint8_t> sessionId(const SSL_SESSION* session) {
+  unsigned int length;
+  const uint8_t* id = SSL_SESSION_get_id(session, &length);
+  return {id, length};
+}
+
+bool expired(const SSL_SESSION* session, uint64_t now) {
+  return static_cast<uint64_t>(SSL_SESSION_get_time(session)) +
+             static_cast<uint64_t>(SSL_SESSION_get_timeout(session)) <=
+         now;
+}
+
+int64_t nanoseconds(MonotonicTime time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::atomic<uint64_t> next_cache_id{1};
+
+// The reference of a thread to the ticket keys of the last cache it used.
+struct ThreadTicketKeys {
+  uint64_t cache_id_{};
+  uint64_t generation_{};
+  SessionTicketKeysConstSharedPtr keys_;
+};
+
+} // namespace
+
+ServerSessionCache::ServerSessionCache(TimeSource& time_source, uint32_t max_sessions,
+                                       std::chrono::seconds ticket_key_rotation_interval)
+    : time_source_(time_source), id_(next_cache_id++),
+      max_sessions_per_bucket_(std::max<uint32_t>(1, max_sessions / NumBuckets)),
+      ticket_key_rotation_interval_(ticket_key_rotation_interval),
+      ticket_keys_(std::make_shared<SessionTicketKeys>(1, generateTicketKey())),
+      ticket_key_created_(time_source_.monotonicTime()),
+      next_ticket_key_rotation_(nanoseconds(ticket_key_created_ + ticket_key_rotation_interval_)) {
+}
+
+void ServerSessionCache::insert(bssl::UniquePtr<SSL_SESSION> session) {
+  const std::string key = sessionKey(sessionId(session.get()));
+  if (key.empty()) {
+    // Sessions issued along with a session ticket have no ID.
+    return;
+  }
+  const uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                           time_source_.systemTime().time_since_epoch())
+                           .count();
+
+  Bucket& b = bucket(key);
+  absl::MutexLock lock(&b.lock_);
+  auto existing = b.index_.find(key);
+  if (existing != b.index_.end()) {
+    b.sessions_.erase(existing->second);
+    b.index_.erase(existing);
+  }
+  while (!b.sessions_.empty() && (b.sessions_.size() >= max_sessions_per_bucket_ ||
+                                  expired(b.sessions_.front().get(), now))) {
+    b.index_.erase(sessionKey(sessionId(b.sessions_.front().get())));
+    b.sessions_.pop_front();
+  }
+  b.sessions_.push_back(std::move(session));
+  b.index_.emplace(key, std::prev(b.sessions_.end()));
+}
+
+bssl::UniquePtr<SSL_SESSION> ServerSessionCache::lookup(absl::Span<const uint8_t> session_id) {
+  const std::string key = sessionKey(session_id);
+  Bucket& b = bucket(key);
+  absl::MutexLock lock(&b.lock_);
+  auto it = b.index_.find(key);
+  if (it == b.index_.end()) {
+    return nullptr;
+  }
+  // BoringSSL checks whether the session is still valid when resuming it.
+  SSL_SESSION* session = it->second->get();
+  SSL_SESSION_up_ref(session);
+  return bssl::UniquePtr<SSL_SESSION>(session);
+}
+
+const SessionTicketKeys& ServerSessionCache::ticketKeys() {
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (nanoseconds(now) >= next_ticket_key_rotation_.load(std::memory_order_acquire)) {
+    rotateTicketKeys(now);
+  }
+
+  static thread_local ThreadTicketKeys thread_keys;
+  if (thread_keys.cache_id_ != id_ ||
+      thread_keys.generation_ != ticket_keys_generation_.load(std::memory_order_acquire)) {
+    absl::MutexLock lock(&ticket_keys_lock_);
+    thread_keys.cache_id_ = id_;
+    thread_keys.generation_ = ticket_keys_generation_.load(std::memory_order_relaxed);
+    thread_keys.keys_ = ticket_keys_;
+  }
+  return *thread_keys.keys_;
+}
+
+void ServerSessionCache::rotateTicketKeys(MonotonicTime now) {
+  absl::MutexLock lock(&ticket_keys_lock_);
+  // Another thread may have rotated the keys in the meantime.
+  if (now - ticket_key_created_ < ticket_key_rotation_interval_) {
+    return;
+  }
+  auto keys = std::make_shared<SessionTicketKeys>(1, generateTicketKey());
+  // Tickets encrypted with a key that has been retired for a whole interval are not accepted
+  // anymore.
+  if (now - ticket_key_created_ < 2 * ticket_key_rotation_interval_) {
+    keys->push_back(ticket_keys_->front());
+  }
+  ticket_keys_ = std::move(keys);
+  ticket_key_created_ = now;
+  ticket_keys_generation_.fetch_add(1, std::memory_order_release);
+  next_ticket_key_rotation_.store(nanoseconds(now + ticket_key_rotation_interval_),
+                                  std::memory_order_release);
+}
+
+Envoy::Ssl::ServerSessionState ServerSessionCache::exportState() {
+  Envoy::Ssl::ServerSessionState state;
+  const uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                           time_source_.systemTime().time_since_epoch())
+                           .count();
+  for (Bucket& b : buckets_) {
+    absl::MutexLock lock(&b.lock_);
+    for (const bssl::UniquePtr<SSL_SESSION>& session : b.sessions_) {
+      if (expired(session.get(), now)) {
+        continue;
+      }
+      uint8_t* bytes;
+      size_t length;
+      if (SSL_SESSION_to_bytes(session.get(), &bytes, &length) == 1) {
+        state.sessions_.emplace_back(reinterpret_cast<const char*>(bytes), length);
+        OPENSSL_free(bytes);
+      }
+    }
+  }
+
+  const MonotonicTime monotonic_now = time_source_.monotonicTime();
+  absl::MutexLock lock(&ticket_keys_lock_);
+  state.ticket_keys_ = *ticket_keys_;
+  state.ticket_key_age_ =
+      std::chrono::duration_cast<std::chrono::seconds>(monotonic_now - ticket_key_created_);
+  return state;
+}
+
+void ServerSessionCache::importState(const Envoy::Ssl::ServerSessionState& state) {
+  // The context only supplies the certificate handling of the parsed sessions, which is the same
+  // for all the server contexts.
+  bssl::UniquePtr<SSL_CTX> ssl_ctx(SSL_CTX_new(TLS_method()));
+  for (const std::string& bytes : state.sessions_) {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_from_bytes(
+        reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), ssl_ctx.get()));
+    if (session != nullptr) {
+      insert(std::move(session));
+    }
+  }
+
+  if (state.ticket_keys_.empty()) {
+    return;
+  }
+  const MonotonicTime now = time_source_.monotonicTime();
+  absl::MutexLock lock(&ticket_keys_lock_);
+  ticket_keys_ = std::make_shared<SessionTicketKeys>(state.ticket_keys_);
+  ticket_key_created_ = now - state.ticket_key_age_;
+  ticket_keys_generation_.fetch_add(1, std::memory_order_release);
+  next_ticket_key_rotation_.store(nanoseconds(ticket_key_created_ + ticket_key_rotation_interval_),
+                                  std::memory_order_release);
+}
+
+size_t ServerSessionCache::size() {
+  size_t size = 0;
+  for (Bucket& b : buckets_) {
+    absl::MutexLock lock(&b.lock_);
+    size += b.sessions_.size();
+  }
+  return size;
+}
+
+std::string ServerSessionCache::sessionKey(absl::Span<const uint8_t> session_id) {
+  return {reinterpret_cast<const char*>(session_id.data()), session_id.size()};
+}
+
+ServerSessionCache::Bucket& ServerSessionCache::bucket(absl::string_view key) {
+  return buckets_[HashUtil::xxHash64(key) % NumBuckets];
+}
+
+Envoy::Ssl::ServerContextConfig::SessionTicketKey ServerSessionCache::generateTicketKey() {
+  Envoy::Ssl::ServerContextConfig::SessionTicketKey key;
+  RELEASE_ASSERT(RAND_bytes(key.name_.data(), key.name_.size()) == 1, "");
+  RELEASE_ASSERT(RAND_bytes(key.hmac_key_.data(), key.hmac_key_.size()) == 1, "");
+  RELEASE_ASSERT(RAND_bytes(key.aes_key_.data(), key.aes_key_.size()) == 1, "");
+  return key;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
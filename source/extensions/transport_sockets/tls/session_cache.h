@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/ssl/context_config.h"
+#include "envoy/ssl/context_manager.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+using SessionTicketKeys = std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey>;
+using SessionTicketKeysConstSharedPtr = std::shared_ptr<const SessionTicketKeys>;
+
+/**
+ * Server side session resumption state shared by all the server contexts of a context manager.
+ * Each SSL_CTX otherwise keeps its own session cache and generates its own session ticket key, so
+ * every context update (e.g. a listener or certificate update) forces all clients into a full
+ * handshake. Sessions can still only be resumed on contexts with the same session ID context, as
+ * BoringSSL checks it on resumption.
+ *
+ * The state lives in the memory of this process. On a hot restart, the new process takes over the
+ * sessions and ticket keys of the old one, see exportState() and importState().
+ *
+ * The cache can be used from any thread. Sessions are spread over lock striped buckets, so that
+ * handshakes on different workers rarely contend.
+ */
+class ServerSessionCache {
+public:
+  static constexpr uint32_t NumBuckets = 16;
+  // Same as the default size of the internal BoringSSL session cache.
+  static constexpr uint32_t DefaultMaxSessions = 20 * 1024;
+  // Same as the default BoringSSL session ticket key rotation interval.
+  static constexpr std::chrono::hours DefaultTicketKeyRotationInterval{48};
+
+  ServerSessionCache(TimeSource& time_source, uint32_t max_sessions = DefaultMaxSessions,
+                     std::chrono::seconds ticket_key_rotation_interval =
+                         DefaultTicketKeyRotationInterval);
+
+  /**
+   * Store a session established by a full handshake. Expired sessions, and the oldest sessions
+   * once the bucket is full, are evicted.
+   * @param session supplies the session, the cache takes ownership of the reference.
+   */
+  void insert(bssl::UniquePtr<SSL_SESSION> session);
+
+  /**
+   * @param session_id supplies the session ID sent by the client.
+   * @return a new reference to the cached session, or nullptr if there is none.
+   */
+  bssl::UniquePtr<SSL_SESSION> lookup(absl::Span<const uint8_t> session_id);
+
+  /**
+   * @return the session ticket keys, the first one being used for encryption. The keys are
+   *         generated in memory and rotated every ticket_key_rotation_interval, the previous key
+   *         is kept for decryption so that recently issued tickets stay valid. Each thread keeps
+   *         its own reference to the current keys, so that only a rotation takes a lock. The
+   *         returned keys are valid until the next call on the same thread.
+   */
+  const SessionTicketKeys& ticketKeys();
+
+  /**
+   * @return the unexpired sessions and the ticket keys, to hand them over to another process.
+   */
+  Envoy::Ssl::ServerSessionState exportState();
+
+  /**
+   * Take over the sessions and the ticket keys exported by another cache. The sessions are added to
+   * this cache, and the ticket keys replace the ones of this cache, keeping their age so that they
+   * are rotated when the other cache would have.
+   * @param state supplies the exported state.
+   */
+  void importState(const Envoy::Ssl::ServerSessionState& state);
+
+  /**
+   * @return the number of cached sessions.
+   */
+  size_t size();
+
+private:
+  using SessionList = std::list<bssl::UniquePtr<SSL_SESSION>>;
+
+  struct Bucket {
+    absl::Mutex lock_;
+    // Oldest session first.
+    SessionList sessions_ ABSL_GUARDED_BY(lock_);
+    absl::flat_hash_map<std::string, SessionList::iterator> index_ ABSL_GUARDED_BY(lock_);
+  };
+
+  static std::string sessionKey(absl::Span<const uint8_t> session_id);
+  Bucket& bucket(absl::string_view key);
+  static Envoy::Ssl::ServerContextConfig::SessionTicketKey generateTicketKey();
+  void rotateTicketKeys(MonotonicTime now);
+
+  TimeSource& time_source_;
+  // Tells the per thread references to the ticket keys of different caches apart.
+  const uint64_t id_;
+  const uint32_t max_sessions_per_bucket_;
+  const std::chrono::seconds ticket_key_rotation_interval_;
+  std::array<Bucket, NumBuckets> buckets_;
+
+  absl::Mutex ticket_keys_lock_;
+  SessionTicketKeysConstSharedPtr ticket_keys_ ABSL_GUARDED_BY(ticket_keys_lock_);
+  MonotonicTime ticket_key_created_ ABSL_GUARDED_BY(ticket_keys_lock_);
+  // Incremented on each rotation, so that the threads know when to refresh their reference.
+  std::atomic<uint64_t> ticket_keys_generation_{};
+  // The monotonic time of the next rotation, in nanoseconds.
+  std::atomic<int64_t> next_ticket_key_rotation_;
+};
+
+using ServerSessionCacheSharedPtr = std::shared_ptr<ServerSessionCache>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
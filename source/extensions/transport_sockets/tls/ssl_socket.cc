@@ -9,6 +9,7 @@
 #include "common/runtime/runtime_features.h"
 
 #include "extensions/transport_sockets/tls/io_handle_bio.h"
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 #include "extensions/transport_sockets/tls/ssl_handshaker.h"
 #include "extensions/transport_sockets/tls/utility.h"
 
@@ -192,6 +193,16 @@ Network::Connection& SslSocket::connection() const { return callbacks_->connecti
 
 void SslSocket::onSuccess(SSL* ssl) {
   ctx_->logHandshake(ssl);
+  if (ctx_->kernelTlsOffload()) {
+    kernel_tls_tx_ = enableKernelTlsTx(ssl, callbacks_->ioHandle());
+    if (kernel_tls_tx_) {
+      ctx_->stats().kernel_tls_tx_offload_.inc();
+    } else {
+      ENVOY_CONN_LOG(debug, "kernel TLS transmit offload is not available",
+                     callbacks_->connection());
+      ctx_->stats().kernel_tls_tx_offload_failed_.inc();
+    }
+  }
   callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 }
 
@@ -236,6 +247,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
@@ -284,12 +299,47 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel encrypts whatever is written to the socket, so this is a plain socket write.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "kernel TLS write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        return {PostIoAction::KeepOpen, total_bytes_written, false};
+      }
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    ENVOY_CONN_LOG(trace, "kernel TLS write returns: {}", callbacks_->connection(), result.rc_);
+    total_bytes_written += result.rc_;
+  }
+
+  if (end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(info_->state() == Ssl::SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
 
 void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::PreHandshake);
+  if (kernel_tls_tx_) {
+    // BoringSSL can't send records anymore, the kernel sends the close_notify alert instead.
+    if (info_->state() != Ssl::SocketState::ShutdownSent &&
+        callbacks_->connection().state() != Network::Connection::State::Closed) {
+      const bool sent = sendKernelTlsCloseNotify(callbacks_->ioHandle());
+      ENVOY_CONN_LOG(debug, "kernel TLS shutdown: close_notify sent={}", callbacks_->connection(),
+                     sent);
+      info_->setState(Ssl::SocketState::ShutdownSent);
+    }
+    return;
+  }
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
     int rc = SSL_shutdown(rawSsl());
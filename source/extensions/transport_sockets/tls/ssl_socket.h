@@ -81,6 +81,7 @@ private:
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
   Network::PostIoAction doHandshake();
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
   void drainErrorQueue();
   void shutdownSsl();
   void shutdownBasic();
@@ -92,6 +93,8 @@ private:
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImplSharedPtr ctx_;
   uint64_t bytes_to_retry_{};
+  // Whether the kernel encrypts the records sent on the connection.
+  bool kernel_tls_tx_{};
   std::string failure_reason_;
 
   SslHandshakerImplSharedPtr info_;
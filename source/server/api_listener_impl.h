@@ -134,6 +134,7 @@ protected:
       uint32_t bufferLimit() const override { return 65000; }
       bool localAddressRestored() const override { return false; }
       bool aboveHighWatermark() const override { return false; }
+      bool buffersEmpty() const override { return true; }
       const Network::ConnectionSocket::OptionsSharedPtr& socketOptions() const override {
         return options_;
       }
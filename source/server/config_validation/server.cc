@@ -48,8 +48,9 @@ ValidationInstance::ValidationInstance(
                                                         file_system, random_generator_)),
       dispatcher_(api_->allocateDispatcher("main_thread")),
       singleton_manager_(new Singleton::ManagerImpl(api_->threadFactory())),
-      access_log_manager_(options.fileFlushIntervalMsec(), *api_, *dispatcher_, access_log_lock,
-                          store),
+      access_log_manager_(options.fileFlushIntervalMsec(), options.fileFlushBufferLimitBytes(),
+                          options.fileFlushOverflowPolicy() == FileFlushOverflowPolicy::Block,
+                          *api_, *dispatcher_, access_log_lock, store),
       mutex_tracer_(nullptr), grpc_context_(stats_store_.symbolTable()),
       http_context_(stats_store_.symbolTable()), time_system_(time_system),
       server_contexts_(*this) {
@@ -11,6 +11,7 @@
 
 #include "common/event/deferred_task.h"
 #include "common/network/connection_impl.h"
+#include "common/network/transferable_connection.h"
 #include "common/network/utility.h"
 #include "common/stats/timespan_impl.h"
 
@@ -160,6 +161,26 @@ void ConnectionHandlerImpl::setListenerRejectFraction(float reject_fraction) {
   }
 }
 
+void ConnectionHandlerImpl::releaseTransferableConnections(const ReleasedConnectionCb& cb) {
+  for (auto& listener : listeners_) {
+    if (auto tcp_listener = listener.second.tcpListener(); tcp_listener.has_value()) {
+      tcp_listener->get().releaseTransferableConnections(*listener.first, cb);
+    }
+  }
+}
+
+bool ConnectionHandlerImpl::adoptConnection(const Network::Address::Instance& listener_address,
+                                            Network::ConnectionSocketPtr&& socket) {
+  ActiveTcpListenerOptRef tcp_listener = findActiveTcpListenerByAddress(listener_address);
+  if (!tcp_listener.has_value()) {
+    ENVOY_LOG(debug, "closing adopted connection: no listener on {}", listener_address.asString());
+    socket->close();
+    return false;
+  }
+  tcp_listener->get().adoptConnection(std::move(socket));
+  return true;
+}
+
 void ConnectionHandlerImpl::ActiveTcpListener::removeConnection(ActiveTcpConnection& connection) {
   ENVOY_CONN_LOG(debug, "adding to cleanup list", *connection.connection_);
   ActiveConnections& active_connections = connection.active_connections_;
@@ -480,6 +501,7 @@ void ConnectionHandlerImpl::ActiveTcpListener::newConnection(
   auto transport_socket = filter_chain->transportSocketFactory().createTransportSocket(nullptr);
   stream_info->setDownstreamSslConnection(transport_socket->ssl());
   auto& active_connections = getOrCreateActiveConnections(*filter_chain);
+  Network::IoHandle& io_handle = socket->ioHandle();
   auto server_conn_ptr = parent_.dispatcher_.createServerConnection(
       std::move(socket), std::move(transport_socket), *stream_info);
   if (const auto timeout = filter_chain->transportSocketConnectTimeout();
@@ -487,7 +509,7 @@ void ConnectionHandlerImpl::ActiveTcpListener::newConnection(
     server_conn_ptr->setTransportSocketConnectTimeout(timeout);
   }
   ActiveTcpConnectionPtr active_connection(
-      new ActiveTcpConnection(active_connections, std::move(server_conn_ptr),
+      new ActiveTcpConnection(active_connections, std::move(server_conn_ptr), io_handle,
                               parent_.dispatcher_.timeSource(), std::move(stream_info)));
   active_connection->connection_->setBufferLimits(config_->perConnectionBufferLimitBytes());
 
@@ -573,6 +595,66 @@ void ConnectionHandlerImpl::ActiveTcpListener::post(Network::ConnectionSocketPtr
       });
 }
 
+void ConnectionHandlerImpl::ActiveTcpListener::releaseTransferableConnections(
+    const Network::Address::Instance& listener_address, const ReleasedConnectionCb& cb) {
+  // Closing a connection removes it from its list, so find the connections to release first.
+  std::vector<ActiveTcpConnection*> released;
+  for (const auto& chain_and_connections : connections_by_context_) {
+    for (const ActiveTcpConnectionPtr& active_connection :
+         chain_and_connections.second->connections_) {
+      const Network::Connection& connection = *active_connection->connection_;
+      const StreamInfo::FilterState& filter_state = connection.streamInfo().filterState();
+      // The other process only learns the connection's socket, so connections whose addresses
+      // were restored by listener filters stay here, as do connections with pipelined input or
+      // pending writes.
+      if (connection.state() == Network::Connection::State::Open && connection.buffersEmpty() &&
+          !connection.localAddressRestored() &&
+          *connection.remoteAddress() == *connection.directRemoteAddress() &&
+          filter_state.hasData<Network::TransferableConnection>(
+              Network::TransferableConnection::key()) &&
+          filter_state
+              .getDataReadOnly<Network::TransferableConnection>(
+                  Network::TransferableConnection::key())
+              .idle()) {
+        released.push_back(active_connection.get());
+      }
+    }
+  }
+
+  for (ActiveTcpConnection* active_connection : released) {
+    ENVOY_CONN_LOG(debug, "releasing connection to another process",
+                   *active_connection->connection_);
+    stats_.downstream_cx_released_.inc();
+    // There is nothing left to write, and closing our copy of the socket leaves the peer
+    // connected through the duplicate.
+    Network::IoHandlePtr io_handle = active_connection->io_handle_.duplicate();
+    active_connection->connection_->close(Network::ConnectionCloseType::NoFlush);
+    cb(std::move(io_handle), listener_address);
+  }
+}
+
+void ConnectionHandlerImpl::ActiveTcpListener::adoptConnection(
+    Network::ConnectionSocketPtr&& socket) {
+  if (listenerConnectionLimitReached()) {
+    ENVOY_LOG(trace, "closing adopted connection: listener connection limit reached for {}",
+              config_->name());
+    socket->close();
+    stats_.downstream_cx_overflow_.inc();
+    return;
+  }
+
+  stats_.downstream_cx_adopted_.inc();
+  // Only plaintext connections are handed over, and the other process already ran the listener
+  // filters.
+  socket->setDetectedTransportProtocol(
+      Extensions::TransportSockets::TransportProtocolNames::get().RawBuffer);
+  incNumConnections();
+  auto stream_info = std::make_unique<StreamInfo::StreamInfoImpl>(
+      parent_.dispatcher_.timeSource(), StreamInfo::FilterState::LifeSpan::Connection);
+  stream_info->setDownstreamDirectRemoteAddress(socket->directRemoteAddress());
+  newConnection(std::move(socket), std::move(stream_info));
+}
+
 ConnectionHandlerImpl::ActiveConnections::ActiveConnections(
     ConnectionHandlerImpl::ActiveTcpListener& listener, const Network::FilterChain& filter_chain)
     : listener_(listener), filter_chain_(filter_chain) {}
@@ -584,9 +666,10 @@ ConnectionHandlerImpl::ActiveConnections::~ActiveConnections() {
 
 ConnectionHandlerImpl::ActiveTcpConnection::ActiveTcpConnection(
     ActiveConnections& active_connections, Network::ConnectionPtr&& new_connection,
-    TimeSource& time_source, std::unique_ptr<StreamInfo::StreamInfo>&& stream_info)
+    Network::IoHandle& io_handle, TimeSource& time_source,
+    std::unique_ptr<StreamInfo::StreamInfo>&& stream_info)
     : stream_info_(std::move(stream_info)), active_connections_(active_connections),
-      connection_(std::move(new_connection)),
+      connection_(std::move(new_connection)), io_handle_(io_handle),
       conn_length_(new Stats::HistogramCompletableTimespanImpl(
           active_connections_.listener_.stats_.downstream_cx_length_ms_, time_source)) {
   // We just universally set no delay on connections. Theoretically we might at some point want
@@ -31,6 +31,8 @@ namespace Server {
   COUNTER(downstream_cx_overflow)                                                                  \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_overload_reject)                                                           \
+  COUNTER(downstream_cx_adopted)                                                                   \
+  COUNTER(downstream_cx_released)                                                                  \
   COUNTER(downstream_global_cx_overflow)                                                           \
   COUNTER(downstream_pre_cx_timeout)                                                               \
   COUNTER(no_filter_chain_match)                                                                   \
@@ -85,6 +87,9 @@ public:
   void enableListeners() override;
   void setListenerRejectFraction(float reject_fraction) override;
   const std::string& statPrefix() const override { return per_handler_stat_prefix_; }
+  void releaseTransferableConnections(const ReleasedConnectionCb& cb) override;
+  bool adoptConnection(const Network::Address::Instance& listener_address,
+                       Network::ConnectionSocketPtr&& socket) override;
 
   /**
    * Wrapper for an active listener owned by this handler.
@@ -163,6 +168,17 @@ private:
     void newConnection(Network::ConnectionSocketPtr&& socket,
                        std::unique_ptr<StreamInfo::StreamInfo> stream_info);
 
+    /**
+     * Release the idle connections which another process can take over.
+     */
+    void releaseTransferableConnections(const Network::Address::Instance& listener_address,
+                                        const ReleasedConnectionCb& cb);
+
+    /**
+     * Create a new connection from a socket released by another process.
+     */
+    void adoptConnection(Network::ConnectionSocketPtr&& socket);
+
     /**
      * Return the active connections container attached with the given filter chain.
      */
@@ -216,7 +232,8 @@ private:
                                public Event::DeferredDeletable,
                                public Network::ConnectionCallbacks {
     ActiveTcpConnection(ActiveConnections& active_connections,
-                        Network::ConnectionPtr&& new_connection, TimeSource& time_system,
+                        Network::ConnectionPtr&& new_connection, Network::IoHandle& io_handle,
+                        TimeSource& time_system,
                         std::unique_ptr<StreamInfo::StreamInfo>&& stream_info);
     ~ActiveTcpConnection() override;
 
@@ -234,6 +251,9 @@ private:
     std::unique_ptr<StreamInfo::StreamInfo> stream_info_;
     ActiveConnections& active_connections_;
     Network::ConnectionPtr connection_;
+    // The connection's socket, which the connection owns. Used to hand the connection over to
+    // another process.
+    Network::IoHandle& io_handle_;
     Stats::TimespanPtr conn_length_;
   };
 
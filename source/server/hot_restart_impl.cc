@@ -118,6 +118,15 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   return as_child_.duplicateParentListenSocket(address);
 }
 
+void HotRestartImpl::duplicateParentConnections(Event::Dispatcher& dispatcher,
+                                                const ParentConnectionCb& cb) {
+  as_child_.duplicateParentConnections(dispatcher, cb);
+}
+
+absl::optional<Ssl::ServerSessionState> HotRestartImpl::duplicateParentServerSessionState() {
+  return as_child_.getParentServerSessionState();
+}
+
 void HotRestartImpl::initialize(Event::Dispatcher& dispatcher, Server::Instance& server) {
   as_parent_.initialize(dispatcher, server);
 }
@@ -141,7 +150,10 @@ HotRestartImpl::mergeParentStatsIfAny(Stats::StoreRoot& stats_store) {
   return response;
 }
 
-void HotRestartImpl::shutdown() { as_parent_.shutdown(); }
+void HotRestartImpl::shutdown() {
+  as_parent_.shutdown();
+  as_child_.shutdown();
+}
 
 uint32_t HotRestartImpl::baseId() { return base_id_; }
 std::string HotRestartImpl::version() { return hotRestartVersion(); }
@@ -104,6 +104,9 @@ public:
   // Server::HotRestart
   void drainParentListeners() override;
   int duplicateParentListenSocket(const std::string& address) override;
+  void duplicateParentConnections(Event::Dispatcher& dispatcher,
+                                  const ParentConnectionCb& cb) override;
+  absl::optional<Ssl::ServerSessionState> duplicateParentServerSessionState() override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void sendParentAdminShutdownRequest(time_t& original_start_time) override;
   void sendParentTerminateRequest() override;
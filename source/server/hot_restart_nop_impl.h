@@ -18,6 +18,10 @@ public:
   // Server::HotRestart
   void drainParentListeners() override {}
   int duplicateParentListenSocket(const std::string&) override { return -1; }
+  void duplicateParentConnections(Event::Dispatcher&, const ParentConnectionCb&) override {}
+  absl::optional<Ssl::ServerSessionState> duplicateParentServerSessionState() override {
+    return absl::nullopt;
+  }
   void initialize(Event::Dispatcher&, Server::Instance&) override {}
   void sendParentAdminShutdownRequest(time_t&) override {}
   void sendParentTerminateRequest() override {}
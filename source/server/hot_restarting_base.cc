@@ -64,6 +64,19 @@ void HotRestartingBase::bindDomainSocket(uint64_t id, const std::string& role,
 
 void HotRestartingBase::sendHotRestartMessage(sockaddr_un& address,
                                               const HotRestartMessage& proto) {
+  const std::vector<Datagram> datagrams = toDatagrams(proto);
+
+  RELEASE_ASSERT(fcntl(my_domain_socket_, F_SETFL, 0) != -1,
+                 fmt::format("Set domain socket blocking failed, errno = {}", errno));
+  for (const Datagram& datagram : datagrams) {
+    RELEASE_ASSERT(sendDatagram(address, datagram), "blocking hot restart sendmsg() would block.");
+  }
+  RELEASE_ASSERT(fcntl(my_domain_socket_, F_SETFL, O_NONBLOCK) != -1,
+                 fmt::format("Set domain socket nonblocking failed, errno = {}", errno));
+}
+
+std::vector<HotRestartingBase::Datagram>
+HotRestartingBase::toDatagrams(const HotRestartMessage& proto) const {
   const uint64_t serialized_size = proto.ByteSizeLong();
   const uint64_t total_size = sizeof(uint64_t) + serialized_size;
   // Fill with uint64_t 'length' followed by the serialized HotRestartMessage.
@@ -73,46 +86,53 @@ void HotRestartingBase::sendHotRestartMessage(sockaddr_un& address,
   RELEASE_ASSERT(proto.SerializeWithCachedSizesToArray(send_buf.data() + sizeof(uint64_t)),
                  "failed to serialize a HotRestartMessage");
 
-  RELEASE_ASSERT(fcntl(my_domain_socket_, F_SETFL, 0) != -1,
-                 fmt::format("Set domain socket blocking failed, errno = {}", errno));
-
-  uint8_t* next_byte_to_send = send_buf.data();
-  uint64_t sent = 0;
-  while (sent < total_size) {
+  std::vector<Datagram> datagrams;
+  for (uint64_t sent = 0; sent < total_size; sent += MaxSendmsgSize) {
     const uint64_t cur_chunk_size = std::min(MaxSendmsgSize, total_size - sent);
-    iovec iov[1];
-    iov[0].iov_base = next_byte_to_send;
-    iov[0].iov_len = cur_chunk_size;
-    next_byte_to_send += cur_chunk_size;
-    sent += cur_chunk_size;
-    msghdr message;
-    memset(&message, 0, sizeof(message));
-    message.msg_name = &address;
-    message.msg_namelen = sizeof(address);
-    message.msg_iov = iov;
-    message.msg_iovlen = 1;
+    datagrams.push_back(Datagram{
+        std::vector<uint8_t>(send_buf.begin() + sent, send_buf.begin() + sent + cur_chunk_size),
+        {}});
+  }
+  // The fds go along with the first datagram, so that they arrive with the start of the message.
+  datagrams.front().fds_ = passedFds(proto);
+  RELEASE_ASSERT(datagrams.front().fds_.size() <= MaxPassedFds,
+                 "a hot restart message passed more fds than one sendmsg() can.");
+  return datagrams;
+}
 
-    // Control data stuff, only relevant for the fd passing done with PassListenSocketReply.
-    uint8_t control_buffer[CMSG_SPACE(sizeof(int))];
-    if (replyIsExpectedType(&proto, HotRestartMessage::Reply::kPassListenSocket) &&
-        proto.reply().pass_listen_socket().fd() != -1) {
-      memset(control_buffer, 0, CMSG_SPACE(sizeof(int)));
-      message.msg_control = control_buffer;
-      message.msg_controllen = CMSG_SPACE(sizeof(int));
-      cmsghdr* control_message = CMSG_FIRSTHDR(&message);
-      control_message->cmsg_level = SOL_SOCKET;
-      control_message->cmsg_type = SCM_RIGHTS;
-      control_message->cmsg_len = CMSG_LEN(sizeof(int));
-      *reinterpret_cast<int*>(CMSG_DATA(control_message)) = proto.reply().pass_listen_socket().fd();
-      ASSERT(sent == total_size, "an fd passing message was too long for one sendmsg().");
-    }
+bool HotRestartingBase::sendDatagram(sockaddr_un& address, const Datagram& datagram) {
+  iovec iov[1];
+  iov[0].iov_base = const_cast<uint8_t*>(datagram.data_.data());
+  iov[0].iov_len = datagram.data_.size();
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_name = &address;
+  message.msg_namelen = sizeof(address);
+  message.msg_iov = iov;
+  message.msg_iovlen = 1;
 
-    const int rc = sendmsg(my_domain_socket_, &message, 0);
-    RELEASE_ASSERT(rc == static_cast<int>(cur_chunk_size),
-                   fmt::format("hot restart sendmsg() failed: returned {}, errno {}", rc, errno));
+  // Control data stuff, only relevant for the fd passing done with PassListenSocketReply and
+  // PassConnections.
+  uint8_t control_buffer[CMSG_SPACE(sizeof(int) * MaxPassedFds)];
+  if (!datagram.fds_.empty()) {
+    const size_t fds_size = sizeof(int) * datagram.fds_.size();
+    memset(control_buffer, 0, CMSG_SPACE(fds_size));
+    message.msg_control = control_buffer;
+    message.msg_controllen = CMSG_SPACE(fds_size);
+    cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+    control_message->cmsg_level = SOL_SOCKET;
+    control_message->cmsg_type = SCM_RIGHTS;
+    control_message->cmsg_len = CMSG_LEN(fds_size);
+    memcpy(CMSG_DATA(control_message), datagram.fds_.data(), fds_size);
   }
-  RELEASE_ASSERT(fcntl(my_domain_socket_, F_SETFL, O_NONBLOCK) != -1,
-                 fmt::format("Set domain socket nonblocking failed, errno = {}", errno));
+
+  const int rc = sendmsg(my_domain_socket_, &message, 0);
+  if (rc == -1 && errno == SOCKET_ERROR_AGAIN) {
+    return false;
+  }
+  RELEASE_ASSERT(rc == static_cast<int>(datagram.data_.size()),
+                 fmt::format("hot restart sendmsg() failed: returned {}, errno {}", rc, errno));
+  return true;
 }
 
 bool HotRestartingBase::replyIsExpectedType(const HotRestartMessage* proto,
@@ -121,24 +141,54 @@ bool HotRestartingBase::replyIsExpectedType(const HotRestartMessage* proto,
          proto->reply().reply_case() == oneof_type;
 }
 
-// Pull the cloned fd, if present, out of the control data and write it into the
-// PassListenSocketReply proto; the higher level code will see a listening fd that Just Works. We
-// should only get control data in a PassListenSocketReply, it should only be the fd passing type,
-// and there should only be one at a time. Crash on any other control data.
-void HotRestartingBase::getPassedFdIfPresent(HotRestartMessage* out, msghdr* message) {
-  cmsghdr* cmsg = CMSG_FIRSTHDR(message);
-  if (cmsg != nullptr) {
-    RELEASE_ASSERT(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
-                       replyIsExpectedType(out, HotRestartMessage::Reply::kPassListenSocket),
-                   "recvmsg() came with control data when the message's purpose was not to pass a "
-                   "file descriptor.");
+std::vector<int> HotRestartingBase::passedFds(const HotRestartMessage& proto) const {
+  std::vector<int> fds;
+  if (replyIsExpectedType(&proto, HotRestartMessage::Reply::kPassListenSocket)) {
+    if (proto.reply().pass_listen_socket().fd() != -1) {
+      fds.push_back(proto.reply().pass_listen_socket().fd());
+    }
+  } else if (replyIsExpectedType(&proto, HotRestartMessage::Reply::kPassConnections)) {
+    for (const auto& connection : proto.reply().pass_connections().connections()) {
+      fds.push_back(connection.fd());
+    }
+  }
+  return fds;
+}
 
-    out->mutable_reply()->mutable_pass_listen_socket()->set_fd(
-        *reinterpret_cast<int*>(CMSG_DATA(cmsg)));
+// Pull the cloned fds, if present, out of the control data. They are written into the
+// PassListenSocketReply or PassConnections proto once the message is complete.
+void HotRestartingBase::takePassedFds(msghdr* message) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(message); cmsg != nullptr; cmsg = CMSG_NXTHDR(message, cmsg)) {
+    RELEASE_ASSERT(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS,
+                   "recvmsg() came with control data other than passed file descriptors.");
+    const size_t num_fds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    const int* fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+    recv_fds_.insert(recv_fds_.end(), fds, fds + num_fds);
+  }
+}
 
-    RELEASE_ASSERT(CMSG_NXTHDR(message, cmsg) == nullptr,
-                   "More than one control data on a single hot restart recvmsg().");
+// Write the passed fds into the PassListenSocketReply or PassConnections proto; the higher level
+// code will see listening or connected fds that Just Work. We should only get fds in those
+// replies, and exactly as many as the proto lists. Crash otherwise.
+void HotRestartingBase::setPassedFds(HotRestartMessage* out) {
+  if (recv_fds_.empty()) {
+    return;
+  }
+  if (replyIsExpectedType(out, HotRestartMessage::Reply::kPassListenSocket)) {
+    RELEASE_ASSERT(recv_fds_.size() == 1, "PassListenSocket came with more than one fd.");
+    out->mutable_reply()->mutable_pass_listen_socket()->set_fd(recv_fds_[0]);
+  } else {
+    RELEASE_ASSERT(replyIsExpectedType(out, HotRestartMessage::Reply::kPassConnections),
+                   "recvmsg() came with control data when the message's purpose was not to pass a "
+                   "file descriptor.");
+    auto* connections = out->mutable_reply()->mutable_pass_connections()->mutable_connections();
+    RELEASE_ASSERT(static_cast<size_t>(connections->size()) == recv_fds_.size(),
+                   "PassConnections came with a different number of fds than connections.");
+    for (int i = 0; i < connections->size(); ++i) {
+      connections->Mutable(i)->set_fd(recv_fds_[i]);
+    }
   }
+  recv_fds_.clear();
 }
 
 // While in use, recv_buf_ is always >= MaxSendmsgSize. In between messages, it is kept empty,
@@ -175,19 +225,19 @@ std::unique_ptr<HotRestartMessage> HotRestartingBase::receiveHotRestartMessage(B
 
   iovec iov[1];
   msghdr message;
-  uint8_t control_buffer[CMSG_SPACE(sizeof(int))];
+  uint8_t control_buffer[CMSG_SPACE(sizeof(int) * MaxPassedFds)];
   std::unique_ptr<HotRestartMessage> ret = nullptr;
   while (!ret) {
     iov[0].iov_base = recv_buf_.data() + cur_msg_recvd_bytes_;
     iov[0].iov_len = MaxSendmsgSize;
 
-    // We always setup to receive an FD even though most messages do not pass one.
-    memset(control_buffer, 0, CMSG_SPACE(sizeof(int)));
+    // We always setup to receive FDs even though most messages do not pass any.
+    memset(control_buffer, 0, sizeof(control_buffer));
     memset(&message, 0, sizeof(message));
     message.msg_iov = iov;
     message.msg_iovlen = 1;
     message.msg_control = control_buffer;
-    message.msg_controllen = CMSG_SPACE(sizeof(int));
+    message.msg_controllen = sizeof(control_buffer);
 
     const int recvmsg_rc = recvmsg(my_domain_socket_, &message, 0);
     if (block == Blocking::No && recvmsg_rc == -1 && errno == SOCKET_ERROR_AGAIN) {
@@ -196,6 +246,7 @@ std::unique_ptr<HotRestartMessage> HotRestartingBase::receiveHotRestartMessage(B
     RELEASE_ASSERT(recvmsg_rc != -1, fmt::format("recvmsg() returned -1, errno = {}", errno));
     RELEASE_ASSERT(message.msg_flags == 0,
                    fmt::format("recvmsg() left msg_flags = {}", message.msg_flags));
+    takePassedFds(&message);
     cur_msg_recvd_bytes_ += recvmsg_rc;
 
     // If we don't already know 'length', we're at the start of a new length+protobuf message!
@@ -224,7 +275,7 @@ std::unique_ptr<HotRestartMessage> HotRestartingBase::receiveHotRestartMessage(B
     RELEASE_ASSERT(fcntl(my_domain_socket_, F_SETFL, O_NONBLOCK) != -1,
                    fmt::format("Set domain socket nonblocking failed, errno = {}", errno));
   }
-  getPassedFdIfPresent(ret.get(), &message);
+  setPassedFds(ret.get());
   return ret;
 }
 
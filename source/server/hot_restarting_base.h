@@ -9,6 +9,7 @@
 #include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/common/platform.h"
 #include "envoy/server/hot_restart.h"
@@ -48,9 +49,27 @@ protected:
   // starts at byte 0.
   //
   // There is no mechanism to explicitly pair responses to requests. However, the child initiates
-  // all exchanges, and blocks until a reply is received, so there is implicit pairing.
+  // all exchanges, and blocks until a reply is received, so there is implicit pairing. The one
+  // exception is PassConnections, whose replies the parent keeps sending as it releases
+  // connections, and which the child tells apart by their type.
+  //
+  // The fds which a message passes go along with its first datagram, up to MaxPassedFds of them.
   void sendHotRestartMessage(sockaddr_un& address, const envoy::HotRestartMessage& proto);
 
+  // The most fds that one sendmsg() can pass (the kernel's SCM_MAX_FD).
+  static constexpr uint32_t MaxPassedFds = 253;
+
+  // One sendmsg() datagram of a protocol message, along with the fds which it passes.
+  struct Datagram {
+    std::vector<uint8_t> data_;
+    std::vector<int> fds_;
+  };
+  // Splits a protocol message into the datagrams which carry it, in order.
+  std::vector<Datagram> toDatagrams(const envoy::HotRestartMessage& proto) const;
+  // Sends one datagram. Returns false if the domain socket is non-blocking and can't take the
+  // datagram yet.
+  bool sendDatagram(sockaddr_un& address, const Datagram& datagram);
+
   enum class Blocking { Yes, No };
   // Receive data, possibly enough to build one of our protocol messages.
   // If block is true, blocks until a full protocol message is available.
@@ -67,7 +86,10 @@ protected:
   static Stats::Gauge& hotRestartGeneration(Stats::Scope& scope);
 
 private:
-  void getPassedFdIfPresent(envoy::HotRestartMessage* out, msghdr* message);
+  // Returns the fds which the message passes to the other process.
+  std::vector<int> passedFds(const envoy::HotRestartMessage& proto) const;
+  void takePassedFds(msghdr* message);
+  void setPassedFds(envoy::HotRestartMessage* out);
   std::unique_ptr<envoy::HotRestartMessage> parseProtoAndResetState();
   void initRecvBufIfNewMessage();
 
@@ -93,6 +115,8 @@ private:
   // expected_proto_length_. The protobuf partial data starts at byte 8.
   // Should be resized to 0 in between messages, to indicate readiness for a new message.
   std::vector<uint8_t> recv_buf_;
+  // The fds which came with the datagrams of the in-flight message.
+  std::vector<int> recv_fds_;
 };
 
 } // namespace Server
@@ -1,5 +1,6 @@
 #include "server/hot_restarting_child.h"
 
+#include "common/api/os_sys_calls_impl.h"
 #include "common/common/utility.h"
 
 namespace Envoy {
@@ -16,6 +17,16 @@ HotRestartingChild::HotRestartingChild(int base_id, int restart_epoch,
         createDomainSocketAddress(restart_epoch_ + -1, "parent", socket_path, socket_mode);
   }
   bindDomainSocket(restart_epoch_, "child", socket_path, socket_mode);
+  if (restart_epoch_ != 0) {
+    // The parent sends its replies without blocking. Being connected, our socket only takes
+    // datagrams from the parent, and the parent's socket turns writable again as we read them.
+    const Api::SysCallIntResult result = Api::OsSysCallsSingleton::get().connect(
+        myDomainSocket(), reinterpret_cast<sockaddr*>(&parent_address_), sizeof(parent_address_));
+    if (result.rc_ != 0) {
+      ENVOY_LOG(warn, "unable to connect to the hot restart parent's domain socket, errno={}",
+                result.errno_);
+    }
+  }
 }
 
 int HotRestartingChild::duplicateParentListenSocket(const std::string& address) {
@@ -27,23 +38,118 @@ int HotRestartingChild::duplicateParentListenSocket(const std::string& address)
   wrapped_request.mutable_request()->mutable_pass_listen_socket()->set_address(address);
   sendHotRestartMessage(parent_address_, wrapped_request);
 
-  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveHotRestartMessage(Blocking::Yes);
+  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveParentReply();
   if (!replyIsExpectedType(wrapped_reply.get(), HotRestartMessage::Reply::kPassListenSocket)) {
     return -1;
   }
   return wrapped_reply->reply().pass_listen_socket().fd();
 }
 
+void HotRestartingChild::duplicateParentConnections(Event::Dispatcher& dispatcher,
+                                                    const HotRestart::ParentConnectionCb& cb) {
+  if (restart_epoch_ == 0 || parent_terminated_ || parent_connection_cb_ != nullptr) {
+    return;
+  }
+
+  parent_connection_cb_ = cb;
+  // The parent sends the connections as it releases them. The waits for the replies to other
+  // requests read from the same socket, so the event is level triggered to pick up the
+  // connections which arrive behind those replies.
+  socket_event_ = dispatcher.createFileEvent(
+      myDomainSocket(), [this](uint32_t) { onSocketEvent(); }, Event::FileTriggerType::Level,
+      Event::FileReadyType::Read);
+
+  HotRestartMessage wrapped_request;
+  wrapped_request.mutable_request()->mutable_pass_connections();
+  sendHotRestartMessage(parent_address_, wrapped_request);
+}
+
+void HotRestartingChild::onSocketEvent() {
+  std::unique_ptr<HotRestartMessage> wrapped_reply;
+  while (parent_connection_cb_ != nullptr &&
+         (wrapped_reply = receiveHotRestartMessage(Blocking::No)) != nullptr) {
+    // The replies to other requests are taken while waiting for them.
+    RELEASE_ASSERT(onPassConnectionsReply(*wrapped_reply),
+                   "Hot restart parent sent an unexpected message.");
+  }
+}
+
+bool HotRestartingChild::onPassConnectionsReply(const HotRestartMessage& wrapped_reply) {
+  if (replyIsExpectedType(&wrapped_reply, HotRestartMessage::Reply::kPassConnections)) {
+    for (const auto& connection : wrapped_reply.reply().pass_connections().connections()) {
+      parent_connection_cb_(connection.fd(), connection.listener_address());
+    }
+    return true;
+  }
+  // A parent which doesn't hand over connections replies that it didn't recognize the request.
+  if (wrapped_reply.didnt_recognize_your_last_message()) {
+    parent_connection_cb_ = nullptr;
+    socket_event_->setEnabled(0);
+    return true;
+  }
+  return false;
+}
+
+std::unique_ptr<HotRestartMessage> HotRestartingChild::receiveParentReply() {
+  while (true) {
+    std::unique_ptr<HotRestartMessage> wrapped_reply = receiveHotRestartMessage(Blocking::Yes);
+    if (parent_connection_cb_ == nullptr || !onPassConnectionsReply(*wrapped_reply)) {
+      return wrapped_reply;
+    }
+  }
+}
+
+absl::optional<Ssl::ServerSessionState> HotRestartingChild::getParentServerSessionState() {
+  if (restart_epoch_ == 0 || parent_terminated_) {
+    return absl::nullopt;
+  }
+
+  HotRestartMessage wrapped_request;
+  wrapped_request.mutable_request()->mutable_server_session_state();
+  sendHotRestartMessage(parent_address_, wrapped_request);
+
+  // A parent which doesn't hand over its sessions replies that it didn't recognize the request.
+  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveParentReply();
+  if (!replyIsExpectedType(wrapped_reply.get(), HotRestartMessage::Reply::kServerSessionState)) {
+    return absl::nullopt;
+  }
+  const HotRestartMessage::Reply::ServerSessionState& reply =
+      wrapped_reply->reply().server_session_state();
+  if (reply.ticket_keys().empty() && reply.sessions().empty()) {
+    return absl::nullopt;
+  }
+
+  Ssl::ServerSessionState state;
+  for (const HotRestartMessage::Reply::ServerSessionState::TicketKey& reply_key :
+       reply.ticket_keys()) {
+    Ssl::ServerContextConfig::SessionTicketKey key;
+    RELEASE_ASSERT(reply_key.name().size() == key.name_.size() &&
+                       reply_key.hmac_key().size() == key.hmac_key_.size() &&
+                       reply_key.aes_key().size() == key.aes_key_.size(),
+                   "Hot restart parent sent a malformed session ticket key.");
+    std::copy(reply_key.name().begin(), reply_key.name().end(), key.name_.begin());
+    std::copy(reply_key.hmac_key().begin(), reply_key.hmac_key().end(), key.hmac_key_.begin());
+    std::copy(reply_key.aes_key().begin(), reply_key.aes_key().end(), key.aes_key_.begin());
+    state.ticket_keys_.push_back(key);
+  }
+  state.ticket_key_age_ = std::chrono::seconds(reply.ticket_key_age_seconds());
+  state.sessions_.assign(reply.sessions().begin(), reply.sessions().end());
+  return state;
+}
+
 std::unique_ptr<HotRestartMessage> HotRestartingChild::getParentStats() {
   if (restart_epoch_ == 0 || parent_terminated_) {
     return nullptr;
   }
 
   HotRestartMessage wrapped_request;
-  wrapped_request.mutable_request()->mutable_stats();
+  // The stat merger keeps the names of the stats from earlier replies, so the parent only needs to
+  // send them once. Parents which don't know about indexes ignore this and send names every time.
+  wrapped_request.mutable_request()->mutable_stats()->set_indexed(true);
+  wrapped_request.mutable_request()->mutable_stats()->set_forget_indexes(stat_merger_ == nullptr);
   sendHotRestartMessage(parent_address_, wrapped_request);
 
-  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveHotRestartMessage(Blocking::Yes);
+  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveParentReply();
   RELEASE_ASSERT(replyIsExpectedType(wrapped_reply.get(), HotRestartMessage::Reply::kStats),
                  "Hot restart parent did not respond as expected to get stats request.");
   return wrapped_reply;
@@ -68,7 +174,7 @@ void HotRestartingChild::sendParentAdminShutdownRequest(time_t& original_start_t
   wrapped_request.mutable_request()->mutable_shutdown_admin();
   sendHotRestartMessage(parent_address_, wrapped_request);
 
-  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveHotRestartMessage(Blocking::Yes);
+  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveParentReply();
   RELEASE_ASSERT(replyIsExpectedType(wrapped_reply.get(), HotRestartMessage::Reply::kShutdownAdmin),
                  "Hot restart parent did not respond as expected to ShutdownParentAdmin.");
   original_start_time = wrapped_reply->reply().shutdown_admin().original_start_time_unix_seconds();
@@ -82,6 +188,7 @@ void HotRestartingChild::sendParentTerminateRequest() {
   wrapped_request.mutable_request()->mutable_terminate();
   sendHotRestartMessage(parent_address_, wrapped_request);
   parent_terminated_ = true;
+  // The connections which the parent already sent are still taken from the socket.
 
   // Note that the 'generation' counter needs to retain the contribution from
   // the parent.
@@ -96,6 +203,11 @@ void HotRestartingChild::sendParentTerminateRequest() {
   stat_merger_.reset();
 }
 
+void HotRestartingChild::shutdown() {
+  socket_event_.reset();
+  parent_connection_cb_ = nullptr;
+}
+
 void HotRestartingChild::mergeParentStats(Stats::Store& stats_store,
                                           const HotRestartMessage::Reply::Stats& stats_proto) {
   if (!stat_merger_) {
@@ -114,6 +226,8 @@ void HotRestartingChild::mergeParentStats(Stats::Store& stats_store,
     }
   }
   stat_merger_->mergeStats(stats_proto.counter_deltas(), stats_proto.gauges(), dynamics);
+  stat_merger_->mergeIndexedStats(stats_proto.stat_names(), stats_proto.indexed_counter_deltas(),
+                                  stats_proto.indexed_gauges(), dynamics);
 }
 
 } // namespace Server
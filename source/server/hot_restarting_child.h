@@ -16,16 +16,29 @@ public:
                      mode_t socket_mode);
 
   int duplicateParentListenSocket(const std::string& address);
+  void duplicateParentConnections(Event::Dispatcher& dispatcher,
+                                  const HotRestart::ParentConnectionCb& cb);
+  absl::optional<Ssl::ServerSessionState> getParentServerSessionState();
   std::unique_ptr<envoy::HotRestartMessage> getParentStats();
   void drainParentListeners();
   void sendParentAdminShutdownRequest(time_t& original_start_time);
   void sendParentTerminateRequest();
   void mergeParentStats(Stats::Store& stats_store,
                         const envoy::HotRestartMessage::Reply::Stats& stats_proto);
+  void shutdown();
 
 private:
+  void onSocketEvent();
+  // Handles a reply to PassConnections. Returns false if the reply is to another request.
+  bool onPassConnectionsReply(const envoy::HotRestartMessage& wrapped_reply);
+  // Waits for the reply to a request, handling the replies to PassConnections which arrive first.
+  std::unique_ptr<envoy::HotRestartMessage> receiveParentReply();
+
   const int restart_epoch_;
   bool parent_terminated_{};
+  // Set while the parent hands connections over.
+  HotRestart::ParentConnectionCb parent_connection_cb_;
+  Event::FileEventPtr socket_event_;
   sockaddr_un parent_address_;
   std::unique_ptr<Stats::StatMerger> stat_merger_{};
   Stats::StatName hot_restart_generation_stat_name_;
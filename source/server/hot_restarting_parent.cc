@@ -2,14 +2,18 @@
 
 #include "envoy/server/instance.h"
 
+#include "common/common/thread.h"
 #include "common/memory/stats.h"
 #include "common/network/utility.h"
+#include "common/runtime/runtime_features.h"
 #include "common/stats/stat_merger.h"
 #include "common/stats/symbol_table_impl.h"
 #include "common/stats/utility.h"
 
 #include "server/listener_impl.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Server {
 
@@ -23,13 +27,20 @@ HotRestartingParent::HotRestartingParent(int base_id, int restart_epoch,
 }
 
 void HotRestartingParent::initialize(Event::Dispatcher& dispatcher, Server::Instance& server) {
+  // Replies are sent without blocking. The socket turns writable again once the child reads what
+  // it was sent, since the child's socket is connected to ours.
   socket_event_ = dispatcher.createFileEvent(
       myDomainSocket(),
       [this](uint32_t events) -> void {
-        ASSERT(events == Event::FileReadyType::Read);
-        onSocketEvent();
+        if (events & Event::FileReadyType::Write) {
+          sendQueuedReplies();
+        }
+        if (events & Event::FileReadyType::Read) {
+          onSocketEvent();
+        }
       },
-      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  release_connections_timer_ = dispatcher.createTimer([this]() { releaseConnectionsForChild(); });
   internal_ = std::make_unique<Internal>(&server);
 }
 
@@ -40,25 +51,34 @@ void HotRestartingParent::onSocketEvent() {
       ENVOY_LOG(error, "child sent us a HotRestartMessage reply (we want requests); ignoring.");
       HotRestartMessage wrapped_reply;
       wrapped_reply.set_didnt_recognize_your_last_message(true);
-      sendHotRestartMessage(child_address_, wrapped_reply);
+      sendToChild(wrapped_reply);
       continue;
     }
     switch (wrapped_request->request().request_case()) {
     case HotRestartMessage::Request::kShutdownAdmin: {
-      sendHotRestartMessage(child_address_, internal_->shutdownAdmin());
+      sendToChild(internal_->shutdownAdmin());
       break;
     }
 
     case HotRestartMessage::Request::kPassListenSocket: {
-      sendHotRestartMessage(child_address_,
-                            internal_->getListenSocketsForChild(wrapped_request->request()));
+      sendToChild(internal_->getListenSocketsForChild(wrapped_request->request()));
       break;
     }
 
     case HotRestartMessage::Request::kStats: {
       HotRestartMessage wrapped_reply;
-      internal_->exportStatsToChild(wrapped_reply.mutable_reply()->mutable_stats());
-      sendHotRestartMessage(child_address_, wrapped_reply);
+      if (wrapped_request->request().stats().indexed()) {
+        internal_->exportIndexedStatsToChild(wrapped_request->request().stats(),
+                                             wrapped_reply.mutable_reply()->mutable_stats());
+      } else {
+        internal_->exportStatsToChild(wrapped_reply.mutable_reply()->mutable_stats());
+      }
+      sendToChild(wrapped_reply);
+      break;
+    }
+
+    case HotRestartMessage::Request::kServerSessionState: {
+      sendToChild(internal_->exportServerSessionState());
       break;
     }
 
@@ -67,6 +87,14 @@ void HotRestartingParent::onSocketEvent() {
       break;
     }
 
+    case HotRestartMessage::Request::kPassConnections: {
+      // The child asks once. From then on, the connections are sent as they are released.
+      if (!releasing_connections_) {
+        releaseConnectionsForChild();
+      }
+      break;
+    }
+
     case HotRestartMessage::Request::kTerminate: {
       ENVOY_LOG(info, "shutting down due to child request");
       kill(getpid(), SIGTERM);
@@ -77,14 +105,57 @@ void HotRestartingParent::onSocketEvent() {
       ENVOY_LOG(error, "child sent us an unfamiliar type of HotRestartMessage; ignoring.");
       HotRestartMessage wrapped_reply;
       wrapped_reply.set_didnt_recognize_your_last_message(true);
-      sendHotRestartMessage(child_address_, wrapped_reply);
+      sendToChild(wrapped_reply);
       break;
     }
     }
   }
 }
 
-void HotRestartingParent::shutdown() { socket_event_.reset(); }
+void HotRestartingParent::sendToChild(const HotRestartMessage& wrapped_reply,
+                                      std::vector<Network::IoHandlePtr>&& io_handles) {
+  std::vector<Datagram> datagrams = toDatagrams(wrapped_reply);
+  // The fds go along with the first datagram, so the sockets can close once it is sent.
+  send_queue_.push_back(QueuedDatagram{std::move(datagrams.front()), std::move(io_handles)});
+  for (auto it = datagrams.begin() + 1; it != datagrams.end(); ++it) {
+    send_queue_.push_back(QueuedDatagram{std::move(*it), {}});
+  }
+  sendQueuedReplies();
+}
+
+void HotRestartingParent::sendQueuedReplies() {
+  while (!send_queue_.empty() && sendDatagram(child_address_, send_queue_.front().datagram_)) {
+    send_queue_.pop_front();
+  }
+}
+
+void HotRestartingParent::releaseConnectionsForChild() {
+  releasing_connections_ = internal_->releaseConnectionsForChild(
+      [this](std::vector<Internal::ConnectionsReply>&& replies) {
+        if (socket_event_ == nullptr) {
+          // Shut down while the workers released the connections, which close with the replies.
+          return;
+        }
+        for (Internal::ConnectionsReply& reply : replies) {
+          sendToChild(reply.message_, std::move(reply.io_handles_));
+        }
+        // More connections go idle until this process exits. Look for them right away while
+        // there are some to hand over, otherwise check back in a while.
+        release_connections_timer_->enableTimer(replies.empty() ? std::chrono::milliseconds(1000)
+                                                                : std::chrono::milliseconds(0));
+      });
+  if (!releasing_connections_) {
+    HotRestartMessage wrapped_reply;
+    wrapped_reply.set_didnt_recognize_your_last_message(true);
+    sendToChild(wrapped_reply);
+  }
+}
+
+void HotRestartingParent::shutdown() {
+  socket_event_.reset();
+  release_connections_timer_.reset();
+  send_queue_.clear();
+}
 
 HotRestartingParent::Internal::Internal(Server::Instance* server) : server_(server) {
   Stats::Gauge& hot_restart_generation = hotRestartGeneration(server->stats());
@@ -148,6 +219,56 @@ void HotRestartingParent::Internal::exportStatsToChild(HotRestartMessage::Reply:
   stats->set_num_connections(server_->listenerManager().numConnections());
 }
 
+void HotRestartingParent::Internal::exportIndexedStatsToChild(
+    const HotRestartMessage::Request::Stats& request, HotRestartMessage::Reply::Stats* stats) {
+  if (request.forget_indexes()) {
+    exported_stats_.clear();
+    exported_counters_.clear();
+    exported_gauges_.clear();
+  }
+
+  for (const Stats::GaugeSharedPtr& gauge : server_->stats().gauges()) {
+    if (gauge->used()) {
+      const uint64_t value = gauge->value();
+      auto it = exported_gauges_.find(gauge.get());
+      if (it == exported_gauges_.end()) {
+        it = exported_gauges_.emplace(gauge.get(), ExportedGauge{statIndex(stats, *gauge), value})
+                 .first;
+      } else if (it->second.value_ == value) {
+        continue;
+      }
+      it->second.value_ = value;
+      (*stats->mutable_indexed_gauges())[it->second.index_] = value;
+    }
+  }
+
+  for (const Stats::CounterSharedPtr& counter : server_->stats().counters()) {
+    if (counter->used()) {
+      // As in exportStatsToChild(), the parent no longer latches its counters for anything else.
+      const uint64_t latched_value = counter->latch();
+      if (latched_value > 0) {
+        auto it = exported_counters_.find(counter.get());
+        if (it == exported_counters_.end()) {
+          it = exported_counters_.emplace(counter.get(), statIndex(stats, *counter)).first;
+        }
+        (*stats->mutable_indexed_counter_deltas())[it->second] = latched_value;
+      }
+    }
+  }
+  stats->set_memory_allocated(Memory::Stats::totalCurrentlyAllocated());
+  stats->set_num_connections(server_->listenerManager().numConnections());
+}
+
+uint32_t HotRestartingParent::Internal::statIndex(HotRestartMessage::Reply::Stats* stats,
+                                                  Stats::Metric& metric) {
+  const uint32_t index = exported_stats_.size();
+  exported_stats_.emplace_back(&metric);
+  const std::string name = metric.name();
+  (*stats->mutable_stat_names())[index] = name;
+  recordDynamics(stats, name, metric.statName());
+  return index;
+}
+
 void HotRestartingParent::Internal::recordDynamics(HotRestartMessage::Reply::Stats* stats,
                                                    const std::string& name,
                                                    Stats::StatName stat_name) {
@@ -174,5 +295,71 @@ void HotRestartingParent::Internal::recordDynamics(HotRestartMessage::Reply::Sta
 
 void HotRestartingParent::Internal::drainListeners() { server_->drainListeners(); }
 
+HotRestartMessage HotRestartingParent::Internal::exportServerSessionState() {
+  HotRestartMessage wrapped_reply;
+  HotRestartMessage::Reply::ServerSessionState* reply =
+      wrapped_reply.mutable_reply()->mutable_server_session_state();
+  absl::optional<Ssl::ServerSessionState> state =
+      server_->sslContextManager().exportServerSessionState();
+  if (!state.has_value()) {
+    return wrapped_reply;
+  }
+  for (const Ssl::ServerContextConfig::SessionTicketKey& key : state->ticket_keys_) {
+    HotRestartMessage::Reply::ServerSessionState::TicketKey* reply_key = reply->add_ticket_keys();
+    reply_key->set_name(key.name_.data(), key.name_.size());
+    reply_key->set_hmac_key(key.hmac_key_.data(), key.hmac_key_.size());
+    reply_key->set_aes_key(key.aes_key_.data(), key.aes_key_.size());
+  }
+  reply->set_ticket_key_age_seconds(state->ticket_key_age_.count());
+  for (std::string& session : state->sessions_) {
+    reply->add_sessions(std::move(session));
+  }
+  return wrapped_reply;
+}
+
+bool HotRestartingParent::Internal::releaseConnectionsForChild(
+    std::function<void(std::vector<ConnectionsReply>&& replies)> cb) {
+  if (!Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.hot_restart_transfer_idle_connections")) {
+    return false;
+  }
+
+  struct ReleasedConnections {
+    Thread::MutexBasicLockable mutex_;
+    std::vector<std::pair<Network::IoHandlePtr, std::string>> connections_ ABSL_GUARDED_BY(mutex_);
+  };
+  auto released = std::make_shared<ReleasedConnections>();
+  server_->listenerManager().releaseTransferableConnections(
+      [released](Network::IoHandlePtr&& io_handle,
+                 const Network::Address::Instance& listener_address) {
+        Thread::LockGuard lock(released->mutex_);
+        released->connections_.emplace_back(
+            std::move(io_handle),
+            absl::StrCat(Network::Utility::TCP_SCHEME, listener_address.asString()));
+      },
+      [released, cb]() {
+        std::vector<std::pair<Network::IoHandlePtr, std::string>> connections;
+        {
+          Thread::LockGuard lock(released->mutex_);
+          connections.swap(released->connections_);
+        }
+        std::vector<ConnectionsReply> replies;
+        for (auto& connection : connections) {
+          // Pass as many connections in each reply as one sendmsg() can.
+          if (replies.empty() || replies.back().io_handles_.size() == MaxPassedFds) {
+            replies.emplace_back();
+          }
+          ConnectionsReply& reply = replies.back();
+          HotRestartMessage::Reply::PassConnections::Connection* passed =
+              reply.message_.mutable_reply()->mutable_pass_connections()->add_connections();
+          passed->set_fd(connection.first->fdDoNotUse());
+          passed->set_listener_address(connection.second);
+          reply.io_handles_.push_back(std::move(connection.first));
+        }
+        cb(std::move(replies));
+      });
+  return true;
+}
+
 } // namespace Server
 } // namespace Envoy
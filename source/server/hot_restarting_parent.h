@@ -1,9 +1,19 @@
 #pragma once
 
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "envoy/network/io_handle.h"
+#include "envoy/stats/refcount_ptr.h"
+#include "envoy/stats/stats.h"
+
 #include "common/common/hash.h"
 
 #include "server/hot_restarting_base.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Server {
 
@@ -31,21 +41,68 @@ public:
     getListenSocketsForChild(const envoy::HotRestartMessage::Request& request);
     // 'stats' is a field in the reply protobuf to be sent to the child, which we should populate.
     void exportStatsToChild(envoy::HotRestartMessage::Reply::Stats* stats);
+    // Like exportStatsToChild(), for children which keep the stat names of earlier replies. Only
+    // the gauges which changed since the last export are included.
+    void exportIndexedStatsToChild(const envoy::HotRestartMessage::Request::Stats& request,
+                                   envoy::HotRestartMessage::Reply::Stats* stats);
     void recordDynamics(envoy::HotRestartMessage::Reply::Stats* stats, const std::string& name,
                         Stats::StatName stat_name);
     void drainListeners();
+    // Return value is the response to return to the child.
+    envoy::HotRestartMessage exportServerSessionState();
+
+    // A reply which hands connections over to the child. The sockets in io_handles_ are the ones
+    // whose fds the reply passes, and must stay open until the reply is sent.
+    struct ConnectionsReply {
+      envoy::HotRestartMessage message_;
+      std::vector<Network::IoHandlePtr> io_handles_;
+    };
+    // Releases the connections which the child can take over. 'cb' is called on the main thread
+    // with the replies to send to the child, each passing up to MaxPassedFds connections, or with
+    // no replies if no connection was released. Returns false without calling 'cb' if connections
+    // are not handed over.
+    bool
+    releaseConnectionsForChild(std::function<void(std::vector<ConnectionsReply>&& replies)> cb);
 
   private:
+    // Returns the index of a stat in indexed exports, adding the stat's name to 'stats' the first
+    // time the stat is exported.
+    uint32_t statIndex(envoy::HotRestartMessage::Reply::Stats* stats, Stats::Metric& metric);
+
+    struct ExportedGauge {
+      uint32_t index_;
+      uint64_t value_;
+    };
+
     Server::Instance* const server_{};
+    // The stats exported to the child by index. A stat's index is its position in exported_stats_,
+    // which also keeps the stats alive so that their addresses aren't reused for other stats.
+    std::vector<Stats::RefcountPtr<Stats::Metric>> exported_stats_;
+    absl::flat_hash_map<const Stats::Counter*, uint32_t> exported_counters_;
+    absl::flat_hash_map<const Stats::Gauge*, ExportedGauge> exported_gauges_;
   };
 
 private:
   void onSocketEvent();
+  // Queues a reply to the child, and sends as much of the queue as the domain socket takes without
+  // blocking. The sockets in io_handles are closed once the reply has passed their fds.
+  void sendToChild(const envoy::HotRestartMessage& wrapped_reply,
+                   std::vector<Network::IoHandlePtr>&& io_handles = {});
+  void sendQueuedReplies();
+  void releaseConnectionsForChild();
+
+  struct QueuedDatagram {
+    Datagram datagram_;
+    std::vector<Network::IoHandlePtr> io_handles_;
+  };
 
   const int restart_epoch_;
   sockaddr_un child_address_;
   Event::FileEventPtr socket_event_;
+  Event::TimerPtr release_connections_timer_;
   std::unique_ptr<Internal> internal_;
+  std::deque<QueuedDatagram> send_queue_;
+  bool releasing_connections_{};
 };
 
 } // namespace Server
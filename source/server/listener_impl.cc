@@ -319,7 +319,7 @@ ListenerImpl::ListenerImpl(ListenerImpl& origin,
                            const envoy::config::listener::v3::Listener& config,
                            const std::string& version_info, ListenerManagerImpl& parent,
                            const std::string& name, bool added_via_api, bool workers_started,
-                           uint64_t hash, uint32_t concurrency)
+                           uint64_t hash)
     : parent_(parent), address_(origin.address_),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
       hand_off_restored_destination_connections_(
@@ -337,7 +337,9 @@ ListenerImpl::ListenerImpl(ListenerImpl& origin,
       listener_init_target_("", nullptr),
       dynamic_init_manager_(std::make_unique<Init::ManagerImpl>(
           fmt::format("Listener-local-init-manager {} {}", name, hash))),
-      config_(config), version_info_(version_info),
+      listener_filter_factories_(origin.listener_filter_factories_),
+      access_logs_(origin.access_logs_), config_(config), version_info_(version_info),
+      listen_socket_options_(origin.listen_socket_options_),
       listener_filters_timeout_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, listener_filters_timeout, 15000)),
       continue_on_listener_filters_timeout_(config.continue_on_listener_filters_timeout()),
@@ -350,19 +352,13 @@ ListenerImpl::ListenerImpl(ListenerImpl& origin,
         ASSERT(workers_started_);
         parent_.inPlaceFilterChainUpdate(*this);
       }) {
-  buildAccessLog();
-  auto socket_type = Network::Utility::protobufAddressSocketType(config.address());
-  buildListenSocketOptions(socket_type);
-  buildUdpListenerFactory(socket_type, concurrency);
-  buildUdpWriterFactory(socket_type);
-  createListenerFilterFactories(socket_type);
-  validateFilterChains(socket_type);
+  // In place update is tcp only and only the filter chains differ from the origin listener (see
+  // supportUpdateFilterChain()), so the access logs, socket options and listener filters, including
+  // the implicitly added ones, are taken over as they are rather than built again. Listener filter
+  // factories only capture state owned by the listener factory context base, which is shared with
+  // the origin listener.
+  validateFilterChains(Network::Socket::Type::Stream);
   buildFilterChains();
-  // In place update is tcp only so it's safe to apply below tcp only initialization.
-  buildSocketOptions();
-  buildOriginalDstListenerFilter();
-  buildProxyProtocolListenerFilter();
-  buildTlsInspectorListenerFilter();
   open_connections_ = origin.open_connections_;
 }
 
@@ -512,9 +508,20 @@ void ListenerImpl::buildSocketOptions() {
   if (connection_balancer_ == nullptr) {
     // Not in place listener update.
     if (config_.has_connection_balance_config()) {
-      // Currently exact balance is the only supported type and there are no options.
-      ASSERT(config_.connection_balance_config().has_exact_balance());
-      connection_balancer_ = std::make_shared<Network::ExactConnectionBalancerImpl>();
+      const auto& balance_config = config_.connection_balance_config();
+      switch (balance_config.balance_type_case()) {
+      case envoy::config::listener::v3::Listener::ConnectionBalanceConfig::kExactBalance:
+        connection_balancer_ = std::make_shared<Network::ExactConnectionBalancerImpl>();
+        break;
+      case envoy::config::listener::v3::Listener::ConnectionBalanceConfig::kLeastConnectionBalance:
+        connection_balancer_ = std::make_shared<Network::LeastConnectionBalancerImpl>(
+            parent_.server_.api().randomGenerator(),
+            PROTOBUF_GET_WRAPPED_OR_DEFAULT(balance_config.least_connection_balance(),
+                                            choice_count, 2));
+        break;
+      default:
+        NOT_REACHED_GCOVR_EXCL_LINE;
+      }
     } else {
       connection_balancer_ = std::make_shared<Network::NopConnectionBalancerImpl>();
     }
@@ -747,7 +754,7 @@ ListenerImpl::newListenerWithFilterChain(const envoy::config::listener::v3::List
   return absl::WrapUnique(
       new ListenerImpl(*this, config, version_info_, parent_, name_, added_via_api_,
                        /* new new workers started state */ workers_started,
-                       /* use new hash */ hash, parent_.server_.options().concurrency()));
+                       /* use new hash */ hash));
 }
 
 void ListenerImpl::diffFilterChain(const ListenerImpl& another_listener,
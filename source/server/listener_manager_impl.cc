@@ -971,6 +971,49 @@ void ListenerManagerImpl::stopWorkers() {
   }
 }
 
+void ListenerManagerImpl::releaseTransferableConnections(
+    Network::ConnectionHandler::ReleasedConnectionCb cb, std::function<void()> completion) {
+  if (!workers_started_) {
+    completion();
+    return;
+  }
+  const auto workers_pending_release = std::make_shared<std::atomic<uint64_t>>(workers_.size());
+  for (const auto& worker : workers_) {
+    worker->releaseTransferableConnections(cb, [this, completion, workers_pending_release]() {
+      if (--(*workers_pending_release) == 0) {
+        server_.dispatcher().post(completion);
+      }
+    });
+  }
+}
+
+void ListenerManagerImpl::adoptParentConnections() {
+  if (!workers_started_) {
+    return;
+  }
+  server_.hotRestart().duplicateParentConnections(
+      server_.dispatcher(), [this](int fd, const std::string& listener_address) {
+        Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
+        Network::ConnectionSocketPtr socket;
+        Network::Address::InstanceConstSharedPtr address;
+        try {
+          address = Network::Utility::resolveUrl(listener_address);
+          // These throw if the peer has already gone away.
+          Network::Address::InstanceConstSharedPtr local_address = io_handle->localAddress();
+          Network::Address::InstanceConstSharedPtr remote_address = io_handle->peerAddress();
+          socket = std::make_unique<Network::AcceptedSocketImpl>(std::move(io_handle),
+                                                                 local_address, remote_address);
+        } catch (const EnvoyException& e) {
+          ENVOY_LOG(debug, "dropping connection from parent on {}: {}", listener_address, e.what());
+          return;
+        }
+        ENVOY_LOG(debug, "adopting connection from parent on {}", listener_address);
+        Worker& worker = *workers_[next_adopting_worker_];
+        next_adopting_worker_ = (next_adopting_worker_ + 1) % workers_.size();
+        worker.adoptConnection(std::move(address), std::move(socket));
+      });
+}
+
 void ListenerManagerImpl::endListenerUpdate(FailureStates&& failure_states) {
   overall_error_state_ = std::move(failure_states);
 }
@@ -201,6 +201,9 @@ public:
   bool isWorkerStarted() override { return workers_started_; }
   Http::Context& httpContext() { return server_.httpContext(); }
   ApiListenerOptRef apiListener() override;
+  void releaseTransferableConnections(Network::ConnectionHandler::ReleasedConnectionCb cb,
+                                      std::function<void()> completion) override;
+  void adoptParentConnections() override;
 
   Instance& server_;
   ListenerComponentFactory& factory_;
@@ -304,6 +307,8 @@ private:
 
   std::vector<WorkerPtr> workers_;
   bool workers_started_{};
+  // The worker which adopts the next connection released by another process.
+  uint32_t next_adopting_worker_{};
   absl::optional<StopListenersType> stop_listeners_type_;
   Stats::ScopePtr scope_;
   ListenerManagerStats stats_;
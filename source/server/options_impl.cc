@@ -126,6 +126,14 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   TCLAP::ValueArg<uint32_t> file_flush_interval_msec("", "file-flush-interval-msec",
                                                      "Interval for log flushing in msec", false,
                                                      10000, "uint32_t", cmd);
+  TCLAP::ValueArg<uint64_t> file_flush_buffer_limit_bytes(
+      "", "file-flush-buffer-limit-bytes",
+      "Limit in bytes of the data buffered for each log file (0 for no limit)", false, 0,
+      "uint64_t", cmd);
+  TCLAP::ValueArg<std::string> file_flush_overflow_policy(
+      "", "file-flush-overflow-policy",
+      "What to do with log writes beyond the buffer limit, one of 'drop' (default) or 'block'.",
+      false, "drop", "string", cmd);
   TCLAP::ValueArg<uint32_t> drain_time_s("", "drain-time-s",
                                          "Hot restart and LDS removal drain time in seconds", false,
                                          600, "uint32_t", cmd);
@@ -264,6 +272,7 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
+  file_flush_buffer_limit_bytes_ = file_flush_buffer_limit_bytes.getValue();
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   socket_path_ = socket_path.getValue();
@@ -288,6 +297,15 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
         fmt::format("error: unknown drain-strategy '{}'", mode.getValue()));
   }
 
+  if (file_flush_overflow_policy.getValue() == "drop") {
+    file_flush_overflow_policy_ = Server::FileFlushOverflowPolicy::Drop;
+  } else if (file_flush_overflow_policy.getValue() == "block") {
+    file_flush_overflow_policy_ = Server::FileFlushOverflowPolicy::Block;
+  } else {
+    throw MalformedArgvException(fmt::format("error: unknown file-flush-overflow-policy '{}'",
+                                             file_flush_overflow_policy.getValue()));
+  }
+
   if (hot_restart_version_option.getValue()) {
     std::cerr << hot_restart_version_cb(!hot_restart_disabled_);
     throw NoServingException();
@@ -392,6 +410,11 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   }
   command_line_options->mutable_file_flush_interval()->MergeFrom(
       Protobuf::util::TimeUtil::MillisecondsToDuration(fileFlushIntervalMsec().count()));
+  command_line_options->set_file_flush_buffer_limit_bytes(fileFlushBufferLimitBytes());
+  command_line_options->set_file_flush_overflow_policy(
+      fileFlushOverflowPolicy() == Server::FileFlushOverflowPolicy::Block
+          ? envoy::admin::v3::CommandLineOptions::Block
+          : envoy::admin::v3::CommandLineOptions::Drop);
 
   command_line_options->mutable_drain_time()->MergeFrom(
       Protobuf::util::TimeUtil::SecondsToDuration(drainTime().count()));
@@ -420,7 +443,9 @@ OptionsImpl::OptionsImpl(const std::string& service_cluster, const std::string&
       local_address_ip_version_(Network::Address::IpVersion::v4), log_level_(log_level),
       log_format_(Logger::Logger::DEFAULT_LOG_FORMAT), log_format_escaped_(false),
       restart_epoch_(0u), service_cluster_(service_cluster), service_node_(service_node),
-      service_zone_(service_zone), file_flush_interval_msec_(10000), drain_time_(600),
+      service_zone_(service_zone), file_flush_interval_msec_(10000),
+      file_flush_buffer_limit_bytes_(0),
+      file_flush_overflow_policy_(Server::FileFlushOverflowPolicy::Drop), drain_time_(600),
       parent_shutdown_time_(900), drain_strategy_(Server::DrainStrategy::Gradual),
       mode_(Server::Mode::Serve), hot_restart_disabled_(false), signal_handling_enabled_(true),
       mutex_tracing_enabled_(false), cpuset_threads_(false), fake_symbol_table_enabled_(false),
@@ -78,6 +78,12 @@ public:
   void setFileFlushIntervalMsec(std::chrono::milliseconds file_flush_interval_msec) {
     file_flush_interval_msec_ = file_flush_interval_msec;
   }
+  void setFileFlushBufferLimitBytes(uint64_t file_flush_buffer_limit_bytes) {
+    file_flush_buffer_limit_bytes_ = file_flush_buffer_limit_bytes;
+  }
+  void setFileFlushOverflowPolicy(Server::FileFlushOverflowPolicy file_flush_overflow_policy) {
+    file_flush_overflow_policy_ = file_flush_overflow_policy;
+  }
   void setServiceClusterName(const std::string& service_cluster) {
     service_cluster_ = service_cluster;
   }
@@ -144,6 +150,10 @@ public:
   std::chrono::milliseconds fileFlushIntervalMsec() const override {
     return file_flush_interval_msec_;
   }
+  uint64_t fileFlushBufferLimitBytes() const override { return file_flush_buffer_limit_bytes_; }
+  Server::FileFlushOverflowPolicy fileFlushOverflowPolicy() const override {
+    return file_flush_overflow_policy_;
+  }
   const std::string& serviceClusterName() const override { return service_cluster_; }
   const std::string& serviceNodeName() const override { return service_node_; }
   const std::string& serviceZone() const override { return service_zone_; }
@@ -197,6 +207,8 @@ private:
   std::string service_node_;
   std::string service_zone_;
   std::chrono::milliseconds file_flush_interval_msec_;
+  uint64_t file_flush_buffer_limit_bytes_;
+  Server::FileFlushOverflowPolicy file_flush_overflow_policy_;
   std::chrono::seconds drain_time_;
   std::chrono::seconds parent_shutdown_time_;
   Server::DrainStrategy drain_strategy_;
@@ -215,8 +215,11 @@ bool operator==(const NamedOverloadActionSymbolTable::Symbol& lhs,
 }
 
 OverloadAction::OverloadAction(const envoy::config::overload::v3::OverloadAction& config,
-                               Stats::Scope& stats_scope)
-    : state_(OverloadActionState::inactive()),
+                               Stats::Scope& stats_scope, TimeSource& time_source)
+    : time_source_(time_source), ramp_down_duration_(std::chrono::milliseconds(
+                                     PROTOBUF_GET_MS_OR_DEFAULT(config, ramp_down_duration, 0))),
+      target_state_(OverloadActionState::inactive()), state_(OverloadActionState::inactive()),
+      last_state_update_(time_source_.monotonicTime()),
       active_gauge_(
           makeGauge(stats_scope, config.name(), "active", Stats::Gauge::ImportMode::Accumulate)),
       scale_percent_gauge_(makeGauge(stats_scope, config.name(), "scale_percent",
@@ -246,19 +249,17 @@ OverloadAction::OverloadAction(const envoy::config::overload::v3::OverloadAction
 }
 
 bool OverloadAction::updateResourcePressure(const std::string& name, double pressure) {
-  const OverloadActionState old_state = getState();
-
   auto it = triggers_.find(name);
   ASSERT(it != triggers_.end());
   if (!it->second->updateValue(pressure)) {
-    return false;
+    return updateState();
   }
   const auto trigger_new_state = it->second->actionState();
   active_gauge_.set(trigger_new_state.isSaturated() ? 1 : 0);
   scale_percent_gauge_.set(trigger_new_state.value() * 100);
 
   {
-    // Compute the new state as the maximum over all trigger states.
+    // Compute the new target state as the maximum over all trigger states.
     OverloadActionState new_state = OverloadActionState::inactive();
     for (auto& trigger : triggers_) {
       const auto trigger_state = trigger.second->actionState();
@@ -266,9 +267,24 @@ bool OverloadAction::updateResourcePressure(const std::string& name, double pres
         new_state = trigger_state;
       }
     }
-    state_ = new_state;
+    target_state_ = new_state;
   }
 
+  return updateState();
+}
+
+bool OverloadAction::updateState() {
+  const OverloadActionState old_state = state_;
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (ramp_down_duration_.count() == 0 || target_state_.value() >= state_.value()) {
+    state_ = target_state_;
+  } else {
+    // Ramp down linearly, so that the load shed by the action comes back gradually.
+    const float max_decrease =
+        std::chrono::duration<float>(now - last_state_update_) / ramp_down_duration_;
+    state_ = OverloadActionState(std::max(target_state_.value(), state_.value() - max_decrease));
+  }
+  last_state_update_ = now;
   return state_.value() != old_state.value();
 }
 
@@ -282,7 +298,8 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
     : started_(false), dispatcher_(dispatcher), tls_(slot_allocator),
       refresh_interval_(
           std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, refresh_interval, 1000))) {
-  Configuration::ResourceMonitorFactoryContextImpl context(dispatcher, api, validation_visitor);
+  Configuration::ResourceMonitorFactoryContextImpl context(dispatcher, api, validation_visitor,
+                                                           slot_allocator);
   for (const auto& resource : config.resource_monitors()) {
     const auto& name = resource.name();
     ENVOY_LOG(debug, "Adding resource monitor for {}", name);
@@ -306,7 +323,8 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
     // We cannot currently use in place construction as the OverloadAction constructor may throw,
     // causing an inconsistent internal state of the actions_ map, which on destruction results in
     // an invalid free.
-    auto result = actions_.try_emplace(symbol, OverloadAction(action, stats_scope));
+    auto result =
+        actions_.try_emplace(symbol, OverloadAction(action, stats_scope, dispatcher.timeSource()));
     if (!result.second) {
       throw EnvoyException(absl::StrCat("Duplicate overload action ", name));
     }
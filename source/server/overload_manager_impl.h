@@ -25,13 +25,14 @@ namespace Server {
 class OverloadAction {
 public:
   OverloadAction(const envoy::config::overload::v3::OverloadAction& config,
-                 Stats::Scope& stats_scope);
+                 Stats::Scope& stats_scope, TimeSource& time_source);
 
   // Updates the current pressure for the given resource and returns whether the action
   // has changed state.
   bool updateResourcePressure(const std::string& name, double pressure);
 
-  // Returns the current action state, which is the max state across all registered triggers.
+  // Returns the current action state, which is the max state across all registered triggers, unless
+  // it is still ramping down from a higher state.
   OverloadActionState getState() const;
 
   class Trigger {
@@ -47,8 +48,16 @@ public:
   using TriggerPtr = std::unique_ptr<Trigger>;
 
 private:
+  // Moves the state towards the target state and returns whether it has changed.
+  bool updateState();
+
   absl::node_hash_map<std::string, TriggerPtr> triggers_;
+  TimeSource& time_source_;
+  const std::chrono::milliseconds ramp_down_duration_;
+  // The max state across all registered triggers.
+  OverloadActionState target_state_;
   OverloadActionState state_;
+  MonotonicTime last_state_update_;
   Stats::Gauge& active_gauge_;
   Stats::Gauge& scale_percent_gauge_;
 };
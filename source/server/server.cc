@@ -40,6 +40,7 @@
 #include "common/network/tcp_listener_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/router/rds_impl.h"
+#include "common/runtime/runtime_features.h"
 #include "common/runtime/runtime_impl.h"
 #include "common/signal/fatal_error_handler.h"
 #include "common/singleton/manager_impl.h"
@@ -79,8 +80,9 @@ InstanceImpl::InstanceImpl(
       singleton_manager_(new Singleton::ManagerImpl(api_->threadFactory())),
       handler_(new ConnectionHandlerImpl(*dispatcher_, absl::nullopt)),
       listener_component_factory_(*this), worker_factory_(thread_local_, *api_, hooks),
-      access_log_manager_(options.fileFlushIntervalMsec(), *api_, *dispatcher_, access_log_lock,
-                          store),
+      access_log_manager_(options.fileFlushIntervalMsec(), options.fileFlushBufferLimitBytes(),
+                          options.fileFlushOverflowPolicy() == FileFlushOverflowPolicy::Block,
+                          *api_, *dispatcher_, access_log_lock, store),
       terminated_(false),
       mutex_tracer_(options.mutexTracingEnabled() ? &Envoy::MutexTracerImpl::getOrCreateTracer()
                                                   : nullptr),
@@ -508,6 +510,15 @@ void InstanceImpl::initialize(const Options& options,
 
   // Once we have runtime we can initialize the SSL context manager.
   ssl_context_manager_ = createContextManager("ssl_context_manager", time_source_);
+  // Take over the TLS sessions of the parent, so that its clients can resume them with us instead
+  // of all going through full handshakes.
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_shared_server_session_cache")) {
+    absl::optional<Ssl::ServerSessionState> session_state =
+        restarter_.duplicateParentServerSessionState();
+    if (session_state.has_value()) {
+      ssl_context_manager_->importServerSessionState(session_state.value());
+    }
+  }
 
   const bool use_tcp_for_dns_lookups = bootstrap_.use_tcp_for_dns_lookups();
   dns_resolver_ = dispatcher_->createDnsResolver({}, use_tcp_for_dns_lookups);
@@ -602,6 +613,11 @@ void InstanceImpl::startWorkers() {
   // if applicable that they can stop listening and drain.
   restarter_.drainParentListeners();
   drain_manager_->startParentShutdownSequence();
+  if (options_.restartEpoch() > 0 &&
+      Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.hot_restart_transfer_idle_connections")) {
+    listener_manager_->adoptParentConnections();
+  }
 }
 
 Runtime::LoaderPtr InstanceUtil::createRuntime(Instance& server,
@@ -36,6 +36,12 @@ class SslContextManagerNoTlsStub final : public Envoy::Ssl::ContextManager {
 
   Ssl::PrivateKeyMethodManager& privateKeyMethodManager() override { throwException(); }
 
+  absl::optional<Envoy::Ssl::ServerSessionState> exportServerSessionState() override {
+    return absl::nullopt;
+  }
+
+  void importServerSessionState(const Envoy::Ssl::ServerSessionState& /* state */) override {}
+
 private:
   [[noreturn]] void throwException() {
     throw EnvoyException("SSL is not supported in this configuration");
@@ -123,6 +123,26 @@ void WorkerImpl::stopListener(Network::ListenerConfig& listener, std::function<v
   });
 }
 
+void WorkerImpl::releaseTransferableConnections(
+    Network::ConnectionHandler::ReleasedConnectionCb cb, std::function<void()> completion) {
+  ASSERT(thread_);
+  dispatcher_->post([this, cb, completion]() -> void {
+    handler_->releaseTransferableConnections(cb);
+    completion();
+  });
+}
+
+void WorkerImpl::adoptConnection(Network::Address::InstanceConstSharedPtr listener_address,
+                                 Network::ConnectionSocketPtr&& socket) {
+  ASSERT(thread_);
+  // It is not possible to capture a unique_ptr because the post() API copies the lambda, so we must
+  // bundle the socket inside a shared_ptr that can be captured.
+  auto adopted_socket = std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  dispatcher_->post([this, listener_address, adopted_socket]() -> void {
+    handler_->adoptConnection(*listener_address, std::move(*adopted_socket));
+  });
+}
+
 void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
   ENVOY_LOG(debug, "worker entering dispatch loop");
   // The watch dog must be created after the dispatcher starts running and has post events flushed,
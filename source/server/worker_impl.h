@@ -54,6 +54,10 @@ public:
   void initializeStats(Stats::Scope& scope) override;
   void stop() override;
   void stopListener(Network::ListenerConfig& listener, std::function<void()> completion) override;
+  void releaseTransferableConnections(Network::ConnectionHandler::ReleasedConnectionCb cb,
+                                      std::function<void()> completion) override;
+  void adoptConnection(Network::Address::InstanceConstSharedPtr listener_address,
+                       Network::ConnectionSocketPtr&& socket) override;
 
 private:
   void threadRoutine(GuardDog& guard_dog);
@@ -16,6 +16,7 @@
 #include "test/common/stream_info/test_util.h"
 #include "test/common/upstream/utility.h"
 #include "test/mocks/access_log/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/filesystem/mocks.h"
 #include "test/mocks/runtime/mocks.h"
@@ -693,6 +694,94 @@ status_code_filter:
   EXPECT_FALSE(filter.evaluate(info, request_headers, response_headers, response_trailers));
 }
 
+TEST(AccessLogFilterTest, SamplingPerGroup) {
+  const std::string filter_yaml = R"EOF(
+sampling_filter:
+  keep_filter:
+    status_code_filter:
+      comparison:
+        op: GE
+        value:
+          default_value: 500
+          runtime_key: keep_key
+  keys: [ROUTE_NAME, RESPONSE_CODE]
+  sample_every:
+    default_value: 3
+    runtime_key: key
+    )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Random::MockRandomGenerator> random;
+
+  envoy::config::accesslog::v3::AccessLogFilter config;
+  TestUtility::loadFromYaml(filter_yaml, config);
+  SamplingFilter filter(config.sampling_filter(), runtime, random,
+                        ProtobufMessage::getStrictValidationVisitor());
+
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  TestStreamInfo info;
+  info.response_code_ = 200;
+  info.setRouteName("foo");
+
+  // The first of every three requests of a group is logged.
+  EXPECT_TRUE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+  EXPECT_FALSE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+  EXPECT_FALSE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+  EXPECT_TRUE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+
+  // Other groups are sampled separately.
+  info.setRouteName("bar");
+  EXPECT_TRUE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+  info.response_code_ = 404;
+  EXPECT_TRUE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+  EXPECT_FALSE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+
+  // The requests matching the keep filter are always logged.
+  info.response_code_ = 503;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+  }
+
+  // Sampling can be turned off at runtime.
+  info.response_code_ = 200;
+  info.setRouteName("baz");
+  EXPECT_CALL(runtime.snapshot_, getInteger("key", 3)).WillOnce(Return(0));
+  EXPECT_FALSE(filter.evaluate(info, request_headers, response_headers, response_trailers));
+}
+
+TEST_F(AccessLogImplTest, SamplingFilter) {
+  const std::string yaml = R"EOF(
+name: accesslog
+filter:
+  sampling_filter:
+    keys: [UPSTREAM_CLUSTER]
+    sample_every:
+      default_value: 2
+      runtime_key: key
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.access_loggers.file.v3.FileAccessLog
+  path: /dev/null
+  )EOF";
+
+  const InstanceSharedPtr log =
+      AccessLogFactory::fromProto(parseAccessLogFromV3Yaml(yaml), context_);
+
+  EXPECT_CALL(*file_, write(_)).Times(2);
+  for (int i = 0; i < 4; ++i) {
+    log->log(&request_headers_, &response_headers_, &response_trailers_, stream_info_);
+  }
+}
+
+TEST_F(AccessLogImplTest, SamplingFilterMissingSampleEvery) {
+  envoy::config::accesslog::v3::AccessLogFilter config;
+  config.mutable_sampling_filter();
+  EXPECT_THROW(FilterFactory::fromProto(config, runtime_, context_.api_.random_,
+                                        ProtobufMessage::getStrictValidationVisitor()),
+               ProtoValidationException);
+}
+
 TEST_F(AccessLogImplTest, StatusCodeLessThan) {
   const std::string yaml = R"EOF(
 name: accesslog
@@ -1,4 +1,6 @@
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/access_log/access_log_manager_impl.h"
 #include "common/filesystem/file_shared_impl.h"
@@ -11,6 +13,11 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -31,7 +38,7 @@ class AccessLogManagerImplTest : public testing::Test {
 protected:
   AccessLogManagerImplTest()
       : file_(new NiceMock<Filesystem::MockFile>), thread_factory_(Thread::threadFactoryForTest()),
-        access_log_manager_(timeout_40ms_, api_, dispatcher_, lock_, store_) {
+        access_log_manager_(timeout_40ms_, 0, false, api_, dispatcher_, lock_, store_) {
     EXPECT_CALL(file_system_, createFile("foo"))
         .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(file_))));
 
@@ -159,8 +166,8 @@ TEST_F(AccessLogManagerImplTest, FlushToLogFileOnDemand) {
   EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
 
   // The first write to a given file will start the flush thread. Because AccessManagerImpl::write
-  // holds the write_lock_ when the thread is started, the thread will flush on its first loop, once
-  // it obtains the write_lock_. Perform a write to get all that out of the way.
+  // only starts the thread once the data is buffered, the thread will flush on its first loop.
+  // Perform a write to get all that out of the way.
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
         return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
@@ -443,6 +450,153 @@ TEST_F(AccessLogManagerImplTest, BigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST_F(AccessLogManagerImplTest, DropWritesOverBufferLimit) {
+  AccessLogManagerImpl access_log_manager(timeout_40ms_, 10, false, api_, dispatcher_, lock_,
+                                          store_);
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  Sequence sq;
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager.createAccessLog("foo");
+
+  // Hold the flush thread in its first write, so that the following writes stay buffered.
+  absl::Notification writing;
+  absl::Notification release;
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("prime-it"));
+        writing.Notify();
+        release.WaitForNotification();
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("prime-it");
+  writing.WaitForNotification();
+
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("0123456789"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("01234");
+  log_file->write("56789");
+  log_file->write("x");
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_dropped").value());
+  EXPECT_EQ(3UL, store_.counter("filesystem.write_buffered").value());
+
+  release.Notify();
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    while (file_->num_writes_ != 2) {
+      file_->write_event_.wait(file_->write_mutex_);
+    }
+  }
+
+  // Once the buffers have been flushed, a write larger than the limit is accepted.
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("more than ten bytes"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("more than ten bytes");
+  log_file->flush();
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_dropped").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// A blocked write wakes up the flush thread, so it doesn't depend on the flush timer, which
+// doesn't fire while the thread of its dispatcher is blocked.
+TEST_F(AccessLogManagerImplTest, BlockWritesOverBufferLimit) {
+  AccessLogManagerImpl access_log_manager(timeout_40ms_, 10, true, api_, dispatcher_, lock_,
+                                          store_);
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager.createAccessLog("foo");
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&written](absl::string_view data) -> Api::IoCallSizeResult {
+        absl::StrAppend(&written, data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("prime-it");
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    while (file_->num_writes_ != 1) {
+      file_->write_event_.wait(file_->write_mutex_);
+    }
+  }
+
+  // Too little to wake up the flush thread.
+  log_file->write("abc");
+  // Doesn't fit, so this waits for the flush thread to flush "abc".
+  log_file->write("01234567");
+  EXPECT_EQ(3UL, store_.counter("filesystem.write_buffered").value());
+  log_file->flush();
+
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    EXPECT_EQ("prime-itabc01234567", written);
+  }
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_dropped").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Writes from several threads all reach the file, each thread's in the order they were made.
+TEST_F(AccessLogManagerImplTest, ConcurrentWriters) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&written](absl::string_view data) -> Api::IoCallSizeResult {
+        absl::StrAppend(&written, data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  constexpr uint32_t num_threads = 8;
+  constexpr uint32_t num_lines = 1000;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory_.createThread([&log_file, i]() -> void {
+      for (uint32_t j = 0; j < num_lines; ++j) {
+        log_file->write(absl::StrCat(i, " ", j, "\n"));
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  timer->invokeCallback();
+  log_file->flush();
+
+  std::vector<uint32_t> next_line(num_threads);
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    for (absl::string_view line : absl::StrSplit(written, '\n', absl::SkipEmpty())) {
+      const std::vector<absl::string_view> parts = absl::StrSplit(line, ' ');
+      ASSERT_EQ(2, parts.size());
+      uint32_t thread_index;
+      uint32_t line_index;
+      ASSERT_TRUE(absl::SimpleAtoi(parts[0], &thread_index));
+      ASSERT_TRUE(absl::SimpleAtoi(parts[1], &line_index));
+      EXPECT_EQ(next_line[thread_index]++, line_index);
+    }
+  }
+  for (uint32_t lines : next_line) {
+    EXPECT_EQ(num_lines, lines);
+  }
+  EXPECT_EQ(num_threads * num_lines, store_.counter("filesystem.write_buffered").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
@@ -591,6 +591,126 @@ TEST_F(GrpcMuxImplTest, SingleWatcherWithEmptyUpdates) {
   grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
 }
 
+// Resource decoder which counts the resources it decodes.
+class CountingResourceDecoder
+    : public TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment> {
+public:
+  CountingResourceDecoder() : TestOpaqueResourceDecoderImpl("cluster_name") {}
+
+  ProtobufTypes::MessagePtr decodeResource(const ProtobufWkt::Any& resource) override {
+    ++decoded_;
+    return TestOpaqueResourceDecoderImpl::decodeResource(resource);
+  }
+
+  uint32_t decoded_{};
+};
+
+// Validate that resources whose serialized content did not change are not decoded again, while
+// watches still see the new version.
+TEST_F(GrpcMuxImplTest, UnchangedResourcesAreNotDecodedAgain) {
+  setup();
+  InSequence s;
+  CountingResourceDecoder resource_decoder;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  NiceMock<MockSubscriptionCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x", "y"}, foo_callbacks, resource_decoder);
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y"}, "", true);
+  grpc_mux_->start();
+
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment_x;
+  load_assignment_x.set_cluster_name("x");
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment_y;
+  load_assignment_y.set_cluster_name("y");
+
+  {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info("1");
+    response->add_resources()->PackFrom(load_assignment_x);
+    response->add_resources()->PackFrom(load_assignment_y);
+    EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "1"));
+    expectSendMessage(type_url, {"x", "y"}, "1");
+    grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+    EXPECT_EQ(2, resource_decoder.decoded_);
+  }
+
+  {
+    // Only "y" changes, so only "y" is decoded.
+    load_assignment_y.mutable_policy()->set_overprovisioning_factor(200);
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info("2");
+    response->add_resources()->PackFrom(load_assignment_x);
+    response->add_resources()->PackFrom(load_assignment_y);
+    EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "2"))
+        .WillOnce(Invoke([&](const std::vector<DecodedResourceRef>& resources,
+                             const std::string&) {
+          EXPECT_EQ(2, resources.size());
+          EXPECT_EQ("2", resources[0].get().version());
+          EXPECT_TRUE(TestUtility::protoEqual(resources[0].get().resource(), load_assignment_x));
+          EXPECT_TRUE(TestUtility::protoEqual(resources[1].get().resource(), load_assignment_y));
+        }));
+    expectSendMessage(type_url, {"x", "y"}, "2");
+    grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+    EXPECT_EQ(3, resource_decoder.decoded_);
+  }
+
+  expectSendMessage(type_url, {}, "2");
+}
+
+// Validate that, when enabled, watches whose resources did not change are not updated again.
+TEST_F(GrpcMuxImplTest, SkipUnchangedResourceUpdates) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.skip_unchanged_sotw_resource_updates", "true"}});
+  setup();
+  InSequence s;
+  TestUtility::TestOpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>
+      resource_decoder("cluster_name");
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  NiceMock<MockSubscriptionCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x"}, foo_callbacks, resource_decoder);
+  NiceMock<MockSubscriptionCallbacks> bar_callbacks;
+  auto bar_sub = grpc_mux_->addWatch(type_url, {"y"}, bar_callbacks, resource_decoder);
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"y", "x"}, "", true);
+  grpc_mux_->start();
+
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment_x;
+  load_assignment_x.set_cluster_name("x");
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment_y;
+  load_assignment_y.set_cluster_name("y");
+  const auto send_response = [&](const std::string& version) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info(version);
+    response->add_resources()->PackFrom(load_assignment_x);
+    response->add_resources()->PackFrom(load_assignment_y);
+    expectSendMessage(type_url, {"y", "x"}, version);
+    grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+  };
+
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, "1"));
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "1"));
+  send_response("1");
+
+  // Only "y" changes, so only the watch on "y" is updated.
+  load_assignment_y.mutable_policy()->set_overprovisioning_factor(200);
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, "2"));
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "2")).Times(0);
+  send_response("2");
+
+  // Nothing changes.
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, "3")).Times(0);
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "3")).Times(0);
+  send_response("3");
+
+  expectSendMessage(type_url, {"x"}, "3");
+  expectSendMessage(type_url, {}, "3");
+}
+
 // Exactly one test requires a mock time system to provoke behavior that cannot
 // easily be achieved with a SimulatedTimeSystem.
 class GrpcMuxImplTestWithMockTimeSystem : public GrpcMuxImplTestBase {
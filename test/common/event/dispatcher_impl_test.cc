@@ -342,6 +342,8 @@ TEST_F(DispatcherImplTest, InitializeStats) {
               histogram("test.dispatcher.loop_duration_us", Stats::Histogram::Unit::Microseconds));
   EXPECT_CALL(scope_,
               histogram("test.dispatcher.poll_delay_us", Stats::Histogram::Unit::Microseconds));
+  EXPECT_CALL(scope_,
+              histogram("test.dispatcher.post_callbacks", Stats::Histogram::Unit::Unspecified));
   dispatcher_->initializeStats(scope_, "test.");
 }
 
@@ -561,6 +563,57 @@ TEST_F(DispatcherMonotonicTimeTest, ApproximateMonotonicTime) {
   dispatcher_->run(Dispatcher::RunType::Block);
 }
 
+class DispatcherPostCallbackBudgetTest : public testing::Test {
+protected:
+  DispatcherPostCallbackBudgetTest() {
+    api_ = Api::createApiForTest();
+    dispatcher_ = api_->allocateDispatcher("test_thread");
+    // Enabled after the dispatcher is created, as the server does with its dispatchers.
+    Runtime::LoaderSingleton::getExisting()->mergeValues(
+        {{"envoy.reloadable_features.dispatcher_post_callback_budget", "true"}});
+  }
+
+  TestScopedRuntime scoped_runtime_;
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+// Callbacks beyond the budget wait for the next event loop iteration.
+TEST_F(DispatcherPostCallbackBudgetTest, RunRemainingCallbacksNextIteration) {
+  const uint32_t num_callbacks = DispatcherImpl::MaxPostCallbacksPerIteration + 1;
+  std::vector<bool> marker_ran_before;
+  bool marker_ran = false;
+  SchedulableCallbackPtr marker =
+      dispatcher_->createSchedulableCallback([&marker_ran]() { marker_ran = true; });
+  SchedulableCallbackPtr start = dispatcher_->createSchedulableCallback([&]() {
+    for (uint32_t i = 0; i < num_callbacks; ++i) {
+      dispatcher_->post([&]() { marker_ran_before.push_back(marker_ran); });
+    }
+    // Scheduled after the posted callbacks in the current iteration.
+    marker->scheduleCallbackCurrentIteration();
+  });
+  start->scheduleCallbackCurrentIteration();
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+
+  ASSERT_EQ(num_callbacks, marker_ran_before.size());
+  EXPECT_FALSE(marker_ran_before[num_callbacks - 2]);
+  EXPECT_TRUE(marker_ran_before[num_callbacks - 1]);
+}
+
+// Callbacks posted before the event loop starts all run first, regardless of the budget.
+TEST_F(DispatcherPostCallbackBudgetTest, RunAllCallbacksBeforeEventLoop) {
+  const uint32_t num_callbacks = DispatcherImpl::MaxPostCallbacksPerIteration + 1;
+  uint32_t callbacks_run = 0;
+  for (uint32_t i = 0; i < num_callbacks; ++i) {
+    dispatcher_->post([&callbacks_run]() { ++callbacks_run; });
+  }
+  SchedulableCallbackPtr check = dispatcher_->createSchedulableCallback(
+      [&]() { EXPECT_EQ(num_callbacks, callbacks_run); });
+  check->scheduleCallbackCurrentIteration();
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(num_callbacks, callbacks_run);
+}
+
 class TimerImplTest : public testing::TestWithParam<bool> {
 protected:
   TimerImplTest() {
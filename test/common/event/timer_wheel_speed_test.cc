@@ -0,0 +1,62 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <chrono>
+#include <vector>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/timer_wheel.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+// Re-arms each of a number of idle timeouts, as a busy worker does on every read and write of
+// its connections and streams. The timeouts are long enough to never fire.
+class TimerSpeedTest {
+public:
+  TimerSpeedTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {}
+
+  template <class CreateTimer> void run(benchmark::State& state, CreateTimer create_timer) {
+    const uint64_t num_timers = state.range(0);
+    std::vector<TimerPtr> timers;
+    timers.reserve(num_timers);
+    for (uint64_t i = 0; i < num_timers; ++i) {
+      timers.push_back(create_timer([]() {}));
+    }
+    uint64_t n = 0;
+    for (auto _ : state) {
+      for (TimerPtr& timer : timers) {
+        timer->enableTimer(std::chrono::milliseconds(300000 + (n++ % 1000)));
+      }
+    }
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+} // namespace Event
+} // namespace Envoy
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_DispatcherTimers(benchmark::State& state) {
+  Envoy::Event::TimerSpeedTest context;
+  context.run(state, [&context](Envoy::Event::TimerCb cb) {
+    return context.dispatcher_->createTimer(cb);
+  });
+}
+BENCHMARK(BM_DispatcherTimers)->Arg(100)->Arg(10000)->Arg(100000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_TimerWheelTimers(benchmark::State& state) {
+  Envoy::Event::TimerSpeedTest context;
+  Envoy::Event::TimerWheel wheel(*context.dispatcher_,
+                                 Envoy::Event::TimerWheel::DefaultTickDuration);
+  context.run(state, [&wheel](Envoy::Event::TimerCb cb) { return wheel.createTimer(cb); });
+}
+BENCHMARK(BM_TimerWheelTimers)->Arg(100)->Arg(10000)->Arg(100000);
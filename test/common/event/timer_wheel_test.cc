@@ -0,0 +1,246 @@
+#include <chrono>
+
+#include "envoy/event/timer.h"
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/timer_wheel.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/wrapped_dispatcher.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+using testing::InSequence;
+using testing::MockFunction;
+
+class ScopeTrackingDispatcher : public WrappedDispatcher {
+public:
+  ScopeTrackingDispatcher(DispatcherPtr dispatcher)
+      : WrappedDispatcher(*dispatcher), dispatcher_(std::move(dispatcher)) {}
+
+  const ScopeTrackedObject* setTrackedObject(const ScopeTrackedObject* object) override {
+    if (object != nullptr) {
+      scopes_.push_back(object);
+    }
+    return impl_.setTrackedObject(object);
+  }
+
+  std::vector<const ScopeTrackedObject*> scopes_;
+
+private:
+  DispatcherPtr dispatcher_;
+};
+
+class TimerWheelTest : public testing::Test, public TestUsingSimulatedTime {
+public:
+  TimerWheelTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        wheel_(dispatcher_, std::chrono::milliseconds(10)) {}
+
+  void advance(std::chrono::milliseconds duration) {
+    simTime().advanceTimeAndRun(duration, dispatcher_, Dispatcher::RunType::NonBlock);
+  }
+
+  Api::ApiPtr api_;
+  ScopeTrackingDispatcher dispatcher_;
+  TimerWheel wheel_;
+};
+
+TEST_F(TimerWheelTest, CreateAndDestroyTimer) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  EXPECT_FALSE(timer->enabled());
+}
+
+// Timers fire at the first tick at or after their timeout.
+TEST_F(TimerWheelTest, FireAtNextTick) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::milliseconds(25));
+  EXPECT_TRUE(timer->enabled());
+
+  advance(std::chrono::milliseconds(25));
+  EXPECT_TRUE(timer->enabled());
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(5));
+  EXPECT_FALSE(timer->enabled());
+}
+
+TEST_F(TimerWheelTest, DisableTimer) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::milliseconds(100));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+
+  // The strict mock callback catches the timer firing anyway.
+  advance(std::chrono::seconds(1));
+}
+
+TEST_F(TimerWheelTest, ReEnableTimer) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::milliseconds(100));
+  advance(std::chrono::milliseconds(50));
+  timer->enableTimer(std::chrono::milliseconds(100));
+
+  advance(std::chrono::milliseconds(90));
+  EXPECT_TRUE(timer->enabled());
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_FALSE(timer->enabled());
+}
+
+TEST_F(TimerWheelTest, FireInOrder) {
+  InSequence s;
+  MockFunction<TimerCb> callback1;
+  MockFunction<TimerCb> callback2;
+  MockFunction<TimerCb> callback3;
+  TimerPtr timer1 = wheel_.createTimer(callback1.AsStdFunction());
+  TimerPtr timer2 = wheel_.createTimer(callback2.AsStdFunction());
+  TimerPtr timer3 = wheel_.createTimer(callback3.AsStdFunction());
+  timer3->enableTimer(std::chrono::seconds(100));
+  timer2->enableTimer(std::chrono::seconds(10));
+  timer1->enableTimer(std::chrono::seconds(1));
+
+  EXPECT_CALL(callback1, Call());
+  EXPECT_CALL(callback2, Call());
+  EXPECT_CALL(callback3, Call());
+  advance(std::chrono::seconds(100));
+}
+
+// Timers in the higher levels of the wheel move down as their time approaches.
+TEST_F(TimerWheelTest, CascadeLongTimer) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::minutes(10));
+
+  advance(std::chrono::minutes(10) - std::chrono::milliseconds(10));
+  EXPECT_TRUE(timer->enabled());
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(10));
+}
+
+// Timers beyond the range of the wheel are parked in its last slot.
+TEST_F(TimerWheelTest, TimerBeyondWheelRange) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::hours(24 * 8));
+
+  advance(std::chrono::hours(24 * 8) - std::chrono::milliseconds(10));
+  EXPECT_TRUE(timer->enabled());
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(10));
+}
+
+// Timers enabled after the wheel has been idle for a while don't fire early.
+TEST_F(TimerWheelTest, EnableAfterIdle) {
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  EXPECT_CALL(callback, Call());
+  timer->enableTimer(std::chrono::milliseconds(20));
+  advance(std::chrono::milliseconds(20));
+
+  advance(std::chrono::hours(1));
+  timer->enableTimer(std::chrono::milliseconds(20));
+  advance(std::chrono::milliseconds(10));
+  EXPECT_TRUE(timer->enabled());
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(10));
+}
+
+// Callbacks can disable and enable other timers expiring in the same tick.
+TEST_F(TimerWheelTest, CallbackChangesOtherTimers) {
+  MockFunction<TimerCb> callback2;
+  MockFunction<TimerCb> callback3;
+  TimerPtr timer2 = wheel_.createTimer(callback2.AsStdFunction());
+  TimerPtr timer3 = wheel_.createTimer(callback3.AsStdFunction());
+  TimerPtr timer1 = wheel_.createTimer([&]() {
+    timer2->disableTimer();
+    timer3.reset();
+    timer2->enableTimer(std::chrono::milliseconds(10));
+  });
+  timer1->enableTimer(std::chrono::milliseconds(10));
+  timer2->enableTimer(std::chrono::milliseconds(10));
+  timer3->enableTimer(std::chrono::milliseconds(10));
+
+  advance(std::chrono::milliseconds(10));
+  EXPECT_TRUE(timer2->enabled());
+
+  EXPECT_CALL(callback2, Call());
+  advance(std::chrono::milliseconds(10));
+}
+
+TEST_F(TimerWheelTest, ScopeTracking) {
+  MockFunction<TimerCb> callback;
+  MockScopedTrackedObject scope;
+  TimerPtr timer = wheel_.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::milliseconds(10), &scope);
+
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_THAT(dispatcher_.scopes_, testing::ElementsAre(&scope));
+}
+
+TEST(DispatcherCoarseTimerTest, UseTimerWheel) {
+  TestScopedRuntime scoped_runtime;
+  Event::SimulatedTimeSystem time_system;
+  Api::ApiPtr api = Api::createApiForTest(time_system);
+  DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  // Enabled after the dispatcher is created, as the server does with its dispatchers. The coarse
+  // timers created before the event loop runs use libevent.
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.coarse_timers_use_timer_wheel", "true"}});
+  MockFunction<TimerCb> early_callback;
+  TimerPtr early_timer = dispatcher->createCoarseTimer(early_callback.AsStdFunction());
+  early_timer->enableTimer(std::chrono::milliseconds(5));
+  dispatcher->run(Dispatcher::RunType::NonBlock);
+
+  MockFunction<TimerCb> callback;
+  TimerPtr timer = dispatcher->createCoarseTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::milliseconds(5));
+  EXPECT_CALL(early_callback, Call());
+  time_system.advanceTimeAndRun(std::chrono::milliseconds(5), *dispatcher,
+                                Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(timer->enabled());
+
+  EXPECT_CALL(callback, Call());
+  time_system.advanceTimeAndRun(TimerWheel::DefaultTickDuration, *dispatcher,
+                                Dispatcher::RunType::NonBlock);
+}
+
+// Objects still waiting for deferred deletion when the dispatcher is destroyed may own enabled
+// coarse timers, which are removed from the wheel when they are destroyed.
+TEST(DispatcherCoarseTimerTest, DeferredDeleteEnabledTimer) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.coarse_timers_use_timer_wheel", "true"}});
+  Event::SimulatedTimeSystem time_system;
+  Api::ApiPtr api = Api::createApiForTest(time_system);
+  DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  dispatcher->run(Dispatcher::RunType::NonBlock);
+
+  struct TimerOwner : public DeferredDeletable {
+    TimerPtr timer_;
+  };
+  auto owner = std::make_unique<TimerOwner>();
+  owner->timer_ = dispatcher->createCoarseTimer([]() {});
+  owner->timer_->enableTimer(std::chrono::milliseconds(5));
+  dispatcher->deferredDelete(std::move(owner));
+  dispatcher.reset();
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
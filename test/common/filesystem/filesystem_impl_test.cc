@@ -1,6 +1,7 @@
 #include <chrono>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/utility.h"
@@ -313,6 +314,23 @@ TEST_F(FileSystemImplTest, NonExistingFile) {
   EXPECT_EQ(" new data", contents);
 }
 
+TEST_F(FileSystemImplTest, Writev) {
+  const std::string file_path =
+      TestEnvironment::writeStringToFileForTest("test_envoy", "existing file");
+
+  {
+    FilePtr file = file_system_.createFile(file_path);
+    const Api::IoCallBoolResult open_result = file->open(DefaultFlags);
+    EXPECT_TRUE(open_result.rc_);
+    const std::vector<absl::string_view> buffers{" new", "", " data"};
+    const Api::IoCallSizeResult result = file->writev(buffers);
+    EXPECT_EQ(9, result.rc_);
+  }
+
+  auto contents = TestEnvironment::readFileToStringForTest(file_path);
+  EXPECT_EQ("existing file new data", contents);
+}
+
 TEST_F(FileSystemImplTest, Close) {
   const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
   ::unlink(new_file_path.c_str());
@@ -339,6 +357,10 @@ TEST_F(FileSystemImplTest, WriteAfterClose) {
   const Api::IoCallSizeResult size_result = file->write(" new data");
   EXPECT_EQ(-1, size_result.rc_);
   EXPECT_EQ(IoFileError::IoErrorCode::BadFd, size_result.err_->getErrorCode());
+  const std::vector<absl::string_view> buffers{" new data"};
+  const Api::IoCallSizeResult writev_result = file->writev(buffers);
+  EXPECT_EQ(-1, writev_result.rc_);
+  EXPECT_EQ(IoFileError::IoErrorCode::BadFd, writev_result.err_->getErrorCode());
 }
 
 TEST_F(FileSystemImplTest, NonExistingFileAndReadOnly) {
@@ -28,6 +28,38 @@ std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> makeJsonFormatter(bool type
   return std::make_unique<Envoy::Formatter::JsonFormatterImpl>(JsonLogFormat, typed, false);
 }
 
+std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> makeNestedJsonFormatter() {
+  ProtobufWkt::Struct JsonLogFormat;
+  const std::string format_yaml = R"EOF(
+    remote_address: '%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%'
+    start_time: '%START_TIME(%Y/%m/%dT%H:%M:%S%z %s)%'
+    request:
+      method: '%REQ(:METHOD)%'
+      url: '%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)%'
+      protocol: '%PROTOCOL%'
+      referer: '%REQ(REFERER)%'
+      user-agent: '%REQ(USER-AGENT)%'
+      request_id: '%REQ(X-REQUEST-ID)%'
+      forwarded_for: '%REQ(X-FORWARDED-FOR)%'
+    response:
+      response_code: '%RESPONSE_CODE%'
+      bytes_sent: '%BYTES_SENT%'
+      duration: '%DURATION%'
+      upstream_host: '%UPSTREAM_HOST%'
+  )EOF";
+  TestUtility::loadFromYaml(format_yaml, JsonLogFormat);
+  return std::make_unique<Envoy::Formatter::JsonFormatterImpl>(JsonLogFormat, false, true);
+}
+
+Http::TestRequestHeaderMapImpl makeRequestHeaders() {
+  return {{":method", "GET"},
+          {":authority", "www.example.com"},
+          {":path", "/static/js/app.min.js?v=20201019"},
+          {"x-forwarded-proto", "https"},
+          {"referer", "https://www.example.com/index.html"},
+          {"user-agent", "Mozilla/5.0 (X11; Linux x86_64; rv:82.0) Gecko/20100101 Firefox/82.0"}};
+}
+
 std::unique_ptr<Envoy::TestStreamInfo> makeStreamInfo() {
   auto stream_info = std::make_unique<Envoy::TestStreamInfo>();
   stream_info->setDownstreamRemoteAddress(
@@ -50,7 +82,7 @@ static void BM_AccessLogFormatter(benchmark::State& state) {
       std::make_unique<Envoy::Formatter::FormatterImpl>(LogFormat, false);
 
   size_t output_bytes = 0;
-  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
   Http::TestResponseHeaderMapImpl response_headers;
   Http::TestResponseTrailerMapImpl response_trailers;
   std::string body;
@@ -69,7 +101,7 @@ static void BM_JsonAccessLogFormatter(benchmark::State& state) {
   std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> json_formatter = makeJsonFormatter(false);
 
   size_t output_bytes = 0;
-  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
   Http::TestResponseHeaderMapImpl response_headers;
   Http::TestResponseTrailerMapImpl response_trailers;
   std::string body;
@@ -90,7 +122,7 @@ static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
       makeJsonFormatter(true);
 
   size_t output_bytes = 0;
-  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
   Http::TestResponseHeaderMapImpl response_headers;
   Http::TestResponseTrailerMapImpl response_trailers;
   std::string body;
@@ -104,4 +136,47 @@ static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
 }
 BENCHMARK(BM_TypedJsonAccessLogFormatter);
 
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_NestedJsonAccessLogFormatter(benchmark::State& state) {
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
+  std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> json_formatter = makeNestedJsonFormatter();
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) {
+    output_bytes +=
+        json_formatter
+            ->format(request_headers, response_headers, response_trailers, *stream_info, body)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_NestedJsonAccessLogFormatter);
+
+// Values which need escaping, such as user agents with quotes.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_JsonAccessLogFormatterEscaping(benchmark::State& state) {
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo();
+  std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> json_formatter = makeJsonFormatter(false);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
+  request_headers.setCopy(Http::LowerCaseString("user-agent"),
+                          "curl/7.72.0 \"quoted\" \\escaped\\ \ttabbed");
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) {
+    output_bytes +=
+        json_formatter
+            ->format(request_headers, response_headers, response_trailers, *stream_info, body)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_JsonAccessLogFormatterEscaping);
+
 } // namespace Envoy
@@ -1112,6 +1112,22 @@ TEST(SubstitutionFormatterTest, requestHeaderFormatter) {
         formatter.formatValue(request_header, response_header, response_trailer, stream_info, body),
         ProtoEq(ValueUtil::stringValue("GE")));
   }
+
+  {
+    RequestHeaderFormatter formatter(":Method", "", absl::optional<size_t>(2));
+    std::string output = "method=";
+    EXPECT_TRUE(formatter.formatTo(request_header, response_header, response_trailer, stream_info,
+                                   body, output));
+    EXPECT_EQ("method=GE", output);
+  }
+
+  {
+    RequestHeaderFormatter formatter("does_not_exist", "", absl::optional<size_t>());
+    std::string output = "method=";
+    EXPECT_FALSE(formatter.formatTo(request_header, response_header, response_trailer, stream_info,
+                                    body, output));
+    EXPECT_EQ("method=", output);
+  }
 }
 
 TEST(SubstitutionFormatterTest, responseHeaderFormatter) {
@@ -2058,6 +2074,97 @@ TEST(SubstitutionFormatterTest, JsonFormatterTypedTest) {
   EXPECT_THAT(output.fields().at("filter_state"), ProtoEq(expected));
 }
 
+// The JSON output is written directly, with the members in the order of their keys.
+TEST(SubstitutionFormatterTest, JsonFormatterTypedOutputTest) {
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  StreamInfo::MockStreamInfo stream_info;
+  std::string body;
+  EXPECT_CALL(Const(stream_info), lastDownstreamRxByteReceived())
+      .WillRepeatedly(Return(std::chrono::nanoseconds(5000000)));
+
+  ProtobufWkt::Value list;
+  list.mutable_list_value()->add_values()->set_bool_value(true);
+  list.mutable_list_value()->add_values()->set_string_value("two");
+  list.mutable_list_value()->add_values()->set_number_value(3.14);
+  list.mutable_list_value()->add_values()->set_null_value(ProtobufWkt::NULL_VALUE);
+  ProtobufWkt::Struct s;
+  (*s.mutable_fields())["list"] = list;
+  stream_info.filter_state_->setData("test_obj",
+                                     std::make_unique<TestSerializedStructFilterState>(s),
+                                     StreamInfo::FilterState::StateType::ReadOnly);
+  EXPECT_CALL(Const(stream_info), filterState()).Times(testing::AtLeast(1));
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    request_duration: '%REQUEST_DURATION%'
+    filter_state: '%FILTER_STATE(test_obj)%'
+    missing: '%REQ(missing)%'
+  )EOF",
+                            key_mapping);
+  JsonFormatterImpl formatter(key_mapping, true, false);
+
+  EXPECT_EQ(
+      "{\"filter_state\":{\"list\":[true,\"two\",3.14,null]},\"missing\":null,"
+      "\"request_duration\":5}\n",
+      formatter.format(request_headers, response_headers, response_trailers, stream_info, body));
+}
+
+// Keys and values are escaped as JSON strings require.
+TEST(SubstitutionFormatterTest, JsonFormatterEscapingTest) {
+  Http::TestRequestHeaderMapImpl request_headers{{"x-value", "a\"b\\c\td\x01"}};
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  StreamInfo::MockStreamInfo stream_info;
+  std::string body;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    'key "quoted"': 'plain "quoted"'
+    value: '%REQ(x-value)%'
+    values: '%REQ(x-value)% and %REQ(x-value)%'
+  )EOF",
+                            key_mapping);
+  JsonFormatterImpl formatter(key_mapping, false, false);
+
+  const std::string json =
+      formatter.format(request_headers, response_headers, response_trailers, stream_info, body);
+  EXPECT_EQ("{\"key \\\"quoted\\\"\":\"plain \\\"quoted\\\"\","
+            "\"value\":\"a\\\"b\\\\c\\td\\u0001\","
+            "\"values\":\"a\\\"b\\\\c\\td\\u0001 and a\\\"b\\\\c\\td\\u0001\"}\n",
+            json);
+  verifyJsonOutput(json, {{"value", "a\"b\\c\td\x01"}});
+}
+
+// Omitted values leave no trace in the output, including in nested objects.
+TEST(SubstitutionFormatterTest, JsonFormatterOmitEmptyNestedTest) {
+  Http::TestRequestHeaderMapImpl request_headers{{"present", "value"}};
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  StreamInfo::MockStreamInfo stream_info;
+  std::string body;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    a: '%REQ(missing)%'
+    b: '%REQ(present)%'
+    c:
+      d: '%REQ(missing)%'
+      e: '%REQ(present)%'
+      f: '%REQ(missing)%'
+    g:
+      h: '%REQ(missing)%'
+    i: '%REQ(missing)%'
+  )EOF",
+                            key_mapping);
+  JsonFormatterImpl formatter(key_mapping, false, true);
+
+  EXPECT_EQ(
+      "{\"b\":\"value\",\"c\":{\"e\":\"value\"},\"g\":{}}\n",
+      formatter.format(request_headers, response_headers, response_trailers, stream_info, body));
+}
+
 TEST(SubstitutionFormatterTest, CompositeFormatterSuccess) {
   StreamInfo::MockStreamInfo stream_info;
   Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
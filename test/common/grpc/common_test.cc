@@ -381,5 +381,12 @@ TEST(GrpcContextTest, PrependGrpcFrameHeader) {
   EXPECT_EQ(buffer->toString(), header_string + "test");
 }
 
+// Ensure that the flags are set in the gRPC header of a compressed frame.
+TEST(GrpcContextTest, PrependCompressedGrpcFrameHeader) {
+  Buffer::OwnedImpl buffer("test");
+  Common::prependGrpcFrameHeader(buffer, GRPC_FH_COMPRESSED);
+  EXPECT_EQ(buffer.toString(), std::string("\x01\x00\x00\x00\x04test", 9));
+}
+
 } // namespace Grpc
 } // namespace Envoy
@@ -1,3 +1,5 @@
+#include "common/network/transferable_connection.h"
+
 #include "test/common/http/conn_manager_impl_test_base.h"
 #include "test/test_common/logging.h"
 #include "test/test_common/test_runtime.h"
@@ -2988,5 +2990,40 @@ TEST_F(HttpConnectionManagerImplDeathTest, InvalidConnectionManagerConfig) {
   filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// The connection reports that it can be handed over to another process only between requests.
+TEST_F(HttpConnectionManagerImplTest, TransferableConnectionIdleBetweenRequests) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.hot_restart_transfer_idle_connections", "true"}});
+  setup(false, "");
+  setupFilterChain(1, 0);
+  const auto& transferable = filter_callbacks_.connection_.streamInfo()
+                                 .filterState()
+                                 ->getDataReadOnly<Network::TransferableConnection>(
+                                     Network::TransferableConnection::key());
+  EXPECT_TRUE(transferable.idle());
+
+  EXPECT_CALL(*decoder_filters_[0], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  startRequest(true);
+  EXPECT_FALSE(transferable.idle());
+
+  EXPECT_CALL(response_encoder_, encodeHeaders(_, true));
+  EXPECT_CALL(*decoder_filters_[0], onStreamComplete());
+  EXPECT_CALL(*decoder_filters_[0], onDestroy());
+  ResponseHeaderMapPtr response_headers{new TestResponseHeaderMapImpl{{":status", "200"}}};
+  decoder_filters_[0]->callbacks_->streamInfo().setResponseCodeDetails("");
+  decoder_filters_[0]->callbacks_->encodeHeaders(std::move(response_headers), true, "details");
+  EXPECT_TRUE(transferable.idle());
+
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+TEST_F(HttpConnectionManagerImplTest, TransferableConnectionDisabled) {
+  setup(false, "");
+  EXPECT_FALSE(filter_callbacks_.connection_.streamInfo().filterState()->hasData<
+               Network::TransferableConnection>(Network::TransferableConnection::key()));
+}
+
 } // namespace Http
 } // namespace Envoy
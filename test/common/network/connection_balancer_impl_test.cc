@@ -0,0 +1,89 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class TestBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  explicit TestBalancedConnectionHandler(uint64_t num_connections)
+      : num_connections_(num_connections) {}
+
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() const override { return num_connections_; }
+  void incNumConnections() override { ++num_connections_; }
+  void post(Network::ConnectionSocketPtr&&) override {}
+
+  uint64_t num_connections_;
+};
+
+class LeastConnectionBalancerImplTest : public testing::Test {
+public:
+  NiceMock<Random::MockRandomGenerator> random_;
+  LeastConnectionBalancerImpl balancer_{random_, 2};
+};
+
+// With no more handlers than choices, all of them are compared.
+TEST_F(LeastConnectionBalancerImplTest, FewHandlers) {
+  TestBalancedConnectionHandler handler1(5);
+  TestBalancedConnectionHandler handler2(3);
+  balancer_.registerHandler(handler1);
+  balancer_.registerHandler(handler2);
+
+  EXPECT_CALL(random_, random()).Times(0);
+  EXPECT_EQ(&handler2, &balancer_.pickTargetHandler(handler1));
+  EXPECT_EQ(4, handler2.numConnections());
+  EXPECT_EQ(&handler2, &balancer_.pickTargetHandler(handler1));
+  EXPECT_EQ(5, handler2.numConnections());
+
+  // Ties keep the connection on the current handler.
+  EXPECT_EQ(&handler1, &balancer_.pickTargetHandler(handler1));
+  EXPECT_EQ(6, handler1.numConnections());
+  EXPECT_EQ(5, handler2.numConnections());
+
+  balancer_.unregisterHandler(handler1);
+  balancer_.unregisterHandler(handler2);
+}
+
+// With more handlers than choices, the least loaded of the randomly chosen ones is picked.
+TEST_F(LeastConnectionBalancerImplTest, RandomChoices) {
+  TestBalancedConnectionHandler handler1(1);
+  TestBalancedConnectionHandler handler2(10);
+  TestBalancedConnectionHandler handler3(4);
+  TestBalancedConnectionHandler handler4(7);
+  balancer_.registerHandler(handler1);
+  balancer_.registerHandler(handler2);
+  balancer_.registerHandler(handler3);
+  balancer_.registerHandler(handler4);
+
+  // Handler 1 is the least loaded overall but isn't among the choices.
+  EXPECT_CALL(random_, random()).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(&handler3, &balancer_.pickTargetHandler(handler2));
+  EXPECT_EQ(5, handler3.numConnections());
+
+  // The current handler is kept if it is at least as good as the choices.
+  EXPECT_CALL(random_, random()).WillOnce(Return(1)).WillOnce(Return(5));
+  EXPECT_EQ(&handler1, &balancer_.pickTargetHandler(handler1));
+  EXPECT_EQ(2, handler1.numConnections());
+
+  balancer_.unregisterHandler(handler3);
+  EXPECT_CALL(random_, random()).WillOnce(Return(1)).WillOnce(Return(2));
+  EXPECT_EQ(&handler4, &balancer_.pickTargetHandler(handler2));
+  EXPECT_EQ(8, handler4.numConnections());
+
+  balancer_.unregisterHandler(handler1);
+  balancer_.unregisterHandler(handler2);
+  balancer_.unregisterHandler(handler4);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -21,6 +21,7 @@
 #include "test/mocks/server/instance.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/registry.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
@@ -235,6 +236,73 @@ TEST_F(RdsImplTest, Basic) {
   // Old config use count should be 1 now.
   EXPECT_EQ(1, config.use_count());
   EXPECT_EQ(2UL, scope_.counter("foo.rds.foo_route_config.config_reload").value());
+
+  // Same response again. The route table that is already published is kept.
+  config = rds_->config();
+  rds_callbacks_->onConfigUpdate(decoded_resources_2.refvec_, "3");
+  EXPECT_EQ(config.get(), rds_->config().get());
+  EXPECT_EQ(2UL, scope_.counter("foo.rds.foo_route_config.config_reload").value());
+}
+
+// Counts the route tables built, through the typed metadata of their routes.
+class CountingMetadataFactory : public HttpRouteTypedMetadataFactory {
+public:
+  std::string name() const override { return "counting"; }
+  std::unique_ptr<const Envoy::Config::TypedMetadata::Object>
+  parse(const ProtobufWkt::Struct& data) const override {
+    ++parsed_;
+    if (data.fields().find("fail") != data.fields().end()) {
+      throw EnvoyException("metadata rejected");
+    }
+    return nullptr;
+  }
+
+  mutable uint32_t parsed_{};
+};
+
+// The route table built while validating an update is the one published.
+TEST_F(RdsImplTest, OneRouteTableBuiltPerUpdate) {
+  CountingMetadataFactory factory;
+  Registry::InjectFactory<HttpRouteTypedMetadataFactory> registered_factory(factory);
+  setup();
+
+  const auto route_config = [](const std::string& metadata) {
+    const std::string yaml = fmt::format(R"EOF(
+name: foo_route_config
+virtual_hosts:
+- name: integration
+  domains: ["*"]
+  routes:
+  - match: {{ prefix: "/foo" }}
+    route: {{ cluster: foo }}
+    metadata: {{ filter_metadata: {{ counting: {} }} }}
+)EOF",
+                                         metadata);
+    return TestUtility::parseYaml<envoy::config::route::v3::RouteConfiguration>(yaml);
+  };
+
+  EXPECT_CALL(init_watcher_, ready());
+  const auto decoded_resources = TestUtility::decodeResources({route_config("{}")});
+  rds_callbacks_->onConfigUpdate(decoded_resources.refvec_, "1");
+  EXPECT_EQ(1, factory.parsed_);
+  ConfigConstSharedPtr config = rds_->config();
+
+  // An unchanged configuration isn't built again.
+  rds_callbacks_->onConfigUpdate(decoded_resources.refvec_, "2");
+  EXPECT_EQ(1, factory.parsed_);
+
+  // A rejected configuration leaves the published route table in place.
+  const auto rejected_resources = TestUtility::decodeResources({route_config("{ fail: true }")});
+  EXPECT_THROW_WITH_MESSAGE(rds_callbacks_->onConfigUpdate(rejected_resources.refvec_, "3"),
+                            EnvoyException, "metadata rejected");
+  EXPECT_EQ(2, factory.parsed_);
+  EXPECT_EQ(config.get(), rds_->config().get());
+
+  const auto updated_resources = TestUtility::decodeResources({route_config("{ foo: bar }")});
+  rds_callbacks_->onConfigUpdate(updated_resources.refvec_, "4");
+  EXPECT_EQ(3, factory.parsed_);
+  EXPECT_NE(config.get(), rds_->config().get());
+  EXPECT_EQ(2UL, scope_.counter("foo.rds.foo_route_config.config_reload").value());
 }
 
 // Validate behavior when the config is delivered but it fails PGV validation.
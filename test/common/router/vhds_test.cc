@@ -77,7 +77,7 @@ vhds:
   makeRouteConfigUpdate(const envoy::config::route::v3::RouteConfiguration& rc) {
     RouteConfigUpdatePtr config_update_info =
         std::make_unique<RouteConfigUpdateReceiverImpl>(factory_context_.timeSource());
-    config_update_info->onRdsUpdate(rc, "1");
+    config_update_info->onRdsUpdate(rc, "1", MessageUtil::hash(rc));
     return config_update_info;
   }
 
@@ -197,7 +197,8 @@ vhds:
       decoded_resources.refvec_, removed_resources, "1");
   EXPECT_EQ(2UL, config_update_info->routeConfiguration().virtual_hosts_size());
 
-  config_update_info->onRdsUpdate(updated_route_config, "2");
+  config_update_info->onRdsUpdate(updated_route_config, "2",
+                                  MessageUtil::hash(updated_route_config));
 
   EXPECT_EQ(3UL, config_update_info->routeConfiguration().virtual_hosts_size());
   auto actual_vhost_0 = config_update_info->routeConfiguration().virtual_hosts(0);
@@ -96,6 +96,42 @@ TEST_F(StatMergerTest, CounterMerge) {
   EXPECT_EQ(4, store_.counterFromString("draculaer").latch());
 }
 
+TEST_F(StatMergerTest, IndexedMerge) {
+  store_.counterFromString("draculaer").inc();
+  Protobuf::Map<uint32_t, std::string> stat_names;
+  Protobuf::Map<uint32_t, uint64_t> counter_deltas;
+  Protobuf::Map<uint32_t, uint64_t> gauges;
+  stat_names[0] = "draculaer";
+  stat_names[1] = "whywassixafraidofseven";
+  counter_deltas[0] = 1;
+  gauges[1] = 100;
+  stat_merger_.mergeIndexedStats(stat_names, counter_deltas, gauges);
+  EXPECT_EQ(2, store_.counterFromString("draculaer").value());
+  EXPECT_EQ(778, whywassixafraidofseven_.value());
+
+  // Later merges only carry the indexes.
+  stat_names.clear();
+  counter_deltas[0] = 2;
+  gauges[1] = 111;
+  stat_merger_.mergeIndexedStats(stat_names, counter_deltas, gauges);
+  EXPECT_EQ(4, store_.counterFromString("draculaer").value());
+  EXPECT_EQ(789, whywassixafraidofseven_.value());
+
+  // The parent's stats are unchanged, so only the child's values change.
+  counter_deltas.clear();
+  gauges.clear();
+  whywassixafraidofseven_.inc();
+  stat_merger_.mergeIndexedStats(stat_names, counter_deltas, gauges);
+  EXPECT_EQ(790, whywassixafraidofseven_.value());
+
+  // Stats the parent never named are skipped.
+  counter_deltas[2] = 1;
+  gauges[3] = 1;
+  stat_merger_.mergeIndexedStats(stat_names, counter_deltas, gauges);
+  EXPECT_EQ(4, store_.counterFromString("draculaer").value());
+  EXPECT_EQ(790, whywassixafraidofseven_.value());
+}
+
 TEST_F(StatMergerTest, BasicDefaultAccumulationImport) {
   Protobuf::Map<std::string, uint64_t> gauges;
   gauges["whywassixafraidofseven"] = 111;
@@ -391,6 +427,25 @@ TEST_F(StatMergerThreadLocalTest, RetainNeverImportModeAfterMerge) {
   EXPECT_EQ(42, gauge.value());
 }
 
+// Gauges which the child initializes as never imported after their first merge by index stop
+// merging the parent's value.
+TEST_F(StatMergerThreadLocalTest, IndexedNeverImportAfterMerge) {
+  StatMerger stat_merger(store_);
+  Protobuf::Map<uint32_t, std::string> stat_names;
+  Protobuf::Map<uint32_t, uint64_t> counter_deltas;
+  Protobuf::Map<uint32_t, uint64_t> gauges;
+  stat_names[0] = "mygauge";
+  gauges[0] = 789;
+  stat_merger.mergeIndexedStats(stat_names, counter_deltas, gauges);
+
+  Gauge& gauge = store_.gaugeFromString("mygauge", Gauge::ImportMode::NeverImport);
+  EXPECT_EQ(0, gauge.value());
+  gauge.set(42);
+  gauges[0] = 790;
+  stat_merger.mergeIndexedStats(Protobuf::Map<uint32_t, std::string>(), counter_deltas, gauges);
+  EXPECT_EQ(42, gauge.value());
+}
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
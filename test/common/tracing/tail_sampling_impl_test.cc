@@ -0,0 +1,245 @@
+#include <chrono>
+#include <memory>
+
+#include "common/stats/isolated_store_impl.h"
+#include "common/tracing/tail_sampling_impl.h"
+
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Eq;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Tracing {
+namespace {
+
+class TailSamplingHttpTracerTest : public testing::Test {
+public:
+  TailSamplingHttpTracerTest() {
+    stream_info_.start_time_monotonic_ = time_system_.monotonicTime();
+  }
+
+  void initialize(uint32_t max_buffered_spans = 1024) {
+    tracer_ = std::make_unique<TailSamplingHttpTracer>(
+        inner_tracer_,
+        TailSamplingConfig{max_buffered_spans, std::chrono::milliseconds(100), true}, tls_,
+        time_system_, TailSamplingHttpTracer::generateStats("tracing.", store_));
+  }
+
+  SpanPtr startSpan(Decision decision = {Reason::NotTraceableRequestId, false}) {
+    return tracer_->startSpan(config_, request_headers_, stream_info_, decision);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "tracing.tail_sampling." + name)->value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  std::shared_ptr<MockHttpTracer> inner_tracer_{std::make_shared<MockHttpTracer>()};
+  NiceMock<MockConfig> config_;
+  Http::TestRequestHeaderMapImpl request_headers_{{":path", "/"}, {":method", "GET"}};
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  std::unique_ptr<TailSamplingHttpTracer> tracer_;
+};
+
+// The requests sampled when they start are traced right away.
+TEST_F(TailSamplingHttpTracerTest, TracedRequest) {
+  initialize();
+  auto* span = new MockSpan();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _))
+      .WillOnce(Invoke([span](const Config&, Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                              const Decision decision) -> Span* {
+        EXPECT_TRUE(decision.traced);
+        EXPECT_EQ(Reason::Sampling, decision.reason);
+        return span;
+      }));
+  SpanPtr active_span = startSpan({Reason::Sampling, true});
+  EXPECT_EQ(span, active_span.get());
+  EXPECT_EQ(0, counter("recorded"));
+}
+
+// The slow requests are traced once they complete, with the finished child spans.
+TEST_F(TailSamplingHttpTracerTest, SampleSlowRequest) {
+  initialize();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _)).Times(0);
+  SpanPtr active_span = startSpan();
+  EXPECT_EQ(1, counter("recorded"));
+
+  const SystemTime start_time = time_system_.systemTime();
+  active_span->setOperation("op");
+  active_span->setTag("foo", "bar");
+  active_span->log(start_time, "event");
+  active_span->setBaggage("key", "value");
+  EXPECT_EQ("value", active_span->getBaggage("key"));
+  SpanPtr finished_child = active_span->spawnChild(config_, "finished", start_time);
+  finished_child->setTag("child", "tag");
+  time_system_.advanceTimeWait(std::chrono::milliseconds(10));
+  const SystemTime child_finish_time = time_system_.systemTime();
+  finished_child->finishSpan();
+  SpanPtr unfinished_child = active_span->spawnChild(config_, "unfinished", start_time);
+  time_system_.advanceTimeWait(std::chrono::milliseconds(90));
+  const SystemTime finish_time = time_system_.systemTime();
+
+  auto* span = new MockSpan();
+  auto* child_span = new MockSpan();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _))
+      .WillOnce(Invoke([span](const Config&, Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                              const Decision decision) -> Span* {
+        EXPECT_TRUE(decision.traced);
+        return span;
+      }));
+  EXPECT_CALL(*span, setOperation(Eq("op")));
+  EXPECT_CALL(*span, setTag(Eq("foo"), Eq("bar")));
+  EXPECT_CALL(*span, log(start_time, "event"));
+  EXPECT_CALL(*span, setBaggage(Eq("key"), Eq("value")));
+  EXPECT_CALL(*span, spawnChild_(_, "finished", start_time)).WillOnce(Return(child_span));
+  EXPECT_CALL(*child_span, setOperation(Eq("finished")));
+  EXPECT_CALL(*child_span, setTag(Eq("child"), Eq("tag")));
+  // The spans are replayed later on, with the time at which they finished.
+  EXPECT_CALL(*child_span, finishSpanAt(child_finish_time));
+  EXPECT_CALL(*span, finishSpanAt(finish_time));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(10));
+  active_span->finishSpanAt(finish_time);
+  EXPECT_EQ(1, counter("sampled"));
+
+  // The unfinished child span can still be used once its parent is gone.
+  active_span.reset();
+  unfinished_child->setTag("late", "tag");
+  unfinished_child->finishSpan();
+}
+
+TEST_F(TailSamplingHttpTracerTest, SampleError) {
+  initialize();
+  SpanPtr active_span = startSpan();
+  active_span->setTag(Tags::get().Error, Tags::get().True);
+
+  auto* span = new NiceMock<MockSpan>();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _)).WillOnce(Return(span));
+  EXPECT_CALL(*span, finishSpanAt(time_system_.systemTime()));
+  active_span->finishSpan();
+  EXPECT_EQ(1, counter("sampled"));
+}
+
+TEST_F(TailSamplingHttpTracerTest, FastRequestNotSampled) {
+  initialize();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _)).Times(0);
+  SpanPtr active_span = startSpan();
+  active_span->setTag(Tags::get().HttpStatusCode, "200");
+  time_system_.advanceTimeWait(std::chrono::milliseconds(99));
+  active_span->finishSpan();
+  EXPECT_EQ(1, counter("not_sampled"));
+}
+
+// The sampling decision set on the span overrides the rules.
+TEST_F(TailSamplingHttpTracerTest, SetSampled) {
+  initialize();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _)).Times(0);
+  SpanPtr active_span = startSpan();
+  active_span->setSampled(false);
+  time_system_.advanceTimeWait(std::chrono::milliseconds(100));
+  active_span->finishSpan();
+  EXPECT_EQ(1, counter("not_sampled"));
+}
+
+// The requests started while the buffer is full are not recorded.
+TEST_F(TailSamplingHttpTracerTest, Overflow) {
+  initialize(1);
+  SpanPtr first_span = startSpan();
+
+  auto* span = new MockSpan();
+  EXPECT_CALL(*inner_tracer_, startSpan_(_, _, _, _))
+      .WillOnce(Invoke([span](const Config&, Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                              const Decision decision) -> Span* {
+        EXPECT_FALSE(decision.traced);
+        return span;
+      }));
+  SpanPtr second_span = startSpan();
+  EXPECT_EQ(span, second_span.get());
+  EXPECT_EQ(1, counter("overflow"));
+
+  // The record of a request is reused once the request is gone, even if it did not complete.
+  first_span.reset();
+  SpanPtr third_span = startSpan();
+  EXPECT_EQ(2, counter("recorded"));
+  EXPECT_EQ("", third_span->getBaggage("key"));
+}
+
+TEST(SpanRecordBufferTest, ReuseRecords) {
+  SpanRecordBuffer buffer(2);
+  SpanRecordPtr first = buffer.acquire();
+  SpanRecordPtr second = buffer.acquire();
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(nullptr, buffer.acquire());
+
+  first->tags_.add() = {"foo", "bar"};
+  SpanRecord* const first_record = first.get();
+  buffer.release(std::move(first));
+  SpanRecordPtr reused = buffer.acquire();
+  EXPECT_EQ(first_record, reused.get());
+  EXPECT_TRUE(reused->tags_.empty());
+}
+
+// The entries and the child records of a record are reused along with it.
+TEST(SpanRecordBufferTest, ReuseEntries) {
+  Event::SimulatedTimeSystem time_system;
+  SpanRecordBuffer buffer(1);
+  NiceMock<MockConfig> config;
+  SpanRecordPtr record = buffer.acquire();
+  SpanRecord* child_record;
+  const std::pair<std::string, std::string>* tag;
+  {
+    RecordingSpan span(*record, time_system);
+    span.setTag("foo", "bar");
+    tag = &record->tags_[0];
+    SpanPtr child = span.spawnChild(config, "child", SystemTime());
+    child_record = record->children_[0].get();
+  }
+  buffer.release(std::move(record));
+
+  record = buffer.acquire();
+  RecordingSpan span(*record, time_system);
+  span.setTag("baz", "qux");
+  EXPECT_EQ(tag, &record->tags_[0]);
+  EXPECT_EQ("baz", record->tags_[0].first);
+  EXPECT_EQ(1U, record->tags_.size());
+  SpanPtr child = span.spawnChild(config, "other", SystemTime());
+  EXPECT_EQ(child_record, record->children_[0].get());
+  EXPECT_EQ("other", child_record->operation_);
+  EXPECT_FALSE(child_record->finish_time_.has_value());
+}
+
+// The record of a child span which outlives the request is not reused while the span is alive.
+TEST(SpanRecordBufferTest, ChildSpanOutlivesRecord) {
+  Event::SimulatedTimeSystem time_system;
+  SpanRecordBuffer buffer(1);
+  NiceMock<MockConfig> config;
+  SpanRecordPtr record = buffer.acquire();
+  SpanPtr child = RecordingSpan(*record, time_system).spawnChild(config, "child", SystemTime());
+  const SpanRecord* const child_record = record->children_[0].get();
+  buffer.release(std::move(record));
+
+  record = buffer.acquire();
+  SpanPtr other_child =
+      RecordingSpan(*record, time_system).spawnChild(config, "other", SystemTime());
+  EXPECT_NE(child_record, record->children_[0].get());
+  EXPECT_EQ("child", child_record->operation_);
+  child->setTag("foo", "bar");
+  EXPECT_TRUE(record->children_[0]->tags_.empty());
+}
+
+} // namespace
+} // namespace Tracing
+} // namespace Envoy
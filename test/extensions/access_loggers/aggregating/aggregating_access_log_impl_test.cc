@@ -0,0 +1,217 @@
+#include <memory>
+
+#include "envoy/extensions/access_loggers/aggregating/v3/aggregating.pb.h"
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/access_loggers/aggregating/aggregating_access_log_impl.h"
+
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Aggregating {
+namespace {
+
+class AggregatingAccessLogTest : public testing::Test {
+public:
+  AggregatingAccessLogTest() {
+    time_system_.setSystemTime(std::chrono::milliseconds(1234));
+    ON_CALL(*file_, write(_)).WillByDefault(Invoke([this](absl::string_view data) {
+      ASSERT_FALSE(data.empty());
+      ASSERT_EQ('\n', data.back());
+      rows_.push_back(TestUtility::jsonToStruct(std::string(data.substr(0, data.size() - 1))));
+    }));
+  }
+
+  void initialize(const std::string& extra_yaml = "") {
+    const std::string yaml = fmt::format(R"EOF(
+path: /dev/null
+dimensions:
+- name: route
+  format: "%ROUTE_NAME%"
+- name: code
+  format: "%RESPONSE_CODE%"
+- name: missing
+  format: "x-%REQ(X-MISSING)%"
+duration_buckets_ms: [10, 100]
+{}
+)EOF",
+                                         extra_yaml);
+    envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog config;
+    TestUtility::loadFromYaml(yaml, config);
+    EXPECT_CALL(log_manager_, createAccessLog("/dev/null")).WillOnce(Return(file_));
+    timer_ = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+    EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(10000), _));
+    auto sink = std::make_shared<AggregatingLogSink>(config, log_manager_, time_system_, store_);
+    logger_ = std::make_unique<AggregatingAccessLog>(nullptr, std::move(sink), tls_);
+  }
+
+  void log(uint32_t code, absl::optional<std::chrono::milliseconds> duration) {
+    stream_info_.response_code_ = code;
+    stream_info_.end_time_ = duration;
+    logger_->log(&request_headers_, &response_headers_, &response_trailers_, stream_info_);
+  }
+
+  // Returns the row with the given response code dimension, null if the code is empty.
+  const ProtobufWkt::Struct* findRow(const std::string& code) {
+    for (const ProtobufWkt::Struct& row : rows_) {
+      const ProtobufWkt::Value& value =
+          row.fields().at("dimensions").struct_value().fields().at("code");
+      if (code.empty() ? value.has_null_value() : value.string_value() == code) {
+        return &row;
+      }
+    }
+    return nullptr;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "access_logs.aggregating_access_log." + name)->value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<AccessLog::MockAccessLogManager> log_manager_;
+  std::shared_ptr<AccessLog::MockAccessLogFile> file_{
+      std::make_shared<NiceMock<AccessLog::MockAccessLogFile>>()};
+  std::vector<ProtobufWkt::Struct> rows_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Event::MockTimer* timer_{};
+  Http::TestRequestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/foo"}};
+  Http::TestResponseHeaderMapImpl response_headers_;
+  Http::TestResponseTrailerMapImpl response_trailers_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  std::unique_ptr<AggregatingAccessLog> logger_;
+};
+
+// The entries are aggregated per group and a row per group is written once the interval is over.
+TEST_F(AggregatingAccessLogTest, AggregatePerGroup) {
+  initialize();
+  stream_info_.setRouteName("foo");
+  log(200, std::chrono::milliseconds(5));
+  log(200, std::chrono::milliseconds(10));
+  log(200, std::chrono::milliseconds(50));
+  log(503, std::chrono::milliseconds(500));
+  log(503, absl::nullopt);
+  EXPECT_EQ(5, counter("entries_aggregated"));
+
+  // The worker hands its aggregates over before the interval is over.
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(10000), _));
+  time_system_.advanceTimeWait(std::chrono::seconds(9));
+  timer_->invokeCallback();
+  EXPECT_TRUE(rows_.empty());
+
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(10000), _));
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  timer_->invokeCallback();
+  ASSERT_EQ(2, rows_.size());
+  EXPECT_EQ(2, counter("rows_written"));
+
+  const ProtobufWkt::Struct expected_ok = TestUtility::jsonToStruct(R"EOF({
+    "start_time_ms": 1234,
+    "end_time_ms": 11234,
+    "dimensions": {"route": "foo", "code": "200", "missing": null},
+    "count": 3,
+    "duration_ms_sum": 65,
+    "duration_ms_buckets": [2, 1, 0]
+  })EOF");
+  const ProtobufWkt::Struct* ok = findRow("200");
+  ASSERT_NE(nullptr, ok);
+  EXPECT_TRUE(TestUtility::protoEqual(expected_ok, *ok));
+
+  // Entries without a duration are only counted.
+  const ProtobufWkt::Struct* error = findRow("503");
+  ASSERT_NE(nullptr, error);
+  EXPECT_EQ(2, error->fields().at("count").number_value());
+  EXPECT_EQ(500, error->fields().at("duration_ms_sum").number_value());
+  const auto& buckets = error->fields().at("duration_ms_buckets").list_value().values();
+  ASSERT_EQ(3, buckets.size());
+  EXPECT_EQ(1, buckets[2].number_value());
+
+  // The next interval starts empty.
+  rows_.clear();
+  log(200, std::chrono::milliseconds(1));
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(10000), _));
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  timer_->invokeCallback();
+  ASSERT_EQ(1, rows_.size());
+  EXPECT_EQ(11234, rows_[0].fields().at("start_time_ms").number_value());
+  EXPECT_EQ(1, rows_[0].fields().at("count").number_value());
+}
+
+// The entries of the groups past the maximum are counted in the group with all dimensions null.
+TEST_F(AggregatingAccessLogTest, MaxGroups) {
+  initialize("max_groups: 1");
+  log(200, std::chrono::milliseconds(5));
+  log(404, std::chrono::milliseconds(5));
+  log(503, std::chrono::milliseconds(5));
+  log(200, std::chrono::milliseconds(5));
+  EXPECT_EQ(2, counter("entries_overflowed"));
+
+  logger_.reset();
+  ASSERT_EQ(2, rows_.size());
+  const ProtobufWkt::Struct* ok = findRow("200");
+  ASSERT_NE(nullptr, ok);
+  EXPECT_EQ(2, ok->fields().at("count").number_value());
+  const ProtobufWkt::Struct* overflow = findRow("");
+  ASSERT_NE(nullptr, overflow);
+  EXPECT_EQ(2, overflow->fields().at("count").number_value());
+  EXPECT_TRUE(
+      overflow->fields().at("dimensions").struct_value().fields().at("route").has_null_value());
+}
+
+// The aggregates still pending are written when the logger is destroyed.
+TEST_F(AggregatingAccessLogTest, FlushOnDestruction) {
+  initialize();
+  log(200, std::chrono::milliseconds(5));
+  EXPECT_TRUE(rows_.empty());
+
+  logger_.reset();
+  ASSERT_EQ(1, rows_.size());
+  EXPECT_EQ(1, rows_[0].fields().at("count").number_value());
+  EXPECT_EQ(1, counter("rows_written"));
+}
+
+TEST(AggregatingLogSinkTest, DurationBuckets) {
+  envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog config;
+  config.set_path("/dev/null");
+  Event::SimulatedTimeSystem time_system;
+  Stats::IsolatedStoreImpl store;
+  NiceMock<AccessLog::MockAccessLogManager> log_manager;
+
+  {
+    AggregatingLogSink sink(config, log_manager, time_system, store);
+    EXPECT_EQ(13, sink.durationBucketCount());
+    EXPECT_EQ(0, sink.durationBucket(0));
+    EXPECT_EQ(0, sink.durationBucket(1));
+    EXPECT_EQ(1, sink.durationBucket(2));
+    EXPECT_EQ(11, sink.durationBucket(10000));
+    EXPECT_EQ(12, sink.durationBucket(10001));
+  }
+
+  config.add_duration_buckets_ms(10);
+  config.add_duration_buckets_ms(10);
+  EXPECT_THROW_WITH_MESSAGE(
+      std::make_unique<AggregatingLogSink>(config, log_manager, time_system, store),
+      EnvoyException, "aggregating access log duration_buckets_ms must be strictly increasing");
+}
+
+} // namespace
+} // namespace Aggregating
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#include "envoy/config/accesslog/v3/accesslog.pb.h"
+#include "envoy/extensions/access_loggers/aggregating/v3/aggregating.pb.h"
+
+#include "common/access_log/access_log_impl.h"
+
+#include "extensions/access_loggers/aggregating/config.h"
+
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::HasSubstr;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Aggregating {
+namespace {
+
+TEST(AggregatingAccessLogConfigTest, ValidateFail) {
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  EXPECT_THROW(AggregatingAccessLogFactory().createAccessLogInstance(
+                   envoy::extensions::access_loggers::aggregating::v3::AggregatingAccessLog(),
+                   nullptr, context),
+               ProtoValidationException);
+}
+
+TEST(AggregatingAccessLogConfigTest, WriteRows) {
+  const std::string yaml = R"EOF(
+name: envoy.access_loggers.aggregating
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.access_loggers.aggregating.v3.AggregatingAccessLog
+  path: /dev/null
+  dimensions:
+  - name: code
+    format: "%RESPONSE_CODE%"
+)EOF";
+  envoy::config::accesslog::v3::AccessLog config;
+  TestUtility::loadFromYaml(yaml, config);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  AccessLog::InstanceSharedPtr logger = AccessLog::AccessLogFactory::fromProto(config, context);
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  logger->log(nullptr, nullptr, nullptr, stream_info);
+  logger->log(nullptr, nullptr, nullptr, stream_info);
+
+  std::string written;
+  EXPECT_CALL(*context.access_log_manager_.file_, write(_))
+      .WillOnce(Invoke([&written](absl::string_view data) { written = std::string(data); }));
+  logger.reset();
+  EXPECT_THAT(written, HasSubstr("\"count\":2"));
+  EXPECT_THAT(written, HasSubstr("\"dimensions\":{\"code\":\"200\"}"));
+}
+
+} // namespace
+} // namespace Aggregating
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
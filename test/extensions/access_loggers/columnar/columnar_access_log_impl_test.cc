@@ -0,0 +1,315 @@
+#include <memory>
+
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/access_loggers/columnar/columnar_access_log_impl.h"
+
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::ElementsAre;
+using testing::InSequence;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+namespace {
+
+class ColumnarAccessLogTest : public testing::Test {
+public:
+  ColumnarAccessLogTest() : api_(Api::createApiForTest()) {
+    time_system_.setSystemTime(std::chrono::milliseconds(1234));
+    stream_info_.response_code_ = 200;
+    ON_CALL(*file_, write(_)).WillByDefault(Invoke([this](absl::string_view data) {
+      written_.add(data);
+    }));
+  }
+
+  std::unique_ptr<ColumnarAccessLog> createLogger(const std::string& path,
+                                                  const std::string& extra_yaml) {
+    const std::string yaml = fmt::format(R"EOF(
+path: {}
+columns:
+- name: code
+  format: "%RESPONSE_CODE%"
+- name: path
+  format: "%REQ(:PATH)%"
+- name: missing
+  format: "x-%REQ(X-MISSING)%"
+{}
+)EOF",
+                                         path, extra_yaml);
+    envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog config;
+    TestUtility::loadFromYaml(yaml, config);
+    timer_ = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+    auto sink =
+        std::make_shared<ColumnarLogSink>(config, nullptr, file_cache_, main_dispatcher_, store_);
+    return std::make_unique<ColumnarAccessLog>(nullptr, std::move(sink), tls_);
+  }
+
+  void initialize(const std::string& path, const std::string& extra_yaml = "") {
+    EXPECT_CALL(log_manager_, createAccessLog(path)).WillOnce(Return(file_));
+    logger_ = createLogger(path, extra_yaml);
+  }
+
+  void log() { log(*logger_); }
+
+  void log(ColumnarAccessLog& logger) {
+    logger.log(&request_headers_, &response_headers_, &response_trailers_, stream_info_);
+  }
+
+  std::vector<DecodedBlock> decodeWritten() {
+    std::vector<DecodedBlock> blocks;
+    DecodedBlock block;
+    while (decodeBlock(
+        written_, [](absl::string_view) { return nullptr; }, block)) {
+      blocks.push_back(std::move(block));
+    }
+    EXPECT_EQ(0, written_.length());
+    return blocks;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "access_logs.columnar_access_log." + name)->value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<AccessLog::MockAccessLogManager> log_manager_;
+  std::shared_ptr<AccessLog::MockAccessLogFile> file_{
+      std::make_shared<NiceMock<AccessLog::MockAccessLogFile>>()};
+  ColumnarLogFileCacheSharedPtr file_cache_{
+      std::make_shared<ColumnarLogFileCache>(log_manager_, api_->fileSystem(), time_system_)};
+  Buffer::OwnedImpl written_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Event::MockDispatcher> main_dispatcher_;
+  Event::MockTimer* timer_{};
+  Http::TestRequestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/foo"}};
+  Http::TestResponseHeaderMapImpl response_headers_;
+  Http::TestResponseTrailerMapImpl response_trailers_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  std::unique_ptr<ColumnarAccessLog> logger_;
+};
+
+// A batch is written as soon as it is full.
+TEST_F(ColumnarAccessLogTest, WriteFullBatch) {
+  initialize(TestEnvironment::temporaryPath("columnar_full_batch"), "max_batch_entries: 2");
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  log();
+  EXPECT_EQ(0, written_.length());
+
+  EXPECT_CALL(*timer_, disableTimer());
+  request_headers_.setPath("/bar");
+  log();
+
+  const std::vector<DecodedBlock> blocks = decodeWritten();
+  ASSERT_EQ(1, blocks.size());
+  EXPECT_THAT(blocks[0].column_names_, ElementsAre("code", "path", "missing"));
+  EXPECT_THAT(blocks[0].columns_[0], ElementsAre(absl::make_optional<std::string>("200"),
+                                                 absl::make_optional<std::string>("200")));
+  EXPECT_THAT(blocks[0].columns_[1], ElementsAre(absl::make_optional<std::string>("/foo"),
+                                                 absl::make_optional<std::string>("/bar")));
+  EXPECT_THAT(blocks[0].columns_[2], ElementsAre(absl::nullopt, absl::nullopt));
+  EXPECT_EQ(2, counter("logs_written"));
+  EXPECT_EQ(1, counter("batches_written"));
+  EXPECT_EQ(counter("bytes_written"), counter("bytes_uncompressed") + 22);
+}
+
+// A batch which does not fill up is written when the flush timer fires.
+TEST_F(ColumnarAccessLogTest, FlushTimer) {
+  initialize(TestEnvironment::temporaryPath("columnar_flush_timer"),
+             "batch_flush_interval: 0.1s");
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(100), _));
+  log();
+  EXPECT_CALL(*timer_, enableTimer(_, _)).Times(0);
+  log();
+  EXPECT_EQ(0, written_.length());
+
+  timer_->invokeCallback();
+  const std::vector<DecodedBlock> blocks = decodeWritten();
+  ASSERT_EQ(1, blocks.size());
+  EXPECT_EQ(2, blocks[0].columns_[0].size());
+
+  EXPECT_EQ(1, counter("batches_written"));
+
+  // The next entry starts a new batch and arms the timer again.
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(100), _));
+  log();
+}
+
+// The batches still pending are written when the logger is destroyed.
+TEST_F(ColumnarAccessLogTest, FlushOnDestruction) {
+  initialize(TestEnvironment::temporaryPath("columnar_destruction"));
+  log();
+  EXPECT_EQ(0, written_.length());
+
+  logger_.reset();
+  const std::vector<DecodedBlock> blocks = decodeWritten();
+  ASSERT_EQ(1, blocks.size());
+  EXPECT_EQ(1, blocks[0].columns_[0].size());
+}
+
+// The existing contents of the file count towards its size.
+TEST_F(ColumnarAccessLogTest, RotateBySize) {
+  const std::string path =
+      TestEnvironment::writeStringToFileForTest("columnar_rotate_by_size", std::string(90, 'x'));
+  TestEnvironment::removePath(path + ".1234");
+  initialize(path, "max_batch_entries: 1\nmax_file_bytes: 100");
+
+  {
+    InSequence s;
+    EXPECT_CALL(*file_, flush());
+    EXPECT_CALL(*file_, reopen());
+  }
+  log();
+  EXPECT_EQ(1, counter("rotated"));
+  EXPECT_TRUE(api_->fileSystem().fileExists(path + ".1234"));
+  EXPECT_FALSE(api_->fileSystem().fileExists(path));
+
+  // The new file starts empty.
+  EXPECT_CALL(*file_, reopen()).Times(0);
+  log();
+  EXPECT_EQ(1, counter("rotated"));
+  EXPECT_EQ(2, counter("batches_written"));
+}
+
+// The worker only posts the rotation, which the main thread does later on. The blocks written in
+// the meantime still go to the rotated file.
+TEST_F(ColumnarAccessLogTest, RotateOnMainThread) {
+  const std::string path =
+      TestEnvironment::writeStringToFileForTest("columnar_rotate_on_main_thread", "");
+  TestEnvironment::removePath(path + ".1234");
+  initialize(path, "max_batch_entries: 1\nmax_file_bytes: 1");
+
+  Event::PostCb rotate;
+  EXPECT_CALL(main_dispatcher_, post(_)).WillOnce(SaveArg<0>(&rotate));
+  EXPECT_CALL(*file_, reopen()).Times(0);
+  log();
+  // A single rotation is posted until it is done.
+  log();
+  EXPECT_EQ(2, counter("batches_written"));
+  EXPECT_TRUE(api_->fileSystem().fileExists(path));
+  EXPECT_EQ(0, counter("rotated"));
+
+  {
+    InSequence s;
+    EXPECT_CALL(*file_, flush());
+    EXPECT_CALL(*file_, reopen());
+  }
+  rotate();
+  EXPECT_EQ(1, counter("rotated"));
+  EXPECT_TRUE(api_->fileSystem().fileExists(path + ".1234"));
+  EXPECT_FALSE(api_->fileSystem().fileExists(path));
+
+  // The sink is kept alive by the posted rotation.
+  EXPECT_CALL(main_dispatcher_, post(_)).WillOnce(SaveArg<0>(&rotate));
+  log();
+  logger_.reset();
+  TestEnvironment::writeStringToFileForTest("columnar_rotate_on_main_thread", "");
+  TestEnvironment::removePath(path + ".1234.1");
+  EXPECT_CALL(*file_, reopen());
+  rotate();
+  EXPECT_EQ(2, counter("rotated"));
+}
+
+TEST_F(ColumnarAccessLogTest, RotateByTime) {
+  const std::string path =
+      TestEnvironment::writeStringToFileForTest("columnar_rotate_by_time", "");
+  TestEnvironment::removePath(path + ".61234");
+  initialize(path, "max_batch_entries: 1\nrotation_interval: 60s");
+
+  EXPECT_CALL(*file_, reopen()).Times(0);
+  log();
+  time_system_.advanceTimeWait(std::chrono::seconds(59));
+  log();
+
+  EXPECT_CALL(*file_, reopen());
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  log();
+  EXPECT_EQ(1, counter("rotated"));
+  EXPECT_TRUE(api_->fileSystem().fileExists(path + ".61234"));
+}
+
+// A file rotated within the same millisecond is not overwritten.
+TEST_F(ColumnarAccessLogTest, RotateWithoutOverwriting) {
+  const std::string path =
+      TestEnvironment::writeStringToFileForTest("columnar_rotate_collision", "");
+  TestEnvironment::writeStringToFileForTest("columnar_rotate_collision.1234", "earlier");
+  TestEnvironment::removePath(path + ".1234.1");
+  initialize(path, "max_batch_entries: 1\nmax_file_bytes: 1");
+
+  EXPECT_CALL(*file_, reopen());
+  log();
+  EXPECT_EQ("earlier", api_->fileSystem().fileReadToEnd(path + ".1234"));
+  EXPECT_TRUE(api_->fileSystem().fileExists(path + ".1234.1"));
+}
+
+// The logs of a path share its file, which is rotated once whichever logs find it due.
+TEST_F(ColumnarAccessLogTest, RotateSharedFile) {
+  const std::string path = TestEnvironment::writeStringToFileForTest("columnar_shared_file", "");
+  TestEnvironment::removePath(path + ".61234");
+  initialize(path, "max_batch_entries: 1\nmax_file_bytes: 1");
+  std::unique_ptr<ColumnarAccessLog> other_logger =
+      createLogger(path, "max_batch_entries: 1\nrotation_interval: 60s");
+
+  Event::PostCb rotate;
+  EXPECT_CALL(main_dispatcher_, post(_)).WillOnce(SaveArg<0>(&rotate));
+  EXPECT_CALL(*file_, reopen()).Times(0);
+  log();
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  log(*other_logger);
+  EXPECT_EQ(2, counter("batches_written"));
+
+  EXPECT_CALL(*file_, reopen());
+  rotate();
+  EXPECT_EQ(1, counter("rotated"));
+  EXPECT_TRUE(api_->fileSystem().fileExists(path + ".61234"));
+}
+
+// A path gets a new file once no log uses the earlier one.
+TEST_F(ColumnarAccessLogTest, FileCache) {
+  const std::string path = TestEnvironment::temporaryPath("columnar_file_cache");
+  EXPECT_CALL(log_manager_, createAccessLog(path)).WillOnce(Return(file_));
+  ColumnarLogFileSharedPtr file = file_cache_->get(path);
+  EXPECT_EQ(file, file_cache_->get(path));
+  EXPECT_EQ(path, file->path());
+
+  file.reset();
+  EXPECT_CALL(log_manager_, createAccessLog(path)).WillOnce(Return(file_));
+  EXPECT_NE(nullptr, file_cache_->get(path));
+}
+
+TEST_F(ColumnarAccessLogTest, RotationFailure) {
+  const std::string path = TestEnvironment::temporaryPath("columnar_rotation_failure");
+  TestEnvironment::removePath(path);
+  initialize(path, "max_batch_entries: 1\nmax_file_bytes: 1");
+
+  EXPECT_CALL(*file_, reopen()).Times(0);
+  log();
+  EXPECT_EQ(0, counter("rotated"));
+  EXPECT_EQ(1, counter("rotation_failed"));
+}
+
+} // namespace
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
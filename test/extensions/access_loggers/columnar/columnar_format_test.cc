@@ -0,0 +1,206 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/access_loggers/columnar/columnar_format.h"
+#include "extensions/compression/gzip/compressor/zlib_compressor_impl.h"
+#include "extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
+
+#include "test/mocks/compression/compressor/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::Invoke;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+namespace {
+
+// Window bits for gzip output, @see deflateInit2 in the zlib manual.
+constexpr int64_t GzipWindowBits = 15 | 16;
+
+class ColumnarFormatTest : public testing::Test {
+public:
+  ColumnarFormatTest() : encoder_({"code", "path"}) {
+    ON_CALL(compressor_factory_, contentEncoding()).WillByDefault(ReturnRef(gzip_));
+    ON_CALL(compressor_factory_, createCompressor()).WillByDefault(Invoke([]() {
+      auto compressor = std::make_unique<Compression::Gzip::Compressor::ZlibCompressorImpl>();
+      compressor->init(
+          Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+          Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+          GzipWindowBits, 8);
+      return compressor;
+    }));
+  }
+
+  void addRow(absl::optional<std::string> code, absl::optional<std::string> path) {
+    encoder_.valueBuffer(0).append(code.value_or("ignored"));
+    encoder_.endValue(0, !code.has_value());
+    encoder_.valueBuffer(1).append(path.value_or("ignored"));
+    encoder_.endValue(1, !path.has_value());
+    encoder_.endRow();
+  }
+
+  Compression::Decompressor::DecompressorPtr lookup(absl::string_view encoding) {
+    if (encoding != gzip_) {
+      return nullptr;
+    }
+    auto decompressor =
+        std::make_unique<Compression::Gzip::Decompressor::ZlibDecompressorImpl>(store_, "test.");
+    decompressor->init(GzipWindowBits);
+    return decompressor;
+  }
+
+  bool decode(Buffer::Instance& input) {
+    return decodeBlock(
+        input, [this](absl::string_view encoding) { return lookup(encoding); }, block_);
+  }
+
+  const std::string gzip_{"gzip"};
+  Stats::IsolatedStoreImpl store_;
+  testing::NiceMock<Compression::Compressor::MockCompressorFactory> compressor_factory_;
+  BatchEncoder encoder_;
+  DecodedBlock block_;
+};
+
+TEST_F(ColumnarFormatTest, RoundTripUncompressed) {
+  addRow("200", "/foo");
+  addRow(absl::nullopt, "");
+  addRow("503", absl::nullopt);
+  EXPECT_EQ(3, encoder_.rows());
+
+  Buffer::OwnedImpl block;
+  const uint64_t payload_length = encoder_.encode(nullptr, block);
+  EXPECT_EQ(0, encoder_.rows());
+  // Header, then for each column its name and three value lengths.
+  EXPECT_EQ(4 + 1 + 1 + 16 + payload_length, block.length());
+  EXPECT_EQ(2 * (4 + 4 + 3 * 4) + 3 + 3 + 4, payload_length);
+
+  ASSERT_TRUE(decode(block));
+  EXPECT_EQ(0, block.length());
+  EXPECT_THAT(block_.column_names_, ElementsAre("code", "path"));
+  EXPECT_THAT(block_.columns_[0],
+              ElementsAre(absl::make_optional<std::string>("200"), absl::nullopt,
+                          absl::make_optional<std::string>("503")));
+  EXPECT_THAT(block_.columns_[1],
+              ElementsAre(absl::make_optional<std::string>("/foo"),
+                          absl::make_optional<std::string>(""), absl::nullopt));
+}
+
+TEST_F(ColumnarFormatTest, RoundTripCompressed) {
+  for (int i = 0; i < 100; ++i) {
+    addRow("200", "/some/long/repeated/path");
+  }
+  Buffer::OwnedImpl block;
+  const uint64_t payload_length = encoder_.encode(&compressor_factory_, block);
+  EXPECT_LT(block.length(), payload_length);
+
+  // Encode a second block to check that blocks are decoded one at a time.
+  addRow("404", absl::nullopt);
+  encoder_.encode(&compressor_factory_, block);
+
+  ASSERT_TRUE(decode(block));
+  EXPECT_NE(0, block.length());
+  ASSERT_EQ(100, block_.columns_[1].size());
+  EXPECT_EQ("/some/long/repeated/path", block_.columns_[1][99].value());
+
+  ASSERT_TRUE(decode(block));
+  EXPECT_EQ(0, block.length());
+  EXPECT_THAT(block_.columns_[0], ElementsAre(absl::make_optional<std::string>("404")));
+  EXPECT_THAT(block_.columns_[1], ElementsAre(absl::nullopt));
+}
+
+TEST_F(ColumnarFormatTest, IncompleteBlock) {
+  addRow("200", "/foo");
+  Buffer::OwnedImpl block;
+  encoder_.encode(nullptr, block);
+  const std::string encoded = block.toString();
+
+  for (size_t length : {size_t(0), size_t(5), size_t(10), encoded.size() - 1}) {
+    Buffer::OwnedImpl partial(encoded.substr(0, length));
+    EXPECT_FALSE(decode(partial));
+    EXPECT_EQ(length, partial.length());
+  }
+}
+
+TEST_F(ColumnarFormatTest, BadMagic) {
+  Buffer::OwnedImpl input(std::string("ECAX\x01\x00", 6));
+  EXPECT_THROW_WITH_MESSAGE(decode(input), EnvoyException,
+                            "malformed columnar access log block: bad magic");
+}
+
+TEST_F(ColumnarFormatTest, UnsupportedVersion) {
+  Buffer::OwnedImpl input(std::string("ECAL\x02\x00", 6));
+  EXPECT_THROW_WITH_MESSAGE(decode(input), EnvoyException,
+                            "malformed columnar access log block: unsupported version 2");
+}
+
+TEST_F(ColumnarFormatTest, UnknownEncoding) {
+  std::string encoding{"snappy"};
+  ON_CALL(compressor_factory_, contentEncoding()).WillByDefault(ReturnRef(encoding));
+  addRow("200", "/foo");
+  Buffer::OwnedImpl block;
+  encoder_.encode(&compressor_factory_, block);
+  EXPECT_THROW_WITH_MESSAGE(decode(block), EnvoyException,
+                            "unknown columnar access log block encoding 'snappy'");
+}
+
+TEST_F(ColumnarFormatTest, PayloadLengthMismatch) {
+  addRow("200", "/foo");
+  Buffer::OwnedImpl block;
+  encoder_.encode(nullptr, block);
+  std::string encoded = block.toString();
+  // Bump the low byte of the uncompressed payload length.
+  encoded[4 + 1 + 1 + 8 + 3]++;
+  Buffer::OwnedImpl input(encoded);
+  EXPECT_THROW_WITH_MESSAGE(decode(input), EnvoyException,
+                            "malformed columnar access log block: payload length mismatch");
+}
+
+TEST_F(ColumnarFormatTest, TooManyRows) {
+  addRow("200", "/foo");
+  Buffer::OwnedImpl block;
+  encoder_.encode(nullptr, block);
+  std::string encoded = block.toString();
+  // Claim 2^24 + 1 rows.
+  encoded[4 + 1 + 1] = 1;
+  Buffer::OwnedImpl input(encoded);
+  EXPECT_THROW_WITH_MESSAGE(
+      decode(input), EnvoyException,
+      "malformed columnar access log block: too many rows or columns for the payload");
+}
+
+TEST_F(ColumnarFormatTest, TruncatedPayload) {
+  addRow("200", "/foo");
+  Buffer::OwnedImpl block;
+  encoder_.encode(nullptr, block);
+  std::string encoded = block.toString();
+  // Make the last value of the last column one byte longer than the payload.
+  encoded[encoded.size() - 4 - 1]++;
+  Buffer::OwnedImpl input(encoded);
+  EXPECT_THROW_WITH_MESSAGE(decode(input), EnvoyException,
+                            "malformed columnar access log block: truncated payload");
+}
+
+TEST_F(ColumnarFormatTest, TrailingPayload) {
+  addRow("200", "/foo");
+  Buffer::OwnedImpl block;
+  encoder_.encode(nullptr, block);
+  std::string encoded = block.toString();
+  // Make the last value of the last column one byte shorter than its value.
+  encoded[encoded.size() - 4 - 1]--;
+  Buffer::OwnedImpl input(encoded);
+  EXPECT_THROW_WITH_MESSAGE(decode(input), EnvoyException,
+                            "malformed columnar access log block: trailing payload");
+}
+
+} // namespace
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,108 @@
+#include "envoy/config/accesslog/v3/accesslog.pb.h"
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+
+#include "common/access_log/access_log_impl.h"
+
+#include "extensions/access_loggers/columnar/config.h"
+
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::StartsWith;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+namespace {
+
+TEST(ColumnarAccessLogConfigTest, ValidateFail) {
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  EXPECT_THROW(ColumnarAccessLogFactory().createAccessLogInstance(
+                   envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog(), nullptr,
+                   context),
+               ProtoValidationException);
+}
+
+TEST(ColumnarAccessLogConfigTest, UnregisteredCompressorLibrary) {
+  const std::string yaml = R"EOF(
+path: /dev/null
+columns:
+- name: code
+  format: "%RESPONSE_CODE%"
+compressor_library:
+  name: fake_compressor
+  typed_config:
+    "@type": type.googleapis.com/test.mock_compressor_library.Unregistered
+)EOF";
+  envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog config;
+  TestUtility::loadFromYaml(yaml, config);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  EXPECT_THROW_WITH_MESSAGE(
+      ColumnarAccessLogFactory().createAccessLogInstance(config, nullptr, context), EnvoyException,
+      "Didn't find a registered implementation for type: "
+      "'test.mock_compressor_library.Unregistered'");
+}
+
+TEST(ColumnarAccessLogConfigTest, CompressedBatches) {
+  const std::string yaml = R"EOF(
+name: envoy.access_loggers.columnar
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.access_loggers.columnar.v3.ColumnarAccessLog
+  path: /dev/null
+  columns:
+  - name: code
+    format: "%RESPONSE_CODE%"
+  max_batch_entries: 1
+  compressor_library:
+    name: gzip
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip
+)EOF";
+  envoy::config::accesslog::v3::AccessLog config;
+  TestUtility::loadFromYaml(yaml, config);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  AccessLog::InstanceSharedPtr logger = AccessLog::AccessLogFactory::fromProto(config, context);
+
+  std::string written;
+  EXPECT_CALL(*context.access_log_manager_.file_, write(_))
+      .WillOnce(Invoke([&written](absl::string_view data) { written = std::string(data); }));
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  logger->log(nullptr, nullptr, nullptr, stream_info);
+  EXPECT_THAT(written, StartsWith(std::string("ECAL\x01\x04gzip", 10)));
+}
+
+// The logs of a path share its file.
+TEST(ColumnarAccessLogConfigTest, SharedFile) {
+  const std::string yaml = R"EOF(
+name: envoy.access_loggers.columnar
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.access_loggers.columnar.v3.ColumnarAccessLog
+  path: /dev/null
+  columns:
+  - name: code
+    format: "%RESPONSE_CODE%"
+)EOF";
+  envoy::config::accesslog::v3::AccessLog config;
+  TestUtility::loadFromYaml(yaml, config);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_CALL(context.access_log_manager_, createAccessLog("/dev/null"));
+  AccessLog::InstanceSharedPtr logger = AccessLog::AccessLogFactory::fromProto(config, context);
+  AccessLog::InstanceSharedPtr other_logger =
+      AccessLog::AccessLogFactory::fromProto(config, context);
+}
+
+} // namespace
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -11,12 +11,14 @@
 #include "extensions/access_loggers/grpc/http_grpc_access_log_impl.h"
 
 #include "test/mocks/access_log/mocks.h"
+#include "test/mocks/compression/compressor/mocks.h"
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stream_info/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
 
 using testing::_;
 using testing::AnyNumber;
@@ -40,12 +42,21 @@ public:
       Grpc::AsyncStreamCallbacks<envoy::service::accesslog::v3::StreamAccessLogsResponse>;
 
   void initLogger(std::chrono::milliseconds buffer_flush_interval_msec, size_t buffer_size_bytes) {
+    initLogger(buffer_flush_interval_msec, buffer_size_bytes, buffer_size_bytes,
+               std::chrono::milliseconds(0), 0, nullptr);
+  }
+
+  void initLogger(std::chrono::milliseconds buffer_flush_interval_msec, size_t buffer_size_bytes,
+                  size_t max_pending_bytes, std::chrono::milliseconds adaptive_target_fill_time,
+                  size_t min_buffer_size_bytes,
+                  Compression::Compressor::CompressorFactorySharedPtr compressor_factory) {
     timer_ = new Event::MockTimer(&dispatcher_);
     EXPECT_CALL(*timer_, enableTimer(buffer_flush_interval_msec, _));
     logger_ = std::make_unique<GrpcAccessLoggerImpl>(
         Grpc::RawAsyncClientPtr{async_client_}, log_name_, buffer_flush_interval_msec,
         buffer_size_bytes, dispatcher_, local_info_, stats_store_,
-        envoy::config::core::v3::ApiVersion::AUTO);
+        envoy::config::core::v3::ApiVersion::AUTO, max_pending_bytes, adaptive_target_fill_time,
+        min_buffer_size_bytes, std::move(compressor_factory));
   }
 
   void expectStreamStart(MockAccessLogStream& stream, AccessLogCallbacks** callbacks_to_set) {
@@ -58,6 +69,10 @@ public:
         }));
   }
 
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(stats_store_, "access_logs.grpc_access_log." + name)->value();
+  }
+
   void expectStreamMessage(MockAccessLogStream& stream, const std::string& expected_message_yaml) {
     envoy::service::accesslog::v3::StreamAccessLogsMessage expected_message;
     TestUtility::loadFromYaml(expected_message_yaml, expected_message);
@@ -254,9 +269,31 @@ TEST_F(GrpcAccessLoggerImplTest, StreamFailure) {
             callbacks.onRemoteClose(Grpc::Status::Internal, "bad");
             return nullptr;
           }));
-  EXPECT_CALL(local_info_, node());
   envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  entry.mutable_request()->set_path("/test/path1");
   logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+
+  // The batch stays queued and is sent on the next stream.
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  expectStreamMessage(stream, R"EOF(
+identifier:
+  node:
+    id: node_name
+    cluster: cluster_name
+    locality:
+      zone: zone_name
+  log_name: test_log_name
+http_logs:
+  log_entry:
+    request:
+      path: /test/path1
+)EOF");
+  EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+  timer_->invokeCallback();
+  EXPECT_EQ(1, counter("messages_sent"));
 }
 
 // Test that log entries are batched.
@@ -348,6 +385,179 @@ TEST_F(GrpcAccessLoggerImplTest, Flushing) {
   timer_->invokeCallback();
 }
 
+// Test that full batches queue up, within max_pending_bytes, while the stream is above its high
+// watermark.
+TEST_F(GrpcAccessLoggerImplTest, PendingMessages) {
+  initLogger(FlushInterval, 1, 200, std::chrono::milliseconds(0), 0, nullptr);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillRepeatedly(Return(true));
+  EXPECT_CALL(stream, sendMessageRaw_(_, _)).Times(0);
+
+  // Each entry takes 104 bytes, so the third one does not fit.
+  const std::string path1(100, '1');
+  const std::string path2(100, '2');
+  envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  for (const std::string& path : {path1, path2, path2}) {
+    entry.mutable_request()->set_path(path);
+    logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+  }
+  EXPECT_EQ(2, counter("logs_written"));
+  EXPECT_EQ(1, counter("logs_dropped"));
+  EXPECT_EQ(0, counter("messages_sent"));
+
+  // Once the stream drains, the batches are sent in order, the first one carrying the identifier.
+  testing::Mock::VerifyAndClearExpectations(&stream);
+  InSequence s;
+  expectStreamMessage(stream, fmt::format(R"EOF(
+identifier:
+  node:
+    id: node_name
+    cluster: cluster_name
+    locality:
+      zone: zone_name
+  log_name: test_log_name
+http_logs:
+  log_entry:
+    request:
+      path: "{}"
+)EOF",
+                                          path1));
+  expectStreamMessage(stream, fmt::format(R"EOF(
+http_logs:
+  log_entry:
+    request:
+      path: "{}"
+)EOF",
+                                          path2));
+  EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+  timer_->invokeCallback();
+  EXPECT_EQ(2, counter("messages_sent"));
+  EXPECT_EQ(counter("bytes_sent"), counter("bytes_uncompressed"));
+}
+
+// Test that the batch size follows the rate of logged bytes.
+TEST_F(GrpcAccessLoggerImplTest, AdaptiveBatching) {
+  InSequence s;
+  // Batches of two flush intervals worth of entries, between 100 and 1000 bytes.
+  initLogger(FlushInterval, 1000, 0, 2 * FlushInterval, 100, nullptr);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  // Each entry takes 54 bytes.
+  entry.mutable_request()->set_path(std::string(50, 'a'));
+  auto log = [this, &entry](int entries) {
+    for (int i = 0; i < entries; ++i) {
+      logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+    }
+  };
+  auto expect_send = [&stream]() {
+    EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(false));
+    EXPECT_CALL(stream, sendMessageRaw_(_, false));
+  };
+
+  // The batch size starts at the minimum.
+  log(1);
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  expect_send();
+  log(1);
+  EXPECT_EQ(1, counter("messages_sent"));
+
+  // 108 bytes were logged in the interval, so the batches grow to 216 bytes.
+  EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+  timer_->invokeCallback();
+  log(3);
+  expect_send();
+  log(1);
+  EXPECT_EQ(2, counter("messages_sent"));
+
+  // The batch size shrinks over quiet intervals, back down to the minimum.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_CALL(*timer_, enableTimer(FlushInterval, _));
+    timer_->invokeCallback();
+  }
+  log(1);
+  expect_send();
+  log(1);
+  EXPECT_EQ(3, counter("messages_sent"));
+  EXPECT_EQ(8, counter("logs_written"));
+}
+
+// Test that messages are compressed with the configured compressor.
+TEST_F(GrpcAccessLoggerImplTest, Compression) {
+  InSequence s;
+  auto compressor_factory =
+      std::make_shared<NiceMock<Compression::Compressor::MockCompressorFactory>>();
+  initLogger(FlushInterval, 0, 0, std::chrono::milliseconds(0), 0, compressor_factory);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(false));
+  EXPECT_CALL(*compressor_factory, createCompressor()).WillOnce(Invoke([]() {
+    auto compressor = std::make_unique<Compression::Compressor::MockCompressor>();
+    EXPECT_CALL(*compressor, compress(_, Compression::Compressor::State::Finish))
+        .WillOnce(Invoke([](Buffer::Instance& buffer, Compression::Compressor::State) {
+          buffer.drain(buffer.length());
+          buffer.add("compressed");
+        }));
+    return compressor;
+  }));
+  EXPECT_CALL(stream, sendCompressedMessageRaw_(_, false))
+      .WillOnce(Invoke([](Buffer::InstancePtr& request, bool) {
+        EXPECT_EQ("compressed", request->toString());
+      }));
+  envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  entry.mutable_request()->set_path("/test/path1");
+  logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+  EXPECT_EQ(1, counter("messages_sent"));
+  EXPECT_EQ(10, counter("bytes_sent"));
+  EXPECT_LT(10, counter("bytes_uncompressed"));
+
+  // The message encoding is announced in the initial metadata of the stream.
+  Http::TestRequestHeaderMapImpl metadata;
+  callbacks->onCreateInitialMetadata(metadata);
+  EXPECT_EQ("mock", metadata.get_("grpc-encoding"));
+}
+
+// The stream of a client which compresses the messages itself, as the Google gRPC client does.
+class MockUncompressedAccessLogStream : public Grpc::RawAsyncStream {
+public:
+  void sendMessageRaw(Buffer::InstancePtr&& request, bool end_stream) override {
+    sendMessageRaw_(request, end_stream);
+  }
+  MOCK_METHOD(void, sendMessageRaw_, (Buffer::InstancePtr & request, bool end_stream));
+  MOCK_METHOD(void, closeStream, ());
+  MOCK_METHOD(void, resetStream, ());
+  MOCK_METHOD(bool, isAboveWriteBufferHighWatermark, (), (const));
+};
+
+// Test that the messages are sent uncompressed if the stream cannot send compressed messages.
+TEST_F(GrpcAccessLoggerImplTest, CompressionUnsupportedByStream) {
+  InSequence s;
+  auto compressor_factory =
+      std::make_shared<NiceMock<Compression::Compressor::MockCompressorFactory>>();
+  initLogger(FlushInterval, 0, 0, std::chrono::milliseconds(0), 0, compressor_factory);
+
+  MockUncompressedAccessLogStream stream;
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&stream));
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(false));
+  EXPECT_CALL(*compressor_factory, createCompressor()).Times(0);
+  EXPECT_CALL(stream, sendMessageRaw_(_, false));
+  envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  entry.mutable_request()->set_path("/test/path1");
+  logger_->log(envoy::data::accesslog::v3::HTTPAccessLogEntry(entry));
+  EXPECT_EQ(1, counter("messages_sent"));
+  EXPECT_EQ(counter("bytes_uncompressed"), counter("bytes_sent"));
+}
+
 class GrpcAccessLoggerCacheImplTest : public testing::Test {
 public:
   GrpcAccessLoggerCacheImplTest() {
@@ -386,25 +596,30 @@ TEST_F(GrpcAccessLoggerCacheImplTest, Deduplication) {
 
   expectClientCreation();
   GrpcAccessLoggerSharedPtr logger1 =
-      logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope);
-  EXPECT_EQ(logger1, logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope));
+      logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope, nullptr);
+  EXPECT_EQ(logger1,
+            logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope, nullptr));
 
   // Do not deduplicate different types of logger
   expectClientCreation();
-  EXPECT_NE(logger1, logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::TCP, scope));
+  EXPECT_NE(logger1,
+            logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::TCP, scope, nullptr));
 
   // Changing log name leads to another logger.
   config.set_log_name("log-2");
   expectClientCreation();
-  EXPECT_NE(logger1, logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope));
+  EXPECT_NE(logger1,
+            logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope, nullptr));
 
   config.set_log_name("log-1");
-  EXPECT_EQ(logger1, logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope));
+  EXPECT_EQ(logger1,
+            logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope, nullptr));
 
   // Changing cluster name leads to another logger.
   config.mutable_grpc_service()->mutable_envoy_grpc()->set_cluster_name("cluster-2");
   expectClientCreation();
-  EXPECT_NE(logger1, logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope));
+  EXPECT_NE(logger1,
+            logger_cache_->getOrCreateLogger(config, GrpcAccessLoggerType::HTTP, scope, nullptr));
 }
 
 } // namespace
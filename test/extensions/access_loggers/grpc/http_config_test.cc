@@ -4,10 +4,12 @@
 #include "envoy/server/access_log_config.h"
 #include "envoy/stats/scope.h"
 
+#include "extensions/access_loggers/grpc/http_config.h"
 #include "extensions/access_loggers/grpc/http_grpc_access_log_impl.h"
 #include "extensions/access_loggers/well_known_names.h"
 
 #include "test/mocks/server/factory_context.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -58,6 +60,48 @@ TEST_F(HttpGrpcAccessLogConfigTest, Ok) {
   EXPECT_NE(nullptr, dynamic_cast<HttpGrpcAccessLog*>(instance.get()));
 }
 
+// Configuration with a compressor library for the messages.
+TEST_F(HttpGrpcAccessLogConfigTest, CompressorLibrary) {
+  TestUtility::loadFromYaml(R"EOF(
+common_config:
+  log_name: foo
+  grpc_service:
+    envoy_grpc:
+      cluster_name: bar
+  compressor_library:
+    name: gzip
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip
+)EOF",
+                            *message_);
+  AccessLog::InstanceSharedPtr instance =
+      factory_->createAccessLogInstance(*message_, std::move(filter_), context_);
+  EXPECT_NE(nullptr, dynamic_cast<HttpGrpcAccessLog*>(instance.get()));
+}
+
+// The compressor library is only supported with the Envoy gRPC client.
+TEST(HttpGrpcAccessLogConfigCompressorTest, CompressorLibraryWithGoogleGrpc) {
+  envoy::extensions::access_loggers::grpc::v3::HttpGrpcAccessLogConfig config;
+  TestUtility::loadFromYaml(R"EOF(
+common_config:
+  log_name: foo
+  grpc_service:
+    google_grpc:
+      target_uri: 127.0.0.1:8000
+      stat_prefix: foo
+  compressor_library:
+    name: gzip
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip
+)EOF",
+                            config);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_THROW_WITH_MESSAGE(
+      HttpGrpcAccessLogFactory().createAccessLogInstance(config, nullptr, context), EnvoyException,
+      "gRPC access log compressor_library is only supported with envoy_grpc, configure the "
+      "compression of google_grpc through its channel_args");
+}
+
 } // namespace
 } // namespace HttpGrpc
 } // namespace AccessLoggers
@@ -45,7 +45,8 @@ public:
   // GrpcAccessLoggerCache
   MOCK_METHOD(GrpcCommon::GrpcAccessLoggerSharedPtr, getOrCreateLogger,
               (const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig& config,
-               GrpcCommon::GrpcAccessLoggerType logger_type, Stats::Scope& scope));
+               GrpcCommon::GrpcAccessLoggerType logger_type, Stats::Scope& scope,
+               Compression::Compressor::CompressorFactorySharedPtr compressor_factory));
 };
 
 class HttpGrpcAccessLogTest : public testing::Test {
@@ -55,17 +56,18 @@ public:
     config_.mutable_common_config()->set_log_name("hello_log");
     config_.mutable_common_config()->add_filter_state_objects_to_log("string_accessor");
     config_.mutable_common_config()->add_filter_state_objects_to_log("serialized");
-    EXPECT_CALL(*logger_cache_, getOrCreateLogger(_, _, _))
+    EXPECT_CALL(*logger_cache_, getOrCreateLogger(_, _, _, _))
         .WillOnce(
             [this](const envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig&
                        config,
-                   GrpcCommon::GrpcAccessLoggerType logger_type, Stats::Scope&) {
+                   GrpcCommon::GrpcAccessLoggerType logger_type, Stats::Scope&,
+                   Compression::Compressor::CompressorFactorySharedPtr) {
               EXPECT_EQ(config.DebugString(), config_.common_config().DebugString());
               EXPECT_EQ(GrpcCommon::GrpcAccessLoggerType::HTTP, logger_type);
               return logger_;
             });
     access_log_ = std::make_unique<HttpGrpcAccessLog>(AccessLog::FilterPtr{filter_}, config_, tls_,
-                                                      logger_cache_, scope_);
+                                                      logger_cache_, scope_, nullptr);
   }
 
   void expectLog(const std::string& expected_log_entry_yaml) {
@@ -0,0 +1,124 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+#include "extensions/compression/brotli/compressor/config.h"
+#include "extensions/compression/brotli/decompressor/brotli_decompressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Compressor {
+namespace {
+
+const std::string Dictionary = R"EOF({"name": "", "namespace": "default", "labels": {}})EOF";
+
+class BrotliCompressorImplTest : public testing::Test {
+protected:
+  BrotliCompressorImplTest() : api_(Api::createApiForTest()) {}
+
+  Envoy::Compression::Compressor::CompressorFactoryPtr createFactory(const std::string& yaml) {
+    envoy::extensions::compression::brotli::compressor::v3::Brotli brotli;
+    TestUtility::loadFromYaml(yaml, brotli);
+    return std::make_unique<BrotliCompressorFactory>(brotli, *api_);
+  }
+
+  // Decompresses the buffer and checks it holds the original text.
+  void expectDecompressesTo(const Buffer::Instance& compressed, const std::string& original_text,
+                            Decompressor::BrotliDictionarySharedPtr dictionary = nullptr) {
+    Stats::IsolatedStoreImpl stats_store;
+    Decompressor::BrotliDecompressorImpl decompressor{stats_store, "test.", 4096, false,
+                                                      std::move(dictionary)};
+    Buffer::OwnedImpl decompressed;
+    decompressor.decompress(compressed, decompressed);
+    EXPECT_EQ(0, stats_store.counterFromString("test.brotli_error").value());
+    EXPECT_EQ(original_text, decompressed.toString());
+  }
+
+  Api::ApiPtr api_;
+};
+
+TEST_F(BrotliCompressorImplTest, FactoryDefaults) {
+  auto factory = createFactory("{}");
+  EXPECT_EQ("brotli.", factory->statsPrefix());
+  EXPECT_EQ("br", factory->contentEncoding());
+}
+
+// Each flush makes all the content compressed so far decompressible.
+TEST_F(BrotliCompressorImplTest, CompressFlushAndFinish) {
+  auto compressor = createFactory("{}")->createCompressor();
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  std::string original_text;
+  for (uint64_t i = 1; i < 10; ++i) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, 1000 * i, i);
+    original_text.append(buffer.toString());
+    compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    accumulation_buffer.move(buffer);
+    expectDecompressesTo(accumulation_buffer, original_text);
+  }
+
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_GT(buffer.length(), 0);
+  accumulation_buffer.move(buffer);
+  expectDecompressesTo(accumulation_buffer, original_text);
+}
+
+TEST_F(BrotliCompressorImplTest, CompressMultipleSlicesWithSmallChunk) {
+  auto compressor = createFactory(R"EOF(
+quality: 11
+encoder_mode: TEXT
+window_bits: 10
+input_block_bits: 16
+chunk_size: 4096
+)EOF")
+                        ->createCompressor();
+  Buffer::OwnedImpl buffer;
+  std::string original_text;
+  for (uint64_t i = 0; i < 20; ++i) {
+    Buffer::OwnedImpl slice;
+    TestUtility::feedBufferWithRandomCharacters(slice, 7000, i);
+    original_text.append(slice.toString());
+    buffer.move(slice);
+  }
+  ASSERT_GT(buffer.getRawSlices().size(), 1);
+
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  expectDecompressesTo(buffer, original_text);
+}
+
+TEST_F(BrotliCompressorImplTest, CompressWithDictionary) {
+  const std::string text = R"EOF({"name": "backend", "namespace": "default", "labels": {}})EOF";
+  Buffer::OwnedImpl plain(text);
+  createFactory("{}")->createCompressor()->compress(
+      plain, Envoy::Compression::Compressor::State::Finish);
+
+  auto factory = createFactory(fmt::format(R"EOF(
+dictionary:
+  inline_string: '{}'
+)EOF",
+                                           Dictionary));
+  Buffer::OwnedImpl primed(text);
+  factory->createCompressor()->compress(primed, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_LT(primed.length(), plain.length());
+  expectDecompressesTo(primed, text, std::make_shared<const std::string>(Dictionary));
+
+  // The content can't be decompressed without the dictionary.
+  Stats::IsolatedStoreImpl stats_store;
+  Decompressor::BrotliDecompressorImpl decompressor{stats_store, "test.", 4096, false, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(primed, decompressed);
+  EXPECT_EQ(1, stats_store.counterFromString("test.brotli_error").value());
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,110 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
+#include "extensions/compression/brotli/decompressor/brotli_decompressor_impl.h"
+#include "extensions/compression/brotli/decompressor/config.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Brotli {
+namespace Decompressor {
+namespace {
+
+using Compressor::BrotliCompressorImpl;
+
+class BrotliDecompressorImplTest : public testing::Test {
+protected:
+  // Compresses random text of the given size into the buffer, and returns the text.
+  static std::string compressRandomText(Buffer::Instance& buffer, uint64_t size,
+                                        Compressor::BrotliEncoderDictionarySharedPtr dictionary) {
+    BrotliCompressorImpl compressor{3, 18, 24, BrotliCompressorImpl::EncoderMode::Default, 4096,
+                                    std::move(dictionary)};
+    TestUtility::feedBufferWithRandomCharacters(buffer, size);
+    const std::string text = buffer.toString();
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    return text;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+};
+
+TEST_F(BrotliDecompressorImplTest, CompressAndDecompress) {
+  Buffer::OwnedImpl compressed;
+  const std::string text = compressRandomText(compressed, 100000, nullptr);
+
+  BrotliDecompressorImpl decompressor{stats_store_, "test.", 4096, false, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(compressed, decompressed);
+  EXPECT_EQ(text, decompressed.toString());
+
+  // Check the decompressor's internal state isn't broken.
+  decompressed.drain(decompressed.length());
+  Buffer::OwnedImpl empty_buffer;
+  decompressor.decompress(empty_buffer, decompressed);
+  EXPECT_EQ(0, decompressed.length());
+  EXPECT_EQ(0, stats_store_.counterFromString("test.brotli_error").value());
+}
+
+// The compressed content is fed one byte at a time, and the output overflows the chunk.
+TEST_F(BrotliDecompressorImplTest, DecompressByteByByte) {
+  Buffer::OwnedImpl compressed;
+  const std::string text = compressRandomText(compressed, 20000, nullptr);
+
+  BrotliDecompressorImpl decompressor{stats_store_, "test.", 4096, true, nullptr};
+  Buffer::OwnedImpl decompressed;
+  const std::string compressed_str = compressed.toString();
+  for (const char c : compressed_str) {
+    Buffer::OwnedImpl byte(&c, 1);
+    decompressor.decompress(byte, decompressed);
+  }
+  EXPECT_EQ(text, decompressed.toString());
+  EXPECT_EQ(0, stats_store_.counterFromString("test.brotli_error").value());
+}
+
+TEST_F(BrotliDecompressorImplTest, FailedDecompression) {
+  // The stream header announces a large window, which the decoder doesn't accept.
+  Buffer::OwnedImpl garbage(std::string("\x11\x00\x00\x00\x00\x00\x00\x00", 8));
+
+  BrotliDecompressorImpl decompressor{stats_store_, "test.", 4096, false, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(garbage, decompressed);
+  EXPECT_EQ(1, stats_store_.counterFromString("test.brotli_error").value());
+}
+
+TEST_F(BrotliDecompressorImplTest, FactoryWithDictionary) {
+  const std::string dictionary = "shared dictionary content";
+  Buffer::OwnedImpl compressed;
+  const std::string text = compressRandomText(
+      compressed, 1000, std::make_shared<const Compressor::BrotliEncoderDictionary>(dictionary, 3));
+
+  envoy::extensions::compression::brotli::decompressor::v3::Brotli brotli;
+  TestUtility::loadFromYaml(fmt::format(R"EOF(
+chunk_size: 8192
+dictionary:
+  inline_string: '{}'
+)EOF",
+                                        dictionary),
+                            brotli);
+  Api::ApiPtr api = Api::createApiForTest();
+  BrotliDecompressorFactory factory{brotli, stats_store_, *api};
+  EXPECT_EQ("brotli.", factory.statsPrefix());
+  EXPECT_EQ("br", factory.contentEncoding());
+
+  Buffer::OwnedImpl decompressed;
+  factory.createDecompressor("test.")->decompress(compressed, decompressed);
+  EXPECT_EQ(text, decompressed.toString());
+  EXPECT_EQ(0, stats_store_.counterFromString("test.brotli_error").value());
+}
+
+} // namespace
+} // namespace Decompressor
+} // namespace Brotli
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,117 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/zstd/compressor/config.h"
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
+#include "extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+namespace {
+
+const std::string Dictionary = R"EOF({"name": "", "namespace": "default", "labels": {}})EOF";
+
+class ZstdCompressorImplTest : public testing::Test {
+protected:
+  ZstdCompressorImplTest() : api_(Api::createApiForTest()) {}
+
+  Envoy::Compression::Compressor::CompressorFactoryPtr createFactory(const std::string& yaml) {
+    envoy::extensions::compression::zstd::compressor::v3::Zstd zstd;
+    TestUtility::loadFromYaml(yaml, zstd);
+    return std::make_unique<ZstdCompressorFactory>(zstd, *api_);
+  }
+
+  // Decompresses the buffer and checks it holds the original text.
+  void expectDecompressesTo(const Buffer::Instance& compressed, const std::string& original_text,
+                            Decompressor::ZstdDDictSharedPtr ddict = nullptr) {
+    Stats::IsolatedStoreImpl stats_store;
+    Decompressor::ZstdDecompressorImpl decompressor{stats_store, "test.", 27, 4096,
+                                                    std::move(ddict)};
+    Buffer::OwnedImpl decompressed;
+    decompressor.decompress(compressed, decompressed);
+    EXPECT_EQ(0, stats_store.counterFromString("test.zstd_generic_error").value());
+    EXPECT_EQ(original_text, decompressed.toString());
+  }
+
+  Api::ApiPtr api_;
+};
+
+TEST_F(ZstdCompressorImplTest, FactoryDefaults) {
+  auto factory = createFactory("{}");
+  EXPECT_EQ("zstd.", factory->statsPrefix());
+  EXPECT_EQ("zstd", factory->contentEncoding());
+}
+
+// Each flush makes all the content compressed so far decompressible.
+TEST_F(ZstdCompressorImplTest, CompressFlushAndFinish) {
+  auto compressor = createFactory("{}")->createCompressor();
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  std::string original_text;
+  for (uint64_t i = 1; i < 10; ++i) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, 1000 * i, i);
+    original_text.append(buffer.toString());
+    compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+    accumulation_buffer.move(buffer);
+    expectDecompressesTo(accumulation_buffer, original_text);
+  }
+
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_GT(buffer.length(), 0);
+  accumulation_buffer.move(buffer);
+  expectDecompressesTo(accumulation_buffer, original_text);
+}
+
+TEST_F(ZstdCompressorImplTest, CompressMultipleSlicesWithUncommonParams) {
+  auto compressor = createFactory(R"EOF(
+compression_level: 19
+strategy: BTULTRA2
+window_log: 10
+enable_checksum: true
+chunk_size: 4096
+)EOF")
+                        ->createCompressor();
+  Buffer::OwnedImpl buffer;
+  std::string original_text;
+  for (uint64_t i = 0; i < 20; ++i) {
+    Buffer::OwnedImpl slice;
+    TestUtility::feedBufferWithRandomCharacters(slice, 7000, i);
+    original_text.append(slice.toString());
+    buffer.move(slice);
+  }
+  ASSERT_GT(buffer.getRawSlices().size(), 1);
+
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  expectDecompressesTo(buffer, original_text);
+}
+
+TEST_F(ZstdCompressorImplTest, CompressWithDictionary) {
+  const std::string text = R"EOF({"name": "backend", "namespace": "default", "labels": {}})EOF";
+  Buffer::OwnedImpl plain(text);
+  createFactory("{}")->createCompressor()->compress(
+      plain, Envoy::Compression::Compressor::State::Finish);
+
+  auto factory = createFactory(fmt::format(R"EOF(
+dictionary:
+  inline_string: '{}'
+)EOF",
+                                           Dictionary));
+  Buffer::OwnedImpl primed(text);
+  factory->createCompressor()->compress(primed, Envoy::Compression::Compressor::State::Finish);
+  EXPECT_LT(primed.length(), plain.length());
+  expectDecompressesTo(primed, text, Decompressor::createDDict(Dictionary));
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,139 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
+#include "extensions/compression/zstd/decompressor/config.h"
+#include "extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Decompressor {
+namespace {
+
+using Compressor::ZstdCompressorImpl;
+
+class ZstdDecompressorImplTest : public testing::Test {
+protected:
+  // Compresses random text of the given size into the buffer, and returns the text.
+  static std::string compressRandomText(Buffer::Instance& buffer, uint64_t size,
+                                        uint32_t window_log, bool enable_checksum,
+                                        Compressor::ZstdCDictSharedPtr cdict) {
+    ZstdCompressorImpl compressor{3, 0, window_log, enable_checksum, 4096, std::move(cdict)};
+    TestUtility::feedBufferWithRandomCharacters(buffer, size);
+    const std::string text = buffer.toString();
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    return text;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counterFromString("test." + name).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+};
+
+TEST_F(ZstdDecompressorImplTest, CompressAndDecompress) {
+  Buffer::OwnedImpl compressed;
+  const std::string text = compressRandomText(compressed, 100000, 0, true, nullptr);
+
+  ZstdDecompressorImpl decompressor{stats_store_, "test.", 27, 4096, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(compressed, decompressed);
+  EXPECT_EQ(text, decompressed.toString());
+
+  // Check the decompressor's internal state isn't broken.
+  decompressed.drain(decompressed.length());
+  Buffer::OwnedImpl empty_buffer;
+  decompressor.decompress(empty_buffer, decompressed);
+  EXPECT_EQ(0, decompressed.length());
+  EXPECT_EQ(0, counter("zstd_generic_error"));
+}
+
+// The compressed content is fed one byte at a time, and the output overflows the chunk.
+TEST_F(ZstdDecompressorImplTest, DecompressByteByByte) {
+  Buffer::OwnedImpl compressed;
+  const std::string text = compressRandomText(compressed, 20000, 0, false, nullptr);
+
+  ZstdDecompressorImpl decompressor{stats_store_, "test.", 27, 4096, nullptr};
+  Buffer::OwnedImpl decompressed;
+  const std::string compressed_str = compressed.toString();
+  for (const char c : compressed_str) {
+    Buffer::OwnedImpl byte(&c, 1);
+    decompressor.decompress(byte, decompressed);
+  }
+  EXPECT_EQ(text, decompressed.toString());
+  EXPECT_EQ(0, counter("zstd_generic_error"));
+}
+
+TEST_F(ZstdDecompressorImplTest, FailedDecompression) {
+  Buffer::OwnedImpl garbage;
+  TestUtility::feedBufferWithRandomCharacters(garbage, 1000);
+
+  ZstdDecompressorImpl decompressor{stats_store_, "test.", 27, 4096, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(garbage, decompressed);
+  EXPECT_EQ(1, counter("zstd_generic_error"));
+}
+
+TEST_F(ZstdDecompressorImplTest, WindowTooLarge) {
+  Buffer::OwnedImpl compressed;
+  compressRandomText(compressed, 100000, 20, false, nullptr);
+
+  ZstdDecompressorImpl decompressor{stats_store_, "test.", 16, 4096, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(compressed, decompressed);
+  EXPECT_EQ(1, counter("zstd_generic_error"));
+}
+
+TEST_F(ZstdDecompressorImplTest, ChecksumMismatch) {
+  Buffer::OwnedImpl compressed;
+  compressRandomText(compressed, 1000, 0, true, nullptr);
+  // Corrupt the checksum, which is the last 4 bytes of the frame.
+  std::string corrupted = compressed.toString();
+  corrupted.back() ^= 0xff;
+  Buffer::OwnedImpl corrupted_buffer(corrupted);
+
+  ZstdDecompressorImpl decompressor{stats_store_, "test.", 27, 4096, nullptr};
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(corrupted_buffer, decompressed);
+  EXPECT_EQ(1, counter("zstd_checksum_wrong_error"));
+}
+
+TEST_F(ZstdDecompressorImplTest, FactoryWithDictionary) {
+  const std::string dictionary = "shared dictionary content";
+  Buffer::OwnedImpl compressed;
+  const std::string text =
+      compressRandomText(compressed, 1000, 0, false, Compressor::createCDict(dictionary, 3));
+
+  envoy::extensions::compression::zstd::decompressor::v3::Zstd zstd;
+  TestUtility::loadFromYaml(fmt::format(R"EOF(
+window_log_max: 20
+chunk_size: 8192
+dictionary:
+  inline_string: '{}'
+)EOF",
+                                        dictionary),
+                            zstd);
+  Api::ApiPtr api = Api::createApiForTest();
+  ZstdDecompressorFactory factory{zstd, stats_store_, *api};
+  EXPECT_EQ("zstd.", factory.statsPrefix());
+  EXPECT_EQ("zstd", factory.contentEncoding());
+
+  Buffer::OwnedImpl decompressed;
+  factory.createDecompressor("test.")->decompress(compressed, decompressed);
+  EXPECT_EQ(text, decompressed.toString());
+  EXPECT_EQ(0, counter("zstd_generic_error"));
+}
+
+} // namespace
+} // namespace Decompressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
@@ -1,6 +1,8 @@
 #include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
 
+#include "extensions/compression/brotli/compressor/brotli_compressor_impl.h"
 #include "extensions/compression/gzip/compressor/zlib_compressor_impl.h"
+#include "extensions/compression/zstd/compressor/zstd_compressor_impl.h"
 #include "extensions/filters/http/common/compressor/compressor.h"
 
 #include "test/mocks/http/mocks.h"
@@ -18,30 +20,23 @@ namespace HttpFilters {
 namespace Common {
 namespace Compressors {
 
+using CompressorFactoryCb = std::function<Envoy::Compression::Compressor::CompressorPtr()>;
+
 class MockCompressorFilterConfig : public CompressorFilterConfig {
 public:
   MockCompressorFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::Compressor& compressor,
       const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-      const std::string& compressor_name,
-      Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel level,
-      Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy strategy,
-      int64_t window_bits, uint64_t memory_level)
+      const std::string& compressor_name, CompressorFactoryCb compressor_factory)
       : CompressorFilterConfig(compressor, stats_prefix + compressor_name + ".", scope, runtime,
                                compressor_name),
-        level_(level), strategy_(strategy), window_bits_(window_bits), memory_level_(memory_level) {
-  }
+        compressor_factory_(std::move(compressor_factory)) {}
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor() override {
-    auto compressor = std::make_unique<Compression::Gzip::Compressor::ZlibCompressorImpl>();
-    compressor->init(level_, strategy_, window_bits_, memory_level_);
-    return compressor;
+    return compressor_factory_();
   }
 
-  const Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel level_;
-  const Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy strategy_;
-  const int64_t window_bits_;
-  const uint64_t memory_level_;
+  const CompressorFactoryCb compressor_factory_;
 };
 
 using CompressionParams =
@@ -49,6 +44,31 @@ using CompressionParams =
                Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy, int64_t,
                uint64_t>;
 
+CompressorFactoryCb gzipCompressor(CompressionParams params) {
+  return [params]() {
+    auto compressor = std::make_unique<Compression::Gzip::Compressor::ZlibCompressorImpl>();
+    compressor->init(std::get<0>(params), std::get<1>(params), std::get<2>(params),
+                     std::get<3>(params));
+    return compressor;
+  };
+}
+
+CompressorFactoryCb brotliCompressor(uint32_t quality, uint32_t window_bits) {
+  return [quality, window_bits]() {
+    return std::make_unique<Compression::Brotli::Compressor::BrotliCompressorImpl>(
+        quality, window_bits, 24,
+        Compression::Brotli::Compressor::BrotliCompressorImpl::EncoderMode::Default, 4096,
+        nullptr);
+  };
+}
+
+CompressorFactoryCb zstdCompressor(uint32_t compression_level) {
+  return [compression_level]() {
+    return std::make_unique<Compression::Zstd::Compressor::ZstdCompressorImpl>(
+        compression_level, 0, 0, false, 4096, nullptr);
+  };
+}
+
 static constexpr uint64_t TestDataSize = 122880;
 
 Buffer::OwnedImpl generateTestData() {
@@ -61,12 +81,30 @@ const Buffer::OwnedImpl& testData() {
   CONSTRUCT_ON_FIRST_USE(Buffer::OwnedImpl, generateTestData());
 }
 
-static std::vector<Buffer::OwnedImpl> generateChunks(const uint64_t chunk_count,
-                                                     const uint64_t chunk_size) {
+// JSON records with recurring keys, which compress like typical API responses do, unlike random
+// characters.
+Buffer::OwnedImpl generateJsonTestData() {
+  Buffer::OwnedImpl data;
+  for (uint64_t i = 0; data.length() < TestDataSize; ++i) {
+    data.add(fmt::format(R"EOF({{"id": {}, "name": "user-{}", "email": "user-{}@example.com", )EOF"
+                         R"EOF("active": {}, "score": {}, "tags": ["tag-{}", "tag-{}"]}},)EOF",
+                         i, i * 7919 % 10007, i * 104729 % 1299709, i % 3 == 0 ? "true" : "false",
+                         i * 31337 % 1000, i % 17, i % 23));
+  }
+  data.drain(data.length() - TestDataSize);
+  return data;
+}
+
+const Buffer::OwnedImpl& jsonTestData() {
+  CONSTRUCT_ON_FIRST_USE(Buffer::OwnedImpl, generateJsonTestData());
+}
+
+static std::vector<Buffer::OwnedImpl>
+generateChunks(const uint64_t chunk_count, const uint64_t chunk_size,
+               const Buffer::OwnedImpl& test_data = testData()) {
   std::vector<Buffer::OwnedImpl> vec;
   vec.reserve(chunk_count);
 
-  const auto& test_data = testData();
   uint64_t added = 0;
 
   for (uint64_t i = 0; i < chunk_count; ++i) {
@@ -88,7 +126,9 @@ struct Result {
   uint64_t total_compressed_bytes = 0;
 };
 
-static Result compressWith(std::vector<Buffer::OwnedImpl>&& chunks, CompressionParams params,
+static Result compressWith(std::vector<Buffer::OwnedImpl>&& chunks,
+                           const std::string& compressor_name,
+                           CompressorFactoryCb compressor_factory,
                            NiceMock<Http::MockStreamDecoderFilterCallbacks>& decoder_callbacks,
                            benchmark::State& state) {
   auto start = std::chrono::high_resolution_clock::now();
@@ -96,12 +136,8 @@ static Result compressWith(std::vector<Buffer::OwnedImpl>&& chunks, CompressionP
   testing::NiceMock<Runtime::MockLoader> runtime;
   envoy::extensions::filters::http::compressor::v3::Compressor compressor;
 
-  const auto level = std::get<0>(params);
-  const auto strategy = std::get<1>(params);
-  const auto window_bits = std::get<2>(params);
-  const auto memory_level = std::get<3>(params);
   CompressorFilterConfigSharedPtr config = std::make_shared<MockCompressorFilterConfig>(
-      compressor, "test.", stats, runtime, "gzip", level, strategy, window_bits, memory_level);
+      compressor, "test.", stats, runtime, compressor_name, std::move(compressor_factory));
 
   ON_CALL(runtime.snapshot_, featureEnabled("test.filter_enabled", 100))
       .WillByDefault(Return(true));
@@ -109,7 +145,8 @@ static Result compressWith(std::vector<Buffer::OwnedImpl>&& chunks, CompressionP
   auto filter = std::make_unique<CompressorFilter>(config);
   filter->setDecoderFilterCallbacks(decoder_callbacks);
 
-  Http::TestRequestHeaderMapImpl headers = {{":method", "get"}, {"accept-encoding", "gzip"}};
+  Http::TestRequestHeaderMapImpl headers = {{":method", "get"},
+                                            {"accept-encoding", compressor_name}};
   filter->decodeHeaders(headers, false);
 
   Http::TestResponseHeaderMapImpl response_headers = {
@@ -133,12 +170,13 @@ static Result compressWith(std::vector<Buffer::OwnedImpl>&& chunks, CompressionP
     ++idx;
   }
 
+  const std::string stats_prefix = "test." + compressor_name + ".";
   EXPECT_EQ(res.total_uncompressed_bytes,
-            stats.counterFromString("test.gzip.total_uncompressed_bytes").value());
+            stats.counterFromString(stats_prefix + "total_uncompressed_bytes").value());
   EXPECT_EQ(res.total_compressed_bytes,
-            stats.counterFromString("test.gzip.total_compressed_bytes").value());
+            stats.counterFromString(stats_prefix + "total_compressed_bytes").value());
 
-  EXPECT_EQ(1U, stats.counterFromString("test.gzip.compressed").value());
+  EXPECT_EQ(1U, stats.counterFromString(stats_prefix + "compressed").value());
   auto end = std::chrono::high_resolution_clock::now();
   const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
   state.SetIterationTime(elapsed.count());
@@ -233,7 +271,7 @@ static void compressFull(benchmark::State& state) {
 
   for (auto _ : state) {
     std::vector<Buffer::OwnedImpl> chunks = generateChunks(1, 122880);
-    compressWith(std::move(chunks), params, decoder_callbacks, state);
+    compressWith(std::move(chunks), "gzip", gzipCompressor(params), decoder_callbacks, state);
   }
 }
 BENCHMARK(compressFull)->DenseRange(0, 8, 1)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -245,7 +283,7 @@ static void compressChunks16384(benchmark::State& state) {
 
   for (auto _ : state) {
     std::vector<Buffer::OwnedImpl> chunks = generateChunks(7, 16384);
-    compressWith(std::move(chunks), params, decoder_callbacks, state);
+    compressWith(std::move(chunks), "gzip", gzipCompressor(params), decoder_callbacks, state);
   }
 }
 BENCHMARK(compressChunks16384)->DenseRange(0, 8, 1)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -257,7 +295,7 @@ static void compressChunks8192(benchmark::State& state) {
 
   for (auto _ : state) {
     std::vector<Buffer::OwnedImpl> chunks = generateChunks(15, 8192);
-    compressWith(std::move(chunks), params, decoder_callbacks, state);
+    compressWith(std::move(chunks), "gzip", gzipCompressor(params), decoder_callbacks, state);
   }
 }
 BENCHMARK(compressChunks8192)->DenseRange(0, 8, 1)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -269,7 +307,7 @@ static void compressChunks4096(benchmark::State& state) {
 
   for (auto _ : state) {
     std::vector<Buffer::OwnedImpl> chunks = generateChunks(30, 4096);
-    compressWith(std::move(chunks), params, decoder_callbacks, state);
+    compressWith(std::move(chunks), "gzip", gzipCompressor(params), decoder_callbacks, state);
   }
 }
 BENCHMARK(compressChunks4096)->DenseRange(0, 8, 1)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -281,11 +319,55 @@ static void compressChunks1024(benchmark::State& state) {
 
   for (auto _ : state) {
     std::vector<Buffer::OwnedImpl> chunks = generateChunks(120, 1024);
-    compressWith(std::move(chunks), params, decoder_callbacks, state);
+    compressWith(std::move(chunks), "gzip", gzipCompressor(params), decoder_callbacks, state);
   }
 }
 BENCHMARK(compressChunks1024)->DenseRange(0, 8, 1)->UseManualTime()->Unit(benchmark::kMillisecond);
 
+// Compares the compression libraries on JSON content. Besides the time, the "ratio" counter reports
+// how many times smaller than the content the compressed output is.
+static std::vector<std::tuple<std::string, CompressorFactoryCb>> library_params = {
+    // gzip: Speed + Standard + Big window + High mem level
+    {"gzip",
+     gzipCompressor(
+         {Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Speed,
+          Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard, 15,
+          9})},
+
+    // gzip: Standard (level 6) + Standard + Big window + High mem level
+    {"gzip",
+     gzipCompressor(
+         {Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+          Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard, 15,
+          9})},
+
+    // brotli: quality 1, 4 and 9 with the default window
+    {"br", brotliCompressor(1, 18)},
+    {"br", brotliCompressor(4, 18)},
+    {"br", brotliCompressor(9, 18)},
+
+    // zstd: levels 1, 3 and 9
+    {"zstd", zstdCompressor(1)},
+    {"zstd", zstdCompressor(3)},
+    {"zstd", zstdCompressor(9)}};
+
+static void compressLibraries(benchmark::State& state) {
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  const auto idx = state.range(0);
+  const auto& params = library_params[idx];
+
+  Result res;
+  for (auto _ : state) {
+    std::vector<Buffer::OwnedImpl> chunks = generateChunks(30, 4096, jsonTestData());
+    res = compressWith(std::move(chunks), std::get<0>(params), std::get<1>(params),
+                       decoder_callbacks, state);
+  }
+  state.SetLabel(std::get<0>(params));
+  state.counters["ratio"] =
+      static_cast<double>(res.total_uncompressed_bytes) / res.total_compressed_bytes;
+}
+BENCHMARK(compressLibraries)->DenseRange(0, 7, 1)->UseManualTime()->Unit(benchmark::kMillisecond);
+
 } // namespace Compressors
 } // namespace Common
 } // namespace HttpFilters
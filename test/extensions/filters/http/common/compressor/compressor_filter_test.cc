@@ -284,6 +284,107 @@ TEST_F(CompressorFilterTest, RemoveAcceptEncodingHeader) {
   }
 }
 
+class ResponseCacheTest : public CompressorFilterTest {
+public:
+  void SetUp() override {
+    setUpFilter(R"EOF(
+{
+  "response_cache": {
+    "max_bytes": 1024,
+    "max_entry_bytes": 8
+  },
+  "compressor_library": {
+     "name": "test",
+     "typed_config": {
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }
+  }
+}
+)EOF");
+  }
+
+  // Sends a compressible response through a new filter and returns the body it forwarded. The mock
+  // compressor leaves the body as is.
+  std::string doCacheableResponse(Http::TestResponseHeaderMapImpl&& headers,
+                                  const std::string& body) {
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+    doRequest({{":method", "get"},
+               {":authority", "example.com"},
+               {":path", "/app.js"},
+               {"accept-encoding", "test"}});
+    headers.addCopy("content-length", "256");
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ("test", headers.get_("content-encoding"));
+    Buffer::OwnedImpl data(body);
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+    return data.toString();
+  }
+};
+
+// A response with the same strong etag is served from the cache, without compressing it.
+TEST_F(ResponseCacheTest, Hit) {
+  EXPECT_EQ("body1", doCacheableResponse({{":status", "200"}, {"etag", "\"v1\""}}, "body1"));
+  EXPECT_EQ(1, stats_.counter("test.test.response_cache_miss").value());
+  EXPECT_EQ(1, stats_.counter("test.test.response_cache_insert").value());
+  EXPECT_EQ(5, config_->responseCache()->bytes());
+
+  EXPECT_EQ("body1", doCacheableResponse({{":status", "200"}, {"etag", "\"v1\""}}, "other"));
+  EXPECT_EQ(1, stats_.counter("test.test.response_cache_hit").value());
+  EXPECT_EQ(2, stats_.counter("test.test.compressed").value());
+  EXPECT_EQ(10, stats_.counter("test.test.total_compressed_bytes").value());
+
+  EXPECT_EQ("body2", doCacheableResponse({{":status", "200"}, {"etag", "\"v2\""}}, "body2"));
+  EXPECT_EQ(2, stats_.counter("test.test.response_cache_miss").value());
+}
+
+// The cached body is sent with the trailers if the upstream sent no body.
+TEST_F(ResponseCacheTest, HitWithTrailers) {
+  EXPECT_EQ("body1", doCacheableResponse({{":status", "200"}, {"etag", "\"v1\""}}, "body1"));
+
+  filter_ = std::make_unique<CompressorFilter>(config_);
+  filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+  filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  doRequest({{":method", "get"},
+             {":authority", "example.com"},
+             {":path", "/app.js"},
+             {"accept-encoding", "test"}});
+  Http::TestResponseHeaderMapImpl headers{
+      {":status", "200"}, {"etag", "\"v1\""}, {"content-length", "256"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_FALSE(headers.has("etag"));
+  std::string body;
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) { body = data.toString(); }));
+  Http::TestResponseTrailerMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+  EXPECT_EQ("body1", body);
+  EXPECT_EQ(1, stats_.counter("test.test.response_cache_hit").value());
+}
+
+// Responses which aren't identified by a strong etag or may not be stored are never cached.
+TEST_F(ResponseCacheTest, NotCacheable) {
+  EXPECT_EQ("body1", doCacheableResponse({{":status", "200"}}, "body1"));
+  EXPECT_EQ("body1", doCacheableResponse({{":status", "200"}, {"etag", "W/\"v1\""}}, "body1"));
+  EXPECT_EQ("body1", doCacheableResponse({{":status", "206"}, {"etag", "\"v1\""}}, "body1"));
+  EXPECT_EQ("body1", doCacheableResponse(
+                         {{":status", "200"}, {"etag", "\"v1\""}, {"cache-control", "no-store"}},
+                         "body1"));
+  EXPECT_EQ(0, stats_.counter("test.test.response_cache_miss").value());
+  EXPECT_EQ(0, config_->responseCache()->bytes());
+}
+
+// Bodies larger than max_entry_bytes are compressed, but not cached.
+TEST_F(ResponseCacheTest, EntryTooLarge) {
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ("too large",
+              doCacheableResponse({{":status", "200"}, {"etag", "\"v1\""}}, "too large"));
+  }
+  EXPECT_EQ(2, stats_.counter("test.test.response_cache_miss").value());
+  EXPECT_EQ(0, stats_.counter("test.test.response_cache_insert").value());
+}
+
 class IsAcceptEncodingAllowedTest
     : public CompressorFilterTest,
       public testing::WithParamInterface<std::tuple<std::string, bool, int, int, int, int>> {};
@@ -0,0 +1,78 @@
+#include <memory>
+#include <string>
+
+#include "extensions/filters/http/common/compressor/response_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Common {
+namespace Compressors {
+namespace {
+
+CompressedBodySharedPtr body(const std::string& data) {
+  return std::make_shared<const std::string>(data);
+}
+
+TEST(CompressedResponseCacheTest, LookupAndInsert) {
+  CompressedResponseCache cache(100, 10);
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0, cache.insert("a", body("aaaa")));
+  ASSERT_NE(nullptr, cache.lookup("a"));
+  EXPECT_EQ("aaaa", *cache.lookup("a"));
+  EXPECT_EQ(4, cache.bytes());
+
+  // Replacing a body doesn't count as an eviction.
+  EXPECT_EQ(0, cache.insert("a", body("aa")));
+  EXPECT_EQ("aa", *cache.lookup("a"));
+  EXPECT_EQ(2, cache.bytes());
+}
+
+TEST(CompressedResponseCacheTest, EntryTooLarge) {
+  CompressedResponseCache cache(100, 10);
+  EXPECT_EQ(10, cache.maxEntryBytes());
+  EXPECT_EQ(0, cache.insert("a", body(std::string(11, 'a'))));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0, cache.bytes());
+
+  // Entries are never larger than the cache.
+  EXPECT_EQ(5, CompressedResponseCache(5, 10).maxEntryBytes());
+}
+
+// The least recently used bodies are evicted first.
+TEST(CompressedResponseCacheTest, EvictLeastRecentlyUsed) {
+  CompressedResponseCache cache(10, 10);
+  cache.insert("a", body("aaaa"));
+  cache.insert("b", body("bbbb"));
+  EXPECT_NE(nullptr, cache.lookup("a"));
+
+  EXPECT_EQ(1, cache.insert("c", body("cccc")));
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_NE(nullptr, cache.lookup("c"));
+  EXPECT_EQ(8, cache.bytes());
+
+  EXPECT_EQ(2, cache.insert("d", body("dddddddddd")));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(nullptr, cache.lookup("c"));
+  EXPECT_EQ(10, cache.bytes());
+}
+
+// Bodies handed out stay valid after they are evicted.
+TEST(CompressedResponseCacheTest, BodyOutlivesEviction) {
+  CompressedResponseCache cache(4, 4);
+  cache.insert("a", body("aaaa"));
+  CompressedBodySharedPtr cached = cache.lookup("a");
+  cache.insert("b", body("bbbb"));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ("aaaa", *cached);
+}
+
+} // namespace
+} // namespace Compressors
+} // namespace Common
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -12,6 +12,7 @@
 #include "common/http/date_provider_impl.h"
 #include "common/http/request_id_extension_uuid_impl.h"
 #include "common/network/address_impl.h"
+#include "common/tracing/tail_sampling_impl.h"
 
 #include "extensions/filters/network/http_connection_manager/config.h"
 
@@ -412,6 +413,42 @@ http_filters:
   EXPECT_THAT(config.tracer(), Eq(http_tracer_));
 }
 
+TEST_F(HttpConnectionManagerConfigTest, TracingTailSamplingConfig) {
+  const std::string yaml_string = R"EOF(
+codec_type: http1
+server_name: foo
+stat_prefix: router
+route_config:
+  virtual_hosts:
+  - name: service
+    domains:
+    - "*"
+    routes:
+    - match:
+        prefix: "/"
+      route:
+        cluster: cluster
+tracing:
+  random_sampling:
+    value: 1
+  tail_sampling:
+    min_duration: 1s
+    sample_errors: true
+http_filters:
+- name: envoy.filters.http.router
+  )EOF";
+
+  EXPECT_CALL(http_tracer_manager_, getOrCreateHttpTracer(nullptr)).WillOnce(Return(http_tracer_));
+
+  HttpConnectionManagerConfig config(parseHttpConnectionManagerFromYaml(yaml_string), context_,
+                                     date_provider_, route_config_provider_manager_,
+                                     scoped_routes_config_provider_manager_, http_tracer_manager_,
+                                     filter_config_provider_manager_);
+
+  // The HttpTracer obtained from the HttpTracerManager is wrapped to sample on completion.
+  EXPECT_NE(nullptr, dynamic_cast<Tracing::TailSamplingHttpTracer*>(config.tracer().get()));
+}
+
 TEST_F(HttpConnectionManagerConfigTest, TracingCustomTagsConfig) {
   const std::string yaml_string = R"EOF(
 stat_prefix: router
@@ -0,0 +1,213 @@
+#include <string>
+
+#include "envoy/extensions/transport_sockets/tls/v3/common.pb.h"
+#include "envoy/registry/registry.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+
+#include "common/protobuf/message_validator_impl.h"
+#include "common/singleton/manager_impl.h"
+
+#include "extensions/private_key_providers/thread_pool/thread_pool_provider.h"
+
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+class MockPrivateKeyConnectionCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  MOCK_METHOD(void, onPrivateKeyMethodComplete, ());
+};
+
+class ThreadPoolPrivateKeyProviderTest : public testing::Test {
+public:
+  ThreadPoolPrivateKeyProviderTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        ssl_ctx_(SSL_CTX_new(TLS_method())), ssl_(SSL_new(ssl_ctx_.get())) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, singletonManager()).WillByDefault(ReturnRef(singleton_manager_));
+    ON_CALL(factory_context_, messageValidationVisitor())
+        .WillByDefault(ReturnRef(ProtobufMessage::getStrictValidationVisitor()));
+  }
+
+  void createProvider(const std::string& key_file) {
+    const std::string yaml = fmt::format(R"EOF(
+provider_name: envoy.tls.key_providers.thread_pool
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3alpha.ThreadPoolPrivateKeyMethodConfig
+  private_key:
+    filename: "{}"
+  num_threads: 2
+)EOF",
+                                         keyPath(key_file));
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider config;
+    TestUtility::loadFromYaml(yaml, config);
+    auto* factory =
+        Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+            config.provider_name());
+    ASSERT_NE(nullptr, factory);
+    provider_ = factory->createPrivateKeyMethodProviderInstance(config, factory_context_);
+  }
+
+  static std::string keyPath(const std::string& key_file) {
+    return TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + key_file);
+  }
+
+  bool verify(const std::string& key_file, uint16_t signature_algorithm, const std::string& input,
+              const uint8_t* signature, size_t signature_len) {
+    const std::string key = api_->fileSystem().fileReadToEnd(keyPath(key_file));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(key.data(), key.size()));
+    bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pkey_ctx;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pkey_ctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              pkey.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), signature, signature_len,
+                            reinterpret_cast<const uint8_t*>(input.data()), input.size());
+  }
+
+  // Signs the input and runs the dispatcher until the operation completes.
+  ssl_private_key_result_t sign(uint16_t signature_algorithm, const std::string& input) {
+    auto method = provider_->getBoringSslPrivateKeyMethod();
+    EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete()).WillOnce(Invoke([this]() {
+      dispatcher_->exit();
+    }));
+    EXPECT_EQ(ssl_private_key_retry,
+              method->sign(ssl_.get(), out_, &out_len_, sizeof(out_), signature_algorithm,
+                           reinterpret_cast<const uint8_t*>(input.data()), input.size()));
+    // The operation is still in flight until the completion reaches the dispatcher.
+    EXPECT_EQ(ssl_private_key_retry, method->complete(ssl_.get(), out_, &out_len_, sizeof(out_)));
+    dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+    return method->complete(ssl_.get(), out_, &out_len_, sizeof(out_));
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  Singleton::ManagerImpl singleton_manager_{api_->threadFactory()};
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  MockPrivateKeyConnectionCallbacks callbacks_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  bssl::UniquePtr<SSL> ssl_;
+  Ssl::PrivateKeyMethodProviderSharedPtr provider_;
+  uint8_t out_[1024];
+  size_t out_len_{};
+};
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, SignRsa) {
+  createProvider("selfsigned_key.pem");
+  EXPECT_TRUE(provider_->checkFips());
+  provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+
+  for (uint16_t signature_algorithm : {SSL_SIGN_RSA_PKCS1_SHA256, SSL_SIGN_RSA_PSS_RSAE_SHA256}) {
+    ASSERT_EQ(ssl_private_key_success, sign(signature_algorithm, "data to sign"));
+    EXPECT_TRUE(
+        verify("selfsigned_key.pem", signature_algorithm, "data to sign", out_, out_len_));
+  }
+
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, SignEcdsa) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+
+  ASSERT_EQ(ssl_private_key_success, sign(SSL_SIGN_ECDSA_SECP256R1_SHA256, "data to sign"));
+  EXPECT_TRUE(verify("selfsigned_ecdsa_p256_key.pem", SSL_SIGN_ECDSA_SECP256R1_SHA256,
+                     "data to sign", out_, out_len_));
+
+  // The key doesn't match the signature algorithm.
+  EXPECT_EQ(ssl_private_key_failure, sign(SSL_SIGN_RSA_PKCS1_SHA256, "data to sign"));
+
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+// The RSA and ECDSA providers share a thread pool, and each operation uses its own key.
+TEST_F(ThreadPoolPrivateKeyProviderTest, RsaAndEcdsaOnSameConnection) {
+  createProvider("selfsigned_key.pem");
+  Ssl::PrivateKeyMethodProviderSharedPtr rsa_provider = provider_;
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  rsa_provider->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+  provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+  EXPECT_THROW_WITH_MESSAGE(
+      provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_), EnvoyException,
+      "Can't distinguish between two registered providers for the same SSL object.");
+
+  ASSERT_EQ(ssl_private_key_success, sign(SSL_SIGN_ECDSA_SECP256R1_SHA256, "data to sign"));
+  EXPECT_TRUE(verify("selfsigned_ecdsa_p256_key.pem", SSL_SIGN_ECDSA_SECP256R1_SHA256,
+                     "data to sign", out_, out_len_));
+  std::swap(provider_, rsa_provider);
+  ASSERT_EQ(ssl_private_key_success, sign(SSL_SIGN_RSA_PKCS1_SHA256, "data to sign"));
+  EXPECT_TRUE(
+      verify("selfsigned_key.pem", SSL_SIGN_RSA_PKCS1_SHA256, "data to sign", out_, out_len_));
+
+  rsa_provider->unregisterPrivateKeyMethod(ssl_.get());
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+// The providers with the same settings share a thread pool, which goes away with them.
+TEST_F(ThreadPoolPrivateKeyProviderTest, SharedThreadPool) {
+  PrivateKeyThreadPoolManager manager(api_->threadFactory());
+  PrivateKeyThreadPoolSharedPtr pool = manager.get(2, 16);
+  EXPECT_EQ(pool, manager.get(2, 16));
+  EXPECT_NE(pool, manager.get(2, 8));
+  EXPECT_NE(pool, manager.get(1, 16));
+
+  std::weak_ptr<PrivateKeyThreadPool> released_pool = pool;
+  pool.reset();
+  EXPECT_TRUE(released_pool.expired());
+  EXPECT_NE(nullptr, manager.get(2, 16));
+}
+
+// The completion of an operation doesn't reach a connection that went away.
+TEST_F(ThreadPoolPrivateKeyProviderTest, UnregisterWithOperationInFlight) {
+  createProvider("selfsigned_key.pem");
+  provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+
+  const std::string input = "data to sign";
+  EXPECT_EQ(ssl_private_key_retry, provider_->getBoringSslPrivateKeyMethod()->sign(
+                                       ssl_.get(), out_, &out_len_, sizeof(out_),
+                                       SSL_SIGN_RSA_PKCS1_SHA256,
+                                       reinterpret_cast<const uint8_t*>(input.data()),
+                                       input.size()));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+  // Wait for the thread pool to finish.
+  provider_.reset();
+
+  EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete()).Times(0);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, InvalidKey) {
+  EXPECT_THROW_WITH_MESSAGE(
+      createProvider("ticket_key_a"), EnvoyException,
+      "Failed to load private key for the thread pool private key provider");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,41 @@
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.h"
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "server/resource_monitor_config_impl.h"
+
+#include "extensions/resource_monitors/event_loop_latency/config.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLatencyMonitor {
+namespace {
+
+TEST(EventLoopLatencyMonitorFactoryTest, CreateMonitor) {
+  auto factory =
+      Registry::FactoryRegistry<Server::Configuration::ResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.event_loop_latency");
+  EXPECT_NE(factory, nullptr);
+
+  envoy::extensions::resource_monitors::event_loop_latency::v3alpha::EventLoopLatencyConfig config;
+  config.mutable_max_latency()->set_seconds(1);
+  Event::MockDispatcher dispatcher;
+  Api::ApiPtr api = Api::createApiForTest();
+  testing::NiceMock<ThreadLocal::MockInstance> tls;
+  Server::Configuration::ResourceMonitorFactoryContextImpl context(
+      dispatcher, *api, ProtobufMessage::getStrictValidationVisitor(), tls);
+  auto monitor = factory->createResourceMonitor(config, context);
+  EXPECT_NE(monitor, nullptr);
+}
+
+} // namespace
+} // namespace EventLoopLatencyMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
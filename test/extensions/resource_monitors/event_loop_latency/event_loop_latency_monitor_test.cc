@@ -0,0 +1,105 @@
+#include <chrono>
+
+#include "envoy/extensions/resource_monitors/event_loop_latency/v3alpha/event_loop_latency.pb.h"
+
+#include "server/resource_monitor_config_impl.h"
+
+#include "extensions/resource_monitors/event_loop_latency/event_loop_latency_monitor.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLatencyMonitor {
+namespace {
+
+class MockedCallbacks : public Server::ResourceMonitor::Callbacks {
+public:
+  MOCK_METHOD(void, onSuccess, (const Server::ResourceUsage&));
+  MOCK_METHOD(void, onFailure, (const EnvoyException&));
+};
+
+class EventLoopLatencyMonitorTest : public Event::TestUsingSimulatedTime, public testing::Test {
+public:
+  EventLoopLatencyMonitorTest() : api_(Api::createApiForTest()) {
+    envoy::extensions::resource_monitors::event_loop_latency::v3alpha::EventLoopLatencyConfig
+        config;
+    config.mutable_max_latency()->set_nanos(100 * 1000 * 1000);
+    Server::Configuration::ResourceMonitorFactoryContextImpl context(
+        dispatcher_, *api_, ProtobufMessage::getStrictValidationVisitor(), tls_);
+    monitor_ = std::make_unique<EventLoopLatencyMonitor>(config, context);
+  }
+
+  double updatePressure() {
+    double pressure = -1;
+    EXPECT_CALL(callbacks_, onSuccess(_)).WillOnce(Invoke([&](const Server::ResourceUsage& usage) {
+      pressure = usage.resource_pressure_;
+    }));
+    monitor_->updateResourceUsage(callbacks_);
+    return pressure;
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Api::ApiPtr api_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  MockedCallbacks callbacks_;
+  std::unique_ptr<EventLoopLatencyMonitor> monitor_;
+};
+
+// Probes which run right away report no pressure.
+TEST_F(EventLoopLatencyMonitorTest, NoLatency) {
+  EXPECT_CALL(tls_, runOnAllThreads(_, _)).Times(2);
+  EXPECT_EQ(0, updatePressure());
+  EXPECT_EQ(0, updatePressure());
+}
+
+TEST_F(EventLoopLatencyMonitorTest, SlowThread) {
+  Event::PostCb probe;
+  Event::PostCb complete;
+  EXPECT_CALL(tls_, runOnAllThreads(_, _))
+      .WillOnce(DoAll(SaveArg<0>(&probe), SaveArg<1>(&complete)));
+  EXPECT_EQ(0, updatePressure());
+
+  // The age of the probe counts while it is in flight, and no other probe is sent.
+  simTime().advanceTimeWait(std::chrono::milliseconds(50));
+  EXPECT_DOUBLE_EQ(0.5, updatePressure());
+
+  simTime().advanceTimeWait(std::chrono::milliseconds(25));
+  probe();
+  simTime().advanceTimeWait(std::chrono::milliseconds(25));
+  complete();
+
+  // The completed probe reports the latency of the thread rather than its own age.
+  EXPECT_CALL(tls_, runOnAllThreads(_, _)).Times(2);
+  EXPECT_DOUBLE_EQ(0.75, updatePressure());
+  EXPECT_DOUBLE_EQ(0, updatePressure());
+}
+
+// The completion of a probe may run after the monitor went away.
+TEST_F(EventLoopLatencyMonitorTest, CompleteAfterDestruction) {
+  Event::PostCb complete;
+  EXPECT_CALL(tls_, runOnAllThreads(_, _)).WillOnce(SaveArg<1>(&complete));
+  EXPECT_EQ(0, updatePressure());
+
+  monitor_.reset();
+  complete();
+}
+
+} // namespace
+} // namespace EventLoopLatencyMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
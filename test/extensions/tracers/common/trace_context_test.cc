@@ -0,0 +1,96 @@
+#include <string>
+
+#include "extensions/tracers/common/trace_context.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Tracers {
+namespace Common {
+namespace {
+
+const std::string trace_parent{"00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"};
+
+TEST(TraceContextHexTest, Decode) {
+  uint64_t value = 0;
+  EXPECT_TRUE(TraceContextHex::decode("0000000000000001", value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(TraceContextHex::decode("ffffffffffffffff", value));
+  EXPECT_EQ(UINT64_MAX, value);
+  EXPECT_TRUE(TraceContextHex::decode("aBc", value));
+  EXPECT_EQ(0xabc, value);
+
+  value = 7;
+  EXPECT_FALSE(TraceContextHex::decode("", value));
+  EXPECT_FALSE(TraceContextHex::decode("00000000000000001", value));
+  EXPECT_FALSE(TraceContextHex::decode("12g4", value));
+  EXPECT_FALSE(TraceContextHex::decode("0x12", value));
+  EXPECT_FALSE(TraceContextHex::decode(absl::string_view("1\0", 2), value));
+  EXPECT_EQ(7, value);
+}
+
+TEST(TraceContextHexTest, DecodeLowercase) {
+  uint64_t value = 0;
+  EXPECT_TRUE(TraceContextHex::decodeLowercase("abc", value));
+  EXPECT_EQ(0xabc, value);
+  EXPECT_FALSE(TraceContextHex::decodeLowercase("aBc", value));
+}
+
+TEST(TraceContextHexTest, Encode) {
+  char out[TraceContextHex::Uint64Length];
+  TraceContextHex::encode(0x00f067aa0ba902b7, out);
+  EXPECT_EQ("00f067aa0ba902b7", absl::string_view(out, sizeof(out)));
+}
+
+TEST(W3cTraceContextTest, ParseAndFormat) {
+  TraceParent parsed;
+  ASSERT_TRUE(W3cTraceContext::parseTraceParent(trace_parent, parsed));
+  EXPECT_EQ(0, parsed.version_);
+  EXPECT_EQ(0x4bf92f3577b34da6, parsed.trace_id_high_);
+  EXPECT_EQ(0xa3ce929d0e0e4736, parsed.trace_id_low_);
+  EXPECT_EQ(0x00f067aa0ba902b7, parsed.parent_id_);
+  EXPECT_TRUE(parsed.sampled());
+
+  W3cTraceContext::TraceParentBuffer buffer;
+  EXPECT_EQ(trace_parent, W3cTraceContext::formatTraceParent(parsed, buffer));
+
+  parsed.trace_flags_ = 0;
+  EXPECT_EQ("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00",
+            W3cTraceContext::formatTraceParent(parsed, buffer));
+}
+
+// The later versions may append fields, and are formatted as version 00.
+TEST(W3cTraceContextTest, LaterVersion) {
+  TraceParent parsed;
+  ASSERT_TRUE(W3cTraceContext::parseTraceParent("01" + trace_parent.substr(2) + "-ext", parsed));
+  EXPECT_EQ(1, parsed.version_);
+  W3cTraceContext::TraceParentBuffer buffer;
+  EXPECT_EQ(trace_parent, W3cTraceContext::formatTraceParent(parsed, buffer));
+
+  EXPECT_FALSE(W3cTraceContext::parseTraceParent("01" + trace_parent.substr(2) + "ext", parsed));
+}
+
+TEST(W3cTraceContextTest, Invalid) {
+  TraceParent parsed;
+  for (const std::string& value : {
+           std::string(""),
+           trace_parent.substr(0, 54),
+           trace_parent + "-ext",
+           "ff" + trace_parent.substr(2),
+           "0g" + trace_parent.substr(2),
+           std::string("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01"),
+           std::string("00-00000000000000000000000000000000-00f067aa0ba902b7-01"),
+           std::string("00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01"),
+           std::string("00_4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"),
+           std::string("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-0x"),
+       }) {
+    EXPECT_FALSE(W3cTraceContext::parseTraceParent(value, parsed)) << value;
+  }
+}
+
+} // namespace
+} // namespace Common
+} // namespace Tracers
+} // namespace Extensions
+} // namespace Envoy
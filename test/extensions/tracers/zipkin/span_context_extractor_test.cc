@@ -196,6 +196,34 @@ TEST(ZipkinSpanContextExtractorTest, WithoutSampled) {
   EXPECT_TRUE(extractor.extractSampled({Tracing::Reason::Sampling, true}));
 }
 
+TEST(ZipkinSpanContextExtractorTest, W3cTraceContext) {
+  {
+    Http::TestRequestHeaderMapImpl request_headers{
+        {"traceparent", fmt::format("00-{}{}-{}-01", trace_id_high, trace_id, span_id)}};
+    SpanContextExtractor extractor(request_headers);
+    auto context = extractor.extractW3cSpanContext();
+    EXPECT_TRUE(context.second);
+    EXPECT_EQ(3, context.first.id());
+    EXPECT_EQ(0, context.first.parentId());
+    EXPECT_EQ(1, context.first.traceId());
+    EXPECT_EQ(9, context.first.traceIdHigh());
+    EXPECT_TRUE(context.first.sampled());
+  }
+
+  {
+    Http::TestRequestHeaderMapImpl request_headers{
+        {"traceparent", fmt::format("00-{}{}-{}-1", trace_id_high, trace_id, span_id)}};
+    SpanContextExtractor extractor(request_headers);
+    EXPECT_FALSE(extractor.extractW3cSpanContext().second);
+  }
+
+  {
+    Http::TestRequestHeaderMapImpl request_headers;
+    SpanContextExtractor extractor(request_headers);
+    EXPECT_FALSE(extractor.extractW3cSpanContext().second);
+  }
+}
+
 TEST(ZipkinSpanContextExtractorTest, TooBig) {
   {
     Http::TestRequestHeaderMapImpl request_headers{
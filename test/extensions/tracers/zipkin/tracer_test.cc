@@ -337,6 +337,33 @@ TEST_F(ZipkinTracerTest, FinishNotSampledSpan) {
   EXPECT_EQ(0ULL, reporter_object->reportedSpans().size());
 }
 
+// A span finished at a given time takes its duration from its start timestamp.
+TEST_F(ZipkinTracerTest, FinishSpanAt) {
+  Network::Address::InstanceConstSharedPtr addr =
+      Network::Utility::parseInternetAddressAndPort("127.0.0.1:9000");
+  NiceMock<Random::MockRandomGenerator> random_generator;
+  Tracer tracer("my_service_name", addr, random_generator, false, true, time_system_);
+  SystemTime timestamp = time_system_.systemTime();
+
+  NiceMock<Tracing::MockConfig> config;
+  ON_CALL(config, operationName()).WillByDefault(Return(Tracing::OperationName::Egress));
+
+  TestReporterImpl* reporter_object = new TestReporterImpl(135);
+  ReporterPtr reporter_ptr(reporter_object);
+  tracer.setReporter(std::move(reporter_ptr));
+
+  SpanPtr span = tracer.startSpan(config, "my_span", timestamp);
+  time_system_.advanceTimeWait(std::chrono::milliseconds(10));
+  span->finish(timestamp + std::chrono::milliseconds(5));
+
+  ASSERT_EQ(1ULL, reporter_object->reportedSpans().size());
+  const Span& reported_span = reporter_object->reportedSpans()[0];
+  EXPECT_EQ(5000, reported_span.duration());
+  const Annotation& ann = reported_span.annotations()[1];
+  EXPECT_EQ(CLIENT_RECV, ann.value());
+  EXPECT_EQ(static_cast<uint64_t>(reported_span.timestamp() + 5000), ann.timestamp());
+}
+
 TEST_F(ZipkinTracerTest, SpanSampledPropagatedToChild) {
   Network::Address::InstanceConstSharedPtr addr =
       Network::Utility::parseInternetAddressAndPort("127.0.0.1:9000");
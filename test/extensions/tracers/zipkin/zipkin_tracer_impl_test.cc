@@ -5,15 +5,20 @@
 
 #include "envoy/config/trace/v3/zipkin.pb.h"
 
+#include "common/buffer/buffer_impl.h"
+#include "common/common/thread.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/runtime/runtime_impl.h"
+#include "common/stats/isolated_store_impl.h"
 #include "common/tracing/http_tracer_impl.h"
 
+#include "extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
 #include "extensions/tracers/zipkin/zipkin_core_constants.h"
 #include "extensions/tracers/zipkin/zipkin_tracer_impl.h"
 
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/runtime/mocks.h"
@@ -22,6 +27,7 @@
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
 #include "test/mocks/upstream/thread_local_cluster.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -58,7 +64,60 @@ public:
     }
 
     driver_ = std::make_unique<Driver>(zipkin_config, cm_, stats_, tls_, runtime_, local_info_,
-                                       random_, time_source_);
+                                       random_, time_source_, dispatcher_,
+                                       Thread::threadFactoryForTest());
+  }
+
+  void setupExportingDriver(const std::string& export_config) {
+    EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillRepeatedly(Return(&cm_.thread_local_cluster_));
+    // The export thread posts the batches to the main thread, which sends them when the test runs
+    // the posted callbacks.
+    ON_CALL(dispatcher_, post(_)).WillByDefault(Invoke([this](Event::PostCb cb) {
+      {
+        Thread::LockGuard guard(posts_lock_);
+        posts_.push_back(std::move(cb));
+      }
+      posts_event_.notifyAll();
+    }));
+    export_timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
+    EXPECT_CALL(*export_timer_, enableTimer(std::chrono::milliseconds(1000), _));
+
+    const std::string yaml_string = fmt::format(R"EOF(
+    collector_cluster: fake_cluster
+    collector_endpoint: /api/v2/spans
+    collector_endpoint_version: HTTP_JSON
+    export_config: {{{}}}
+    )EOF",
+                                                export_config);
+    envoy::config::trace::v3::ZipkinConfig zipkin_config;
+    TestUtility::loadFromYaml(yaml_string, zipkin_config);
+
+    setup(zipkin_config, false);
+  }
+
+  // Waits for the export thread to post the given number of batches, then sends them.
+  void sendPostedBatches(size_t batches) {
+    std::vector<Event::PostCb> posts;
+    {
+      Thread::LockGuard guard(posts_lock_);
+      while (posts_.size() < batches) {
+        posts_event_.wait(posts_lock_);
+      }
+      posts.swap(posts_);
+    }
+    EXPECT_EQ(batches, posts.size());
+    for (Event::PostCb& cb : posts) {
+      cb();
+    }
+  }
+
+  void finishSpans(size_t spans) {
+    for (size_t i = 0; i < spans; ++i) {
+      driver_
+          ->startSpan(config_, request_headers_, operation_name_, start_time_,
+                      {Tracing::Reason::Sampling, true})
+          ->finishSpan();
+    }
   }
 
   void setupValidDriver(const std::string& version) {
@@ -140,8 +199,13 @@ public:
   StreamInfo::MockStreamInfo stream_info_;
 
   NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
   std::unique_ptr<Driver> driver_;
   NiceMock<Event::MockTimer>* timer_;
+  NiceMock<Event::MockTimer>* export_timer_;
+  Thread::MutexBasicLockable posts_lock_;
+  Thread::CondVar posts_event_;
+  std::vector<Event::PostCb> posts_ ABSL_GUARDED_BY(posts_lock_);
   NiceMock<Stats::MockIsolatedStatsStore> stats_;
   NiceMock<Upstream::MockClusterManager> cm_;
   NiceMock<Runtime::MockLoader> runtime_;
@@ -464,6 +528,115 @@ TEST_F(ZipkinDriverTest, FlushSpansTimer) {
   EXPECT_EQ(1U, stats_.counter("tracing.zipkin.spans_sent").value());
 }
 
+// The spans of all threads are exported in batches, one request at a time, and the spans past
+// max_pending_spans are dropped while a request is in flight.
+TEST_F(ZipkinDriverTest, ExportSpansInBatches) {
+  setupExportingDriver("max_pending_spans: 3, max_batch_spans: 2");
+
+  Http::MockAsyncClientRequest request1(&cm_.async_client_), request2(&cm_.async_client_),
+      request3(&cm_.async_client_);
+  Http::AsyncClient::Callbacks* callback{};
+  const absl::optional<std::chrono::milliseconds> timeout(std::chrono::seconds(5));
+  EXPECT_CALL(cm_.async_client_,
+              send_(_, _, Http::AsyncClient::RequestOptions().setTimeout(timeout)))
+      .WillOnce(
+          Invoke([&](Http::RequestMessagePtr& message, Http::AsyncClient::Callbacks& callbacks,
+                     const Http::AsyncClient::RequestOptions&) -> Http::AsyncClient::Request* {
+            callback = &callbacks;
+            EXPECT_EQ("/api/v2/spans", message->headers().getPathValue());
+            EXPECT_EQ("fake_cluster", message->headers().getHostValue());
+            EXPECT_EQ("application/json", message->headers().getContentTypeValue());
+            EXPECT_TRUE(
+                message->headers().get(Http::CustomHeaders::get().ContentEncoding).empty());
+            EXPECT_EQ('[', message->body().toString().front());
+            return &request1;
+          }))
+      .WillOnce(Return(&request2))
+      .WillOnce(Return(&request3));
+
+  // A full batch is exported right away.
+  finishSpans(2);
+  sendPostedBatches(1);
+  EXPECT_EQ(2U, stats_.counter("tracing.zipkin.spans_sent").value());
+
+  // The next batch waits for the request in flight to complete.
+  finishSpans(4);
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.spans_dropped").value());
+  Http::ResponseMessagePtr msg(new Http::ResponseMessageImpl(
+      Http::ResponseHeaderMapPtr{new Http::TestResponseHeaderMapImpl{{":status", "202"}}}));
+  callback->onSuccess(request1, std::move(msg));
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.reports_sent").value());
+  sendPostedBatches(1);
+  EXPECT_EQ(4U, stats_.counter("tracing.zipkin.spans_sent").value());
+
+  // The last span waits for the flush interval.
+  callback->onFailure(request2, Http::AsyncClient::FailureReason::Reset);
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.reports_failed").value());
+  EXPECT_CALL(*export_timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  export_timer_->invokeCallback();
+  sendPostedBatches(1);
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.timer_flushed").value());
+  EXPECT_EQ(5U, stats_.counter("tracing.zipkin.spans_sent").value());
+
+  // The request in flight is cancelled on destruction.
+  EXPECT_CALL(request3, cancel());
+  driver_.reset();
+}
+
+TEST_F(ZipkinDriverTest, ExportSpansWithGzipCompression) {
+  setupExportingDriver("max_batch_spans: 1, gzip_compression: true");
+
+  Http::MockAsyncClientRequest request(&cm_.async_client_);
+  std::string body;
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::RequestMessagePtr& message, Http::AsyncClient::Callbacks&,
+                     const Http::AsyncClient::RequestOptions&) -> Http::AsyncClient::Request* {
+            EXPECT_EQ("gzip", message->headers()
+                                  .get(Http::CustomHeaders::get().ContentEncoding)[0]
+                                  ->value()
+                                  .getStringView());
+            body = message->body().toString();
+            return &request;
+          }));
+
+  finishSpans(1);
+  sendPostedBatches(1);
+
+  Stats::IsolatedStoreImpl store;
+  Compression::Gzip::Decompressor::ZlibDecompressorImpl decompressor(store, "test.");
+  decompressor.init(15 | 16);
+  Buffer::OwnedImpl compressed(body);
+  Buffer::OwnedImpl decompressed;
+  decompressor.decompress(compressed, decompressed);
+  const std::string json = decompressed.toString();
+  ASSERT_FALSE(json.empty());
+  EXPECT_EQ('[', json.front());
+  EXPECT_EQ(']', json.back());
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.spans_sent").value());
+
+  EXPECT_CALL(request, cancel());
+}
+
+TEST_F(ZipkinDriverTest, ExportSkippedIfCollectorClusterHasBeenRemoved) {
+  Upstream::ClusterUpdateCallbacks* cluster_update_callbacks;
+  EXPECT_CALL(cm_, addThreadLocalClusterUpdateCallbacks_(_))
+      .WillOnce(DoAll(SaveArgAddress(&cluster_update_callbacks), Return(nullptr)));
+  setupExportingDriver("max_batch_spans: 1");
+  cluster_update_callbacks->onClusterRemoval("fake_cluster");
+
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _)).Times(0);
+  finishSpans(1);
+  sendPostedBatches(1);
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.reports_skipped_no_cluster").value());
+
+  // The skipped report does not hold back the next one.
+  finishSpans(1);
+  sendPostedBatches(1);
+  EXPECT_EQ(2U, stats_.counter("tracing.zipkin.reports_skipped_no_cluster").value());
+  EXPECT_EQ(2U, stats_.counter("tracing.zipkin.spans_sent").value());
+}
+
 TEST_F(ZipkinDriverTest, NoB3ContextSampledTrue) {
   setupValidDriver("HTTP_JSON");
 
@@ -545,6 +718,49 @@ TEST_F(ZipkinDriverTest, PropagateB3NotSampled) {
   EXPECT_EQ(NOT_SAMPLED, sampled_entry[0]->value().getStringView());
 }
 
+// The W3C trace context is used when there is no B3 header, and is propagated with the B3 headers.
+TEST_F(ZipkinDriverTest, PropagateW3cTraceContext) {
+  EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillRepeatedly(Return(&cm_.thread_local_cluster_));
+  const std::string yaml_string = R"EOF(
+  collector_cluster: fake_cluster
+  collector_endpoint: /api/v2/spans
+  collector_endpoint_version: HTTP_JSON
+  w3c_trace_context: true
+  )EOF";
+  envoy::config::trace::v3::ZipkinConfig zipkin_config;
+  TestUtility::loadFromYaml(yaml_string, zipkin_config);
+  setup(zipkin_config, true);
+
+  request_headers_.addCopy(ZipkinCoreConstants::get().TRACE_PARENT,
+                           "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00");
+  request_headers_.addCopy(Http::LowerCaseString("tracestate"), "congo=t61rcWkgMzE");
+  Tracing::SpanPtr span = driver_->startSpan(config_, request_headers_, operation_name_,
+                                             start_time_, {Tracing::Reason::Sampling, true});
+
+  ZipkinSpanPtr zipkin_span(dynamic_cast<ZipkinSpan*>(span.release()));
+  EXPECT_EQ(0x4bf92f3577b34da6, zipkin_span->span().traceIdHigh());
+  EXPECT_EQ(0xa3ce929d0e0e4736, zipkin_span->span().traceId());
+  EXPECT_FALSE(zipkin_span->span().sampled());
+
+  Http::TestRequestHeaderMapImpl injected_headers{{"tracestate", "congo=t61rcWkgMzE"}};
+  zipkin_span->injectContext(injected_headers);
+  EXPECT_EQ("4bf92f3577b34da6a3ce929d0e0e4736",
+            injected_headers.get_(ZipkinCoreConstants::get().X_B3_TRACE_ID));
+  EXPECT_EQ(
+      fmt::format("00-4bf92f3577b34da6a3ce929d0e0e4736-{}-00", zipkin_span->span().idAsHexString()),
+      injected_headers.get_(ZipkinCoreConstants::get().TRACE_PARENT));
+  EXPECT_EQ("congo=t61rcWkgMzE", injected_headers.get_("tracestate"));
+
+  // An invalid traceparent header starts a new trace.
+  request_headers_.setCopy(ZipkinCoreConstants::get().TRACE_PARENT,
+                           "00-00000000000000000000000000000000-00f067aa0ba902b7-01");
+  span = driver_->startSpan(config_, request_headers_, operation_name_, start_time_,
+                            {Tracing::Reason::Sampling, true});
+  zipkin_span.reset(dynamic_cast<ZipkinSpan*>(span.release()));
+  EXPECT_NE(0xa3ce929d0e0e4736, zipkin_span->span().traceId());
+  EXPECT_TRUE(zipkin_span->span().sampled());
+}
+
 TEST_F(ZipkinDriverTest, PropagateB3NotSampledWithFalse) {
   setupValidDriver("HTTP_JSON");
 
@@ -257,6 +257,27 @@ TEST_F(SslContextImplTest, TestCipherSuites) {
       "ciphers were rejected when tried individually: BOGUS1-SHA256, BOGUS2-SHA");
 }
 
+// A renegotiation would write handshake records past the kernel.
+TEST_F(SslContextImplTest, KernelTlsOffloadWithRenegotiation) {
+  const std::string yaml = R"EOF(
+  common_tls_context:
+    kernel_tls_offload: true
+  )EOF";
+
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(yaml), tls_context);
+  ClientContextConfigImpl cfg(tls_context, factory_context_);
+  auto context = std::dynamic_pointer_cast<ContextImpl>(
+      manager_.createSslClientContext(store_, cfg, nullptr));
+  EXPECT_TRUE(context->kernelTlsOffload());
+
+  tls_context.set_allow_renegotiation(true);
+  ClientContextConfigImpl renegotiating_cfg(tls_context, factory_context_);
+  context = std::dynamic_pointer_cast<ContextImpl>(
+      manager_.createSslClientContext(store_, renegotiating_cfg, nullptr));
+  EXPECT_FALSE(context->kernelTlsOffload());
+}
+
 TEST_F(SslContextImplTest, TestExpiringCert) {
   const std::string yaml = R"EOF(
   common_tls_context:
@@ -561,8 +582,8 @@ TEST_F(SslContextImplTest, TestNoCert) {
   EXPECT_TRUE(context->getCertChainInformation().empty());
 }
 
-// Multiple RSA certificates are rejected.
-TEST_F(SslContextImplTest, AtMostOneRsaCert) {
+// Multiple RSA certificates are only accepted along with certificate selection by SNI.
+TEST_F(SslContextImplTest, MultipleRsaCerts) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
   const std::string tls_context_yaml = R"EOF(
   common_tls_context:
@@ -581,10 +602,15 @@ TEST_F(SslContextImplTest, AtMostOneRsaCert) {
   EXPECT_THROW_WITH_REGEX(
       manager_.createSslServerContext(store_, server_context_config, {}, nullptr), EnvoyException,
       "at most one certificate of a given type may be specified");
+
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.tls_select_certificate_by_sni", "true"}});
+  EXPECT_NO_THROW(manager_.createSslServerContext(store_, server_context_config, {}, nullptr));
 }
 
-// Multiple ECDSA certificates are rejected.
-TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
+// Multiple ECDSA certificates are only accepted along with certificate selection by SNI.
+TEST_F(SslContextImplTest, MultipleEcdsaCerts) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
   const std::string tls_context_yaml = R"EOF(
   common_tls_context:
@@ -603,6 +629,11 @@ TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
   EXPECT_THROW_WITH_REGEX(
       manager_.createSslServerContext(store_, server_context_config, {}, nullptr), EnvoyException,
       "at most one certificate of a given type may be specified");
+
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.tls_select_certificate_by_sni", "true"}});
+  EXPECT_NO_THROW(manager_.createSslServerContext(store_, server_context_config, {}, nullptr));
 }
 
 // Certificates with no subject CN and no SANs are rejected.
@@ -0,0 +1,126 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include "test/mocks/network/io_handle.h"
+#include "test/test_common/environment.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::Return;
+using testing::StrictMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+// Kernel TLS is only built in along with the Linux TLS header.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/tls.h>)
+#define KERNEL_TLS_TEST
+#endif
+#endif
+
+class KernelTlsTest : public testing::Test {
+protected:
+  // Completes a handshake between two SSL objects connected through a BIO pair.
+  void handshake(const char* cipher_list) {
+    const std::string cert = TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem");
+    const std::string key = TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem");
+    ASSERT_EQ(1, SSL_CTX_use_certificate_chain_file(server_ctx_.get(), cert.c_str()));
+    ASSERT_EQ(1, SSL_CTX_use_PrivateKey_file(server_ctx_.get(), key.c_str(), SSL_FILETYPE_PEM));
+    ASSERT_EQ(1, SSL_CTX_set_max_proto_version(client_ctx_.get(), TLS1_2_VERSION));
+    ASSERT_EQ(1, SSL_CTX_set_strict_cipher_list(client_ctx_.get(), cipher_list));
+
+    client_ssl_.reset(SSL_new(client_ctx_.get()));
+    server_ssl_.reset(SSL_new(server_ctx_.get()));
+    SSL_set_connect_state(client_ssl_.get());
+    SSL_set_accept_state(server_ssl_.get());
+    BIO* client_bio;
+    BIO* server_bio;
+    ASSERT_EQ(1, BIO_new_bio_pair(&client_bio, 0, &server_bio, 0));
+    SSL_set_bio(client_ssl_.get(), client_bio, client_bio);
+    SSL_set_bio(server_ssl_.get(), server_bio, server_bio);
+    client_bio_ = client_bio;
+
+    for (int i = 0; i < 10; ++i) {
+      const int client_rc = SSL_do_handshake(client_ssl_.get());
+      const int server_rc = SSL_do_handshake(server_ssl_.get());
+      if (client_rc == 1 && server_rc == 1) {
+        return;
+      }
+    }
+    FAIL() << "handshake did not complete";
+  }
+
+  // Writes from the server and reads the data back on the client, through BoringSSL.
+  void expectSslRoundTrip() {
+    ASSERT_EQ(5, SSL_write(server_ssl_.get(), "hello", 5));
+    char buffer[5];
+    ASSERT_EQ(5, SSL_read(client_ssl_.get(), buffer, sizeof(buffer)));
+    EXPECT_EQ("hello", std::string(buffer, sizeof(buffer)));
+  }
+
+  bssl::UniquePtr<SSL_CTX> client_ctx_{SSL_CTX_new(TLS_method())};
+  bssl::UniquePtr<SSL_CTX> server_ctx_{SSL_CTX_new(TLS_method())};
+  bssl::UniquePtr<SSL> client_ssl_;
+  bssl::UniquePtr<SSL> server_ssl_;
+  BIO* client_bio_{};
+  StrictMock<Network::MockIoHandle> io_handle_;
+};
+
+// Only AES-GCM ciphers are offloaded, the socket isn't touched otherwise.
+TEST_F(KernelTlsTest, UnsupportedCipher) {
+  handshake("ECDHE-RSA-CHACHA20-POLY1305");
+  EXPECT_FALSE(enableKernelTlsTx(server_ssl_.get(), io_handle_));
+  expectSslRoundTrip();
+}
+
+#ifdef KERNEL_TLS_TEST
+
+// Without the tls module the ULP can't be attached.
+TEST_F(KernelTlsTest, NoKernelModule) {
+  handshake("ECDHE-RSA-AES128-GCM-SHA256");
+  EXPECT_CALL(io_handle_, setOption(_, _, _, _)).WillOnce(Return(Api::SysCallIntResult{-1, 0}));
+  EXPECT_FALSE(enableKernelTlsTx(server_ssl_.get(), io_handle_));
+  expectSslRoundTrip();
+}
+
+// The ULP stays attached when the crypto info can't be set. The tls ULP passes the data through to
+// TCP until crypto info is set, so BoringSSL keeps writing its records to the socket.
+TEST_F(KernelTlsTest, UlpAttachedWithoutCryptoInfo) {
+  handshake("ECDHE-RSA-AES256-GCM-SHA384");
+  {
+    InSequence s;
+    EXPECT_CALL(io_handle_, setOption(_, _, _, _)).WillOnce(Return(Api::SysCallIntResult{0, 0}));
+    EXPECT_CALL(io_handle_, setOption(_, _, _, _)).WillOnce(Return(Api::SysCallIntResult{-1, 0}));
+  }
+  EXPECT_FALSE(enableKernelTlsTx(server_ssl_.get(), io_handle_));
+  expectSslRoundTrip();
+}
+
+// Once offloaded, the records BoringSSL would still write never reach the socket.
+TEST_F(KernelTlsTest, Enabled) {
+  handshake("ECDHE-RSA-AES128-GCM-SHA256");
+  EXPECT_CALL(io_handle_, setOption(_, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Return(Api::SysCallIntResult{0, 0}));
+  EXPECT_TRUE(enableKernelTlsTx(server_ssl_.get(), io_handle_));
+
+  SSL_shutdown(server_ssl_.get());
+  EXPECT_EQ(0U, BIO_ctrl_pending(client_bio_));
+}
+
+#endif
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
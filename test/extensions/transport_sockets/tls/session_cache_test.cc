@@ -0,0 +1,197 @@
+#include <chrono>
+#include <string>
+
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+class ServerSessionCacheTest : public testing::Test {
+public:
+  ServerSessionCacheTest() : ssl_ctx_(SSL_CTX_new(TLS_method())) {}
+
+  bssl::UniquePtr<SSL_SESSION> newSession(const std::string& id, uint32_t timeout = 300) {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx_.get()));
+    EXPECT_EQ(1, SSL_SESSION_set1_id(session.get(), reinterpret_cast<const uint8_t*>(id.data()),
+                                     id.size()));
+    SSL_SESSION_set_time(session.get(), std::chrono::duration_cast<std::chrono::seconds>(
+                                            time_system_.systemTime().time_since_epoch())
+                                            .count());
+    SSL_SESSION_set_timeout(session.get(), timeout);
+    return session;
+  }
+
+  // Returns the session which the server established in a TLS 1.2 handshake.
+  bssl::UniquePtr<SSL_SESSION> handshakeSession() {
+    bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+    bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+    const std::string cert = TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem");
+    const std::string key = TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem");
+    EXPECT_EQ(1, SSL_CTX_use_certificate_chain_file(server_ctx.get(), cert.c_str()));
+    EXPECT_EQ(1, SSL_CTX_use_PrivateKey_file(server_ctx.get(), key.c_str(), SSL_FILETYPE_PEM));
+    EXPECT_EQ(1, SSL_CTX_set_max_proto_version(client_ctx.get(), TLS1_2_VERSION));
+    // Without a ticket, the session gets an ID.
+    SSL_CTX_set_options(server_ctx.get(), SSL_OP_NO_TICKET);
+
+    bssl::UniquePtr<SSL> client(SSL_new(client_ctx.get()));
+    bssl::UniquePtr<SSL> server(SSL_new(server_ctx.get()));
+    SSL_set_connect_state(client.get());
+    SSL_set_accept_state(server.get());
+    BIO* client_bio;
+    BIO* server_bio;
+    EXPECT_EQ(1, BIO_new_bio_pair(&client_bio, 0, &server_bio, 0));
+    SSL_set_bio(client.get(), client_bio, client_bio);
+    SSL_set_bio(server.get(), server_bio, server_bio);
+    for (int i = 0; i < 10; ++i) {
+      const int client_rc = SSL_do_handshake(client.get());
+      if (SSL_do_handshake(server.get()) == 1 && client_rc == 1) {
+        break;
+      }
+    }
+
+    bssl::UniquePtr<SSL_SESSION> session(SSL_get1_session(server.get()));
+    EXPECT_NE(nullptr, session);
+    SSL_SESSION_set_time(session.get(), std::chrono::duration_cast<std::chrono::seconds>(
+                                            time_system_.systemTime().time_since_epoch())
+                                            .count());
+    SSL_SESSION_set_timeout(session.get(), 7200);
+    return session;
+  }
+
+  bssl::UniquePtr<SSL_SESSION> lookup(ServerSessionCache& cache, const std::string& id) {
+    return cache.lookup({reinterpret_cast<const uint8_t*>(id.data()), id.size()});
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+};
+
+TEST_F(ServerSessionCacheTest, InsertLookup) {
+  ServerSessionCache cache(time_system_);
+  bssl::UniquePtr<SSL_SESSION> session = newSession("session1");
+  SSL_SESSION* raw_session = session.get();
+  cache.insert(std::move(session));
+  cache.insert(newSession("session2"));
+  EXPECT_EQ(2, cache.size());
+
+  EXPECT_EQ(raw_session, lookup(cache, "session1").get());
+  EXPECT_EQ(nullptr, lookup(cache, "session3"));
+
+  // A new session with the same ID replaces the cached one.
+  bssl::UniquePtr<SSL_SESSION> other = newSession("session1");
+  SSL_SESSION* raw_other = other.get();
+  cache.insert(std::move(other));
+  EXPECT_EQ(raw_other, lookup(cache, "session1").get());
+  EXPECT_EQ(2, cache.size());
+
+  // Sessions without ID aren't cached.
+  cache.insert(bssl::UniquePtr<SSL_SESSION>(SSL_SESSION_new(ssl_ctx_.get())));
+  EXPECT_EQ(2, cache.size());
+}
+
+TEST_F(ServerSessionCacheTest, EvictExpiredSessions) {
+  ServerSessionCache cache(time_system_);
+  for (int i = 0; i < 100; ++i) {
+    cache.insert(newSession(absl::StrCat("old", i), 60));
+  }
+  EXPECT_EQ(100, cache.size());
+
+  // Enough new sessions to hit every bucket.
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  for (int i = 0; i < 1000; ++i) {
+    cache.insert(newSession(absl::StrCat("new", i), 60));
+  }
+  EXPECT_EQ(1000, cache.size());
+  EXPECT_EQ(nullptr, lookup(cache, "old0"));
+  EXPECT_NE(nullptr, lookup(cache, "new0"));
+}
+
+TEST_F(ServerSessionCacheTest, EvictOldestSessionsWhenFull) {
+  ServerSessionCache cache(time_system_, ServerSessionCache::NumBuckets);
+  for (int i = 0; i < 1000; ++i) {
+    cache.insert(newSession(absl::StrCat("session", i)));
+    EXPECT_LE(cache.size(), ServerSessionCache::NumBuckets);
+  }
+  EXPECT_NE(nullptr, lookup(cache, "session999"));
+}
+
+TEST_F(ServerSessionCacheTest, RotateTicketKeys) {
+  ServerSessionCache cache(time_system_, ServerSessionCache::DefaultMaxSessions,
+                           std::chrono::hours(1));
+  const SessionTicketKeys keys = cache.ticketKeys();
+  ASSERT_EQ(1, keys.size());
+  EXPECT_EQ(&cache.ticketKeys(), &cache.ticketKeys());
+  EXPECT_EQ(keys.front().name_, cache.ticketKeys().front().name_);
+
+  // The keys of another cache are told apart from the ones this thread keeps a reference to.
+  ServerSessionCache other_cache(time_system_);
+  EXPECT_NE(keys.front().name_, other_cache.ticketKeys().front().name_);
+  EXPECT_EQ(keys.front().name_, cache.ticketKeys().front().name_);
+
+  // The previous key stays around for decryption.
+  time_system_.advanceTimeWait(std::chrono::hours(1));
+  const SessionTicketKeys rotated_keys = cache.ticketKeys();
+  ASSERT_EQ(2, rotated_keys.size());
+  EXPECT_NE(keys.front().name_, rotated_keys.front().name_);
+  EXPECT_EQ(keys.front().name_, rotated_keys[1].name_);
+
+  // After two intervals without handshakes the previous key is dropped.
+  time_system_.advanceTimeWait(std::chrono::hours(2));
+  const SessionTicketKeys& idle_keys = cache.ticketKeys();
+  ASSERT_EQ(1, idle_keys.size());
+  EXPECT_NE(rotated_keys.front().name_, idle_keys.front().name_);
+}
+
+// A cache takes over the sessions and the ticket keys of another one, as on hot restart.
+TEST_F(ServerSessionCacheTest, ExportImport) {
+  ServerSessionCache cache(time_system_, ServerSessionCache::DefaultMaxSessions,
+                           std::chrono::hours(1));
+  bssl::UniquePtr<SSL_SESSION> session = handshakeSession();
+  unsigned int id_length;
+  const uint8_t* id = SSL_SESSION_get_id(session.get(), &id_length);
+  const std::string session_id(reinterpret_cast<const char*>(id), id_length);
+  ASSERT_FALSE(session_id.empty());
+  cache.insert(std::move(session));
+  cache.insert(newSession("expired", 1));
+  const SessionTicketKeys keys = cache.ticketKeys();
+  time_system_.advanceTimeWait(std::chrono::minutes(30));
+
+  // The expired session is left out.
+  const Envoy::Ssl::ServerSessionState state = cache.exportState();
+  EXPECT_EQ(1, state.sessions_.size());
+  ASSERT_EQ(1, state.ticket_keys_.size());
+  EXPECT_EQ(keys.front().name_, state.ticket_keys_.front().name_);
+  EXPECT_EQ(1800, state.ticket_key_age_.count());
+
+  ServerSessionCache other_cache(time_system_, ServerSessionCache::DefaultMaxSessions,
+                                 std::chrono::hours(1));
+  other_cache.importState(state);
+  EXPECT_NE(nullptr, lookup(other_cache, session_id));
+  EXPECT_EQ(nullptr, lookup(other_cache, "expired"));
+  EXPECT_EQ(keys.front().name_, other_cache.ticketKeys().front().name_);
+  EXPECT_EQ(keys.front().aes_key_, other_cache.ticketKeys().front().aes_key_);
+
+  // The keys are rotated when the first cache would have rotated them.
+  time_system_.advanceTimeWait(std::chrono::minutes(30));
+  const SessionTicketKeys rotated_keys = other_cache.ticketKeys();
+  ASSERT_EQ(2, rotated_keys.size());
+  EXPECT_EQ(keys.front().name_, rotated_keys[1].name_);
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
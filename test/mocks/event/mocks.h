@@ -83,6 +83,8 @@ public:
     return timer;
   }
 
+  Event::TimerPtr createCoarseTimer(Event::TimerCb cb) override { return createTimer(cb); }
+
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override {
     auto schedulable_cb = Event::SchedulableCallbackPtr{createSchedulableCallback_(cb)};
     // Assert that schedulable_cb is not null to avoid confusing test failures down the line.
@@ -78,6 +78,10 @@ public:
 
   TimerPtr createTimer(TimerCb cb) override { return impl_.createTimer(std::move(cb)); }
 
+  TimerPtr createCoarseTimer(TimerCb cb) override {
+    return impl_.createCoarseTimer(std::move(cb));
+  }
+
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override {
     return impl_.createSchedulableCallback(std::move(cb));
   }
@@ -3,6 +3,8 @@
 #include "common/common/assert.h"
 #include "common/common/lock_guard.h"
 
+#include "absl/strings/str_join.h"
+
 namespace Envoy {
 namespace Filesystem {
 
@@ -33,6 +35,10 @@ Api::IoCallSizeResult MockFile::write(absl::string_view buffer) {
   return result;
 }
 
+Api::IoCallSizeResult MockFile::writev(absl::Span<const absl::string_view> buffers) {
+  return write(absl::StrJoin(buffers, ""));
+}
+
 Api::IoCallBoolResult MockFile::close() {
   Api::IoCallBoolResult result = close_();
   is_open_ = !result.rc_;
@@ -26,7 +26,7 @@ public:
   MOCK_METHOD(void, cancel, ());
 };
 
-class MockAsyncStream : public RawAsyncStream {
+class MockAsyncStream : public RawAsyncStream, public RawCompressedAsyncStream {
 public:
   MockAsyncStream();
   ~MockAsyncStream() override;
@@ -38,6 +38,10 @@ public:
   MOCK_METHOD(void, closeStream, ());
   MOCK_METHOD(void, resetStream, ());
   MOCK_METHOD(bool, isAboveWriteBufferHighWatermark, (), (const));
+  void sendCompressedMessageRaw(Buffer::InstancePtr&& request, bool end_stream) override {
+    sendCompressedMessageRaw_(request, end_stream);
+  }
+  MOCK_METHOD(void, sendCompressedMessageRaw_, (Buffer::InstancePtr & request, bool end_stream));
 };
 
 template <class ResponseType> using ResponseTypePtr = std::unique_ptr<ResponseType>;
@@ -81,6 +81,7 @@ public:
   MOCK_METHOD(uint32_t, bufferLimit, (), (const));                                                 \
   MOCK_METHOD(bool, localAddressRestored, (), (const));                                            \
   MOCK_METHOD(bool, aboveHighWatermark, (), (const));                                              \
+  MOCK_METHOD(bool, buffersEmpty, (), (const));                                                    \
   MOCK_METHOD(const Network::ConnectionSocket::OptionsSharedPtr&, socketOptions, (), (const));     \
   MOCK_METHOD(StreamInfo::StreamInfo&, streamInfo, ());                                            \
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));                             \
@@ -165,6 +166,7 @@ public:
   MOCK_METHOD(uint32_t, bufferLimit, (), (const));
   MOCK_METHOD(bool, localAddressRestored, (), (const));
   MOCK_METHOD(bool, aboveHighWatermark, (), (const));
+  MOCK_METHOD(bool, buffersEmpty, (), (const));
   MOCK_METHOD(const Network::ConnectionSocket::OptionsSharedPtr&, socketOptions, (), (const));
   MOCK_METHOD(StreamInfo::StreamInfo&, streamInfo, ());
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
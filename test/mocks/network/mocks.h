@@ -418,6 +418,9 @@ public:
   MOCK_METHOD(void, enableListeners, ());
   MOCK_METHOD(void, setListenerRejectFraction, (float), (override));
   MOCK_METHOD(const std::string&, statPrefix, (), (const));
+  MOCK_METHOD(void, releaseTransferableConnections, (const ReleasedConnectionCb& cb));
+  MOCK_METHOD(bool, adoptConnection,
+              (const Address::Instance& listener_address, ConnectionSocketPtr&& socket));
 };
 
 class MockIp : public Address::Ip {
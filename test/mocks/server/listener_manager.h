@@ -28,6 +28,10 @@ public:
   MOCK_METHOD(void, endListenerUpdate, (ListenerManager::FailureStates &&));
   MOCK_METHOD(ApiListenerOptRef, apiListener, ());
   MOCK_METHOD(bool, isWorkerStarted, ());
+  MOCK_METHOD(void, releaseTransferableConnections,
+              (Network::ConnectionHandler::ReleasedConnectionCb cb,
+               std::function<void()> completion));
+  MOCK_METHOD(void, adoptParentConnections, ());
 };
 } // namespace Server
 } // namespace Envoy
@@ -11,6 +11,7 @@
 #include "common/network/connection_balancer_impl.h"
 #include "common/network/io_socket_handle_impl.h"
 #include "common/network/raw_buffer_socket.h"
+#include "common/network/transferable_connection.h"
 #include "common/network/udp_default_writer_config.h"
 #include "common/network/udp_listener_impl.h"
 #include "common/network/utility.h"
@@ -583,6 +584,98 @@ TEST_F(ConnectionHandlerTest, CloseConnectionOnEmptyFilterChain) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+// Idle connections without buffered data are released with a duplicate of their socket and closed
+// here.
+TEST_F(ConnectionHandlerTest, ReleaseTransferableConnections) {
+  Network::TcpListenerCallbacks* listener_callbacks;
+  auto listener = new NiceMock<Network::MockListener>();
+  TestListener* test_listener =
+      addListener(1, true, false, "test_listener", listener, &listener_callbacks);
+  EXPECT_CALL(*socket_factory_, localAddress()).WillRepeatedly(ReturnRef(local_address_));
+  handler_->addListener(absl::nullopt, *test_listener);
+
+  bool idle = false;
+  bool buffers_empty = true;
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  auto* connection = new NiceMock<Network::MockServerConnection>();
+  ON_CALL(*connection, buffersEmpty()).WillByDefault(ReturnPointee(&buffers_empty));
+  EXPECT_CALL(dispatcher_, createServerConnection_()).WillOnce(Return(connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  connection->stream_info_.filter_state_->setData(
+      Network::TransferableConnection::key(),
+      std::make_unique<Network::TransferableConnection>([&idle]() { return idle; }),
+      StreamInfo::FilterState::StateType::ReadOnly, StreamInfo::FilterState::LifeSpan::FilterChain);
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  testing::MockFunction<void(Network::IoHandlePtr&&, const Network::Address::Instance&)> cb;
+  EXPECT_CALL(cb, Call(_, _)).Times(0);
+  handler_->releaseTransferableConnections(cb.AsStdFunction());
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  // Pipelined input or pending writes keep the connection here.
+  idle = true;
+  buffers_empty = false;
+  handler_->releaseTransferableConnections(cb.AsStdFunction());
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  buffers_empty = true;
+  EXPECT_CALL(os_sys_calls_, duplicate(_)).WillOnce(Return(Api::SysCallSocketResult{42, 0}));
+  EXPECT_CALL(*connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*access_log_, log(_, _, _, _));
+  EXPECT_CALL(cb, Call(_, _))
+      .WillOnce(Invoke([&](Network::IoHandlePtr&& io_handle,
+                           const Network::Address::Instance& listener_address) {
+        EXPECT_EQ(42, io_handle->fdDoNotUse());
+        EXPECT_EQ(*local_address_, listener_address);
+      }));
+  handler_->releaseTransferableConnections(cb.AsStdFunction());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0UL, handler_->numConnections());
+  EXPECT_EQ(1UL, TestUtility::findCounter(stats_store_, "downstream_cx_released")->value());
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
+// Adopted connections skip the listener filters.
+TEST_F(ConnectionHandlerTest, AdoptConnection) {
+  Network::TcpListenerCallbacks* listener_callbacks;
+  auto listener = new NiceMock<Network::MockListener>();
+  TestListener* test_listener =
+      addListener(1, true, false, "test_listener", listener, &listener_callbacks);
+  EXPECT_CALL(*socket_factory_, localAddress()).WillRepeatedly(ReturnRef(local_address_));
+  handler_->addListener(absl::nullopt, *test_listener);
+
+  auto* adopted_socket = new NiceMock<Network::MockConnectionSocket>();
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).Times(0);
+  EXPECT_CALL(*adopted_socket, setDetectedTransportProtocol(absl::string_view("raw_buffer")));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  auto* connection = new NiceMock<Network::MockServerConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_()).WillOnce(Return(connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  EXPECT_TRUE(handler_->adoptConnection(*local_address_,
+                                        Network::ConnectionSocketPtr{adopted_socket}));
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(1UL, TestUtility::findCounter(stats_store_, "downstream_cx_adopted")->value());
+  EXPECT_EQ(1UL, TestUtility::findCounter(stats_store_, "downstream_cx_total")->value());
+
+  EXPECT_CALL(*access_log_, log(_, _, _, _));
+  connection->close(Network::ConnectionCloseType::NoFlush);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0UL, handler_->numConnections());
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
+TEST_F(ConnectionHandlerTest, AdoptConnectionWithoutListener) {
+  auto* adopted_socket = new NiceMock<Network::MockConnectionSocket>();
+  EXPECT_CALL(*adopted_socket, close());
+  EXPECT_CALL(dispatcher_, createServerConnection_()).Times(0);
+  EXPECT_FALSE(handler_->adoptConnection(*local_address_,
+                                         Network::ConnectionSocketPtr{adopted_socket}));
+}
+
 TEST_F(ConnectionHandlerTest, NormalRedirect) {
   Network::TcpListenerCallbacks* listener_callbacks1;
   auto listener1 = new NiceMock<Network::MockListener>();
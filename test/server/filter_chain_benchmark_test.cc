@@ -196,6 +196,20 @@ public:
     filter_chains_ = listener_config_.filter_chains();
   }
 
+  // Builds one filter chain per exact server name and one per wildcard server name, as seen on
+  // TLS terminating listeners serving many customer certificates.
+  void initializeServerNames(::benchmark::State& state) {
+    for (int64_t i = 0; i < state.range(0); i++) {
+      auto* exact_match = listener_config_.add_filter_chains()->mutable_filter_chain_match();
+      exact_match->add_server_names(absl::StrCat("server", i, ".example.com"));
+      exact_match->set_transport_protocol("tls");
+      auto* wildcard_match = listener_config_.add_filter_chains()->mutable_filter_chain_match();
+      wildcard_match->add_server_names(absl::StrCat("*.tenant", i, ".example.com"));
+      wildcard_match->set_transport_protocol("tls");
+    }
+    filter_chains_ = listener_config_.filter_chains();
+  }
+
   Envoy::Thread::MutexBasicLockable lock_;
   Logger::Context logging_state_{spdlog::level::warn, Logger::Logger::DEFAULT_LOG_FORMAT, lock_,
                                  false};
@@ -253,6 +267,39 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindByServerNameTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  initializeServerNames(state);
+  // Half of the lookups hit an exact server name, the other half a wildcard one.
+  std::vector<MockConnectionSocket> sockets;
+  sockets.reserve(state.range(0));
+  for (int i = 0; i < state.range(0); i++) {
+    const std::string server_name = i % 2 == 0 ? absl::StrCat("server", i, ".example.com")
+                                               : absl::StrCat("www.tenant", i, ".example.com");
+    sockets.push_back(std::move(*MockConnectionSocket::createMockConnectionSocket(
+        1234, "127.0.0.1", server_name, "tls", {}, "8.8.8.8", 111)));
+  }
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  FilterChainManagerImpl filter_chain_manager{
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+      init_manager_};
+
+  filter_chain_manager.addFilterChains(filter_chains_, nullptr, dummy_builder_,
+                                       filter_chain_manager);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (int i = 0; i < state.range(0); i++) {
+      filter_chain_manager.findFilterChain(sockets[i]);
+    }
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -265,6 +312,12 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         {1, 4096},
     })
     ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindByServerNameTest)
+    ->Ranges({
+        // scale of the server names, each adding an exact and a wildcard filter chain
+        {1, 1 << 17},
+    })
+    ->Unit(::benchmark::kMillisecond);
 
 /*
 clang-format off
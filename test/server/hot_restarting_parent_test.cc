@@ -1,15 +1,26 @@
+#include <sys/socket.h>
+
 #include <memory>
 
+#include "common/network/address_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+
 #include "server/hot_restarting_child.h"
 #include "server/hot_restarting_parent.h"
 
+#include "test/mocks/network/io_handle.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/server/instance.h"
 #include "test/mocks/server/listener_manager.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::InSequence;
+using testing::Invoke;
 using testing::Return;
 using testing::ReturnRef;
 
@@ -114,6 +125,65 @@ TEST_F(HotRestartingParentTest, ExportStatsToChild) {
   }
 }
 
+TEST_F(HotRestartingParentTest, ExportIndexedStatsToChild) {
+  Stats::TestUtil::TestStore store;
+  MockListenerManager listener_manager;
+  EXPECT_CALL(server_, listenerManager()).WillRepeatedly(ReturnRef(listener_manager));
+  EXPECT_CALL(listener_manager, numConnections()).WillRepeatedly(Return(0));
+  EXPECT_CALL(server_, stats()).WillRepeatedly(ReturnRef(store));
+  HotRestartMessage::Request::Stats request;
+  request.set_indexed(true);
+  request.set_forget_indexes(true);
+
+  uint32_t c1_index;
+  uint32_t g1_index;
+  {
+    store.counter("c1").inc();
+    store.gauge("g1", Stats::Gauge::ImportMode::Accumulate).set(123);
+    HotRestartMessage::Reply::Stats stats;
+    hot_restarting_parent_.exportIndexedStatsToChild(request, &stats);
+    ASSERT_EQ(2, stats.stat_names().size());
+    ASSERT_EQ(1, stats.indexed_counter_deltas().size());
+    ASSERT_EQ(1, stats.indexed_gauges().size());
+    c1_index = stats.indexed_counter_deltas().begin()->first;
+    g1_index = stats.indexed_gauges().begin()->first;
+    EXPECT_NE(c1_index, g1_index);
+    EXPECT_EQ("c1", stats.stat_names().at(c1_index));
+    EXPECT_EQ("g1", stats.stat_names().at(g1_index));
+    EXPECT_EQ(1, stats.indexed_counter_deltas().at(c1_index));
+    EXPECT_EQ(123, stats.indexed_gauges().at(g1_index));
+    EXPECT_TRUE(stats.counter_deltas().empty());
+    EXPECT_TRUE(stats.gauges().empty());
+  }
+  // Later exports don't repeat the names, and leave out the gauges which didn't change.
+  request.set_forget_indexes(false);
+  {
+    store.counter("c1").add(2);
+    HotRestartMessage::Reply::Stats stats;
+    hot_restarting_parent_.exportIndexedStatsToChild(request, &stats);
+    EXPECT_TRUE(stats.stat_names().empty());
+    EXPECT_EQ(2, stats.indexed_counter_deltas().at(c1_index));
+    EXPECT_TRUE(stats.indexed_gauges().empty());
+  }
+  {
+    store.gauge("g1", Stats::Gauge::ImportMode::Accumulate).inc();
+    HotRestartMessage::Reply::Stats stats;
+    hot_restarting_parent_.exportIndexedStatsToChild(request, &stats);
+    EXPECT_TRUE(stats.stat_names().empty());
+    EXPECT_TRUE(stats.indexed_counter_deltas().empty());
+    EXPECT_EQ(124, stats.indexed_gauges().at(g1_index));
+  }
+  // A new child starts over.
+  request.set_forget_indexes(true);
+  {
+    HotRestartMessage::Reply::Stats stats;
+    hot_restarting_parent_.exportIndexedStatsToChild(request, &stats);
+    ASSERT_EQ(1, stats.stat_names().size());
+    EXPECT_EQ("g1", stats.stat_names().begin()->second);
+    EXPECT_EQ(124, stats.indexed_gauges().at(stats.stat_names().begin()->first));
+  }
+}
+
 TEST_F(HotRestartingParentTest, RetainDynamicStats) {
   MockListenerManager listener_manager;
   Stats::SymbolTableImpl parent_symbol_table;
@@ -157,6 +227,210 @@ TEST_F(HotRestartingParentTest, DrainListeners) {
   hot_restarting_parent_.drainListeners();
 }
 
+// Without the runtime feature the parent hands over no connections.
+TEST_F(HotRestartingParentTest, ReleaseConnectionsForChildDisabled) {
+  EXPECT_CALL(server_, listenerManager()).Times(0);
+  EXPECT_FALSE(hot_restarting_parent_.releaseConnectionsForChild(
+      [](std::vector<HotRestartingParent::Internal::ConnectionsReply>&&) { FAIL(); }));
+}
+
+TEST_F(HotRestartingParentTest, ReleaseConnectionsForChild) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.hot_restart_transfer_idle_connections", "true"}});
+  MockListenerManager listener_manager;
+  auto io_handle = std::make_unique<NiceMock<Network::MockIoHandle>>();
+  EXPECT_CALL(*io_handle, fdDoNotUse()).WillRepeatedly(Return(42));
+  Network::Address::Ipv4Instance address("127.0.0.1", 80);
+  EXPECT_CALL(server_, listenerManager()).WillOnce(ReturnRef(listener_manager));
+  EXPECT_CALL(listener_manager, releaseTransferableConnections(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler::ReleasedConnectionCb cb,
+                           std::function<void()> completion) {
+        cb(std::move(io_handle), address);
+        completion();
+      }));
+
+  std::vector<HotRestartingParent::Internal::ConnectionsReply> replies;
+  EXPECT_TRUE(hot_restarting_parent_.releaseConnectionsForChild(
+      [&replies](std::vector<HotRestartingParent::Internal::ConnectionsReply>&& r) {
+        replies = std::move(r);
+      }));
+  ASSERT_EQ(1, replies.size());
+  const auto& connections = replies[0].message_.reply().pass_connections().connections();
+  ASSERT_EQ(1, connections.size());
+  EXPECT_EQ(42, connections[0].fd());
+  EXPECT_EQ("tcp://127.0.0.1:80", connections[0].listener_address());
+  // The socket stays open until the reply is sent.
+  EXPECT_EQ(1, replies[0].io_handles_.size());
+}
+
+// Each reply passes as many connections as one sendmsg() can.
+TEST_F(HotRestartingParentTest, ReleaseConnectionsForChildBatches) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.hot_restart_transfer_idle_connections", "true"}});
+  MockListenerManager listener_manager;
+  Network::Address::Ipv4Instance address("127.0.0.1", 80);
+  EXPECT_CALL(server_, listenerManager()).WillOnce(ReturnRef(listener_manager));
+  EXPECT_CALL(listener_manager, releaseTransferableConnections(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler::ReleasedConnectionCb cb,
+                           std::function<void()> completion) {
+        for (int i = 0; i < 254; ++i) {
+          cb(std::make_unique<NiceMock<Network::MockIoHandle>>(), address);
+        }
+        completion();
+      }));
+
+  std::vector<HotRestartingParent::Internal::ConnectionsReply> replies;
+  EXPECT_TRUE(hot_restarting_parent_.releaseConnectionsForChild(
+      [&replies](std::vector<HotRestartingParent::Internal::ConnectionsReply>&& r) {
+        replies = std::move(r);
+      }));
+  ASSERT_EQ(2, replies.size());
+  EXPECT_EQ(253, replies[0].message_.reply().pass_connections().connections_size());
+  EXPECT_EQ(253, replies[0].io_handles_.size());
+  EXPECT_EQ(1, replies[1].message_.reply().pass_connections().connections_size());
+  EXPECT_EQ(1, replies[1].io_handles_.size());
+}
+
+// Nothing is sent while no connection goes idle.
+TEST_F(HotRestartingParentTest, ReleaseConnectionsForChildNone) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.hot_restart_transfer_idle_connections", "true"}});
+  MockListenerManager listener_manager;
+  EXPECT_CALL(server_, listenerManager()).WillOnce(ReturnRef(listener_manager));
+  EXPECT_CALL(listener_manager, releaseTransferableConnections(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler::ReleasedConnectionCb,
+                           std::function<void()> completion) { completion(); }));
+
+  bool called = false;
+  EXPECT_TRUE(hot_restarting_parent_.releaseConnectionsForChild(
+      [&called](std::vector<HotRestartingParent::Internal::ConnectionsReply>&& replies) {
+        EXPECT_TRUE(replies.empty());
+        called = true;
+      }));
+  EXPECT_TRUE(called);
+}
+
+// A parent and a child talking over their domain sockets.
+// Without the shared session cache, there is nothing to hand over.
+TEST_F(HotRestartingParentTest, ExportServerSessionStateDisabled) {
+  HotRestartMessage message = hot_restarting_parent_.exportServerSessionState();
+  ASSERT_TRUE(message.reply().has_server_session_state());
+  EXPECT_EQ(0, message.reply().server_session_state().ticket_keys_size());
+  EXPECT_EQ(0, message.reply().server_session_state().sessions_size());
+}
+
+TEST_F(HotRestartingParentTest, ExportServerSessionState) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.tls_shared_server_session_cache", "true"}});
+  HotRestartMessage message = hot_restarting_parent_.exportServerSessionState();
+  const HotRestartMessage::Reply::ServerSessionState& reply =
+      message.reply().server_session_state();
+  ASSERT_EQ(1, reply.ticket_keys_size());
+  EXPECT_EQ(16, reply.ticket_keys(0).name().size());
+  EXPECT_EQ(32, reply.ticket_keys(0).hmac_key().size());
+  EXPECT_EQ(32, reply.ticket_keys(0).aes_key().size());
+}
+
+class HotRestartingParentChildTest : public testing::Test {
+public:
+  HotRestartingParentChildTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        socket_path_(fmt::format("@envoy_hot_restarting_parent_test_{}", getpid())),
+        parent_(0, 0, socket_path_, 0), child_(0, 1, socket_path_, 0) {}
+
+  ~HotRestartingParentChildTest() override {
+    parent_.shutdown();
+    child_.shutdown();
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  const std::string socket_path_;
+  NiceMock<MockInstance> server_;
+  HotRestartingParent parent_;
+  HotRestartingChild child_;
+};
+
+// The parent keeps sending the connections it releases, more than one message passes, and the
+// child takes them as they arrive.
+TEST_F(HotRestartingParentChildTest, PassConnections) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.hot_restart_transfer_idle_connections", "true"}});
+  MockListenerManager listener_manager;
+  ON_CALL(server_, listenerManager()).WillByDefault(ReturnRef(listener_manager));
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  Network::Address::Ipv4Instance address("127.0.0.1", 80);
+  EXPECT_CALL(listener_manager, releaseTransferableConnections(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler::ReleasedConnectionCb cb,
+                           std::function<void()> completion) {
+        for (int i = 0; i < 300; ++i) {
+          cb(std::make_unique<Network::IoSocketHandleImpl>(dup(fds[0])), address);
+        }
+        completion();
+      }))
+      .WillRepeatedly(Invoke([](Network::ConnectionHandler::ReleasedConnectionCb,
+                                std::function<void()> completion) { completion(); }));
+  parent_.initialize(*dispatcher_, server_);
+
+  std::vector<int> adopted;
+  child_.duplicateParentConnections(*dispatcher_,
+                                    [&adopted](int fd, const std::string& listener_address) {
+                                      EXPECT_EQ("tcp://127.0.0.1:80", listener_address);
+                                      adopted.push_back(fd);
+                                    });
+  for (int i = 0; i < 100 && adopted.size() < 300; ++i) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  ASSERT_EQ(300, adopted.size());
+
+  // The child's copies belong to the same connection.
+  ASSERT_EQ(1, write(adopted.back(), "a", 1));
+  char c;
+  ASSERT_EQ(1, read(fds[1], &c, 1));
+  for (int fd : adopted) {
+    close(fd);
+  }
+  close(fds[0]);
+  close(fds[1]);
+}
+
+// The child blocks on the parent's reply, so the parent serves it from another thread.
+TEST_F(HotRestartingParentChildTest, ServerSessionState) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.tls_shared_server_session_cache", "true"}});
+  Ssl::ServerSessionState state;
+  state.ticket_keys_.resize(2);
+  state.ticket_keys_[0].name_.fill('a');
+  state.ticket_keys_[1].aes_key_.fill('b');
+  state.ticket_key_age_ = std::chrono::seconds(42);
+  // More than fits in a single datagram.
+  state.sessions_.assign(3, std::string(3000, 's'));
+  Ssl::MockContextManager ssl_context_manager;
+  ON_CALL(server_, sslContextManager()).WillByDefault(ReturnRef(ssl_context_manager));
+  EXPECT_CALL(ssl_context_manager, exportServerSessionState()).WillOnce(Return(state));
+  parent_.initialize(*dispatcher_, server_);
+
+  auto parent_thread = api_->threadFactory().createThread(
+      [this]() { dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit); });
+  absl::optional<Ssl::ServerSessionState> received = child_.getParentServerSessionState();
+  dispatcher_->post([this]() { dispatcher_->exit(); });
+  parent_thread->join();
+
+  ASSERT_TRUE(received.has_value());
+  ASSERT_EQ(2, received->ticket_keys_.size());
+  EXPECT_EQ(state.ticket_keys_[0].name_, received->ticket_keys_[0].name_);
+  EXPECT_EQ(state.ticket_keys_[1].aes_key_, received->ticket_keys_[1].aes_key_);
+  EXPECT_EQ(42, received->ticket_key_age_.count());
+  EXPECT_EQ(state.sessions_, received->sessions_);
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
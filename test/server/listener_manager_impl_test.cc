@@ -41,6 +41,7 @@ namespace {
 
 using testing::AtLeast;
 using testing::InSequence;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::Throw;
@@ -4373,6 +4374,69 @@ filter_chains:
   EXPECT_EQ(1, server_.stats_store_.counter("listener_manager.listener_stopped").value());
 }
 
+// Validate that an in place filter chain update takes over the listener filters of the updated
+// listener rather than building them again.
+TEST_F(ListenerManagerImplTest, InplaceUpdateReusesListenerFilters) {
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  const std::string listener_foo_yaml = R"EOF(
+name: foo
+traffic_direction: INBOUND
+address:
+  socket_address:
+    address: 127.0.0.1
+    port_value: 1234
+listener_filters:
+- name: envoy.filters.listener.tls_inspector
+filter_chains:
+- filters: []
+  )EOF";
+
+  ListenerHandle* listener_foo = expectListenerCreate(true, true);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, {true}));
+  EXPECT_CALL(listener_factory_, createListenerFilterFactoryList(_, _));
+  EXPECT_CALL(listener_foo->target_, initialize());
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV3Yaml(listener_foo_yaml), "", true));
+  EXPECT_CALL(*worker_, addListener(_, _, _));
+  listener_foo->target_.ready();
+  worker_->callAddCompletion(true);
+  EXPECT_EQ(1UL, manager_->listeners().size());
+
+  const std::string listener_foo_update1_yaml = R"EOF(
+name: foo
+traffic_direction: INBOUND
+address:
+  socket_address:
+    address: 127.0.0.1
+    port_value: 1234
+listener_filters:
+- name: envoy.filters.listener.tls_inspector
+filter_chains:
+- filters:
+  filter_chain_match:
+    destination_port: 1234
+  )EOF";
+
+  ListenerHandle* listener_foo_update1 = expectListenerOverridden(true);
+  EXPECT_CALL(listener_factory_, createListenerFilterFactoryList(_, _)).Times(0);
+  EXPECT_CALL(listener_foo_update1->target_, initialize());
+  EXPECT_TRUE(
+      manager_->addOrUpdateListener(parseListenerFromV3Yaml(listener_foo_update1_yaml), "", true));
+  EXPECT_EQ(1, server_.stats_store_.counter("listener_manager.listener_in_place_updated").value());
+
+  EXPECT_CALL(*listener_foo_update1, onDestroy());
+  EXPECT_CALL(*worker_, stopListener(_, _));
+  EXPECT_CALL(*listener_factory_.socket_, close());
+  EXPECT_CALL(*listener_foo->drain_manager_, startDrainSequence(_));
+  EXPECT_TRUE(manager_->removeListener("foo"));
+  EXPECT_CALL(*worker_, removeListener(_, _));
+  listener_foo->drain_manager_->drain_sequence_completion_();
+  EXPECT_CALL(*listener_foo, onDestroy());
+  worker_->callRemovalCompletion();
+  EXPECT_EQ(0UL, manager_->listeners().size());
+}
+
 TEST_F(ListenerManagerImplTest, RemoveInplaceUpdatingListener) {
   InSequence s;
 
@@ -4876,6 +4940,41 @@ filter_chains:
 
 // This test verifies that on default initialization the UDP Packet Writer
 // is initialized in passthrough mode. (i.e. by using UdpDefaultWriter).
+TEST_F(ListenerManagerImplTest, ReleaseTransferableConnections) {
+  testing::MockFunction<void()> completion;
+  Network::ConnectionHandler::ReleasedConnectionCb cb = [](Network::IoHandlePtr&&,
+                                                           const Network::Address::Instance&) {};
+  // Without workers there is nothing to release.
+  EXPECT_CALL(*worker_, releaseTransferableConnections(_, _)).Times(0);
+  EXPECT_CALL(completion, Call());
+  manager_->releaseTransferableConnections(cb, completion.AsStdFunction());
+
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+  EXPECT_CALL(*worker_, releaseTransferableConnections(_, _))
+      .WillOnce(Invoke([](Network::ConnectionHandler::ReleasedConnectionCb,
+                          std::function<void()> worker_completion) { worker_completion(); }));
+  EXPECT_CALL(server_.dispatcher_, post(_));
+  EXPECT_CALL(completion, Call());
+  manager_->releaseTransferableConnections(cb, completion.AsStdFunction());
+}
+
+TEST_F(ListenerManagerImplTest, AdoptParentConnections) {
+  // The connections can't be adopted before the workers start.
+  EXPECT_CALL(server_.hot_restart_, duplicateParentConnections(_, _)).Times(0);
+  manager_->adoptParentConnections();
+
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+  // A connection whose socket is already gone is dropped.
+  EXPECT_CALL(server_.hot_restart_, duplicateParentConnections(Ref(server_.dispatcher_), _))
+      .WillOnce(Invoke([](Event::Dispatcher&, const HotRestart::ParentConnectionCb& cb) {
+        cb(-1, "tcp://127.0.0.1:1234");
+      }));
+  EXPECT_CALL(*worker_, adoptConnection(_, _)).Times(0);
+  manager_->adoptParentConnections();
+}
+
 TEST_F(ListenerManagerImplTest, UdpDefaultWriterConfig) {
   const envoy::config::listener::v3::Listener listener = parseListenerFromV3Yaml(R"EOF(
 address:
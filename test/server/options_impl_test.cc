@@ -89,7 +89,8 @@ TEST_F(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 0 "
       "--local-address-ip-version v6 -l info --component-log-level upstream:debug,connection:trace "
       "--service-cluster cluster --service-node node --service-zone zone "
-      "--file-flush-interval-msec 9000 "
+      "--file-flush-interval-msec 9000 --file-flush-buffer-limit-bytes 1048576 "
+      "--file-flush-overflow-policy block "
       "--drain-time-s 60 --log-format [%v] --enable-fine-grain-logging --parent-shutdown-time-s 90 "
       "--log-path "
       "/foo/bar "
@@ -112,6 +113,8 @@ TEST_F(OptionsImplTest, All) {
   EXPECT_EQ("node", options->serviceNodeName());
   EXPECT_EQ("zone", options->serviceZone());
   EXPECT_EQ(std::chrono::milliseconds(9000), options->fileFlushIntervalMsec());
+  EXPECT_EQ(1048576U, options->fileFlushBufferLimitBytes());
+  EXPECT_EQ(Server::FileFlushOverflowPolicy::Block, options->fileFlushOverflowPolicy());
   EXPECT_EQ(std::chrono::seconds(60), options->drainTime());
   EXPECT_EQ(std::chrono::seconds(90), options->parentShutdownTime());
   EXPECT_TRUE(options->hotRestartDisabled());
@@ -180,6 +183,8 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setLogPath("/foo/bar");
   options->setRestartEpoch(44);
   options->setFileFlushIntervalMsec(std::chrono::milliseconds(45));
+  options->setFileFlushBufferLimitBytes(4096);
+  options->setFileFlushOverflowPolicy(Server::FileFlushOverflowPolicy::Block);
   options->setMode(Server::Mode::Validate);
   options->setServiceClusterName("cluster_foo");
   options->setServiceNodeName("node_foo");
@@ -210,6 +215,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(std::chrono::seconds(43), options->parentShutdownTime());
   EXPECT_EQ(44, options->restartEpoch());
   EXPECT_EQ(std::chrono::milliseconds(45), options->fileFlushIntervalMsec());
+  EXPECT_EQ(4096U, options->fileFlushBufferLimitBytes());
+  EXPECT_EQ(Server::FileFlushOverflowPolicy::Block, options->fileFlushOverflowPolicy());
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ("cluster_foo", options->serviceClusterName());
   EXPECT_EQ("node_foo", options->serviceNodeName());
@@ -244,6 +251,10 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->restartEpoch(), command_line_options->restart_epoch());
   EXPECT_EQ(options->fileFlushIntervalMsec().count() / 1000,
             command_line_options->file_flush_interval().seconds());
+  EXPECT_EQ(options->fileFlushBufferLimitBytes(),
+            command_line_options->file_flush_buffer_limit_bytes());
+  EXPECT_EQ(envoy::admin::v3::CommandLineOptions::Block,
+            command_line_options->file_flush_overflow_policy());
   EXPECT_EQ(envoy::admin::v3::CommandLineOptions::Validate, command_line_options->mode());
   EXPECT_EQ(options->serviceClusterName(), command_line_options->service_cluster());
   EXPECT_EQ(options->serviceNodeName(), command_line_options->service_node());
@@ -266,6 +277,8 @@ TEST_F(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(spdlog::level::warn, options->logLevel());
   EXPECT_EQ("@envoy_domain_socket", options->socketPath());
   EXPECT_EQ(0, options->socketMode());
+  EXPECT_EQ(0U, options->fileFlushBufferLimitBytes());
+  EXPECT_EQ(Server::FileFlushOverflowPolicy::Drop, options->fileFlushOverflowPolicy());
   EXPECT_FALSE(options->hotRestartDisabled());
   EXPECT_FALSE(options->cpusetThreadsEnabled());
 
@@ -331,6 +344,9 @@ TEST_F(OptionsImplTest, OptionsFromArgvPrefix) {
 TEST_F(OptionsImplTest, BadCliOption) {
   EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --local-address-ip-version foo"),
                           MalformedArgvException, "error: unknown IP address version 'foo'");
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --file-flush-overflow-policy foo"),
+                          MalformedArgvException,
+                          "error: unknown file-flush-overflow-policy 'foo'");
 }
 
 TEST_F(OptionsImplTest, ParseComponentLogLevels) {
@@ -434,6 +450,10 @@ TEST_F(OptionsImplTest, SaneTestConstructor) {
   EXPECT_EQ(regular_options_impl->mode(), test_options_impl.mode());
   EXPECT_EQ(regular_options_impl->fileFlushIntervalMsec(),
             test_options_impl.fileFlushIntervalMsec());
+  EXPECT_EQ(regular_options_impl->fileFlushBufferLimitBytes(),
+            test_options_impl.fileFlushBufferLimitBytes());
+  EXPECT_EQ(regular_options_impl->fileFlushOverflowPolicy(),
+            test_options_impl.fileFlushOverflowPolicy());
   EXPECT_EQ(regular_options_impl->hotRestartDisabled(), test_options_impl.hotRestartDisabled());
   EXPECT_EQ(regular_options_impl->cpusetThreadsEnabled(), test_options_impl.cpusetThreadsEnabled());
 }
@@ -16,6 +16,7 @@
 #include "test/mocks/protobuf/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/registry.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -129,7 +130,7 @@ private:
   }
 };
 
-class OverloadManagerImplTest : public testing::Test {
+class OverloadManagerImplTest : public Event::TestUsingSimulatedTime, public testing::Test {
 protected:
   OverloadManagerImplTest()
       : factory1_("envoy.resource_monitors.fake_resource1"),
@@ -355,6 +356,58 @@ TEST_F(OverloadManagerImplTest, ScaledTrigger) {
   EXPECT_EQ(100, scale_percent_gauge.value());
 }
 
+TEST_F(OverloadManagerImplTest, RampDown) {
+  setDispatcherExpectation();
+
+  auto manager(createOverloadManager(R"YAML(
+  refresh_interval:
+    seconds: 1
+  resource_monitors:
+    - name: envoy.resource_monitors.fake_resource1
+  actions:
+    - name: envoy.overload_actions.dummy_action
+      triggers:
+        - name: envoy.resource_monitors.fake_resource1
+          scaled:
+            scaling_threshold: 0.5
+            saturation_threshold: 0.9
+      ramp_down_duration: 10s
+)YAML"));
+  manager->start();
+  const auto& action_state =
+      manager->getThreadLocalOverloadState().getState("envoy.overload_actions.dummy_action");
+
+  // Increases in pressure take effect immediately.
+  factory1_.monitor_->setPressure(0.9);
+  timer_cb_();
+  EXPECT_TRUE(action_state.isSaturated());
+
+  // Decreases take effect at the rate of 0.1 per second.
+  factory1_.monitor_->setPressure(0.1);
+  simTime().advanceTimeWait(std::chrono::seconds(1));
+  timer_cb_();
+  EXPECT_FLOAT_EQ(0.9, action_state.value());
+  simTime().advanceTimeWait(std::chrono::seconds(3));
+  timer_cb_();
+  EXPECT_FLOAT_EQ(0.6, action_state.value());
+
+  // The state doesn't ramp down below the current pressure, and follows increases right away.
+  factory1_.monitor_->setPressure(0.7);
+  simTime().advanceTimeWait(std::chrono::seconds(3));
+  timer_cb_();
+  EXPECT_FLOAT_EQ(0.5, action_state.value());
+  factory1_.monitor_->setPressure(0.8);
+  timer_cb_();
+  EXPECT_FLOAT_EQ(0.75, action_state.value());
+
+  factory1_.monitor_->setPressure(0.1);
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  timer_cb_();
+  EXPECT_EQ(0, action_state.value());
+
+  manager->stop();
+}
+
 TEST_F(OverloadManagerImplTest, FailedUpdates) {
   setDispatcherExpectation();
   auto manager(createOverloadManager(kRegularStateConfig));
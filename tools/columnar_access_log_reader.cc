@@ -0,0 +1,101 @@
+/**
+ * Utility to print the blocks of a columnar access log as tab-separated text. Each block starts
+ * with a line holding the column names prefixed by '#'. Null values print as '-', and tabs,
+ * newlines and other unprintable characters in the values are escaped.
+ *
+ * Usage:
+ *
+ * columnar_access_log_reader <columnar access log path>
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/headers.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/access_loggers/columnar/columnar_format.h"
+#include "extensions/compression/brotli/decompressor/brotli_decompressor_impl.h"
+#include "extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
+#include "extensions/compression/zstd/decompressor/zstd_decompressor_impl.h"
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_join.h"
+
+namespace {
+
+// The largest windows the compressor library configurations allow.
+constexpr int64_t GzipWindowBits = 15 | 16;
+constexpr uint32_t ZstdWindowLogMax = 27;
+constexpr uint32_t ChunkSize = 64 * 1024;
+
+} // namespace
+
+// NOLINT(namespace-envoy)
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <columnar access log path>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file) {
+    std::cerr << "Unable to open " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  Envoy::Buffer::OwnedImpl input(
+      std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+
+  Envoy::Stats::IsolatedStoreImpl stats_store;
+  const auto& encodings = Envoy::Http::CustomHeaders::get().ContentEncodingValues;
+  auto decompressor_lookup = [&](absl::string_view encoding)
+      -> Envoy::Compression::Decompressor::DecompressorPtr {
+    if (encoding == encodings.Gzip) {
+      auto decompressor = std::make_unique<
+          Envoy::Extensions::Compression::Gzip::Decompressor::ZlibDecompressorImpl>(
+          stats_store, "gzip.", ChunkSize);
+      decompressor->init(GzipWindowBits);
+      return decompressor;
+    }
+    if (encoding == encodings.Brotli) {
+      return std::make_unique<
+          Envoy::Extensions::Compression::Brotli::Decompressor::BrotliDecompressorImpl>(
+          stats_store, "brotli.", ChunkSize, false, nullptr);
+    }
+    if (encoding == encodings.Zstd) {
+      return std::make_unique<
+          Envoy::Extensions::Compression::Zstd::Decompressor::ZstdDecompressorImpl>(
+          stats_store, "zstd.", ZstdWindowLogMax, ChunkSize, nullptr);
+    }
+    return nullptr;
+  };
+
+  Envoy::Extensions::AccessLoggers::Columnar::DecodedBlock block;
+  try {
+    while (Envoy::Extensions::AccessLoggers::Columnar::decodeBlock(input, decompressor_lookup,
+                                                                    block)) {
+      std::cout << "#" << absl::StrJoin(block.column_names_, "\t") << "\n";
+      const size_t rows = block.columns_.empty() ? 0 : block.columns_[0].size();
+      for (size_t row = 0; row < rows; ++row) {
+        for (size_t column = 0; column < block.columns_.size(); ++column) {
+          const auto& value = block.columns_[column][row];
+          std::cout << (column == 0 ? "" : "\t") << (value ? absl::CEscape(*value) : "-");
+        }
+        std::cout << "\n";
+      }
+    }
+  } catch (const Envoy::EnvoyException& e) {
+    std::cerr << argv[1] << ": " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (input.length() != 0) {
+    std::cerr << argv[1] << ": " << input.length() << " trailing bytes of an incomplete block"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}